@@ -140,3 +140,5 @@ end
 -- PROJECTS
 GenerateProject("00_Testing")
 GenerateProject("01_Assignment")
+GenerateProject("02_Benchmarks")
+GenerateProject("03_Tests")
@@ -31,6 +31,22 @@ cbuffer CustomConstantBuffer : register(b0) {
   unsigned int is_light_sensitive;
 };
 
+// Quadtree terrain node being drawn.
+cbuffer TerrainConstantBuffer : register(b1) {
+  float4 terrain_node;      // First sample x and z, samples covered, patch quads.
+  float4 terrain_morph;     // Morph start and end distances.
+  float4 terrain_camera;    // Camera position in terrain space.
+  float4 terrain_size;      // Sample spacing x, height, sample spacing z.
+  float4 terrain_samples;   // Width, height, 1 / (width - 1), 1 / (height - 1).
+  float4 terrain_offset;    // Tile position in terrain space, streamed terrains.
+};
+
+// Bounds of the packed vertex positions.
+cbuffer PackedConstantBuffer : register(b2) {
+  float4 packed_position_min;
+  float4 packed_position_extent;
+};
+
 
 /******************************************************************************/
 /********                   INPUT OUTPUT STRUCTS                       ********/
@@ -66,6 +82,7 @@ Texture2D texture_material_map : register(t1);
 Texture2D texture_grass : register(t2);
 Texture2D texture_moss : register(t3);
 Texture2D texture_asphalt : register(t4);
+Texture2D<float> texture_height : register(t5);
 
 
 
@@ -85,6 +102,20 @@ struct Light {
 /********                      VERTEX FUNCTIONS                        ********/
 /******************************************************************************/
 
+// Bilinear terrain height, sample coordinates are clamped to the terrain.
+float TerrainHeight(float2 sample_position) {
+  float2 last_sample = terrain_samples.xy - 1.0f;
+  sample_position = clamp(sample_position, 0.0f, last_sample);
+  int2 first = int2(floor(sample_position));
+  int2 second = min(first + 1, int2(last_sample));
+  float2 t = sample_position - first;
+
+  float h00 = texture_height.Load(int3(first.x, first.y, 0));
+  float h10 = texture_height.Load(int3(second.x, first.y, 0));
+  float h01 = texture_height.Load(int3(first.x, second.y, 0));
+  float h11 = texture_height.Load(int3(second.x, second.y, 0));
+  return lerp(lerp(h00, h10, t.x), lerp(h01, h11, t.x), t.y) * terrain_size.y;
+}
 
 
 /******************************************************************************/
@@ -122,6 +153,71 @@ PixelInfo VertexShaderFunction(VertexInfo vertex_info) {
 }
 
 
+// Same inputs already expanded by the input layout: positions are unorm 16
+// inside the mesh bounds and normals unorm 10:10:10:2.
+PixelInfo PackedVertexShaderFunction(VertexInfo vertex_info) {
+  vertex_info.vPosition = float4(packed_position_min.xyz +
+                                 vertex_info.vPosition.xyz * packed_position_extent.xyz, 1.0f);
+  vertex_info.vNormal = float4(vertex_info.vNormal.xyz * 2.0f - 1.0f, 0.0f);
+  return VertexShaderFunction(vertex_info);
+}
+
+
+PixelInfo TerrainVertexShaderFunction(VertexInfo vertex_info) {
+  PixelInfo pixel_info;
+
+  // Patch grid position, in quads, and node position, in samples.
+  float patch_quads = terrain_node.w;
+  float quad_samples = terrain_node.z / patch_quads;
+  float2 grid = vertex_info.vPosition.xz * patch_quads;
+  float2 last_sample = terrain_samples.xy - 1.0f;
+  float2 sample_position = min(terrain_node.xy + grid * quad_samples, last_sample);
+
+  // Geomorphing, the odd vertices slide to the next level before the switch.
+  float3 position = float3(sample_position.x * terrain_size.x,
+                           TerrainHeight(sample_position),
+                           sample_position.y * terrain_size.z) + terrain_offset.xyz;
+  float morph = saturate((distance(position, terrain_camera.xyz) - terrain_morph.x) /
+                         (terrain_morph.y - terrain_morph.x));
+  float2 odd = frac(grid * 0.5f) * 2.0f;
+  sample_position = min(terrain_node.xy + (grid - odd * morph) * quad_samples, last_sample);
+
+  position = float3(sample_position.x * terrain_size.x,
+                    TerrainHeight(sample_position),
+                    sample_position.y * terrain_size.z) + terrain_offset.xyz;
+
+  pixel_info.Position = float4(position, 1.0f);
+  pixel_info.Position = mul(pixel_info.Position, m.model);
+  pixel_info.Position = mul(pixel_info.Position, m.view);
+  pixel_info.Position = mul(pixel_info.Position, m.projection);
+
+  // Normal from the heights around.
+  float left = TerrainHeight(sample_position - float2(1.0f, 0.0f));
+  float right = TerrainHeight(sample_position + float2(1.0f, 0.0f));
+  float back = TerrainHeight(sample_position - float2(0.0f, 1.0f));
+  float front = TerrainHeight(sample_position + float2(0.0f, 1.0f));
+  pixel_info.Normal = float4((left - right) / (2.0f * terrain_size.x),
+                             1.0f,
+                             (back - front) / (2.0f * terrain_size.z),
+                             0.0f);
+  pixel_info.Normal = mul(pixel_info.Normal, m.model);
+  pixel_info.Normal = normalize(pixel_info.Normal);
+
+  // Same uvs the terrain mesh had, every streamed tile repeats the texture.
+  pixel_info.TexCoord = float2(sample_position.x * terrain_samples.z,
+                               1.0f - sample_position.y * terrain_samples.w);
+
+  pixel_info.Color = vertex_info.vColor;
+
+  pixel_info.MapColor = float4(0.0f, 0.0f, 0.0f, 0.0f);
+  if (type == TERRAIN) {
+    pixel_info.MapColor = texture_material_map.SampleLevel(sampler_type, pixel_info.TexCoord, 0);
+  }
+
+  return pixel_info;
+}
+
+
 /******************************************************************************/
 /********                      PIXEL FUNCTIONS                         ********/
 /******************************************************************************/
@@ -11,14 +11,17 @@
 
 #include <vector>
 #include "Wolfy3D.h"
-#include "bone.h"
+#include "core/skeleton.h"
+#include "core/animation_clip.h"
+#include "core/baked_animation_clip.h"
+#include "core/pose_blender.h"
 
 namespace W3D {
-  
+
 class Animation {
 
 public:
-  
+
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
 *******************************************************************************/
@@ -35,25 +38,27 @@ public:
 /*******************************************************************************
 ***                               Public methods                             ***
 *******************************************************************************/
-  
+
   ///--------------------------------------------------------------------------
-  /// @fn   void initFromFile();
+  /// @fn   void init(const AnimationClip* shared_clip);
   ///
-  /// @brief  Initializes all the bpmes of the class by parsing an xml file.
-  /// @param  filename XML file with the bones info.
+  /// @brief  Sets the clip played, shared with the rest of instances.
+  /// @param  shared_clip Keyframes of every bone, nullptr plays nothing.
   ///--------------------------------------------------------------------------
-  void initFromFile(const char* filename);
+  void init(const AnimationClip* shared_clip);
 
   ///--------------------------------------------------------------------------
-  /// @fn   void update(const float32& delta_time);
+  /// @fn   void update(const float32& delta_time, Pose* pose);
   ///
-  /// @param delta_time Delta time, time in miliseconds between frames.
-  /// @brief updates all the elements of the class.
+  /// @param delta_time Delta time, time in seconds between frames.
+  /// @param pose Pose where every bone is written.
+  /// @brief Advances the time, looping at the end of the clip, and samples
+  ///        every bone there. Any delta is exact, however many keys it skips.
   ///--------------------------------------------------------------------------
-  void update(const float32& delta_time);
+  void update(const float32& delta_time, Pose* pose);
 
   ///--------------------------------------------------------------------------
-  /// @fn   void start(const bool apply_blending = true, 
+  /// @fn   void start(const bool apply_blending = true,
   ///                  const float32 blending_duration = 0.5f);
   ///
   /// @brief Starts the animation from the first step applying a smooth blending.
@@ -62,12 +67,21 @@ public:
   ///--------------------------------------------------------------------------
   void start(const bool apply_blending = true, const float32 blending_duration = 0.5f);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void seek(const float32 time);
+  ///
+  /// @brief Jumps to any time of the clip, ending the blending if any. The
+  ///        pose changes on the next update, even with no delta.
+  /// @param time Seconds since the start, wrapped to the clip duration.
+  ///--------------------------------------------------------------------------
+  void seek(const float32 time);
 
 /*******************************************************************************
 ***                          Setters and Getters                             ***
 *******************************************************************************/
 
-
+  /// Seconds played since the start of the clip.
+  float32 time() const;
 
 /*******************************************************************************
 ***                           Public  Attributes                                 ***
@@ -77,63 +91,33 @@ public:
   float32 speed;
   /// Robot class.
   class Robot* robot;
-
-
+  /// Keyframes of every bone, shared by every robot.
+  const AnimationClip* clip;
+  /// Frames of the clip baked, shared by every robot. Played instead of
+  /// the keys when set, with the bones without keys in the rest pose.
+  const BakedAnimationClip* baked;
 
 private:
 
-/*******************************************************************************
-***                             Private methods                              ***
-*******************************************************************************/
-
-  /// Updates all the bones positions.
-  void updateBonesPositions(const float32& delta_time);
-  /// Updates all the bones rotations.
-  void updateBonesRotations(const float32& delta_time);
-
-
 /*******************************************************************************
 ***                           Private Attributes                             ***
 *******************************************************************************/
 
-  /* Bones hierarchy */
-
-/// Root bone.
-  Bone robot_root;
-  /// Body bone.
-  Bone body;
-  /// Left Ankle bone.
-  Bone left_ankle;
-  /// Left Elbow bone.
-  Bone left_elbow;
-  /// Left Hip bone.
-  Bone left_hip;
-  /// Left Knee bone.
-  Bone left_knee;
-  /// Left Shoulder bone.
-  Bone left_shoulder;
-  /// Left Wrist bone.
-  Bone left_wrist;
-  /// Right Ankle bone.
-  Bone right_ankle;
-  /// Right Elbow bone.
-  Bone right_elbow;
-  /// Right Hip bone.
-  Bone right_hip;
-  /// Right Knee bone.
-  Bone right_knee;
-  /// Right Shoulder bone.
-  Bone right_shoulder;
-  /// Right Wrist bone.
-  Bone right_wrist;
-  /// Neck bone.
-  Bone neck;
-  /// Pelvis bone.
-  Bone pelvis_presley;
-
+  /// Playback time, the only per instance data besides the speed and the
+  /// blending.
+  float32 time_;
+  /// Blending from the start pose to the first keys, before playing.
+  float32 blend_time_;
+  float32 blend_duration_;
+  /// Bones when the animation started. Blended from, and held by the bones
+  /// without keys.
+  Pose start_pose_;
+  /// Mixes the start pose and the clip one while blending. Not copied, it
+  /// keeps no state between updates.
+  PoseBlender blender_;
 
 }; /* Animation */
 
 }; /* W3D */
 
-#endif
\ No newline at end of file
+#endif
@@ -39,7 +39,8 @@ public:
   ///--------------------------------------------------------------------------
   /// @fn   void init();
   ///
-  /// @brief  Initializes all the animations of the class.
+  /// @brief  Initializes all the animations of the class for the robot
+  ///         skeleton.
   ///--------------------------------------------------------------------------
   void init();
 
@@ -51,6 +52,16 @@ public:
   ///--------------------------------------------------------------------------
   void update(const float32& delta_time);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void setBaked(Animation* animation, const bool baked);
+  ///
+  /// @brief  Plays an animation from its clip baked at a fixed rate, or from
+  ///         its keys. Baked once for every robot, by the clip cache.
+  /// @param  animation Animation of this controller.
+  /// @param  baked True to play the baked frames.
+  ///--------------------------------------------------------------------------
+  void setBaked(Animation* animation, const bool baked);
+
 
 /*******************************************************************************
 ***                          Setters and Getters                             ***
@@ -16,6 +16,9 @@
 #include "core/entity.h"
 
 namespace W3D {
+
+/// Radius of the bullet bounding sphere.
+const float32 kBulletBoundingRadius = 1.0f;
   
 class Bullet {
 
@@ -49,7 +52,9 @@ public:
   /// @fn   void update(const float32& delta_time);
   ///
   /// @param delta_time Delta time, time in miliseconds between frames.
-  /// @brief updates all the elements of the class.
+  /// @brief updates all the elements of the class. The bullet only moves
+  ///        when the significance manager lets it, by the time elapsed
+  ///        since it last did.
   ///--------------------------------------------------------------------------
   void update(const float32& delta_time);
 
@@ -80,6 +85,8 @@ public:
   DirectX::XMFLOAT3 projectile_velocity_;
   /// Set if the bullet is active or not.
   bool is_active_;
+  /// Handle in the significance manager.
+  uint32 significance_;
 
 
 
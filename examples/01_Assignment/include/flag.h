@@ -0,0 +1,134 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+
+#ifndef __FLAG_H__
+#define __FLAG_H__ 1
+
+#include <vector>
+#include "Wolfy3D.h"
+#include "core/geo.h"
+#include "core/core.h"
+#include "core/entity.h"
+
+namespace W3D {
+
+/// Quads of the flag cloth, along the wind and up.
+const uint32 kFlagColumns = 24;
+const uint32 kFlagRows = 12;
+  
+/// Flag waving in the wind, its vertices moved every frame through a
+/// dynamic geometry, only the cloth ones.
+class Flag {
+
+public:
+  
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor
+  Flag();
+  /// Default class destructor
+	~Flag();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+  
+  ///--------------------------------------------------------------------------
+  /// @fn   void init();
+  ///
+  /// @brief  Initializes all the elements of the class.
+  ///--------------------------------------------------------------------------
+  void init();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void update(const float32& delta_time);
+  ///
+  /// @param delta_time Delta time, time in miliseconds between frames.
+  /// @brief Moves the cloth vertices along the wave, they are uploaded at
+  ///        the start of the next frame.
+  ///--------------------------------------------------------------------------
+  void update(const float32& delta_time);
+
+
+/*******************************************************************************
+***                           Public  Attributes                             ***
+*******************************************************************************/
+
+
+  /* Hierarchy */
+
+  /// Object Root node, the bottom of the pole.
+  Entity root_;
+  /// Pole geometry node.
+  Entity pole_;
+  /// Cloth geometry node, at the top of the pole.
+  Entity cloth_;
+
+  /* Parameters */
+
+  /// Waves per second, and their height at the free end.
+  float32 wave_speed_;
+  float32 wave_amplitude_;
+  /// Set if the cloth is waving or not.
+  bool is_waving_;
+
+
+
+private:
+
+/*******************************************************************************
+***                             Private methods                              ***
+*******************************************************************************/
+
+  /// Private copy constructor.
+  Flag(const Flag& copy);
+  /// Private operator of assignment.
+  Flag& operator=(const Flag& copy);
+
+  /// Writes the cloth vertices at a time, front face first and then the
+  /// back one with the normals reversed.
+  void waveCloth(Geometry::Vertex* vertices, const float32 time);
+
+  /* Init methods */
+
+  /// Initialize the geometries.
+  void initGeometries();
+  /// Initialize the transforms.
+  void initTransforms();
+  /// Initialize the material.
+  void initMaterials();
+  /// Initialize the render components.
+  void initRenderComponents();
+
+
+/*******************************************************************************
+***                           Private Attributes                             ***
+*******************************************************************************/
+
+
+  /* Render Properties */
+  
+  /// Material used to render the pole and the cloth. 
+  MaterialDiffuse material_;
+  /// Pole geometry.
+  Geometry geo_pole_;
+  /// Cloth geometry, dynamic.
+  Geometry geo_cloth_;
+
+  /// Seconds waving.
+  float32 time_;
+
+
+
+}; /* Flag */
+
+}; /* W3D */
+
+#endif
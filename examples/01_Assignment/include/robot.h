@@ -15,9 +15,15 @@
 #include "core/geo.h"
 #include "core/core.h"
 #include "core/entity.h"
+#include "core/skeleton.h"
 #include "animation_controller.h"
 
 namespace W3D {
+
+/// Bones of the robot, one piece of the mesh each but the root.
+const uint32 kRobotNumBones = 16;
+/// Radius of the robot bounding sphere, around its root bone.
+const float32 kRobotBoundingRadius = 6.0f;
   
 class Robot {
 
@@ -44,12 +50,22 @@ public:
   void init();
 
   ///--------------------------------------------------------------------------
-  /// @fn   void update(const float32& delta_time);
+  /// @fn   void update(const float32& delta_time, const bool full_rate = false);
   ///
-  /// @brief updates all the elements of the class.
+  /// @brief updates all the elements of the class. The animation only
+  ///        advances when the significance manager lets it, by the time
+  ///        accumulated since it last did.
   /// @param delta_time Delta time, time in miliseconds between frames.
+  /// @param full_rate Animates this frame whatever the significance is.
   ///--------------------------------------------------------------------------
-  void update(const float32& delta_time);
+  void update(const float32& delta_time, const bool full_rate = false);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void applyPose();
+  ///
+  /// @brief Writes the pose of every bone into its node transform.
+  ///--------------------------------------------------------------------------
+  void applyPose();
 
   ///--------------------------------------------------------------------------
   /// @fn   void checkDistanceToPlane(const DirectX::XMVECTOR& plane_pos);
@@ -74,6 +90,23 @@ public:
   ///--------------------------------------------------------------------------
   void set_material_color(const float32 r, const float32 g, const float32 b);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   Entity* bone(const char* name);
+  ///
+  /// @brief Node of a bone.
+  /// @param name Name of the bone in the skeleton.
+  /// @return Node of the bone, nullptr if there is no bone with that name.
+  ///--------------------------------------------------------------------------
+  Entity* bone(const char* name);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   const Pose& rest_pose() const;
+  ///
+  /// @brief Pose of the bones before any animation, shared by every robot.
+  /// @return Rest pose of the skeleton.
+  ///--------------------------------------------------------------------------
+  const Pose& rest_pose() const;
+
   ///--------------------------------------------------------------------------
   /// @fn   void set_animations_speed(const float32 speed);
   ///
@@ -92,38 +125,12 @@ public:
   /// Class root.
   Entity root_;
 
-  /// Root node.
-  Entity robot_root_;
-  /// Body node.
-  Entity body_;
-  /// Left Ankle node.
-  Entity left_ankle_;
-  /// Left Elbow node.
-  Entity left_elbow_;
-  /// Left Hip node.
-  Entity left_hip_;
-  /// Left Knee node.
-  Entity left_knee_;
-  /// Left Shoulder node.
-  Entity left_shoulder_;
-  /// Left Wrist node.
-  Entity left_wrist_;
-  /// Right Ankle node.
-  Entity right_ankle_;
-  /// Right Elbow node.
-  Entity right_elbow_;
-  /// Right Hip node.
-  Entity right_hip_;
-  /// Right Knee node.
-  Entity right_knee_;
-  /// Right Shoulder node.
-  Entity right_shoulder_;
-  /// Right Wrist node.
-  Entity right_wrist_;
-  /// Neck node.
-  Entity neck_;
-  /// Pelvis node.
-  Entity pelvis_presley_;
+  /// Bones hierarchy, parents first, shared by every robot.
+  const Skeleton* skeleton_;
+  /// Node of every bone of the skeleton.
+  Entity bones_[kRobotNumBones];
+  /// Local transform of every bone, written by the animations.
+  Pose pose_;
 
   /// Camera designed to see the robot animations.
   Entity camera_node_;
@@ -148,10 +155,8 @@ private:
 
   /// Initialize the geometries.
   void initGeometries();
-  /// Initialize the names of the nodes.
-  void initNames();
-  /// Initialize textures used in the material.
-  void initHierarchy();
+  /// Initialize the skeleton, and the names and hierarchy of the nodes.
+  void initSkeleton();
   /// Initialize the transforms.
   void initTransforms();
   /// Initialize the material.
@@ -179,40 +184,17 @@ private:
 
   /* Render Properties */
   
-  /// Body geometry.
-  Geometry geo_body_;
-  /// Left Ankle geometry.
-  Geometry geo_left_ankle_;
-  /// Left Elbow geometry.
-  Geometry geo_left_elbow_;
-  /// Left Hip geometry.
-  Geometry geo_left_hip_;
-  /// Left Knee geometry.
-  Geometry geo_left_knee_;
-  /// Left Shoulder geometry.
-  Geometry geo_left_shoulder_;
-  /// Left Wrist geometry.
-  Geometry geo_left_wrist_;
-  /// Right Ankle geometry.
-  Geometry geo_right_ankle_;
-  /// Right Elbow geometry.
-  Geometry geo_right_elbow_;
-  /// Right Hip geometry.
-  Geometry geo_right_hip_;
-  /// Right Knee geometry.
-  Geometry geo_right_knee_;
-  /// Right Shoulder geometry.
-  Geometry geo_right_shoulder_;
-  /// Right Wrist geometry.
-  Geometry geo_right_wrist_;
-  /// Neck geometry.
-  Geometry geo_neck_;
-  /// Pelvis geometry.
-  Geometry geo_pelvis_presley_;
+  /// Geometry of every bone, the root has none.
+  Geometry geometries_[kRobotNumBones];
 
   /// Material used to render. 
   MaterialDiffuse material_;
 
+  /// Handle in the significance manager.
+  uint32 significance_;
+  /// Animation time accumulated while the significance skips the updates.
+  float32 pending_delta_time_;
+
   /// Distance to robot is enough to attack.
   bool is_near_to_plane_;
   /// Distance between robots and plane to change animations.
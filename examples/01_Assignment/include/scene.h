@@ -15,9 +15,13 @@
 #include "bullet.h"
 #include "skybox.h"
 #include "robot.h"
+#include "flag.h"
 
 namespace W3D {
 
+/// Radius of the landing track bounding sphere.
+const float32 kLandingTrackBoundingRadius = 20.0f;
+
 
 /// Class to manage all the scene which will be rendered.
 class Scene {
@@ -97,6 +101,10 @@ public:
   Entity landing_track_;
   /// Landing track camera_;
   Entity landing_track_camera_;
+  /// Flag at the end of the landing track, a dynamic geometry.
+  Flag flag_;
+  /// Landing track handle in the significance manager.
+  uint32 landing_track_significance_;
 
 private:
 
@@ -128,6 +136,8 @@ private:
   void activeRobots();
   /// Sets the animation speed of the robots.
   void setRototsAnimationSpeed(const float32 speed);
+  /// Places the robots and the landing track on the terrain.
+  void groundObjects();
 
 
   /* Animations */
@@ -136,14 +146,22 @@ private:
   void enableAnimationsDebugMode();
   /// Disable Animations debug mode.
   void disableAnimationsDebugMode();
+  /// Moves every robot animation to the next key of its clip.
+  void jumpRobotsToNextKey();
+  /// Moves every robot animation to the time given, in seconds.
+  void seekRobotsAnimations(const float32 time);
   /// Checks if the distance between the robot and the plane is enough to attack.
   void checkDistancesBetweenRobotsAndPlane();
+  /// Plays every robot animation baked or from its keys, as chosen per clip.
+  void bakeRobotsAnimations();
 
 
   /* ImGui */
 
   /// Updates all the Imguie framework to debug and test the scene.
   void updateImgui();
+  /// Shows the significance tiers and budget.
+  void updateSignificanceImgui();
 
 /*******************************************************************************
 ***                           Private Attributes                             ***
@@ -171,10 +189,12 @@ private:
   float32 debug_mode_speed_;
   /// Speed of the animations before entering debug mode.
   float32 last_speed_saved_;
-  /// Keyframe speed to jump between steps.
-  float32 key_frame_step_time_;
   /// Animations current speed.
   float32 animations_speed_;
+  /// Clips played from their baked frames instead of their keys.
+  bool is_idle_baked_;
+  bool is_attack_baked_;
+  bool is_die_baked_;
 
 
 }; /* Scene */
@@ -50,6 +50,16 @@ public:
   ///--------------------------------------------------------------------------
   void update(const float32& delta_time);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   float32 groundHeight(const float32 x, const float32 z);
+  ///
+  /// @param x Scene position x.
+  /// @param z Scene position z.
+  /// @brief Height of the terrain under a scene position.
+  /// @return Scene height of the ground, 0 while the terrain is loading.
+  ///--------------------------------------------------------------------------
+  float32 groundHeight(const float32 x, const float32 z);
+
 
 /*******************************************************************************
 ***                          Setters and Getters                             ***
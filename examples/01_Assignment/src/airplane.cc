@@ -92,10 +92,10 @@ void Airplane::update(const float32& delta_time) {
 
 
 void Airplane::initGeometries() {
-  geo_plane_.initFromFile("../data/geometries/plane/plane.x");
-  geo_prop_.initFromFile("../data/geometries/plane/prop.x");
-  geo_turret_.initFromFile("../data/geometries/plane/turret.x");
-  geo_gun_.initFromFile("../data/geometries/plane/gun.x");
+  geo_plane_.initFromFile("../data/geometries/plane/plane.x", { 1.0f, 1.0f, 1.0f, 1.0f }, true);
+  geo_prop_.initFromFile("../data/geometries/plane/prop.x", { 1.0f, 1.0f, 1.0f, 1.0f }, true);
+  geo_turret_.initFromFile("../data/geometries/plane/turret.x", { 1.0f, 1.0f, 1.0f, 1.0f }, true);
+  geo_gun_.initFromFile("../data/geometries/plane/gun.x", { 1.0f, 1.0f, 1.0f, 1.0f }, true);
 }
 
 void Airplane::initHierarchy() {  
@@ -157,6 +157,12 @@ void Airplane::fire() {
   bullet->projectile_velocity_.y = bullet->projectile_velocity_.y * bullet->projectile_speed_ + traslation_velocity_.y;
   bullet->projectile_velocity_.z = bullet->projectile_velocity_.z * bullet->projectile_speed_ + traslation_velocity_.z;
 
+  // Moves from the spawn point on, whenever its next update is.
+  auto& significance = Core::instance().significance_;
+  significance.set_bounds(bullet->significance_, bullet->root_.transform().world_position_float3(),
+                          kBulletBoundingRadius);
+  significance.restart(bullet->significance_);
+
   bullet_index_++;
   if (bullet_index_ >= num_bullets_) {
     bullet_index_ = 0;
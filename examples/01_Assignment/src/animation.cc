@@ -8,179 +8,125 @@
 #include "robot.h"
 #include "animation.h"
 #include "imgui/imgui.h"
+#include <math.h>
 
 namespace W3D {
 
-
-
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
 *******************************************************************************/
 
 Animation::Animation() {
-  robot_root.name = "root";
-  body.name = "body";
-  left_ankle.name = "left_ankle";
-  left_elbow.name = "left_elbow";
-  left_hip.name = "left_hip";
-  left_knee.name = "left_knee";
-  left_shoulder.name = "left_shoulder";
-  left_wrist.name = "left_wrist";
-  right_ankle.name = "right_ankle";
-  right_elbow.name = "right_elbow";
-  right_hip.name = "right_hip";
-  right_knee.name = "right_knee";
-  right_shoulder.name = "right_shoulder";
-  right_wrist.name = "right_wrist";
-  neck.name = "neck";
-  pelvis_presley.name = "pelvis";
+  speed = 1.0f;
   robot = nullptr;
+  clip = nullptr;
+  baked = nullptr;
+  time_ = 0.0f;
+  blend_time_ = 0.0f;
+  blend_duration_ = 0.0f;
 }
 
 Animation::~Animation() {}
 
 Animation::Animation(const Animation& copy) {
-  robot_root = copy.robot_root;
-  body = copy.body;
-  left_ankle = copy.left_ankle;
-  left_elbow = copy.left_elbow;
-  left_hip = copy.left_hip;
-  left_knee = copy.left_knee;
-  left_shoulder = copy.left_shoulder;
-  left_wrist = copy.left_wrist;
-  right_ankle = copy.right_ankle;
-  right_elbow = copy.right_elbow;
-  right_hip = copy.right_hip;
-  right_knee = copy.right_knee;
-  right_shoulder = copy.right_shoulder;
-  right_wrist = copy.right_wrist;
-  neck = copy.neck;
-  pelvis_presley = copy.pelvis_presley;
   speed = copy.speed;
   robot = copy.robot;
+  clip = copy.clip;
+  baked = copy.baked;
+  time_ = copy.time_;
+  blend_time_ = copy.blend_time_;
+  blend_duration_ = copy.blend_duration_;
+  start_pose_ = copy.start_pose_;
 }
 
 Animation& Animation::operator=(const Animation& copy) {
-  robot_root = copy.robot_root;
-  body = copy.body;
-  left_ankle = copy.left_ankle;
-  left_elbow = copy.left_elbow;
-  left_hip = copy.left_hip;
-  left_knee = copy.left_knee;
-  left_shoulder = copy.left_shoulder;
-  left_wrist = copy.left_wrist;
-  right_ankle = copy.right_ankle;
-  right_elbow = copy.right_elbow;
-  right_hip = copy.right_hip;
-  right_knee = copy.right_knee;
-  right_shoulder = copy.right_shoulder;
-  right_wrist = copy.right_wrist;
-  neck = copy.neck;
-  pelvis_presley = copy.pelvis_presley;
   speed = copy.speed;
   robot = copy.robot;
+  clip = copy.clip;
+  baked = copy.baked;
+  time_ = copy.time_;
+  blend_time_ = copy.blend_time_;
+  blend_duration_ = copy.blend_duration_;
+  start_pose_ = copy.start_pose_;
   return *this;
 }
+
 /*******************************************************************************
 ***                               Public methods                             ***
 *******************************************************************************/
 
-void Animation::initFromFile(const char* filename) {
-  tinyxml2::XMLDocument xml;
-  xml.LoadFile(filename);
-
-  robot_root.setup(xml);
-  body.setup(xml);
-  left_ankle.setup(xml);
-  left_elbow.setup(xml);
-  left_hip.setup(xml);
-  left_knee.setup(xml);
-  left_shoulder.setup(xml);
-  left_wrist.setup(xml);
-  right_ankle.setup(xml);
-  right_elbow.setup(xml);
-  right_hip.setup(xml);
-  right_knee.setup(xml);
-  right_shoulder.setup(xml);
-  right_wrist.setup(xml);
-  neck.setup(xml);
-  pelvis_presley.setup(xml);
-
+void Animation::init(const AnimationClip* shared_clip) {
+  clip = shared_clip;
+  baked = nullptr;
   speed = 1.0f;
+  time_ = 0.0f;
+  blend_time_ = blend_duration_ = 0.0f;
+  start_pose_.resize(clip ? clip->num_bones_ : 0);
 }
 
-void Animation::update(const float32& delta_time) {
+void Animation::update(const float32& delta_time, Pose* pose) {
+  if (!clip) { return; }
   float32 delta_scaled = delta_time * speed;
-  updateBonesPositions(delta_scaled);
-  updateBonesRotations(delta_scaled);
+
+  // The clip starts once the blending to its first keys is over.
+  if (blend_time_ < blend_duration_) {
+    blend_time_ += delta_scaled;
+    delta_scaled = blend_time_ - blend_duration_;
+  }
+  if (delta_scaled > 0.0f) { seek(time_ + delta_scaled); }
+
+  *pose = start_pose_;
+  if (baked) {
+    baked->sample(time_, true, pose);
+  }
+  else {
+    clip->sample(time_, pose);
+  }
+  if (blend_time_ >= blend_duration_) { return; }
+
+  const float32 alpha = blend_time_ / blend_duration_;
+  blender_.clear();
+  blender_.addBlend(start_pose_, 1.0f - alpha);
+  blender_.addBlend(*pose, alpha);
+  blender_.blend(pose);
 }
 
 void Animation::start(const bool apply_blending, const float32 blending_duration) {
-  robot_root.start(apply_blending, robot->robot_root_.transform().quaternion_rotation_float4(), robot->robot_root_.transform().position_float4(), blending_duration);
-  body.start(apply_blending, robot->body_.transform().quaternion_rotation_float4(), robot->body_.transform().position_float4(), blending_duration);
-  left_ankle.start(apply_blending, robot->left_ankle_.transform().quaternion_rotation_float4(), robot->left_ankle_.transform().position_float4(), blending_duration);
-  left_elbow.start(apply_blending, robot->left_elbow_.transform().quaternion_rotation_float4(), robot->left_elbow_.transform().position_float4(), blending_duration);
-  left_hip.start(apply_blending, robot->left_hip_.transform().quaternion_rotation_float4(), robot->left_hip_.transform().position_float4(), blending_duration);
-  left_knee.start(apply_blending, robot->left_knee_.transform().quaternion_rotation_float4(), robot->left_knee_.transform().position_float4(), blending_duration);
-  left_shoulder.start(apply_blending, robot->left_shoulder_.transform().quaternion_rotation_float4(), robot->left_shoulder_.transform().position_float4(), blending_duration);
-  left_wrist.start(apply_blending, robot->left_wrist_.transform().quaternion_rotation_float4(), robot->left_wrist_.transform().position_float4(), blending_duration);
-  right_ankle.start(apply_blending, robot->right_ankle_.transform().quaternion_rotation_float4(), robot->right_ankle_.transform().position_float4(), blending_duration);
-  right_elbow.start(apply_blending, robot->right_elbow_.transform().quaternion_rotation_float4(), robot->right_elbow_.transform().position_float4(), blending_duration);
-  right_hip.start(apply_blending, robot->right_hip_.transform().quaternion_rotation_float4(), robot->right_hip_.transform().position_float4(), blending_duration);
-  right_knee.start(apply_blending, robot->right_knee_.transform().quaternion_rotation_float4(), robot->right_knee_.transform().position_float4(), blending_duration);
-  right_shoulder.start(apply_blending, robot->right_shoulder_.transform().quaternion_rotation_float4(), robot->right_shoulder_.transform().position_float4(), blending_duration);
-  right_wrist.start(apply_blending, robot->right_wrist_.transform().quaternion_rotation_float4(), robot->right_wrist_.transform().position_float4(), blending_duration);
-  neck.start(apply_blending, robot->neck_.transform().quaternion_rotation_float4(), robot->neck_.transform().position_float4(), blending_duration);
-  pelvis_presley.start(apply_blending, robot->pelvis_presley_.transform().quaternion_rotation_float4(), robot->pelvis_presley_.transform().position_float4(), blending_duration);
+  if (!clip) { return; }
+  time_ = 0.0f;
+  blend_time_ = 0.0f;
+  blend_duration_ = apply_blending ? blending_duration : 0.0f;
+
+  // Bones without keys stay where they are.
+  for (uint32 bone = 0; bone < clip->num_bones_; ++bone) {
+    TransformComponent& transform = robot->bones_[bone].transform();
+    DirectX::XMFLOAT3 position = transform.position_float3();
+    DirectX::XMFLOAT4 rotation = transform.quaternion_rotation_float4();
+    start_pose_.translation_x[bone] = position.x;
+    start_pose_.translation_y[bone] = position.y;
+    start_pose_.translation_z[bone] = position.z;
+    start_pose_.rotation_x[bone] = rotation.x;
+    start_pose_.rotation_y[bone] = rotation.y;
+    start_pose_.rotation_z[bone] = rotation.z;
+    start_pose_.rotation_w[bone] = rotation.w;
+  }
 }
 
-
-
+void Animation::seek(const float32 time) {
+  blend_time_ = blend_duration_;
+  time_ = time;
+  if (clip && clip->duration_ > 0.0f) {
+    time_ = fmodf(time_, clip->duration_);
+    if (time_ < 0.0f) { time_ += clip->duration_; }
+  }
+}
 
 /*******************************************************************************
-***                              Private methods                             ***
+***                          Setters and Getters                             ***
 *******************************************************************************/
 
-
-void Animation::updateBonesPositions(const float32& delta_time) {
-  robot->robot_root_.transform().set_position(robot_root.translation.update(delta_time));
-  robot->pelvis_presley_.transform().set_position(pelvis_presley.translation.update(delta_time));
-  robot->body_.transform().set_position(body.translation.update(delta_time));
-  robot->right_shoulder_.transform().set_position(right_shoulder.translation.update(delta_time));
-  robot->right_elbow_.transform().set_position(right_elbow.translation.update(delta_time));
-  robot->right_wrist_.transform().set_position(right_wrist.translation.update(delta_time));
-  robot->left_shoulder_.transform().set_position(left_shoulder.translation.update(delta_time));
-  robot->left_elbow_.transform().set_position(left_elbow.translation.update(delta_time));
-  robot->left_wrist_.transform().set_position(left_wrist.translation.update(delta_time));
-  robot->neck_.transform().set_position(neck.translation.update(delta_time));
-  robot->left_hip_.transform().set_position(left_hip.translation.update(delta_time));
-  robot->left_knee_.transform().set_position(left_knee.translation.update(delta_time));
-  robot->left_ankle_.transform().set_position(left_ankle.translation.update(delta_time));
-  robot->right_ankle_.transform().set_position(right_ankle.translation.update(delta_time));
-  robot->right_hip_.transform().set_position(right_hip.translation.update(delta_time));
-  robot->right_knee_.transform().set_position(right_knee.translation.update(delta_time));
-}
-
-void Animation::updateBonesRotations(const float32& delta_time) {
-  robot->robot_root_.transform().set_quaternion_rotation(robot_root.rotation.update(delta_time));
-  robot->pelvis_presley_.transform().set_quaternion_rotation(pelvis_presley.rotation.update(delta_time));
-  robot->body_.transform().set_quaternion_rotation(body.rotation.update(delta_time));
-  robot->right_shoulder_.transform().set_quaternion_rotation(right_shoulder.rotation.update(delta_time));
-  robot->right_elbow_.transform().set_quaternion_rotation(right_elbow.rotation.update(delta_time));
-  robot->right_wrist_.transform().set_quaternion_rotation(right_wrist.rotation.update(delta_time));
-  robot->left_shoulder_.transform().set_quaternion_rotation(left_shoulder.rotation.update(delta_time));
-  robot->left_elbow_.transform().set_quaternion_rotation(left_elbow.rotation.update(delta_time));
-  robot->left_wrist_.transform().set_quaternion_rotation(left_wrist.rotation.update(delta_time));
-  robot->neck_.transform().set_quaternion_rotation(neck.rotation.update(delta_time));
-  robot->left_hip_.transform().set_quaternion_rotation(left_hip.rotation.update(delta_time));
-  robot->left_knee_.transform().set_quaternion_rotation(left_knee.rotation.update(delta_time));
-  robot->left_ankle_.transform().set_quaternion_rotation(left_ankle.rotation.update(delta_time));
-  robot->right_ankle_.transform().set_quaternion_rotation(right_ankle.rotation.update(delta_time));
-  robot->right_hip_.transform().set_quaternion_rotation(right_hip.rotation.update(delta_time));
-  robot->right_knee_.transform().set_quaternion_rotation(right_knee.rotation.update(delta_time));
+float32 Animation::time() const {
+  return time_;
 }
 
-
-
-
-}; /* W3D */
\ No newline at end of file
+}; /* W3D */
@@ -11,7 +11,10 @@
 
 namespace W3D {
 
-
+/// Robot animation files are in tenths of the world units.
+const float32 kRobotTranslationScale = 0.1f;
+/// Frames per second of the baked robot clips.
+const float32 kRobotBakeRate = 30.0f;
 
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
@@ -45,17 +48,35 @@ AnimationController& AnimationController::operator=(const AnimationController& c
 *******************************************************************************/
 
 void AnimationController::init() {
-  idle.initFromFile("../data/animations/robot/RobotIdleAnimDAE.txt");
-  attack.initFromFile("../data/animations/robot/RobotAttackAnimDAE.txt");
-  die.initFromFile("../data/animations/robot/RobotDieAnimDAE.txt");
+  // Parsed by the first robot only, the rest share the clips.
+  auto& clips = Core::instance().animation_clips_;
+  const Skeleton& skeleton = *robot->skeleton_;
+  idle.init(clips.load("../data/animations/robot/RobotIdleAnimDAE.txt", skeleton, kRobotTranslationScale));
+  attack.init(clips.load("../data/animations/robot/RobotAttackAnimDAE.txt", skeleton, kRobotTranslationScale));
+  die.init(clips.load("../data/animations/robot/RobotDieAnimDAE.txt", skeleton, kRobotTranslationScale));
   idle.robot = robot;
   attack.robot = robot;
   die.robot = robot;
+  // Idle and attack are played most of the time and are baked. Die is only
+  // played when asked for, it samples its keys and saves the baked frames.
+  setBaked(&idle, true);
+  setBaked(&attack, true);
+  setBaked(&die, false);
 }
 
 void AnimationController::update(const float32& delta_time) {
   if (current_animation) {
-    current_animation->update(delta_time);
+    current_animation->update(delta_time, &robot->pose_);
+    robot->applyPose();
+  }
+}
+
+void AnimationController::setBaked(Animation* animation, const bool baked) {
+  animation->baked = nullptr;
+  if (baked && animation->clip) {
+    animation->baked = Core::instance().animation_clips_.bake(animation->clip, *robot->skeleton_,
+                                                              robot->rest_pose(), kRobotBakeRate,
+                                                              BakedAnimationClip::kFormat_Pose);
   }
 }
 
@@ -19,6 +19,7 @@ namespace W3D {
 Bullet::Bullet() {
   is_active_ = false;
   projectile_speed_ = 0.04f;
+  significance_ = 0;
 }
 
 Bullet::~Bullet() {}
@@ -26,11 +27,13 @@ Bullet::~Bullet() {}
 Bullet::Bullet(const Bullet & copy) {
   projectile_speed_ = copy.projectile_speed_;
   projectile_velocity_ = copy.projectile_velocity_;
+  significance_ = copy.significance_;
 }
 
 Bullet& Bullet::operator=(const Bullet & copy) {
   projectile_speed_ = copy.projectile_speed_;
   projectile_velocity_ = copy.projectile_velocity_;
+  significance_ = copy.significance_;
   return (*this);
 }
 
@@ -44,13 +47,21 @@ void Bullet::init() {
   initGeometries();
   initMaterials();
   initRenderComponents();
+  significance_ = Core::instance().significance_.add(root_.transform().world_position_float3(),
+                                                     kBulletBoundingRadius);
 }
 
 void Bullet::update(const float32& delta_time) {
-  if (is_active_) {
-    root_.transform().traslate(projectile_velocity_.x * delta_time,
-                               projectile_velocity_.y * delta_time,
-                               projectile_velocity_.z * delta_time);
+  auto& significance = Core::instance().significance_;
+  if (is_active_ && significance.isDue(significance_)) {
+    significance.beginUpdate(significance_);
+    const float32 elapsed = significance.elapsed(significance_);
+    root_.transform().traslate(projectile_velocity_.x * elapsed,
+                               projectile_velocity_.y * elapsed,
+                               projectile_velocity_.z * elapsed);
+    significance.set_bounds(significance_, root_.transform().world_position_float3(),
+                            kBulletBoundingRadius);
+    significance.endUpdate(significance_);
   }
 }
 
@@ -0,0 +1,137 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "flag.h"
+#include <math.h>
+
+namespace W3D {
+
+/// Cloth size, along the wind and up, and pole height.
+const float32 kFlagWidth = 6.0f;
+const float32 kFlagHeight = 3.0f;
+const float32 kFlagPoleHeight = 12.0f;
+/// Vertices of one face of the cloth.
+const uint32 kFlagFaceVertices = (kFlagColumns + 1) * (kFlagRows + 1);
+/// Waves along the cloth at the same time.
+const float32 kFlagWaveLength = 0.75f;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+Flag::Flag() {
+  wave_speed_ = 1.2f;
+  wave_amplitude_ = 0.6f;
+  is_waving_ = true;
+  time_ = 0.0f;
+}
+
+Flag::~Flag() {}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void Flag::init() {
+  initTransforms();
+  initGeometries();
+  initMaterials();
+  initRenderComponents();
+}
+
+void Flag::update(const float32& delta_time) {
+  if (!is_waving_) { return; }
+  time_ += delta_time * 0.001f;
+  // Both faces in one range, a single copy.
+  Geometry::Vertex* vertices = geo_cloth_.editVertices(0, kFlagFaceVertices * 2);
+  if (vertices) { waveCloth(vertices, time_); }
+}
+
+
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+void Flag::waveCloth(Geometry::Vertex* vertices, const float32 time) {
+  const float32 wave_number = DirectX::XM_2PI * kFlagWaveLength / kFlagWidth;
+  const float32 phase_speed = DirectX::XM_2PI * wave_speed_;
+
+  for (uint32 column = 0; column <= kFlagColumns; ++column) {
+    // Fixed at the pole, growing towards the free end.
+    const float32 u = (float32)column / (float32)kFlagColumns;
+    const float32 x = u * kFlagWidth;
+    const float32 angle = wave_number * x - phase_speed * time;
+    const float32 z = wave_amplitude_ * u * sinf(angle);
+    const float32 slope = wave_amplitude_ * (sinf(angle) / kFlagWidth + u * wave_number * cosf(angle));
+    DirectX::XMFLOAT3 normal;
+    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorSet(-slope, 0.0f, 1.0f, 0.0f)));
+
+    for (uint32 row = 0; row <= kFlagRows; ++row) {
+      const float32 v = (float32)row / (float32)kFlagRows;
+      Geometry::Vertex& front = vertices[row * (kFlagColumns + 1) + column];
+      front.position = { x, v * kFlagHeight, z };
+      front.normal = normal;
+      front.uv = { u, 1.0f - v };
+      front.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+      Geometry::Vertex& back = vertices[kFlagFaceVertices + row * (kFlagColumns + 1) + column];
+      back = front;
+      back.normal = { -normal.x, -normal.y, -normal.z };
+    }
+  }
+}
+
+void Flag::initGeometries() {
+  geo_pole_.initCylinder(0.15f, kFlagPoleHeight);
+
+  std::vector<Geometry::Vertex> vertices(kFlagFaceVertices * 2);
+  waveCloth(vertices.data(), 0.0f);
+
+  // Clockwise seen from the side the normals point to, as the default
+  // rasterizer state wants the front faces. The back face on its own
+  // vertices, wound the other way.
+  std::vector<uint32> indices;
+  for (uint32 face = 0; face < 2; ++face) {
+    const uint32 base = face * kFlagFaceVertices;
+    for (uint32 row = 0; row < kFlagRows; ++row) {
+      for (uint32 column = 0; column < kFlagColumns; ++column) {
+        const uint32 a = base + row * (kFlagColumns + 1) + column;
+        const uint32 b = a + 1;
+        const uint32 c = a + kFlagColumns + 1;
+        const uint32 d = c + 1;
+        if (face == 0) {
+          indices.insert(indices.end(), { a, b, c, b, d, c });
+        }
+        else {
+          indices.insert(indices.end(), { a, c, b, b, c, d });
+        }
+      }
+    }
+  }
+  geo_cloth_.initDynamic(vertices.data(), (uint32)vertices.size(), indices.data(), (uint32)indices.size());
+}
+
+void Flag::initTransforms() {
+  pole_.transform().set_position(0.0f, kFlagPoleHeight * 0.5f, 0.0f);
+  cloth_.transform().set_position(0.0f, kFlagPoleHeight - kFlagHeight, 0.0f);
+}
+
+void Flag::initRenderComponents() {
+  root_.addChild(&pole_);
+  root_.addChild(&cloth_);
+  pole_.addComponent(W3D::kComponentType_Render, &material_, &geo_pole_);
+  cloth_.addComponent(W3D::kComponentType_Render, &material_, &geo_cloth_);
+}
+
+void Flag::initMaterials() {
+  material_.set_color(1.0f, 0.5f, 0.0f, 1.0f);
+}
+
+
+
+}; /* W3D */
@@ -10,7 +10,63 @@
 
 namespace W3D {
 
+/// Bone of the robot, as the animation files call it, and its node.
+struct RobotBone {
+  const char* name;
+  const char* node_name;
+  /// Index of the parent in the table, -1 for the root.
+  int32 parent;
+  /// Piece of the mesh, nullptr if it has none.
+  const char* geometry;
+  /// Rest position relative to the parent.
+  DirectX::XMFLOAT3 position;
+};
+
+/// Robot skeleton, parents before their children.
+static const RobotBone kRobotBones[kRobotNumBones] = {
+  { "root",           "Robot root",     -1, nullptr,              { 0.1027778f, 7.5644722f, 0.000000f } },
+  { "pelvis",         "Pelvis",          0, "pelvis.x",           { -0.0250011f, 1.5250000f, -0.0000005f } },
+  { "body",           "Body",            1, "body.x",             { 0.0500099f, 4.3749992f, 0.0000003f } },
+  { "left_shoulder",  "Left shoulder",   2, "left_shoulder.x",    { 4.6000000f, 0.0000000f, -0.0009992f } },
+  { "left_elbow",     "Left elbow",      3, "left_elbow.x",       { 3.4250019f, -0.0499817f, -0.0004262f } },
+  { "left_wrist",     "Left wrist",      4, "left_wrist.x",       { 5.5250008f, -0.0999710f, 0.0003968f } },
+  { "right_shoulder", "Right shoulder",  2, "right_shoulder.x",   { -4.4500023f, 0.0500000f, -0.0000021f } },
+  { "right_elbow",    "Right elbow",     6, "right_elbow.x",      { -3.3999996f, 0.0250229f, -0.0000194f } },
+  { "right_wrist",    "Right wrist",     7, "right_wrist.x",      { -6.0000381f, -0.1750183f, 0.0007156f } },
+  { "neck",           "Neck",            2, "neck.x",             { 0.0249983f, 3.6625015f, 2.5999998f } },
+  { "left_hip",       "Left hip",        0, "left_hip.x",         { 1.9500000f, -0.7724991f, 0.000000f } },
+  { "left_knee",      "Left knee",      10, "left_knee.x",        { 0.0000006f, -2.2200001f, 0.000000f } },
+  { "left_ankle",     "Left ankle",     11, "left_ankle.x",       { -0.0800152f, -3.6399994f, -0.0000098f } },
+  { "right_hip",      "Right hip",       0, "right_hip.x",        { -1.9500000f, -0.7724991f, 0.000000f } },
+  { "right_knee",     "Right knee",     13, "right_knee.x",       { 0.0000006f, -2.2000000f, 0.000000f } },
+  { "right_ankle",    "Right ankle",    14, "right_ankle.x",      { 0.0199911f, -3.6799995f, 0.0000039f } },
+};
+
+/// Skeleton of every robot, built from the table the first time.
+static const Skeleton& RobotSkeleton() {
+  static Skeleton skeleton;
+  if (skeleton.num_bones() == 0) {
+    for (uint32 i = 0; i < kRobotNumBones; ++i) {
+      const int32 parent = kRobotBones[i].parent;
+      skeleton.addBone(kRobotBones[i].name, parent < 0 ? Skeleton::kNoBone : (uint32)parent);
+    }
+  }
+  return skeleton;
+}
 
+/// Rest pose of every robot, the table positions without rotation.
+static const Pose& RobotRestPose() {
+  static Pose pose;
+  if (pose.num_bones == 0) {
+    pose.resize(kRobotNumBones);
+    for (uint32 i = 0; i < kRobotNumBones; ++i) {
+      pose.translation_x[i] = kRobotBones[i].position.x;
+      pose.translation_y[i] = kRobotBones[i].position.y;
+      pose.translation_z[i] = kRobotBones[i].position.z;
+    }
+  }
+  return pose;
+}
 
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
@@ -19,6 +75,9 @@ namespace W3D {
 Robot::Robot() {
   is_near_to_plane_ = false;
   distance_to_change_animations_ = 30.0f;
+  skeleton_ = nullptr;
+  significance_ = 0;
+  pending_delta_time_ = 0.0f;
 }
 
 Robot::~Robot() {}
@@ -28,16 +87,17 @@ Robot::~Robot() {}
 *******************************************************************************/
 
 void Robot::init() {
-  initNames();
-  initHierarchy();
+  initSkeleton();
   initTransforms();
   initGeometries();
   initMaterials();
   initRenderComponents();
   initAnimations();
+  significance_ = Core::instance().significance_.add(root_.transform().world_position_float3(),
+                                                     kRobotBoundingRadius);
 }
 
-void Robot::update(const float32& delta_time) {
+void Robot::update(const float32& delta_time, const bool full_rate) {
   if (Input::IsKeyboardButtonDown(Input::kKeyboardButton_Left)) {
     anim_controller_.current_animation = &anim_controller_.attack;
     anim_controller_.current_animation->start(true, 0.5f);
@@ -53,7 +113,16 @@ void Robot::update(const float32& delta_time) {
     anim_controller_.current_animation->start(true, 0.5f);
   }
 
-  anim_controller_.update(delta_time * 0.001f);
+  auto& significance = Core::instance().significance_;
+  significance.set_bounds(significance_, bones_[0].transform().world_position_float3(),
+                          kRobotBoundingRadius);
+  pending_delta_time_ += delta_time;
+  if (full_rate || significance.isDue(significance_)) {
+    significance.beginUpdate(significance_);
+    anim_controller_.update(pending_delta_time_ * 0.001f);
+    pending_delta_time_ = 0.0f;
+    significance.endUpdate(significance_);
+  }
   updateImGui();
 }
 
@@ -80,6 +149,15 @@ void Robot::checkDistanceToPlane(const DirectX::XMVECTOR& plane_pos) {
 }
 
 
+void Robot::applyPose() {
+  for (uint32 i = 0; i < pose_.num_bones; ++i) {
+    TransformComponent& transform = bones_[i].transform();
+    transform.set_position(pose_.translation_x[i], pose_.translation_y[i], pose_.translation_z[i]);
+    transform.set_quaternion_rotation(DirectX::XMFLOAT4(pose_.rotation_x[i], pose_.rotation_y[i],
+                                                        pose_.rotation_z[i], pose_.rotation_w[i]));
+  }
+}
+
 /*******************************************************************************
 ***                          Setters and Getters                             ***
 *******************************************************************************/
@@ -94,6 +172,15 @@ void Robot::set_animations_speed(const float32 speed) {
   anim_controller_.die.speed = speed;
 }
 
+const Pose& Robot::rest_pose() const {
+  return RobotRestPose();
+}
+
+Entity* Robot::bone(const char* name) {
+  const uint32 index = skeleton_ ? skeleton_->find(name) : Skeleton::kNoBone;
+  return index != Skeleton::kNoBone ? &bones_[index] : nullptr;
+}
+
 
 
 /*******************************************************************************
@@ -101,101 +188,40 @@ void Robot::set_animations_speed(const float32 speed) {
 *******************************************************************************/
 
 void Robot::initGeometries() {
-  geo_body_.initFromFile("./../data/geometries/robot/body.x");
-  geo_left_ankle_.initFromFile("./../data/geometries/robot/left_ankle.x");
-  geo_left_elbow_.initFromFile("./../data/geometries/robot/left_elbow.x");
-  geo_left_hip_.initFromFile("./../data/geometries/robot/left_hip.x");
-  geo_left_knee_.initFromFile("./../data/geometries/robot/left_knee.x");
-  geo_left_shoulder_.initFromFile("./../data/geometries/robot/left_shoulder.x");
-  geo_left_wrist_.initFromFile("./../data/geometries/robot/left_wrist.x");
-  geo_right_ankle_.initFromFile("./../data/geometries/robot/right_ankle.x");
-  geo_right_elbow_.initFromFile("./../data/geometries/robot/right_elbow.x");
-  geo_right_hip_.initFromFile("./../data/geometries/robot/right_hip.x");
-  geo_right_knee_.initFromFile("./../data/geometries/robot/right_knee.x");
-  geo_right_shoulder_.initFromFile("./../data/geometries/robot/right_shoulder.x");
-  geo_right_wrist_.initFromFile("./../data/geometries/robot/right_wrist.x");
-  geo_neck_.initFromFile("./../data/geometries/robot/neck.x");
-  geo_pelvis_presley_.initFromFile("./../data/geometries/robot/pelvis.x");
-}
-
-void Robot::initHierarchy() {
-  root_.addChild(&robot_root_);
-  root_.addChild(&camera_node_);
-  robot_root_.addChild(&pelvis_presley_);
-  pelvis_presley_.addChild(&body_);
-  body_.addChild(&left_shoulder_);
-  left_shoulder_.addChild(&left_elbow_);
-  left_elbow_.addChild(&left_wrist_);
-  body_.addChild(&right_shoulder_);
-  right_shoulder_.addChild(&right_elbow_);
-  right_elbow_.addChild(&right_wrist_);
-  body_.addChild(&neck_);
-  robot_root_.addChild(&left_hip_);
-  left_hip_.addChild(&left_knee_);
-  left_knee_.addChild(&left_ankle_);
-  robot_root_.addChild(&right_hip_);
-  right_hip_.addChild(&right_knee_);
-  right_knee_.addChild(&right_ankle_);
-}
-
-void Robot::initNames() {
+  for (uint32 i = 0; i < kRobotNumBones; ++i) {
+    if (!kRobotBones[i].geometry) { continue; }
+    std::string path = std::string("./../data/geometries/robot/") + kRobotBones[i].geometry;
+    geometries_[i].initFromFile(path.c_str(), { 1.0f, 1.0f, 1.0f, 1.0f }, true);
+  }
+}
+
+void Robot::initSkeleton() {
+  skeleton_ = &RobotSkeleton();
   root_.name_ = "Red Robot";
   camera_node_.name_ = "Camera Node";
-  robot_root_.name_ = "Robot root";
-  pelvis_presley_.name_ = "Pelvis";
-  body_.name_ = "Body";
-  left_shoulder_.name_ = "Left shoulder";
-  left_elbow_.name_ = "Left elbow";
-  left_wrist_.name_ = "Left wrist";
-  right_shoulder_.name_ = "Right shoulder";
-  right_elbow_.name_ = "Right elbow";
-  right_wrist_.name_ = "Right wrist";
-  neck_.name_ = "Neck";
-  left_hip_.name_ = "Left hip";
-  left_knee_.name_ = "Left knee";
-  left_ankle_.name_ = "Left ankle";
-  right_hip_.name_ = "Right hip";
-  right_knee_.name_ = "Right knee";
-  right_ankle_.name_ = "Right ankle";
+  for (uint32 i = 0; i < kRobotNumBones; ++i) {
+    const uint32 parent = skeleton_->parent(i);
+    bones_[i].name_ = kRobotBones[i].node_name;
+    Entity* parent_node = parent != Skeleton::kNoBone ? &bones_[parent] : &root_;
+    parent_node->addChild(&bones_[i]);
+  }
+  root_.addChild(&camera_node_);
+  pose_.resize(skeleton_->num_bones());
 }
 
 void Robot::initTransforms() {
   root_.transform().set_scale(0.5f);
   camera_node_.transform().set_position(0.0f, 5.0f, 30.0f);
-  robot_root_.transform().set_position(0.1027778f, 7.5644722f, 0.000000f);
-  pelvis_presley_.transform().set_position(-0.0250011f, 1.5250000f, -0.0000005f);
-  body_.transform().set_position(0.0500099f, 4.3749992f, 0.0000003f);
-  left_shoulder_.transform().set_position(4.6000000f, 0.0000000f, -0.0009992f);
-  left_elbow_.transform().set_position(3.4250019f, -0.0499817f, -0.0004262f);
-  left_wrist_.transform().set_position(5.5250008f, -0.0999710f, 0.0003968f);
-  right_shoulder_.transform().set_position(-4.4500023f, 0.0500000f, -0.0000021f);
-  right_elbow_.transform().set_position(-3.3999996f, 0.0250229f, -0.0000194f);
-  right_wrist_.transform().set_position(-6.0000381f, -0.1750183f, 0.0007156f);
-  neck_.transform().set_position(0.0249983f, 3.6625015f, 2.5999998f);
-  left_hip_.transform().set_position(1.9500000f, -0.7724991f, 0.000000f);
-  left_knee_.transform().set_position(0.0000006f, -2.2200001f, 0.000000f);
-  left_ankle_.transform().set_position(-0.0800152f, -3.6399994f, -0.0000098f);
-  right_hip_.transform().set_position(-1.9500000f, -0.7724991f, 0.000000f);
-  right_knee_.transform().set_position(0.0000006f, -2.2000000f, 0.000000f);
-  right_ankle_.transform().set_position(0.0199911f, -3.6799995f, 0.0000039f);
+  for (uint32 i = 0; i < kRobotNumBones; ++i) {
+    bones_[i].transform().set_position(kRobotBones[i].position);
+  }
 }
 
 void Robot::initRenderComponents() {
-  pelvis_presley_.addComponent(kComponentType_Render, &material_, &geo_pelvis_presley_);
-  body_.addComponent(kComponentType_Render, &material_, &geo_body_);
-  left_shoulder_.addComponent(kComponentType_Render, &material_, &geo_left_shoulder_);
-  left_elbow_.addComponent(kComponentType_Render, &material_, &geo_left_elbow_);
-  left_wrist_.addComponent(kComponentType_Render, &material_, &geo_left_wrist_);
-  right_shoulder_.addComponent(kComponentType_Render, &material_, &geo_right_shoulder_);
-  right_elbow_.addComponent(kComponentType_Render, &material_, &geo_right_elbow_);
-  right_wrist_.addComponent(kComponentType_Render, &material_, &geo_right_wrist_);
-  neck_.addComponent(kComponentType_Render, &material_, &geo_neck_);
-  left_hip_.addComponent(kComponentType_Render, &material_, &geo_left_hip_);
-  left_knee_.addComponent(kComponentType_Render, &material_, &geo_left_knee_);
-  left_ankle_.addComponent(kComponentType_Render, &material_, &geo_left_ankle_);
-  right_hip_.addComponent(kComponentType_Render, &material_, &geo_right_hip_);
-  right_knee_.addComponent(kComponentType_Render, &material_, &geo_right_knee_);
-  right_ankle_.addComponent(kComponentType_Render, &material_, &geo_right_ankle_);
+  for (uint32 i = 0; i < kRobotNumBones; ++i) {
+    if (!kRobotBones[i].geometry) { continue; }
+    bones_[i].addComponent(kComponentType_Render, &material_, &geometries_[i]);
+  }
 }
 
 void Robot::initAnimations() {
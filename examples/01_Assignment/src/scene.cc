@@ -17,10 +17,13 @@ namespace W3D {
 Scene::Scene() {
   camera_mode_ = kCameraMode_Plane3rdPerson;
   debug_mode_speed_ = 1.0f;
-  key_frame_step_time_ = 0.166666f;
   is_debug_mode_active_ = false;
   last_speed_saved_ = 2.0f;
   animations_speed_ = 2.0f;
+  is_idle_baked_ = true;
+  is_attack_baked_ = true;
+  is_die_baked_ = false;
+  landing_track_significance_ = 0;
 }
 
 Scene::~Scene() {}
@@ -41,6 +44,8 @@ void Scene::init() {
   root_.addChild(&terrain_.root_);
   root_.addChild(&landing_track_);
   landing_track_.addChild(&landing_track_camera_);
+  flag_.init();
+  landing_track_.addChild(&flag_.root_);
 
   for (uint32 i = 0; i < plane_.num_bullets_; ++i) {
     plane_.bullet_[i].init();
@@ -49,9 +54,22 @@ void Scene::init() {
 
   landing_track_.transform().set_position(319.0f, 2.5f, 500.0f);
   landing_track_camera_.transform().set_position(0.0f, 7.0f, 15.0f);
+  flag_.root_.transform().set_position(8.0f, 0.0f, 0.0f);
+  landing_track_significance_ = Core::instance().significance_.add(landing_track_.transform().world_position_float3(),
+                                                                   kLandingTrackBoundingRadius);
+
+  // The hills hide the robots and the bullets behind them.
+  terrain_.root_.render3D()->set_occluder(true);
+  plane_.plane_.render3D()->set_occluder(true);
+  Core::instance().cam_.is_occlusion_culling_enabled_ = true;
 }
 
 void Scene::update(const float32 delta_time) {
+  // Chooses what updates this frame, from the camera of the last one.
+  auto& camera = Core::instance().cam_;
+  auto& significance = Core::instance().significance_;
+  significance.update(delta_time, camera.view_matrix(), camera.projection_matrix());
+
   updateImgui();
   if (Input::IsKeyboardButtonDown(Input::kKeyboardButton_Enter) && 
       !plane_.is_plane_engine_active_) {
@@ -59,8 +77,16 @@ void Scene::update(const float32 delta_time) {
     activeRobots();
   }
   plane_.update(delta_time);
+  groundObjects();
   updateRobots(delta_time);
-  landing_track_.transform().rotate(0.0f, delta_time * 0.0005f, 0.0f);
+  significance.set_bounds(landing_track_significance_, landing_track_.transform().world_position_float3(),
+                          kLandingTrackBoundingRadius);
+  if (significance.isDue(landing_track_significance_)) {
+    significance.beginUpdate(landing_track_significance_);
+    landing_track_.transform().rotate(0.0f, significance.elapsed(landing_track_significance_) * 0.0005f, 0.0f);
+    significance.endUpdate(landing_track_significance_);
+  }
+  flag_.update(delta_time);
   updateCameraMode();
   sky_box_.root_.transform().set_position(plane_.root_.transform().position_float3().x,
                                           0.0f, 
@@ -102,12 +128,12 @@ void Scene::updateCameraMode() {
   } break;
   case kCameraMode_RedRobot: {
     camera.set_position(red_robot_.camera_node_.transform().world_position_float3());
-    camera.set_target(red_robot_.body_.transform().world_position_float3());
+    camera.set_target(red_robot_.bone("body")->transform().world_position_float3());
   } break;
   case kCameraMode_GreenRobot: {} break;
   case kCameraMode_BlueRobot: {
     camera.set_position(blue_robot_.camera_node_.transform().world_position_float3());
-    camera.set_target(blue_robot_.body_.transform().world_position_float3());
+    camera.set_target(blue_robot_.bone("body")->transform().world_position_float3());
   } break;
   case kCameraMode_YellowRobot: {} break;
   };
@@ -129,7 +155,7 @@ void Scene::switchCameraMode() {
   case kCameraMode_RedRobot: {
     camera_mode_ = kCameraMode_GreenRobot;
     camera.moveTo(green_robot_.camera_node_.transform().world_position_float3(),
-                  green_robot_.body_.transform().world_position_float3());
+                  green_robot_.bone("body")->transform().world_position_float3());
   } break;
   case kCameraMode_GreenRobot: {
     camera_mode_ = kCameraMode_BlueRobot;
@@ -137,7 +163,7 @@ void Scene::switchCameraMode() {
   case kCameraMode_BlueRobot: {
     camera_mode_ = kCameraMode_YellowRobot;
     camera.moveTo(yellow_robot_.camera_node_.transform().world_position_float3(),
-                  yellow_robot_.body_.transform().world_position_float3());
+                  yellow_robot_.bone("body")->transform().world_position_float3());
   } break;
   case kCameraMode_YellowRobot: {
     camera_mode_ = kCameraMode_Plane3rdPerson;
@@ -220,16 +246,17 @@ void Scene::updateRobots(const float32 delta_time) {
   if (is_debug_mode_active_) {
     delta = 0.0f;
     if (Input::IsKeyboardButtonDown(Input::kKeyboardButton_E)) {
-      delta = 166.0f; // Jump directly to the next key frame.
+      jumpRobotsToNextKey();
     }
   }
   if (Input::IsKeyboardButtonPressed(Input::kKeyboardButton_F)) {
     delta = delta_time / 5.0f / animations_speed_; // 2fps 
   }
-  red_robot_.update(delta);
-  blue_robot_.update(delta);
-  yellow_robot_.update(delta);
-  green_robot_.update(delta);
+  // Seeking in debug mode shows at once.
+  red_robot_.update(delta, is_debug_mode_active_);
+  blue_robot_.update(delta, is_debug_mode_active_);
+  yellow_robot_.update(delta, is_debug_mode_active_);
+  green_robot_.update(delta, is_debug_mode_active_);
 }
 
 void Scene::activeRobots() {
@@ -250,6 +277,29 @@ void Scene::setRototsAnimationSpeed(const float32 speed) {
   green_robot_.set_animations_speed(speed);
 }
 
+void Scene::bakeRobotsAnimations() {
+  Robot* robots[] = { &red_robot_, &blue_robot_, &yellow_robot_, &green_robot_ };
+  for (uint32 i = 0; i < sizeof(robots) / sizeof(robots[0]); ++i) {
+    AnimationController& controller = robots[i]->anim_controller_;
+    controller.setBaked(&controller.idle, is_idle_baked_);
+    controller.setBaked(&controller.attack, is_attack_baked_);
+    controller.setBaked(&controller.die, is_die_baked_);
+  }
+}
+
+void Scene::groundObjects() {
+  Entity* grounded[] = { &red_robot_.root_, &blue_robot_.root_,
+                         &green_robot_.root_, &yellow_robot_.root_,
+                         &landing_track_ };
+
+  for (uint32 i = 0; i < sizeof(grounded) / sizeof(grounded[0]); ++i) {
+    DirectX::XMFLOAT3 position = grounded[i]->transform().position_float3();
+    grounded[i]->transform().set_position(position.x,
+                                          terrain_.groundHeight(position.x, position.z),
+                                          position.z);
+  }
+}
+
 void Scene::enableAnimationsDebugMode() {
   is_debug_mode_active_ = true;
   last_speed_saved_ = animations_speed_;
@@ -263,6 +313,24 @@ void Scene::disableAnimationsDebugMode() {
   setRototsAnimationSpeed(animations_speed_);
 }
 
+void Scene::jumpRobotsToNextKey() {
+  Robot* robots[] = { &red_robot_, &blue_robot_, &yellow_robot_, &green_robot_ };
+  for (uint32 i = 0; i < sizeof(robots) / sizeof(robots[0]); ++i) {
+    Animation* animation = robots[i]->anim_controller_.current_animation;
+    if (animation && animation->clip) {
+      animation->seek(animation->clip->nextKeyTime(animation->time()));
+    }
+  }
+}
+
+void Scene::seekRobotsAnimations(const float32 time) {
+  Robot* robots[] = { &red_robot_, &blue_robot_, &yellow_robot_, &green_robot_ };
+  for (uint32 i = 0; i < sizeof(robots) / sizeof(robots[0]); ++i) {
+    Animation* animation = robots[i]->anim_controller_.current_animation;
+    if (animation) { animation->seek(time); }
+  }
+}
+
 
 void Scene::checkDistancesBetweenRobotsAndPlane() {
 
@@ -288,7 +356,7 @@ void Scene::updateImgui() {
   ImGui::BulletText("C           - Switch between camera modes.");
   ImGui::BulletText("1-2-3       - Select default robots animation (1-Idle, 2-Attack, 3-Die).");
   ImGui::BulletText("TAB         - Enable / Disable animations debug mode.");
-  ImGui::BulletText("E           - In debug mode, jump to the next animation step (10 per anim)");
+  ImGui::BulletText("E           - In debug mode, jump to the next animation key frame");
   ImGui::BulletText("F           - If held down, will slowmotion the animations to 2fps");
   ImGui::Separator();
 
@@ -310,19 +378,89 @@ void Scene::updateImgui() {
     }
     else {
       ImGui::BulletText("Press Mouse Wheel Button to debug animations steps.");
+      Animation* animation = red_robot_.anim_controller_.current_animation;
+      if (animation && animation->clip) {
+        float32 time = animation->time();
+        if (ImGui::SliderFloat("Animations Time", &time, 0.0f, animation->clip->duration_)) {
+          seekRobotsAnimations(time);
+        }
+      }
       if (ImGui::Button("Disable Debug Mode")) {
         disableAnimationsDebugMode();
       }
     }
 
+    ImGui::Text("Baked clips:");
+    bool baked_changed = ImGui::Checkbox("Idle", &is_idle_baked_);
+    ImGui::SameLine();
+    baked_changed |= ImGui::Checkbox("Attack", &is_attack_baked_);
+    ImGui::SameLine();
+    baked_changed |= ImGui::Checkbox("Die", &is_die_baked_);
+    if (baked_changed) {
+      bakeRobotsAnimations();
+    }
+
     //ImGui::Combo("Select Default Animation")
     ImGui::TreePop();
   }
 
+  if (ImGui::TreeNode("Asset Loading")) {
+    LoadStats stats = Loader::Stats();
+    ImGui::Text("Pending: %d  Completed: %d  Failed: %d",
+                stats.num_pending, stats.num_completed, stats.num_failed);
+    ImGui::Text("Parse time (workers): %.2f ms", stats.total_parse_ms);
+    ImGui::Text("Upload time (main thread): %.2f ms", stats.total_upload_ms);
+    ImGui::Text("Last frame: %d uploads, %.2f ms",
+                stats.last_frame_uploads, stats.last_frame_upload_ms);
+    const AnimationClipCache::Stats& clips = Core::instance().animation_clips_.stats();
+    ImGui::Text("Animation clips: %d, %.1f KB, %.2f ms", clips.num_clips,
+                (float32)clips.memory / 1024.0f, clips.load_ms);
+    ImGui::Text("Animation clips shared: %d", clips.num_shared);
+    ImGui::Text("Animation clips baked: %d, %.1f KB, %.2f ms", clips.num_baked,
+                (float32)clips.baked_memory / 1024.0f, clips.bake_ms);
+    const GeometryArena& arena = Core::instance().geometry_arena_;
+    ImGui::Text("Dynamic vertices uploaded: %.1f KB last frame, %.2f MB total",
+                (float32)arena.uploaded_bytes_last_frame() / 1024.0f,
+                (float32)arena.uploaded_bytes_total() / (1024.0f * 1024.0f));
+    ImGui::Checkbox("Flag waving", &flag_.is_waving_);
+    ImGui::TreePop();
+  }
+
+  if (ImGui::TreeNode("Occlusion Culling")) {
+    auto& camera = Core::instance().cam_;
+    ImGui::Checkbox("Enabled", &camera.is_occlusion_culling_enabled_);
+    const OcclusionCuller::Stats& stats = Core::instance().occlusion_culler_.stats();
+    ImGui::Text("Occluders: %u  Triangles: %u  Rasterized: %u",
+                stats.num_occluders, stats.num_triangles, stats.num_rasterized);
+    ImGui::Text("Objects tested: %u  Hidden: %u", stats.num_tested, stats.num_culled);
+    ImGui::Text("Rasterize time: %.3f ms", stats.rasterize_ms);
+    ImGui::TreePop();
+  }
+
+  if (ImGui::TreeNode("Significance")) {
+    updateSignificanceImgui();
+    ImGui::TreePop();
+  }
+
 
 
   ImGui::PopID();
 }
 
+void Scene::updateSignificanceImgui() {
+  auto& significance = Core::instance().significance_;
+  ImGui::Checkbox("Enabled", &significance.is_enabled_);
+  ImGui::SliderFloat("Budget (ms)", &significance.budget_ms_, 0.0f, 4.0f);
+  const SignificanceManager::Stats& stats = significance.stats();
+  ImGui::Text("Objects: %u  Visible: %u", stats.num_objects, stats.num_visible);
+  for (uint32 i = 0; i < SignificanceManager::kNumTiers; ++i) {
+    ImGui::Text("Tier %u, every %u frames: %u objects", i,
+                significance.tiers_[i].interval, stats.num_per_tier[i]);
+  }
+  ImGui::Text("Due: %u  Updated: %u  Deferred: %u",
+              stats.num_due, stats.num_updated, stats.num_deferred);
+  ImGui::Text("Expected: %.3f ms  Spent last frame: %.3f ms", stats.expected_ms, stats.spent_ms);
+}
+
 
 }; /* W3D */
\ No newline at end of file
@@ -36,6 +36,11 @@ void Terrain::update(const float32& delta_time) {
 
 }
 
+float32 Terrain::groundHeight(const float32 x, const float32 z) {
+  DirectX::XMFLOAT3 position = root_.transform().position_float3();
+  return geo_terrain_.heightAt(x - position.x, z - position.z) + position.y;
+}
+
 
 
 /*******************************************************************************
@@ -43,14 +48,15 @@ void Terrain::update(const float32& delta_time) {
 *******************************************************************************/
 
 void Terrain::initGeometries() {
-  geo_terrain_.initTerrain("../data/textures/terrain/Heightmap.bmp", { 1000.0f, 70.0f, 1000.0f });
+  // Generated in the background, rendered as the error geometry until ready.
+  geo_terrain_.initTerrainAsync("../data/textures/terrain/Heightmap.bmp", { 1000.0f, 70.0f, 1000.0f });
 }
 
 void Terrain::initTextures() {
-  map_.initFromFile("../data/textures/terrain/materialmap.dds");
-  grass_.initFromFile("../data/textures/terrain/grass.dds");
-  moss_.initFromFile("../data/textures/terrain/moss.dds");
-  asphalt_.initFromFile("../data/textures/terrain/asphalt.dds");
+  map_.initFromFileAsync("../data/textures/terrain/materialmap.dds");
+  grass_.initFromFileAsync("../data/textures/terrain/grass.dds");
+  moss_.initFromFileAsync("../data/textures/terrain/moss.dds");
+  asphalt_.initFromFileAsync("../data/textures/terrain/asphalt.dds");
 }
 
 void Terrain::initTransforms() {
@@ -0,0 +1,71 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__ 1
+
+#include "Wolfy3D.h"
+
+namespace W3D {
+
+/// Benchmarks results file.
+const char kBenchmarkReportPath[] = "./../build/benchmarks.txt";
+
+///--------------------------------------------------------------------------
+/// @fn   void Report(const char* format, ...);
+///
+/// @brief  Writes a line into the report file and the debugger output.
+///--------------------------------------------------------------------------
+void Report(const char* format, ...);
+
+///--------------------------------------------------------------------------
+/// @fn   float64 ElapsedMs(const uint64 start_microseconds);
+///
+/// @brief  Milliseconds elapsed since the TimeInMicroSeconds() value given.
+///--------------------------------------------------------------------------
+float64 ElapsedMs(const uint64 start_microseconds);
+
+/* Benchmarks */
+
+/// Vertex cache and overdraw optimization of a shuffled grid and the example
+/// geometries, and the levels of detail of the latter.
+void MeshOptimizerBenchmark();
+
+/// Meshlets of the example geometries and the fraction of their triangles
+/// culled from cameras around them.
+void MeshletBenchmark();
+
+/// Software occlusion culling of objects scattered over a hilly ground, seen
+/// from a camera flying low.
+void OcclusionBenchmark();
+
+/// Loading of the robot animation clips, against the previous loader.
+void AnimationLoadBenchmark();
+
+/// Memory, sampling cost and error of the compressed robot clips against
+/// the full ones.
+void AnimationCompressionBenchmark();
+
+/// Crowds of up to 10000 robots sampled and composed serially and over the
+/// worker threads.
+void AnimationCrowdBenchmark();
+
+/// Animation of 10000 robots at full rate and updated by their significance,
+/// with and without a frame budget.
+void AnimationSignificanceBenchmark();
+
+/// Blending of up to 8 robot poses, with masks and additive layers, against
+/// blending them bone by bone.
+void AnimationBlendBenchmark();
+
+/// Memory and error of the robot clips baked at several rates, as poses and
+/// as model matrices, and the cost of a crowd playing them.
+void AnimationBakeBenchmark();
+
+}; /* W3D */
+
+#endif
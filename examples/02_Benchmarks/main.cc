@@ -0,0 +1,66 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "Wolfy3D.h"
+#include "core/core.h"
+#include "benchmark.h"
+
+namespace W3D {
+
+/// Opened report file.
+static FILE* g_report_file = nullptr;
+
+void Report(const char* format, ...) {
+  char line[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line) - 2, format, args);
+  va_end(args);
+  strcat_s(line, sizeof(line), "\n");
+
+  OutputDebugString(line);
+  if (g_report_file) { fputs(line, g_report_file); }
+}
+
+float64 ElapsedMs(const uint64 start_microseconds) {
+  return (float64)(TimeInMicroSeconds() - start_microseconds) * 0.001;
+}
+
+/* MAIN FUNCTION */
+
+int32 main() {
+
+  // No window needed, only the worker threads.
+  Core::instance().jobs_.init();
+  fopen_s(&g_report_file, kBenchmarkReportPath, "w");
+
+  Report("Wolfy3D benchmarks, %d worker threads.", Core::instance().jobs_.num_workers());
+  Report("");
+
+  MeshOptimizerBenchmark();
+  MeshletBenchmark();
+  OcclusionBenchmark();
+  AnimationLoadBenchmark();
+  AnimationCompressionBenchmark();
+  AnimationCrowdBenchmark();
+  AnimationSignificanceBenchmark();
+  AnimationBlendBenchmark();
+  AnimationBakeBenchmark();
+
+  if (g_report_file) {
+    fclose(g_report_file);
+    g_report_file = nullptr;
+  }
+  Core::instance().jobs_.shutdown();
+
+  MessageBox(NULL, "Benchmarks finished, results saved in build/benchmarks.txt", "Wolfy3D Benchmarks", MB_OK);
+  return 0;
+}
+
+}; /* W3D */
@@ -0,0 +1,671 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "benchmark.h"
+#include "core/core.h"
+#include "core/animation_clip.h"
+#include "core/compressed_animation_clip.h"
+#include "core/animation_crowd.h"
+#include "core/significance_manager.h"
+#include "core/pose_blender.h"
+#include "core/baked_animation_clip.h"
+#include "Wolfy3D/math.h"
+#include "tinyxml2/tinyxml2.h"
+#include <math.h>
+#include <string.h>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+namespace W3D {
+
+/// Loads of every clip timed.
+const uint32 kAnimationLoads = 200;
+/// Poses sampled from every clip.
+const uint32 kAnimationSamples = 100000;
+/// Frames of 60 Hz simulated for every crowd size.
+const uint32 kCrowdFrames = 60;
+/// Robots of the crowd scheduled by their significance.
+const uint32 kSignificanceRobots = 10000;
+/// Most poses mixed, and blends timed per case.
+const uint32 kBlendMaxLayers = 8;
+const uint32 kBlendRuns = 100000;
+/// Robots of the crowd playing baked clips, and frames compared per bake.
+const uint32 kBakeRobots = 10000;
+const uint32 kBakeErrorFrames = 600;
+
+/// Robot bones as the animation files call them, parents first.
+static const char* kRobotBoneNames[] = {
+  "root", "pelvis", "body", "left_shoulder", "left_elbow", "left_wrist",
+  "right_shoulder", "right_elbow", "right_wrist", "neck",
+  "left_hip", "left_knee", "left_ankle", "right_hip", "right_knee", "right_ankle",
+};
+static const int32 kRobotBoneParents[] = {
+  -1, 0, 1, 2, 3, 4, 2, 6, 7, 2, 0, 10, 11, 0, 13, 14,
+};
+const uint32 kRobotNumBones = sizeof(kRobotBoneNames) / sizeof(kRobotBoneNames[0]);
+
+/// Robot clips.
+static const char* kRobotClips[] = {
+  "./../data/animations/robot/RobotIdleAnimDAE.txt",
+  "./../data/animations/robot/RobotAttackAnimDAE.txt",
+  "./../data/animations/robot/RobotDieAnimDAE.txt",
+};
+const uint32 kRobotNumClips = sizeof(kRobotClips) / sizeof(kRobotClips[0]);
+
+static void BuildRobotSkeleton(Skeleton& skeleton) {
+  for (uint32 i = 0; i < kRobotNumBones; ++i) {
+    const int32 parent = kRobotBoneParents[i];
+    skeleton.addBone(kRobotBoneNames[i], parent < 0 ? Skeleton::kNoBone : (uint32)parent);
+  }
+}
+
+/// Previous channel lookup, a walk of the whole document per channel.
+static bool LegacyFindChannel(tinyxml2::XMLNode* root,
+                              const std::string& id,
+                              tinyxml2::XMLElement** times,
+                              tinyxml2::XMLElement** values) {
+
+  for (auto* i = root->FirstChildElement(); i != nullptr; i = i->NextSiblingElement()) {
+    const char* attribute = i->Attribute("id");
+    if (attribute && id == attribute) {
+      *times = i->FirstChildElement()->FirstChildElement("float_array");
+      *values = i->FirstChildElement()->NextSiblingElement()->FirstChildElement("float_array");
+      return *times && *values;
+    }
+  }
+  return false;
+}
+
+/// Previous float decoding, through a string stream and a temporary vector.
+static void LegacyParseFloats(tinyxml2::XMLElement* element, std::vector<float64>& values) {
+  values.clear();
+  std::istringstream text(element->GetText() ? element->GetText() : "");
+  std::copy(std::istream_iterator<float64>(text),
+            std::istream_iterator<float64>(),
+            std::back_inserter(values));
+}
+
+/// Previous loading through a tinyxml2 document, same clip as
+/// AnimationClip::initFromFile.
+static bool LegacyLoad(const char* filename,
+                       const Skeleton& skeleton,
+                       const float32 translation_scale,
+                       AnimationClip& clip) {
+
+  tinyxml2::XMLDocument xml;
+  FileView file;
+  if (!Core::instance().vfs_.open(filename, file) ||
+      xml.Parse((const char*)file.data(), file.size()) != tinyxml2::XML_SUCCESS ||
+      !xml.FirstChild()) {
+    return false;
+  }
+  tinyxml2::XMLNode* root = xml.FirstChild();
+
+  clip.num_bones_ = skeleton.num_bones();
+  clip.translation_tracks_.assign(clip.num_bones_, { 0, 0 });
+  clip.rotation_tracks_.assign(clip.num_bones_, { 0, 0 });
+  clip.translation_times_.clear();
+  clip.translation_keys_.clear();
+  clip.rotation_times_.clear();
+  clip.rotation_keys_.clear();
+  clip.duration_ = 0.0f;
+
+  std::vector<float64> times;
+  std::vector<float64> values;
+  for (uint32 bone = 0; bone < clip.num_bones_; ++bone) {
+    const std::string& name = skeleton.name(bone);
+    tinyxml2::XMLElement* times_element = nullptr;
+    tinyxml2::XMLElement* values_element = nullptr;
+
+    if (LegacyFindChannel(root, name + ".translate", &times_element, &values_element)) {
+      LegacyParseFloats(times_element, times);
+      LegacyParseFloats(values_element, values);
+      const uint32 num_keys = times.size() < values.size() / 3 ? times.size() : values.size() / 3;
+      clip.translation_tracks_[bone] = { (uint32)clip.translation_keys_.size(), num_keys };
+      for (uint32 i = 0; i < num_keys; ++i) {
+        clip.translation_times_.push_back((float32)times[i]);
+        clip.translation_keys_.push_back({ (float32)values[i * 3] * translation_scale,
+                                           (float32)values[i * 3 + 1] * translation_scale,
+                                           (float32)values[i * 3 + 2] * translation_scale });
+      }
+      if (num_keys > 0 && clip.translation_times_.back() > clip.duration_) {
+        clip.duration_ = clip.translation_times_.back();
+      }
+    }
+
+    const char* axes[] = { ".rotateX", ".rotateY", ".rotateZ" };
+    std::vector<float64> angles[3];
+    bool found = true;
+    for (uint32 axis = 0; axis < 3 && found; ++axis) {
+      found = LegacyFindChannel(root, name + axes[axis], &times_element, &values_element);
+      if (found) { LegacyParseFloats(values_element, angles[axis]); }
+    }
+    if (!found) { continue; }
+    LegacyParseFloats(times_element, times);
+    const uint32 num_keys = times.size();
+    if (angles[0].size() != num_keys || angles[1].size() != num_keys || angles[2].size() != num_keys) {
+      return false;
+    }
+    clip.rotation_tracks_[bone] = { (uint32)clip.rotation_keys_.size(), num_keys };
+    for (uint32 i = 0; i < num_keys; ++i) {
+      DirectX::XMFLOAT3 euler = { DirectX::XMConvertToRadians((float32)angles[0][i]),
+                                  DirectX::XMConvertToRadians((float32)angles[1][i]),
+                                  DirectX::XMConvertToRadians((float32)angles[2][i]) };
+      clip.rotation_times_.push_back((float32)times[i]);
+      clip.rotation_keys_.push_back(Math::ConvertEulerToQuaternionFloat4(euler));
+    }
+    if (num_keys > 0 && clip.rotation_times_.back() > clip.duration_) {
+      clip.duration_ = clip.rotation_times_.back();
+    }
+  }
+  return true;
+}
+
+/// Largest difference between the keys of two clips, -1 if their tracks differ.
+static float32 MaxKeyDifference(const AnimationClip& a, const AnimationClip& b) {
+  if (a.translation_keys_.size() != b.translation_keys_.size() ||
+      a.rotation_keys_.size() != b.rotation_keys_.size()) {
+    return -1.0f;
+  }
+  float32 difference = 0.0f;
+  for (uint32 i = 0; i < a.translation_keys_.size(); ++i) {
+    const DirectX::XMFLOAT3& p = a.translation_keys_[i];
+    const DirectX::XMFLOAT3& q = b.translation_keys_[i];
+    float32 error = fabsf(p.x - q.x) + fabsf(p.y - q.y) + fabsf(p.z - q.z);
+    if (error > difference) { difference = error; }
+  }
+  for (uint32 i = 0; i < a.rotation_keys_.size(); ++i) {
+    const DirectX::XMFLOAT4& p = a.rotation_keys_[i];
+    const DirectX::XMFLOAT4& q = b.rotation_keys_[i];
+    float32 error = fabsf(p.x - q.x) + fabsf(p.y - q.y) + fabsf(p.z - q.z) + fabsf(p.w - q.w);
+    if (error > difference) { difference = error; }
+  }
+  return difference;
+}
+
+void AnimationLoadBenchmark() {
+  Report("Animation clip loading, robot skeleton of %u bones, %u loads per clip:",
+         kRobotNumBones, kAnimationLoads);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+
+  const char** files = kRobotClips;
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    FileView file;
+    if (!Core::instance().vfs_.open(files[f], file)) { continue; }
+    const uint32 file_size = (uint32)file.size();
+    const char* name = strrchr(files[f], '/') + 1;
+
+    // Document parsing alone, the floor of the previous loader.
+    uint64 start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kAnimationLoads; ++i) {
+      tinyxml2::XMLDocument xml;
+      xml.Parse((const char*)file.data(), file.size());
+    }
+    const float64 xml_ms = ElapsedMs(start) / (float64)kAnimationLoads;
+
+    AnimationClip clip;
+    start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kAnimationLoads; ++i) {
+      clip.initFromFile(files[f], skeleton, 0.1f);
+    }
+    const float64 new_ms = ElapsedMs(start) / (float64)kAnimationLoads;
+
+    AnimationClip legacy_clip;
+    start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kAnimationLoads; ++i) {
+      LegacyLoad(files[f], skeleton, 0.1f, legacy_clip);
+    }
+    const float64 legacy_ms = ElapsedMs(start) / (float64)kAnimationLoads;
+
+    // The document holds a copy of the file plus its nodes, the new loader
+    // only the keys and the text pointers of its channels.
+    Report("  %-26s %6.1f KB  %4u keys in %5.1f KB  %7.3f ms  previous %7.3f ms  speedup x%.2f  "
+           "document alone %7.3f ms  max key difference %g",
+           name, (float32)file_size / 1024.0f,
+           (uint32)(clip.translation_keys_.size() + clip.rotation_keys_.size()),
+           (float32)clip.memory() / 1024.0f,
+           new_ms, legacy_ms, legacy_ms / new_ms, xml_ms,
+           MaxKeyDifference(clip, legacy_clip));
+  }
+  Report("");
+}
+
+/// Time of a sample, spread over the clip.
+static float32 SampleTime(const uint32 sample, const float32 duration) {
+  return (float32)((sample * 2654435761u) % 65536) / 65536.0f * duration;
+}
+
+/// Grows the largest distance and angle found between the bones of two poses.
+static void MaxPoseError(const Pose& a, const Pose& b, float32* max_distance, float32* max_angle) {
+  for (uint32 bone = 0; bone < a.num_bones; ++bone) {
+    const float32 x = a.translation_x[bone] - b.translation_x[bone];
+    const float32 y = a.translation_y[bone] - b.translation_y[bone];
+    const float32 z = a.translation_z[bone] - b.translation_z[bone];
+    const float32 distance = sqrtf(x * x + y * y + z * z);
+    float32 cosine = fabsf(a.rotation_x[bone] * b.rotation_x[bone] +
+                           a.rotation_y[bone] * b.rotation_y[bone] +
+                           a.rotation_z[bone] * b.rotation_z[bone] +
+                           a.rotation_w[bone] * b.rotation_w[bone]);
+    const float32 angle = 2.0f * acosf(cosine < 1.0f ? cosine : 1.0f);
+    if (distance > *max_distance) { *max_distance = distance; }
+    if (angle > *max_angle) { *max_angle = angle; }
+  }
+}
+
+void AnimationCompressionBenchmark() {
+  Report("Animation clip compression, tolerance %.4f units and %.4f rad, %u poses sampled per clip:",
+         CompressedAnimationClip::kTranslationTolerance,
+         CompressedAnimationClip::kRotationTolerance, kAnimationSamples);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+  Pose pose;
+  pose.resize(kRobotNumBones);
+  Pose compressed_pose;
+  compressed_pose.resize(kRobotNumBones);
+
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    AnimationClip clip;
+    if (!clip.initFromFile(kRobotClips[f], skeleton, 0.1f)) { continue; }
+    CompressedAnimationClip compressed;
+    uint64 start = TimeInMicroSeconds();
+    compressed.init(clip);
+    const float64 compress_ms = ElapsedMs(start);
+
+    start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kAnimationSamples; ++i) {
+      clip.sample(SampleTime(i, clip.duration_), &pose);
+    }
+    const float64 sample_ms = ElapsedMs(start);
+    start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kAnimationSamples; ++i) {
+      compressed.sample(SampleTime(i, clip.duration_), &compressed_pose);
+    }
+    const float64 compressed_sample_ms = ElapsedMs(start);
+
+    // Error of every bone against the full clip, on a fraction of the samples.
+    float32 max_distance = 0.0f;
+    float32 max_angle = 0.0f;
+    for (uint32 i = 0; i < kAnimationSamples; i += 97) {
+      clip.sample(SampleTime(i, clip.duration_), &pose);
+      compressed.sample(SampleTime(i, clip.duration_), &compressed_pose);
+      MaxPoseError(pose, compressed_pose, &max_distance, &max_angle);
+    }
+
+    Report("  %-26s %4u -> %4u keys  %5.2f -> %5.2f KB  compressed in %6.3f ms  "
+           "sample %6.0f -> %6.0f ns per pose  max error %.5f units %.5f rad",
+           strrchr(kRobotClips[f], '/') + 1,
+           (uint32)(clip.translation_keys_.size() + clip.rotation_keys_.size()),
+           (uint32)(compressed.translation_keys_.size() + compressed.rotation_keys_.size()),
+           (float32)clip.memory() / 1024.0f, (float32)compressed.memory() / 1024.0f, compress_ms,
+           sample_ms * 1000000.0 / kAnimationSamples,
+           compressed_sample_ms * 1000000.0 / kAnimationSamples,
+           max_distance, max_angle);
+  }
+  Report("");
+}
+
+/// Frame times of a crowd, serial or over the worker threads.
+static void RunCrowd(AnimationCrowd& crowd, const bool parallel,
+                     float64* sample_ms, float64* compose_ms) {
+  *sample_ms = 0.0;
+  *compose_ms = 0.0;
+  for (uint32 frame = 0; frame < kCrowdFrames; ++frame) {
+    crowd.update(1.0f / 60.0f, parallel);
+    *sample_ms += crowd.stats().sample_ms;
+    *compose_ms += crowd.stats().compose_ms;
+  }
+  *sample_ms /= (float64)kCrowdFrames;
+  *compose_ms /= (float64)kCrowdFrames;
+}
+
+void AnimationCrowdBenchmark() {
+  Report("Animation crowds of robots playing the three clips, %u frames, sample + compose per frame:",
+         kCrowdFrames);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+  AnimationClip clips[kRobotNumClips];
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    clips[f].initFromFile(kRobotClips[f], skeleton, 0.1f);
+  }
+  Pose rest_pose;
+  rest_pose.resize(kRobotNumBones);
+
+  const uint32 sizes[] = { 100, 1000, 10000 };
+  for (uint32 s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    AnimationCrowd crowd;
+    crowd.init(&skeleton, rest_pose);
+    for (uint32 i = 0; i < sizes[s]; ++i) {
+      const AnimationClip& clip = clips[i % kRobotNumClips];
+      const float32 x = (float32)(i % 100) * 5.0f;
+      const float32 z = (float32)(i / 100) * 5.0f;
+      crowd.addInstance(&clip, DirectX::XMMatrixTranslation(x, 0.0f, z), SampleTime(i, clip.duration_));
+    }
+
+    float64 serial_sample_ms, serial_compose_ms;
+    float64 sample_ms, compose_ms;
+    RunCrowd(crowd, false, &serial_sample_ms, &serial_compose_ms);
+    RunCrowd(crowd, true, &sample_ms, &compose_ms);
+    const float64 serial_ms = serial_sample_ms + serial_compose_ms;
+    const float64 parallel_ms = sample_ms + compose_ms;
+    Report("  %5u robots: serial %7.3f + %7.3f ms  parallel %7.3f + %7.3f ms  "
+           "speedup x%.2f  %5.2f us per robot",
+           sizes[s], serial_sample_ms, serial_compose_ms, sample_ms, compose_ms,
+           serial_ms / parallel_ms, parallel_ms * 1000.0 / (float64)sizes[s]);
+  }
+  Report("");
+}
+
+/// Animates a crowd for kCrowdFrames frames, only the robots due. Returns
+/// the milliseconds per frame and the updates per frame.
+static float64 RunSignificance(SignificanceManager& significance,
+                               const AnimationClip* const* clips,
+                               std::vector<float32>& times,
+                               std::vector<Pose>& poses,
+                               float64* schedule_ms,
+                               float64* updates) {
+  const float32 delta_time = 1.0f / 60.0f;
+  const DirectX::XMMATRIX projection = DirectX::XMMatrixPerspectiveFovLH(DirectX::XMConvertToRadians(45.0f),
+                                                                         1.0f, 0.1f, 1000.0f);
+  *schedule_ms = 0.0;
+  *updates = 0.0;
+  uint64 start = TimeInMicroSeconds();
+  for (uint32 frame = 0; frame < kCrowdFrames; ++frame) {
+    // Walks along the crowd, looking into it.
+    const float32 x = (float32)frame * 4.0f;
+    const DirectX::XMMATRIX view = DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(x, 10.0f, -20.0f, 1.0f),
+                                                             DirectX::XMVectorSet(x + 100.0f, 0.0f, 200.0f, 1.0f),
+                                                             DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+    uint64 schedule = TimeInMicroSeconds();
+    significance.update(delta_time, view, projection);
+    *schedule_ms += ElapsedMs(schedule);
+
+    for (uint32 i = 0; i < times.size(); ++i) {
+      if (!significance.isDue(i)) { continue; }
+      significance.beginUpdate(i);
+      const AnimationClip& clip = *clips[i % kRobotNumClips];
+      times[i] = fmodf(times[i] + significance.elapsed(i), clip.duration_);
+      clip.sample(times[i], &poses[i]);
+      significance.endUpdate(i);
+    }
+    *updates += (float64)significance.stats().num_updated;
+  }
+  *schedule_ms /= (float64)kCrowdFrames;
+  *updates /= (float64)kCrowdFrames;
+  return ElapsedMs(start) / (float64)kCrowdFrames;
+}
+
+void AnimationSignificanceBenchmark() {
+  Report("Animation of %u robots scheduled by significance, camera walking along them, %u frames:",
+         kSignificanceRobots, kCrowdFrames);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+  AnimationClip clips[kRobotNumClips];
+  const AnimationClip* clip_pointers[kRobotNumClips];
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    clips[f].initFromFile(kRobotClips[f], skeleton, 0.1f);
+    clip_pointers[f] = &clips[f];
+  }
+
+  // Full rate, unlimited budget and the default budget.
+  const bool enabled[] = { false, true, true };
+  const float32 budgets[] = { 1000.0f, 1000.0f, SignificanceManager().budget_ms_ };
+  const char* names[] = { "full rate", "tiers", "tiers + budget" };
+  for (uint32 run = 0; run < sizeof(enabled) / sizeof(enabled[0]); ++run) {
+    SignificanceManager significance;
+    significance.is_enabled_ = enabled[run];
+    significance.budget_ms_ = budgets[run];
+    std::vector<float32> times(kSignificanceRobots);
+    std::vector<Pose> poses(kSignificanceRobots);
+    for (uint32 i = 0; i < kSignificanceRobots; ++i) {
+      const DirectX::XMFLOAT3 center((float32)(i % 100) * 5.0f, 4.0f, (float32)(i / 100) * 5.0f);
+      significance.add(center, 6.0f);
+      times[i] = SampleTime(i, clips[i % kRobotNumClips].duration_);
+      poses[i].resize(kRobotNumBones);
+    }
+
+    float64 schedule_ms, updates;
+    const float64 frame_ms = RunSignificance(significance, clip_pointers, times, poses,
+                                             &schedule_ms, &updates);
+    const SignificanceManager::Stats& stats = significance.stats();
+    Report("  %-14s %7.3f ms per frame (%.3f ms scheduling)  %7.1f robots updated per frame  "
+           "last frame tiers %u / %u / %u / %u, %u deferred",
+           names[run], frame_ms, schedule_ms, updates,
+           stats.num_per_tier[0], stats.num_per_tier[1], stats.num_per_tier[2], stats.num_per_tier[3],
+           stats.num_deferred);
+  }
+  Report("");
+}
+
+/// Blend layers mixed bone by bone, with the quaternion slerp of the engine,
+/// as the previous crossfade did with two poses.
+static void LegacyBlend(const Pose* const* poses, const float32* weights,
+                        const uint32 count, Pose* result) {
+  for (uint32 bone = 0; bone < result->num_bones; ++bone) {
+    float32 weight_sum = 0.0f;
+    DirectX::XMFLOAT3 translation = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT4 rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for (uint32 i = 0; i < count; ++i) {
+      weight_sum += weights[i];
+      const float32 alpha = weights[i] / weight_sum;
+      const Pose& pose = *poses[i];
+      translation.x += (pose.translation_x[bone] - translation.x) * alpha;
+      translation.y += (pose.translation_y[bone] - translation.y) * alpha;
+      translation.z += (pose.translation_z[bone] - translation.z) * alpha;
+      DirectX::XMFLOAT4 destiny = { pose.rotation_x[bone], pose.rotation_y[bone],
+                                    pose.rotation_z[bone], pose.rotation_w[bone] };
+      rotation = Math::QuaternionLerpFloat4(rotation, destiny, alpha);
+    }
+    result->translation_x[bone] = translation.x;
+    result->translation_y[bone] = translation.y;
+    result->translation_z[bone] = translation.z;
+    result->rotation_x[bone] = rotation.x;
+    result->rotation_y[bone] = rotation.y;
+    result->rotation_z[bone] = rotation.z;
+    result->rotation_w[bone] = rotation.w;
+  }
+}
+
+void AnimationBlendBenchmark() {
+  Report("Pose blending of up to %u robot poses, %u blends per case:", kBlendMaxLayers, kBlendRuns);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+  AnimationClip clips[kRobotNumClips];
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    clips[f].initFromFile(kRobotClips[f], skeleton, 0.1f);
+  }
+
+  // Every layer a clip at some time, weights falling.
+  Pose poses[kBlendMaxLayers];
+  const Pose* pose_pointers[kBlendMaxLayers];
+  float32 weights[kBlendMaxLayers];
+  for (uint32 i = 0; i < kBlendMaxLayers; ++i) {
+    const AnimationClip& clip = clips[i % kRobotNumClips];
+    poses[i].resize(kRobotNumBones);
+    clip.sample(SampleTime(i + 1, clip.duration_), &poses[i]);
+    pose_pointers[i] = &poses[i];
+    weights[i] = 1.0f / (float32)(i + 1);
+  }
+  Pose result;
+  result.resize(kRobotNumBones);
+  Pose legacy_result;
+  legacy_result.resize(kRobotNumBones);
+
+  uint64 start = TimeInMicroSeconds();
+  for (uint32 run = 0; run < kBlendRuns; ++run) {
+    clips[0].sample(SampleTime(run, clips[0].duration_), &result);
+  }
+  const float64 sample_ns = ElapsedMs(start) * 1000000.0 / kBlendRuns;
+  Report("  one clip sampled      %6.0f ns per pose", sample_ns);
+
+  PoseBlender blender;
+  for (uint32 layers = 2; layers <= kBlendMaxLayers; layers *= 2) {
+    blender.clear();
+    for (uint32 i = 0; i < layers; ++i) {
+      blender.addBlend(poses[i], weights[i]);
+    }
+    start = TimeInMicroSeconds();
+    for (uint32 run = 0; run < kBlendRuns; ++run) {
+      blender.blend(&result);
+    }
+    const float64 blend_ns = ElapsedMs(start) * 1000000.0 / kBlendRuns;
+    start = TimeInMicroSeconds();
+    for (uint32 run = 0; run < kBlendRuns; ++run) {
+      LegacyBlend(pose_pointers, weights, layers, &legacy_result);
+    }
+    const float64 legacy_ns = ElapsedMs(start) * 1000000.0 / kBlendRuns;
+
+    // Normalized lerp against slerp, they drift apart halfway between poses.
+    float32 max_distance = 0.0f;
+    float32 max_angle = 0.0f;
+    MaxPoseError(result, legacy_result, &max_distance, &max_angle);
+    Report("  %u blend layers        %6.0f ns per pose  %5.2f ns per bone and layer  "
+           "slerp per bone %6.0f ns  x%.1f  difference %.5f units %.5f rad",
+           layers, blend_ns, blend_ns / (kRobotNumBones * layers),
+           legacy_ns, legacy_ns / blend_ns, max_distance, max_angle);
+  }
+
+  // Attack arms added over a blend, from the first keys of the clip.
+  Pose additive_reference;
+  additive_reference.resize(kRobotNumBones);
+  clips[1].sample(0.0f, &additive_reference);
+  BoneMask upper_body;
+  upper_body.init(skeleton, 0.0f);
+  upper_body.setBranch(skeleton, skeleton.find("body"), 1.0f);
+  blender.clear();
+  for (uint32 i = 0; i < 4; ++i) {
+    blender.addBlend(poses[i], weights[i], i == 3 ? &upper_body : nullptr);
+  }
+  blender.addAdditive(poses[1], additive_reference, 0.5f, &upper_body);
+  start = TimeInMicroSeconds();
+  for (uint32 run = 0; run < kBlendRuns; ++run) {
+    blender.blend(&result);
+  }
+  const float64 layered_ns = ElapsedMs(start) * 1000000.0 / kBlendRuns;
+
+  // An additive layer equal to its reference changes nothing, and a whole
+  // one over its reference gives the layer pose.
+  float32 identity_distance = 0.0f;
+  float32 identity_angle = 0.0f;
+  blender.clear();
+  blender.addBlend(poses[0], 1.0f);
+  blender.addAdditive(additive_reference, additive_reference, 1.0f);
+  blender.blend(&result);
+  MaxPoseError(result, poses[0], &identity_distance, &identity_angle);
+  blender.clear();
+  blender.addBlend(additive_reference, 1.0f);
+  blender.addAdditive(poses[1], additive_reference, 1.0f);
+  blender.blend(&result);
+  MaxPoseError(result, poses[1], &identity_distance, &identity_angle);
+
+  Report("  4 blend, 1 masked, 1 additive masked  %6.0f ns per pose  (x%.2f one clip sampled)  "
+         "additive check %.6f units %.6f rad",
+         layered_ns, layered_ns / sample_ns, identity_distance, identity_angle);
+  Report("");
+}
+
+/// Largest distance between the bones of two world matrix sets, transposed.
+static float32 MaxBoneDistance(const DirectX::XMFLOAT4X4* a, const DirectX::XMFLOAT4X4* b) {
+  float32 max_distance = 0.0f;
+  for (uint32 bone = 0; bone < kRobotNumBones; ++bone) {
+    const float32 x = a[bone]._14 - b[bone]._14;
+    const float32 y = a[bone]._24 - b[bone]._24;
+    const float32 z = a[bone]._34 - b[bone]._34;
+    const float32 distance = sqrtf(x * x + y * y + z * z);
+    if (distance > max_distance) { max_distance = distance; }
+  }
+  return max_distance;
+}
+
+void AnimationBakeBenchmark() {
+  Report("Baked robot clips against sampling their keys, error over %u frames, crowd of %u robots:",
+         kBakeErrorFrames, kBakeRobots);
+
+  Skeleton skeleton;
+  BuildRobotSkeleton(skeleton);
+  AnimationClip clips[kRobotNumClips];
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    clips[f].initFromFile(kRobotClips[f], skeleton, 0.1f);
+  }
+  Pose rest_pose;
+  rest_pose.resize(kRobotNumBones);
+
+  // Memory and error of every clip baked at every rate, in both formats.
+  const float32 rates[] = { 15.0f, 30.0f, 60.0f };
+  const uint32 num_rates = sizeof(rates) / sizeof(rates[0]);
+  const BakedAnimationClip::Format formats[] = { BakedAnimationClip::kFormat_Pose,
+                                                 BakedAnimationClip::kFormat_ModelMatrices };
+  const char* format_names[] = { "pose", "matrices" };
+  BakedAnimationClip baked[kRobotNumClips][2];
+  for (uint32 f = 0; f < kRobotNumClips; ++f) {
+    Report("  %-26s keys %5.2f KB", strrchr(kRobotClips[f], '/') + 1,
+           (float32)clips[f].memory() / 1024.0f);
+    for (uint32 r = 0; r < num_rates; ++r) {
+      for (uint32 format = 0; format < 2; ++format) {
+        BakedAnimationClip& clip = baked[f][format];
+        uint64 start = TimeInMicroSeconds();
+        clip.init(clips[f], skeleton, rest_pose, rates[r], formats[format]);
+        const float64 bake_ms = ElapsedMs(start);
+
+        // Both played side by side on a step off the frames.
+        AnimationCrowd crowd;
+        crowd.init(&skeleton, rest_pose);
+        crowd.addInstance(&clips[f], DirectX::XMMatrixIdentity());
+        crowd.addInstance(&clips[f], DirectX::XMMatrixIdentity());
+        crowd.addInstance(&clips[f], DirectX::XMMatrixIdentity());
+        crowd.playBaked(1, &clip, true);
+        crowd.playBaked(2, &clip, false);
+        float32 lerp_error = 0.0f;
+        float32 nearest_error = 0.0f;
+        for (uint32 frame = 0; frame < kBakeErrorFrames; ++frame) {
+          crowd.update(1.0f / 97.0f, false);
+          const float32 lerp_distance = MaxBoneDistance(crowd.world_matrices(0), crowd.world_matrices(1));
+          const float32 nearest_distance = MaxBoneDistance(crowd.world_matrices(0), crowd.world_matrices(2));
+          if (lerp_distance > lerp_error) { lerp_error = lerp_distance; }
+          if (nearest_distance > nearest_error) { nearest_error = nearest_distance; }
+        }
+        Report("    %2.0f Hz %-8s %4u frames  %6.2f KB (x%5.2f keys)  baked in %6.3f ms  "
+               "max bone error %.5f units lerped, %.5f nearest",
+               rates[r], format_names[format], clip.num_frames_,
+               (float32)clip.memory() / 1024.0f, (float32)clip.memory() / (float32)clips[f].memory(),
+               bake_ms, lerp_error, nearest_error);
+      }
+    }
+  }
+
+  // The crowd cost of every way of playing, at the last rate baked.
+  const char* names[] = { "keys sampled", "pose lerped", "pose nearest",
+                          "matrices lerped", "matrices nearest" };
+  for (uint32 run = 0; run < sizeof(names) / sizeof(names[0]); ++run) {
+    AnimationCrowd crowd;
+    crowd.init(&skeleton, rest_pose);
+    for (uint32 i = 0; i < kBakeRobots; ++i) {
+      const uint32 f = i % kRobotNumClips;
+      const float32 x = (float32)(i % 100) * 5.0f;
+      const float32 z = (float32)(i / 100) * 5.0f;
+      const float32 time = SampleTime(i, clips[f].duration_);
+      crowd.addInstance(&clips[f], DirectX::XMMatrixTranslation(x, 0.0f, z), time);
+      if (run > 0) {
+        crowd.playBaked(i, &baked[f][run < 3 ? 0 : 1], run % 2 == 1, time);
+      }
+    }
+    float64 sample_ms, compose_ms;
+    RunCrowd(crowd, false, &sample_ms, &compose_ms);
+    Report("  %5u robots, %-16s %7.3f + %7.3f ms per frame  %5.2f us per robot",
+           kBakeRobots, names[run], sample_ms, compose_ms,
+           (sample_ms + compose_ms) * 1000.0 / (float64)kBakeRobots);
+  }
+  Report("");
+}
+
+}; /* W3D */
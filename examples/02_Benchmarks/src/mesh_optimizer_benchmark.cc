@@ -0,0 +1,110 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "benchmark.h"
+#include "core/core.h"
+#include "core/geo.h"
+#include "core/mesh_optimizer.h"
+#include <algorithm>
+#include <random>
+#include <string.h>
+#include <vector>
+
+namespace W3D {
+
+/// Quads per side of the synthetic grid.
+const uint32 kGridQuads = 256;
+
+/// Grid with unshared vertices per quad and triangles in random order, the
+/// worst case for the vertex cache and the welding.
+static void BuildShuffledGrid(std::vector<Geo::VertexData>& vertices,
+                              std::vector<uint32>& indices) {
+
+  vertices.clear();
+  indices.clear();
+  std::vector<uint32> triangles;
+  for (uint32 z = 0; z < kGridQuads; ++z) {
+    for (uint32 x = 0; x < kGridQuads; ++x) {
+      uint32 first = vertices.size();
+      for (uint32 corner = 0; corner < 4; ++corner) {
+        Geo::VertexData vertex;
+        float32 vx = (float32)(x + (corner & 1));
+        float32 vz = (float32)(z + (corner >> 1));
+        vertex.position = { vx, 0.0f, vz };
+        vertex.normal = { 0.0f, 1.0f, 0.0f };
+        vertex.uv = { vx / (float32)kGridQuads, vz / (float32)kGridQuads };
+        vertex.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+        vertices.push_back(vertex);
+      }
+      triangles.push_back(first);
+      triangles.push_back(first + 2);
+      triangles.push_back(first + 1);
+      triangles.push_back(first + 1);
+      triangles.push_back(first + 2);
+      triangles.push_back(first + 3);
+    }
+  }
+
+  std::vector<uint32> order(triangles.size() / 3);
+  for (uint32 i = 0; i < order.size(); ++i) { order[i] = i; }
+  std::mt19937 random(1234);
+  std::shuffle(order.begin(), order.end(), random);
+  for (uint32 i = 0; i < order.size(); ++i) {
+    indices.push_back(triangles[order[i] * 3]);
+    indices.push_back(triangles[order[i] * 3 + 1]);
+    indices.push_back(triangles[order[i] * 3 + 2]);
+  }
+}
+
+static void ReportStats(const char* name,
+                        const uint32 num_triangles,
+                        const Geo::MeshStats& stats,
+                        const float64 ms) {
+  Report("  %-16s %7u tris  ACMR %.3f -> %.3f  welded %7u  %8.2f ms",
+         name, num_triangles, stats.acmr_before, stats.acmr_after,
+         stats.num_welded, ms);
+}
+
+void MeshOptimizerBenchmark() {
+  Report("Mesh optimization (welding, vertex cache, overdraw and fetch order), cache of %u:",
+         MeshOptimizer::kCacheSize);
+
+  std::vector<Geo::VertexData> vertices;
+  std::vector<uint32> indices;
+  BuildShuffledGrid(vertices, indices);
+  uint64 start = TimeInMicroSeconds();
+  Geo::MeshStats stats = MeshOptimizer::Optimize(vertices, indices);
+  ReportStats("shuffled grid", indices.size() / 3, stats, ElapsedMs(start));
+
+  // The files are optimized and simplified while parsed, the time includes
+  // the parsing.
+  const char* files[] = {
+    "./../data/geometries/robot/body.x",
+    "./../data/geometries/plane/plane.x",
+    "./../data/geometries/plane/turret.x",
+  };
+  for (uint32 i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    Geo geometry;
+    start = TimeInMicroSeconds();
+    if (!geometry.parseFromFile(files[i]) || geometry.lods_.empty()) { continue; }
+    float64 ms = ElapsedMs(start);
+    const char* name = strrchr(files[i], '/') + 1;
+    ReportStats(name, geometry.lods_[0].num_indices / 3, geometry.mesh_stats_, ms);
+
+    // Simplified levels, error relative to the mesh radius.
+    for (uint32 lod = 1; lod < geometry.lods_.size(); ++lod) {
+      const Geo::LodLevel& level = geometry.lods_[lod];
+      Report("    lod %u: %7u tris (%5.1f%%)  error %.4f of the radius", lod,
+             level.num_indices / 3,
+             100.0f * (float32)level.num_indices / (float32)geometry.lods_[0].num_indices,
+             level.error / geometry.bounding_radius_);
+    }
+  }
+  Report("");
+}
+
+}; /* W3D */
@@ -0,0 +1,109 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "benchmark.h"
+#include "core/core.h"
+#include "core/geo.h"
+#include "core/meshlet.h"
+#include <math.h>
+#include <string.h>
+#include <vector>
+
+namespace W3D {
+
+/// Cameras around every mesh, and their distance in bounding radiuses. The
+/// close ones only see part of it.
+const uint32 kMeshletCameras = 256;
+const float32 kMeshletFarDistance = 3.0f;
+const float32 kMeshletNearDistance = 1.2f;
+
+/// Culls the meshlets from cameras orbiting the mesh, looking at its center.
+static void CullAround(const Geo& geometry,
+                       const float32 distance,
+                       Meshlets::Stats* stats,
+                       float64* ms) {
+
+  DirectX::XMMATRIX projection = DirectX::XMMatrixPerspectiveFovLH(0.8f, 16.0f / 9.0f, 0.1f, 1000.0f);
+  std::vector<Meshlets::Range> ranges;
+  *stats = { 0, 0, 0 };
+  uint64 start = TimeInMicroSeconds();
+  for (uint32 i = 0; i < kMeshletCameras; ++i) {
+    // Golden angle spiral over the sphere.
+    float32 y = 1.0f - 2.0f * ((float32)i + 0.5f) / (float32)kMeshletCameras;
+    float32 ring = sqrtf(1.0f - y * y);
+    float32 angle = 2.39996323f * (float32)i;
+    DirectX::XMFLOAT3 camera = { cosf(angle) * ring * distance, y * distance, sinf(angle) * ring * distance };
+    DirectX::XMVECTOR up = fabsf(y) > 0.99f ? DirectX::XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f)
+                                            : DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+    DirectX::XMMATRIX view = DirectX::XMMatrixLookAtLH(DirectX::XMLoadFloat3(&camera),
+                                                       DirectX::XMVectorZero(), up);
+    Meshlets::Cull(geometry.meshlets_, DirectX::XMMatrixMultiply(view, projection),
+                   camera, true, ranges, stats);
+  }
+  *ms = ElapsedMs(start);
+}
+
+static void ReportCulling(const char* name, const Meshlets::Stats& stats, const float64 ms) {
+  Report("    %-6s frustum %5.1f%%  backface %5.1f%%  drawn %5.1f%%  %6.2f us per cull",
+         name,
+         100.0 * (float64)stats.num_frustum_culled / (float64)stats.num_triangles,
+         100.0 * (float64)stats.num_backface_culled / (float64)stats.num_triangles,
+         100.0 * (float64)(stats.num_triangles - stats.num_frustum_culled - stats.num_backface_culled) /
+         (float64)stats.num_triangles,
+         ms * 1000.0 / (float64)kMeshletCameras);
+}
+
+void MeshletBenchmark() {
+  Report("Meshlets of %u to %u triangles, culled from %u cameras around every mesh:",
+         Meshlets::kMinTriangles, Meshlets::kMaxTriangles, kMeshletCameras);
+
+  const char* files[] = {
+    "./../data/geometries/robot/body.x",
+    "./../data/geometries/plane/plane.x",
+    "./../data/geometries/plane/turret.x",
+  };
+  for (uint32 i = 0; i < sizeof(files) / sizeof(files[0]); ++i) {
+    Geo geometry;
+    if (!geometry.parseFromFile(files[i]) || geometry.lods_.empty()) { continue; }
+    const char* name = strrchr(files[i], '/') + 1;
+    const uint32 num_triangles = geometry.lods_[0].num_indices / 3;
+    if (geometry.meshlets_.count == 0) {
+      Report("  %-16s %7u tris, drawn whole", name, num_triangles);
+      continue;
+    }
+
+    // Meshlets are built while parsing, timed again apart.
+    std::vector<uint32> indices(geometry.vertex_index_);
+    Meshlets::Set meshlets;
+    uint64 start = TimeInMicroSeconds();
+    Meshlets::Build(&geometry.vertex_data_[0].position, sizeof(Geo::VertexData),
+                    indices.data(), 0, geometry.lods_[0].num_indices, &meshlets);
+    float64 build_ms = ElapsedMs(start);
+
+    float32 max_radius = 0.0f;
+    uint32 num_cullable = 0;
+    for (uint32 m = 0; m < meshlets.count; ++m) {
+      if (meshlets.radius[m] > max_radius) { max_radius = meshlets.radius[m]; }
+      if (meshlets.cutoff[m] < 1.0f) { num_cullable++; }
+    }
+    Report("  %-16s %7u tris  %5u meshlets  %6.1f tris each  %5.1f%% with a cone  "
+           "radius <= %.3f of the mesh  %8.2f ms",
+           name, num_triangles, meshlets.count, (float32)num_triangles / (float32)meshlets.count,
+           100.0f * (float32)num_cullable / (float32)meshlets.count,
+           max_radius / geometry.bounding_radius_, build_ms);
+
+    Meshlets::Stats stats;
+    float64 ms;
+    CullAround(geometry, geometry.bounding_radius_ * kMeshletFarDistance, &stats, &ms);
+    ReportCulling("far", stats, ms);
+    CullAround(geometry, geometry.bounding_radius_ * kMeshletNearDistance, &stats, &ms);
+    ReportCulling("near", stats, ms);
+  }
+  Report("");
+}
+
+}; /* W3D */
@@ -0,0 +1,117 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "benchmark.h"
+#include "core/core.h"
+#include "core/occlusion_culler.h"
+#include <math.h>
+#include <vector>
+
+namespace W3D {
+
+/// Hilly ground occluder, cells per side and size in world units.
+const uint32 kOcclusionGroundCells = 64;
+const float32 kOcclusionGroundSize = 1000.0f;
+const float32 kOcclusionGroundHeight = 80.0f;
+/// Objects scattered over the ground, and frames simulated.
+const uint32 kOcclusionObjects = 10000;
+const uint32 kOcclusionFrames = 64;
+
+static float32 GroundHeight(const float32 x, const float32 z) {
+  float32 u = x / kOcclusionGroundSize;
+  float32 v = z / kOcclusionGroundSize;
+  return kOcclusionGroundHeight * (0.5f + 0.3f * sinf(u * 11.0f) * cosf(v * 7.0f) +
+                                   0.2f * sinf(u * 23.0f + v * 17.0f));
+}
+
+/// Ground facing up, so its front side is seen from above.
+static void BuildGround(std::vector<DirectX::XMFLOAT3>& positions, std::vector<uint32>& indices) {
+  const uint32 side = kOcclusionGroundCells + 1;
+  const float32 cell = kOcclusionGroundSize / (float32)kOcclusionGroundCells;
+  for (uint32 j = 0; j < side; ++j) {
+    for (uint32 i = 0; i < side; ++i) {
+      float32 x = (float32)i * cell;
+      float32 z = (float32)j * cell;
+      positions.push_back({ x, GroundHeight(x, z), z });
+    }
+  }
+  for (uint32 j = 0; j < kOcclusionGroundCells; ++j) {
+    for (uint32 i = 0; i < kOcclusionGroundCells; ++i) {
+      uint32 p00 = j * side + i;
+      uint32 p10 = p00 + 1;
+      uint32 p01 = p00 + side;
+      uint32 p11 = p01 + 1;
+      uint32 quad[] = { p00, p01, p10, p10, p01, p11 };
+      indices.insert(indices.end(), quad, quad + 6);
+    }
+  }
+}
+
+void OcclusionBenchmark() {
+  Report("Occlusion culling, %ux%u depth buffer, ground of %u triangles, %u objects:",
+         OcclusionCuller::kWidth, OcclusionCuller::kHeight,
+         kOcclusionGroundCells * kOcclusionGroundCells * 2, kOcclusionObjects);
+
+  std::vector<DirectX::XMFLOAT3> positions;
+  std::vector<uint32> indices;
+  BuildGround(positions, indices);
+
+  // Robot sized boxes standing on the ground, pseudo random places.
+  std::vector<DirectX::XMMATRIX> models(kOcclusionObjects);
+  uint32 seed = 12345;
+  for (uint32 i = 0; i < kOcclusionObjects; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    float32 x = (float32)(seed >> 8) / (float32)(1 << 24) * kOcclusionGroundSize;
+    seed = seed * 1664525 + 1013904223;
+    float32 z = (float32)(seed >> 8) / (float32)(1 << 24) * kOcclusionGroundSize;
+    models[i] = DirectX::XMMatrixTranslation(x, GroundHeight(x, z), z);
+  }
+  DirectX::BoundingBox box;
+  box.Center = { 0.0f, 1.0f, 0.0f };
+  box.Extents = { 1.0f, 1.0f, 1.0f };
+
+  auto& culler = Core::instance().occlusion_culler_;
+  DirectX::XMMATRIX projection = DirectX::XMMatrixPerspectiveFovLH(0.8f, 16.0f / 9.0f, 0.1f, 2000.0f);
+  float64 rasterize_ms = 0.0;
+  float64 test_ms = 0.0;
+  uint64 num_culled = 0;
+  uint64 num_rasterized = 0;
+  for (uint32 frame = 0; frame < kOcclusionFrames; ++frame) {
+    // Flying low over the ground, turning around its center.
+    float32 angle = 6.2831853f * (float32)frame / (float32)kOcclusionFrames;
+    float32 half = kOcclusionGroundSize * 0.5f;
+    DirectX::XMFLOAT3 eye = { half + cosf(angle) * half * 0.8f, 0.0f, half + sinf(angle) * half * 0.8f };
+    eye.y = GroundHeight(eye.x, eye.z) + 10.0f;
+    DirectX::XMFLOAT3 target = { half, kOcclusionGroundHeight * 0.5f, half };
+    DirectX::XMMATRIX view = DirectX::XMMatrixLookAtLH(DirectX::XMLoadFloat3(&eye),
+                                                       DirectX::XMLoadFloat3(&target),
+                                                       DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+    culler.beginFrame(DirectX::XMMatrixMultiply(view, projection), Core::instance().jobs_);
+    culler.addOccluder(positions.data(), positions.size(), indices.data(), indices.size(),
+                       DirectX::XMMatrixIdentity());
+    culler.rasterize();
+    rasterize_ms += culler.stats().rasterize_ms;
+    num_rasterized += culler.stats().num_rasterized;
+
+    uint64 start = TimeInMicroSeconds();
+    for (uint32 i = 0; i < kOcclusionObjects; ++i) {
+      culler.testBox(box, models[i]);
+    }
+    test_ms += ElapsedMs(start);
+    num_culled += culler.stats().num_culled;
+  }
+
+  Report("  rasterize %7.3f ms  %7.0f triangles drawn  test %6.1f ns per box  %5.1f%% hidden",
+         rasterize_ms / (float64)kOcclusionFrames,
+         (float64)num_rasterized / (float64)kOcclusionFrames,
+         test_ms * 1000000.0 / ((float64)kOcclusionFrames * kOcclusionObjects),
+         100.0 * (float64)num_culled / ((float64)kOcclusionFrames * kOcclusionObjects));
+  Report("");
+}
+
+}; /* W3D */
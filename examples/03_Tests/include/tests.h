@@ -0,0 +1,42 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __TESTS_H__
+#define __TESTS_H__ 1
+
+#include "Wolfy3D.h"
+
+namespace W3D {
+
+/// Tests results file.
+const char kTestsReportPath[] = "./../build/tests.txt";
+
+///--------------------------------------------------------------------------
+/// @fn   void Report(const char* format, ...);
+///
+/// @brief  Writes a line into the report file and the debugger output.
+///--------------------------------------------------------------------------
+void Report(const char* format, ...);
+
+///--------------------------------------------------------------------------
+/// @fn   void Check(const bool condition, const char* name);
+///
+/// @brief  Reports a check as passed or failed, and counts the failures.
+/// @param  condition Whether the check passed.
+/// @param  name What was checked.
+///--------------------------------------------------------------------------
+void Check(const bool condition, const char* name);
+
+/* Tests */
+
+/// An occluder quad hides a box behind it, but not the boxes in front of it,
+/// beside it or seen through its back face.
+void OcclusionCullerTest();
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,58 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "Wolfy3D.h"
+#include "core/core.h"
+#include "tests.h"
+
+namespace W3D {
+
+/// Opened report file.
+static FILE* g_report_file = nullptr;
+/// Checks run and failed.
+static uint32 g_num_checks = 0;
+static uint32 g_num_failures = 0;
+
+void Report(const char* format, ...) {
+  char line[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(line, sizeof(line) - 2, format, args);
+  va_end(args);
+  strcat_s(line, sizeof(line), "\n");
+
+  OutputDebugString(line);
+  if (g_report_file) { fputs(line, g_report_file); }
+}
+
+void Check(const bool condition, const char* name) {
+  g_num_checks++;
+  if (!condition) { g_num_failures++; }
+  Report("  %s  %s", condition ? "passed" : "FAILED", name);
+}
+
+/* MAIN FUNCTION */
+
+int32 main() {
+
+  // No window, the tests return their failures as the exit code.
+  fopen_s(&g_report_file, kTestsReportPath, "w");
+
+  OcclusionCullerTest();
+
+  Report("");
+  Report("%u of %u checks failed.", g_num_failures, g_num_checks);
+  if (g_report_file) {
+    fclose(g_report_file);
+    g_report_file = nullptr;
+  }
+  return (int32)g_num_failures;
+}
+
+}; /* W3D */
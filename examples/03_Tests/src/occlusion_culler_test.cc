@@ -0,0 +1,75 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "tests.h"
+#include "core/job_system.h"
+#include "core/occlusion_culler.h"
+
+namespace W3D {
+
+/// Occluder quad, half its side and its distance to the camera.
+const float32 kOccluderHalfSize = 2.0f;
+const float32 kOccluderDistance = 10.0f;
+
+/// Box of the given center and half size.
+static DirectX::BoundingBox Box(const float32 x, const float32 y, const float32 z,
+                                const float32 extent) {
+  DirectX::BoundingBox box;
+  box.Center = { x, y, z };
+  box.Extents = { extent, extent, extent };
+  return box;
+}
+
+void OcclusionCullerTest() {
+  Report("Occlusion culler, quad of side %.0f at %.0f units:",
+         kOccluderHalfSize * 2.0f, kOccluderDistance);
+
+  JobSystem jobs;
+  jobs.init();
+
+  // Facing the camera at the origin, clockwise on the screen.
+  const float32 s = kOccluderHalfSize;
+  const DirectX::XMFLOAT3 positions[] = {
+    { -s, -s, 0.0f }, { -s, s, 0.0f }, { s, -s, 0.0f }, { s, s, 0.0f },
+  };
+  const uint32 indices[] = { 0, 1, 2, 2, 1, 3 };
+  const DirectX::XMMATRIX model = DirectX::XMMatrixTranslation(0.0f, 0.0f, kOccluderDistance);
+
+  const DirectX::XMMATRIX view = DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+                                                           DirectX::XMVectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+                                                           DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+  const DirectX::XMMATRIX projection = DirectX::XMMatrixPerspectiveFovLH(0.9f, 16.0f / 9.0f, 0.1f, 1000.0f);
+  const DirectX::XMMATRIX identity = DirectX::XMMatrixIdentity();
+
+  OcclusionCuller culler;
+  culler.beginFrame(DirectX::XMMatrixMultiply(view, projection), jobs);
+  culler.addOccluder(positions, 4, indices, 6, model);
+  Check(culler.testBox(Box(0.0f, 0.0f, 20.0f, 0.5f), identity),
+        "nothing hidden before rasterizing");
+  culler.rasterize();
+
+  Check(culler.stats().num_rasterized == 2, "both triangles rasterized");
+  Check(!culler.testBox(Box(0.0f, 0.0f, 20.0f, 0.5f), identity), "box behind the quad hidden");
+  Check(culler.testBox(Box(0.0f, 0.0f, 5.0f, 0.5f), identity), "box in front of the quad visible");
+  Check(culler.testBox(Box(6.0f, 0.0f, 20.0f, 0.5f), identity), "box beside the quad visible");
+  Check(culler.testBox(Box(0.0f, 0.0f, 10.0f, 0.5f), identity), "box crossing the quad visible");
+
+  // Seen from the other side only its back faces are in view.
+  const DirectX::XMMATRIX back_view = DirectX::XMMatrixLookAtLH(DirectX::XMVectorSet(0.0f, 0.0f, 2.0f * kOccluderDistance, 1.0f),
+                                                                DirectX::XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+                                                                DirectX::XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+  culler.beginFrame(DirectX::XMMatrixMultiply(back_view, projection), jobs);
+  culler.addOccluder(positions, 4, indices, 6, model);
+  culler.rasterize();
+  Check(culler.stats().num_rasterized == 0, "back faces skipped");
+  Check(culler.testBox(Box(0.0f, 0.0f, 0.0f, 0.5f), identity), "box behind the back faces visible");
+
+  jobs.shutdown();
+  Report("");
+}
+
+}; /* W3D */
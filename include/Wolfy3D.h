@@ -17,5 +17,7 @@
 #include "Wolfy3D/math.h"
 #include "Wolfy3D/texture2D.h"
 #include "Wolfy3D/sprite.h"
+#include "Wolfy3D/file_system.h"
+#include "Wolfy3D/loader.h"
 
 #endif
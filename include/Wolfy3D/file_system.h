@@ -0,0 +1,49 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __WOLFY3D_FILE_SYSTEM_H__
+#define __WOLFY3D_FILE_SYSTEM_H__ 1
+
+#include "Wolfy3D/globals.h"
+
+namespace W3D {
+namespace FileSystem {
+
+/// Default archive, mounted automatically at startup when it exists.
+const char kDefaultArchivePath[] = "../data/data.w3p";
+
+///--------------------------------------------------------------------------
+/// @fn   bool Mount(const char* archive_path);
+///
+/// @brief  Mounts an asset archive. Files inside it will be used instead of
+///         the loose files with the same path.
+/// @param  archive_path Archive path.
+/// @return true if successfully mounted, false otherwise.
+///--------------------------------------------------------------------------
+bool Mount(const char* archive_path);
+
+///--------------------------------------------------------------------------
+/// @fn   bool PackDirectory(const char* directory,
+///                          const char* archive_path,
+///                          const bool compress = true);
+///
+/// @brief  Packs every file of a directory and its subdirectories into an
+///         archive. Paths are stored as they would be opened from the
+///         working directory, "../data" -> "data/textures/...".
+/// @param  directory Directory to pack.
+/// @param  archive_path Output archive path.
+/// @param  compress Whether to compress the entries with LZ4 or not.
+/// @return true if successfully packed, false otherwise.
+///--------------------------------------------------------------------------
+bool PackDirectory(const char* directory,
+                   const char* archive_path,
+                   const bool compress = true);
+
+}; /* FileSystem */
+}; /* W3D */
+
+#endif
@@ -9,6 +9,7 @@
 #define __WOLFY3D_GEOMETRY_H__ 1
 
 #include "Wolfy3D/globals.h"
+#include "Wolfy3D/loader.h"
 #include <DirectXMath.h>
 
 namespace W3D {
@@ -18,6 +19,14 @@ class Geometry {
 
  public:
 
+  /// Vertex of the dynamic geometries, same layout as the full vertices.
+  struct Vertex {
+    DirectX::XMFLOAT3 position;
+    DirectX::XMFLOAT3 normal;
+    DirectX::XMFLOAT2 uv;
+    DirectX::XMFLOAT4 color;
+  };
+
 
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
@@ -84,6 +93,46 @@ class Geometry {
                    const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void initTerrainAsync(const char* height_map_filename,
+  ///                             const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+  ///                             const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                             const LoadCallback& callback = nullptr);
+  ///
+  /// @brief  Same as initTerrain but returns immediately. The terrain is
+  ///         generated in a worker thread and rendered as the error geometry
+  ///         until it has been uploaded.
+  /// @param heigh_map_filename File which contains the height map for the terrain.
+  /// @param grid_size Size of the whole terrain, Y will be the max height.
+  /// @param  color Color RGBA of the geometry.
+  /// @param  callback Called in the main thread once loaded.
+  ///--------------------------------------------------------------------------
+  void initTerrainAsync(const char* height_map_filename,
+                        const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+                        const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                        const LoadCallback& callback = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initTerrainStreaming(const char* height_map_filename,
+  ///                                 const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+  ///                                 const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                                 const uint32 memory_budget_mb = 64);
+  ///
+  /// @brief  Terrain for heightmaps too big to be resident. The heightmap is
+  ///         memory mapped and only the tiles around the camera are built,
+  ///         in worker threads, and kept until the memory budget is spent.
+  ///         Tiles not loaded yet are not drawn.
+  ///
+  /// @param heigh_map_filename File which contains the height map for the terrain.
+  /// @param grid_size Size of the whole terrain, Y will be the max height.
+  /// @param  color Color RGBA of the geometry.
+  /// @param  memory_budget_mb Megabytes the resident tiles can use.
+  ///--------------------------------------------------------------------------
+  void initTerrainStreaming(const char* height_map_filename,
+                            const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+                            const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                            const uint32 memory_budget_mb = 64);
+
   ///--------------------------------------------------------------------------
   /// @fn   void initQuad(const float32 width, const float32 height)
   ///
@@ -141,19 +190,202 @@ class Geometry {
                    const float32 height,
                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void initSphere(const float32 radius = 0.5f,
+  ///                       const uint32 slices = 32,
+  ///                       const uint32 stacks = 16,
+  ///                       const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. UV sphere, poles on the Y axis.
+  /// @param  radius Radius of the sphere.
+  /// @param  slices Divisions around the Y axis, at least 3.
+  /// @param  stacks Divisions from pole to pole, at least 2.
+  /// @param  color Color RGBA of the geometry.
+  ///--------------------------------------------------------------------------
+  void initSphere(const float32 radius = 0.5f,
+                  const uint32 slices = 32,
+                  const uint32 stacks = 16,
+                  const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initCylinder(const float32 radius = 0.5f,
+  ///                         const float32 height = 1.0f,
+  ///                         const uint32 slices = 32,
+  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Capped cylinder along the Y axis.
+  /// @param  radius Radius of the cylinder.
+  /// @param  height Height of the cylinder.
+  /// @param  slices Divisions around the Y axis, at least 3.
+  /// @param  color Color RGBA of the geometry.
+  ///--------------------------------------------------------------------------
+  void initCylinder(const float32 radius = 0.5f,
+                    const float32 height = 1.0f,
+                    const uint32 slices = 32,
+                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initTorus(const float32 radius = 0.5f,
+  ///                      const float32 tube_radius = 0.2f,
+  ///                      const uint32 rings = 32,
+  ///                      const uint32 sides = 16,
+  ///                      const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Torus around the Y axis.
+  /// @param  radius Distance from the center to the center of the tube.
+  /// @param  tube_radius Radius of the tube.
+  /// @param  rings Divisions around the Y axis, at least 3.
+  /// @param  sides Divisions around the tube, at least 3.
+  /// @param  color Color RGBA of the geometry.
+  ///--------------------------------------------------------------------------
+  void initTorus(const float32 radius = 0.5f,
+                 const float32 tube_radius = 0.2f,
+                 const uint32 rings = 32,
+                 const uint32 sides = 16,
+                 const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initGrid(const DirectX::XMFLOAT2 size = { 10.0f, 10.0f },
+  ///                     const uint32 cells_x = 10,
+  ///                     const uint32 cells_z = 10,
+  ///                     const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Flat grid in the XZ plane facing up.
+  /// @param  size Size in X and Z.
+  /// @param  cells_x Cells along X.
+  /// @param  cells_z Cells along Z.
+  /// @param  color Color RGBA of the geometry.
+  ///--------------------------------------------------------------------------
+  void initGrid(const DirectX::XMFLOAT2 size = { 10.0f, 10.0f },
+                const uint32 cells_x = 10,
+                const uint32 cells_z = 10,
+                const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
   ///--------------------------------------------------------------------------
   /// @fn   void initFromFile(const char* filename, 
-  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f })
+  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                         const bool packed_vertices = false)
   ///
   /// @brief  Initializes the Geometry.
   /// @param  filename Filename with the info of the geometry.
   /// @param  color Color of the geometry.
+  /// @param  packed_vertices Quantized 20 bytes vertices instead of 48 bytes,
+  ///         positions get 1/65535 of the mesh size of precision.
   ///--------------------------------------------------------------------------
   void initFromFile(const char* filename, 
-                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                    const bool packed_vertices = false);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initFromFileAsync(const char* filename, 
+  ///                              const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                              const LoadCallback& callback = nullptr,
+  ///                              const bool packed_vertices = false)
+  ///
+  /// @brief  Same as initFromFile but returns immediately. The file is parsed
+  ///         in a worker thread and rendered as the error geometry until it
+  ///         has been uploaded.
+  /// @param  filename Filename with the info of the geometry.
+  /// @param  color Color of the geometry.
+  /// @param  callback Called in the main thread once loaded.
+  /// @param  packed_vertices Quantized 20 bytes vertices instead of 48 bytes.
+  ///--------------------------------------------------------------------------
+  void initFromFileAsync(const char* filename, 
+                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                         const LoadCallback& callback = nullptr,
+                         const bool packed_vertices = false);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void initDynamic(const Vertex* vertices,
+  ///                        const uint32 num_vertices,
+  ///                        const uint32* indices,
+  ///                        const uint32 num_indices,
+  ///                        const bool lines = false);
+  ///
+  /// @brief  Initializes a geometry whose vertices can be edited every frame,
+  ///         deformable meshes or debug lines for example. Never shared with
+  ///         other geometries. Only the vertices edited are uploaded.
+  /// @param  vertices Initial vertices.
+  /// @param  num_vertices Number of vertices.
+  /// @param  indices Indices, fixed.
+  /// @param  num_indices Number of indices.
+  /// @param  lines Line list instead of triangle list.
+  ///--------------------------------------------------------------------------
+  void initDynamic(const Vertex* vertices,
+                   const uint32 num_vertices,
+                   const uint32* indices,
+                   const uint32 num_indices,
+                   const bool lines = false);
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
 
-  
+  ///--------------------------------------------------------------------------
+  /// @fn   float32 heightAt(const float32 x, const float32 z);
+  ///
+  /// @brief  Terrain height at a position, bilinear between the heightmap
+  ///         samples. Coordinates are relative to the terrain entity.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @return Height, 0 if not a terrain or not loaded yet.
+  ///--------------------------------------------------------------------------
+  float32 heightAt(const float32 x, const float32 z);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   DirectX::XMFLOAT3 normalAt(const float32 x, const float32 z);
+  ///
+  /// @brief  Terrain normal at a position.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @return Unit normal, up if not a terrain or not loaded yet.
+  ///--------------------------------------------------------------------------
+  DirectX::XMFLOAT3 normalAt(const float32 x, const float32 z);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool raycast(const DirectX::XMFLOAT3 origin,
+  ///                    const DirectX::XMFLOAT3 direction,
+  ///                    const float32 max_distance,
+  ///                    float32* distance);
+  ///
+  /// @brief  First hit of a ray with the terrain.
+  /// @param  origin Ray origin in terrain space.
+  /// @param  direction Ray direction.
+  /// @param  max_distance Hits further than this are ignored.
+  /// @param  distance Distance to the hit along the normalized direction.
+  /// @return true if the ray hits the terrain, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool raycast(const DirectX::XMFLOAT3 origin,
+               const DirectX::XMFLOAT3 direction,
+               const float32 max_distance,
+               float32* distance);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   Vertex* editVertices(const uint32 first, const uint32 count);
+  ///
+  /// @brief  Vertices of a dynamic geometry to be written in place. They are
+  ///         uploaded at the start of the next frame, only the ranges edited.
+  /// @param  first First vertex edited.
+  /// @param  count Vertices edited.
+  /// @return Vertex first, valid until the next edit. nullptr if not dynamic
+  ///         or the range is outside.
+  ///--------------------------------------------------------------------------
+  Vertex* editVertices(const uint32 first, const uint32 count);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool updateVertices(const uint32 first,
+  ///                           const uint32 count,
+  ///                           const Vertex* vertices);
+  ///
+  /// @brief  Replaces vertices of a dynamic geometry, see editVertices.
+  /// @param  first First vertex replaced.
+  /// @param  count Vertices replaced.
+  /// @param  vertices New vertices.
+  /// @return false if not dynamic or the range is outside.
+  ///--------------------------------------------------------------------------
+  bool updateVertices(const uint32 first,
+                      const uint32 count,
+                      const Vertex* vertices);
 
 /*******************************************************************************
 ***                           Private Attributes                             ***
@@ -0,0 +1,64 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __WOLFY3D_LOADER_H__
+#define __WOLFY3D_LOADER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <functional>
+
+namespace W3D {
+
+/// Called in the main thread once an asynchronous load finishes.
+typedef std::function<void(const bool loaded)> LoadCallback;
+
+/// Asynchronous loading statistics.
+struct LoadStats {
+  /// Loads requested but not finished yet.
+  uint32 num_pending;
+  /// Loads finished successfully.
+  uint32 num_completed;
+  /// Loads that failed, their handles keep using the error resources.
+  uint32 num_failed;
+  /// Time spent parsing in the worker threads.
+  float32 total_parse_ms;
+  /// Time spent uploading to the GPU in the main thread.
+  float32 total_upload_ms;
+  /// Uploads done during the last frame.
+  uint32 last_frame_uploads;
+  /// Time spent uploading during the last frame.
+  float32 last_frame_upload_ms;
+};
+
+namespace Loader {
+
+///--------------------------------------------------------------------------
+/// @fn   LoadStats Stats();
+///
+/// @brief  Asynchronous loading statistics getter.
+///--------------------------------------------------------------------------
+LoadStats Stats();
+
+///--------------------------------------------------------------------------
+/// @fn   void SetFrameBudget(const float32 milliseconds);
+///
+/// @brief  Maximum time per frame used to upload the loaded resources to
+///         the GPU. At least one upload is done every frame.
+///--------------------------------------------------------------------------
+void SetFrameBudget(const float32 milliseconds);
+
+///--------------------------------------------------------------------------
+/// @fn   void Flush();
+///
+/// @brief  Blocks until every pending load has finished.
+///--------------------------------------------------------------------------
+void Flush();
+
+}; /* Loader */
+}; /* W3D */
+
+#endif
@@ -9,6 +9,7 @@
 #define __WOLFY3D_TEXTURE2D_H__ 1
 
 #include "Wolfy3D/globals.h"
+#include "Wolfy3D/loader.h"
 #include <DirectXMath.h>
 
 namespace W3D {
@@ -55,6 +56,18 @@ class Texture2D {
   ///--------------------------------------------------------------------------
   void initFromFile(const char* texture_path);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void initFromFileAsync(const char* texture_path,
+  ///                              const LoadCallback& callback = nullptr);
+  ///
+  /// @brief  Same as initFromFile but returns immediately. The image is
+  ///         decoded in a worker thread and the error texture is used until
+  ///         it has been uploaded.
+  /// @param  callback Called in the main thread once loaded.
+  ///--------------------------------------------------------------------------
+  void initFromFileAsync(const char* texture_path,
+                         const LoadCallback& callback = nullptr);
+
 
 /*******************************************************************************
 ***                           Private Attributes                             ***
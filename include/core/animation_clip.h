@@ -0,0 +1,116 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __ANIMATION_CLIP_H__
+#define __ANIMATION_CLIP_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/skeleton.h"
+#include <DirectXMath.h>
+#include <vector>
+
+namespace W3D {
+
+/// Keyframes of every bone of a skeleton, loaded from the COLLADA animation
+/// library files. Tracks are addressed by bone index, and the keys of all of
+/// them live one after the other in a few arrays.
+class AnimationClip {
+
+ public:
+
+  /// Keys of one bone in the clip key arrays. Bones not animated by the
+  /// file have no keys.
+  struct Track {
+    uint32 first_key;
+    uint32 num_keys;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  AnimationClip();
+
+  /// Default class destructor.
+  ~AnimationClip();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initFromFile(const char* filename,
+  ///                         const Skeleton& skeleton,
+  ///                         const float32 translation_scale = 1.0f);
+  ///
+  /// @brief  Loads the channels of every bone of the skeleton. Translations
+  ///         come from "<bone>.translate", rotations from the euler degrees
+  ///         of "<bone>.rotateX", "rotateY" and "rotateZ", which must share
+  ///         their key times, and are stored as quaternions. The file is
+  ///         pulled through once without building any document, and the
+  ///         numbers decoded straight into the keys.
+  /// @param  filename Animation library file.
+  /// @param  skeleton Bones to look for.
+  /// @param  translation_scale Scale from the file units to the world ones.
+  /// @return true if loaded, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initFromFile(const char* filename,
+                    const Skeleton& skeleton,
+                    const float32 translation_scale = 1.0f);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void sample(const float32 time, Pose* pose) const;
+  ///
+  /// @brief  Evaluates every animated bone at any time of the clip, finding
+  ///         the keys around it by binary search. Keeps no state, so any
+  ///         number of instances may sample the clip at once. Times outside
+  ///         the keys hold the first or the last one.
+  /// @param  time Seconds since the start of the clip.
+  /// @param  pose Pose of at least num_bones_ bones. Bones without keys are
+  ///         left as they are.
+  ///--------------------------------------------------------------------------
+  void sample(const float32 time, Pose* pose) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   float32 nextKeyTime(const float32 time) const;
+  ///
+  /// @brief  Time of the first key of any track after the one given.
+  /// @param  time Seconds since the start of the clip.
+  /// @return Key time, the first of the clip when none follows.
+  ///--------------------------------------------------------------------------
+  float32 nextKeyTime(const float32 time) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Bytes used by the tracks and the keys.
+  uint32 memory() const;
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Bones of the skeleton used to load it.
+  uint32 num_bones_;
+  /// Track of every bone.
+  std::vector<Track> translation_tracks_;
+  std::vector<Track> rotation_tracks_;
+  /// Key times, in seconds, and values of all the tracks.
+  std::vector<float32> translation_times_;
+  std::vector<DirectX::XMFLOAT3> translation_keys_;
+  std::vector<float32> rotation_times_;
+  std::vector<DirectX::XMFLOAT4> rotation_keys_;
+  /// Time of the last key, in seconds.
+  float32 duration_;
+
+}; /* AnimationClip */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,133 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __ANIMATION_CLIP_CACHE_H__
+#define __ANIMATION_CLIP_CACHE_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/animation_clip.h"
+#include "core/baked_animation_clip.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace W3D {
+
+/// Animation clips loaded once and shared by every instance playing them.
+/// Clips never change after loading, so instances only keep a const pointer
+/// and their own playback state. Used from the main thread.
+class AnimationClipCache {
+
+ public:
+
+  /// Counters since the start.
+  struct Stats {
+    /// Clips loaded, and the memory of their keys.
+    uint32 num_clips;
+    uint32 memory;
+    /// Requests answered with a clip already loaded.
+    uint32 num_shared;
+    float64 load_ms;
+    /// Clips baked, the memory of their frames and the time taken.
+    uint32 num_baked;
+    uint32 baked_memory;
+    float64 bake_ms;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  AnimationClipCache();
+
+  /// Default class destructor.
+  ~AnimationClipCache();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   const AnimationClip* load(const char* filename,
+  ///                                 const Skeleton& skeleton,
+  ///                                 const float32 translation_scale = 1.0f);
+  ///
+  /// @brief  Returns the clip of a file, loading it the first time. Clips
+  ///         are keyed by path, every skeleton playing the same file must
+  ///         have the same bones in the same order.
+  /// @param  filename Animation library file.
+  /// @param  skeleton Bones to look for when loading.
+  /// @param  translation_scale Scale from the file units to the world ones.
+  /// @return Shared clip, nullptr if it can't be loaded.
+  ///--------------------------------------------------------------------------
+  const AnimationClip* load(const char* filename,
+                            const Skeleton& skeleton,
+                            const float32 translation_scale = 1.0f);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   const BakedAnimationClip* bake(const AnimationClip* clip,
+  ///                                      const Skeleton& skeleton,
+  ///                                      const Pose& rest_pose,
+  ///                                      const float32 sample_rate,
+  ///                                      const BakedAnimationClip::Format format);
+  ///
+  /// @brief  Returns a clip of the cache baked, baking it the first time it
+  ///         is asked with that rest pose, rate and format.
+  /// @param  clip Clip loaded by the cache.
+  /// @param  skeleton Bones of the clip.
+  /// @param  rest_pose Pose of the bones without keys in the clip, the
+  ///         baked clip resets them to it when played.
+  /// @param  sample_rate Frames per second.
+  /// @param  format What every frame keeps.
+  /// @return Shared baked clip, nullptr if there is no clip.
+  ///--------------------------------------------------------------------------
+  const BakedAnimationClip* bake(const AnimationClip* clip,
+                                 const Skeleton& skeleton,
+                                 const Pose& rest_pose,
+                                 const float32 sample_rate,
+                                 const BakedAnimationClip::Format format);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void clear();
+  ///
+  /// @brief  Releases every clip and baked clip. Nobody may be using them.
+  ///--------------------------------------------------------------------------
+  void clear();
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Counters since the start.
+  const Stats& stats() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  AnimationClipCache(const AnimationClipCache& copy);
+  AnimationClipCache& operator=(const AnimationClipCache& copy);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Clips by path. Failed loads are kept as nullptr so they aren't retried.
+  std::unordered_map<std::string, std::unique_ptr<AnimationClip>> clips_;
+  /// Few of them, looked up by their source clip, rate and format.
+  std::vector<std::unique_ptr<BakedAnimationClip>> baked_clips_;
+  Stats stats_;
+
+}; /* AnimationClipCache */
+
+}; /* W3D */
+
+#endif
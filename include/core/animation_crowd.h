@@ -0,0 +1,183 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __ANIMATION_CROWD_H__
+#define __ANIMATION_CROWD_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/skeleton.h"
+#include "core/animation_clip.h"
+#include "core/baked_animation_clip.h"
+#include <DirectXMath.h>
+#include <vector>
+
+namespace W3D {
+
+/// Many instances of a skeleton playing shared clips, evaluated in two
+/// parallel phases over the worker threads: first every instance samples
+/// its clip into its own pose, then every pose is composed from local to
+/// world, parents first, into one matrix per bone. Instances never touch
+/// each other's data, and no entity is involved. Used from the main thread.
+class AnimationCrowd {
+
+ public:
+
+  /// Instances per job of both phases.
+  static const uint32 kInstancesPerJob = 64;
+
+  /// Counters of the last update.
+  struct Stats {
+    uint32 num_instances;
+    float64 sample_ms;
+    float64 compose_ms;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  AnimationCrowd();
+
+  /// Default class destructor.
+  ~AnimationCrowd();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const Skeleton* skeleton, const Pose& rest_pose);
+  ///
+  /// @brief  Sets the skeleton of every instance, removing the previous ones.
+  /// @param  skeleton Bones, shared, must outlive the crowd.
+  /// @param  rest_pose Pose of the bones without keys in the clips.
+  ///--------------------------------------------------------------------------
+  void init(const Skeleton* skeleton, const Pose& rest_pose);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 addInstance(const AnimationClip* clip,
+  ///                          const DirectX::XMMATRIX& root,
+  ///                          const float32 time = 0.0f);
+  ///
+  /// @brief  Adds an instance playing a clip in a loop.
+  /// @param  clip Clip played, shared, nullptr keeps the rest pose.
+  /// @param  root World matrix the root bones are relative to, as built by
+  ///         DirectXMath, not transposed.
+  /// @param  time Seconds of the clip to start at.
+  /// @return Index of the instance.
+  ///--------------------------------------------------------------------------
+  uint32 addInstance(const AnimationClip* clip,
+                     const DirectX::XMMATRIX& root,
+                     const float32 time = 0.0f);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void play(const uint32 instance,
+  ///                 const AnimationClip* clip,
+  ///                 const float32 time = 0.0f);
+  ///
+  /// @brief  Changes the clip of an instance.
+  /// @param  instance Index of the instance.
+  /// @param  clip Clip played, shared, nullptr keeps the current pose.
+  /// @param  time Seconds of the clip to start at.
+  ///--------------------------------------------------------------------------
+  void play(const uint32 instance, const AnimationClip* clip, const float32 time = 0.0f);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void playBaked(const uint32 instance,
+  ///                      const BakedAnimationClip* baked,
+  ///                      const bool interpolate = true,
+  ///                      const float32 time = 0.0f);
+  ///
+  /// @brief  Changes the clip of an instance to a baked one. With baked
+  ///         model matrices nothing is sampled or composed, the second
+  ///         phase looks the matrices up and the pose is left as it was.
+  /// @param  instance Index of the instance.
+  /// @param  baked Clip played, shared, of the crowd skeleton.
+  /// @param  interpolate Lerps between the baked frames.
+  /// @param  time Seconds of the clip to start at.
+  ///--------------------------------------------------------------------------
+  void playBaked(const uint32 instance,
+                 const BakedAnimationClip* baked,
+                 const bool interpolate = true,
+                 const float32 time = 0.0f);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void update(const float32 delta_time, const bool parallel = true);
+  ///
+  /// @brief  Advances every instance, samples its pose and composes its
+  ///         world matrices.
+  /// @param  delta_time Seconds since the last update.
+  /// @param  parallel Spreads both phases over the worker threads, false
+  ///         runs them on the calling thread.
+  ///--------------------------------------------------------------------------
+  void update(const float32 delta_time, const bool parallel = true);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Number of instances.
+  uint32 num_instances() const;
+  /// Bones of every instance.
+  uint32 num_bones() const;
+  /// Pose of an instance after the last update.
+  const Pose& pose(const uint32 instance) const;
+  /// World matrices of the bones of an instance, transposed like the model
+  /// matrices of the transform component.
+  const DirectX::XMFLOAT4X4* world_matrices(const uint32 instance) const;
+  /// World matrix the root bones of an instance are relative to, not
+  /// transposed.
+  void set_root(const uint32 instance, const DirectX::XMMATRIX& root);
+  /// Playback speed of an instance, 1.0f by default.
+  void set_speed(const uint32 instance, const float32 speed);
+  /// Counters of the last update.
+  const Stats& stats() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  /// Playback of one instance.
+  struct Instance {
+    const AnimationClip* clip;
+    /// Played instead of the clip when set.
+    const BakedAnimationClip* baked;
+    bool interpolate;
+    float32 time;
+    float32 speed;
+  };
+
+  AnimationCrowd(const AnimationCrowd& copy);
+  AnimationCrowd& operator=(const AnimationCrowd& copy);
+
+  /// First phase, advances and samples the instances [begin, end).
+  void sampleInstances(const uint32 begin, const uint32 end, const float32 delta_time);
+  /// Second phase, composes the world matrices of the instances [begin, end).
+  void composeInstances(const uint32 begin, const uint32 end);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  const Skeleton* skeleton_;
+  Pose rest_pose_;
+  /// Per instance data.
+  std::vector<Instance> instances_;
+  std::vector<Pose> poses_;
+  std::vector<DirectX::XMFLOAT4X4> roots_;
+  /// num_bones() matrices per instance, one instance after the other.
+  std::vector<DirectX::XMFLOAT4X4> world_matrices_;
+  Stats stats_;
+
+}; /* AnimationCrowd */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,146 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __ASYNC_LOADER_H__
+#define __ASYNC_LOADER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "Wolfy3D/loader.h"
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <functional>
+
+namespace W3D {
+
+class AsyncLoader {
+
+ public:
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  AsyncLoader();
+
+  /// Default class destructor.
+  ~AsyncLoader();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void load(const void* resource,
+  ///                 const std::function<bool(const char**)>& parse,
+  ///                 const std::function<bool(const bool)>& upload,
+  ///                 const LoadCallback& callback);
+  ///
+  /// @brief  Starts loading a resource. Main thread only.
+  /// @param  resource Resource being loaded, used to identify the request.
+  /// @param  parse Executed in a worker thread, reads and prepares the data.
+  ///         It receives where to leave its error message, shown later from
+  ///         the main thread.
+  /// @param  upload Executed in the main thread after parsing, GPU work. It
+  ///         receives whether the parsing succeeded, to update the resource.
+  /// @param  callback Called in the main thread when finished. Can be null.
+  ///--------------------------------------------------------------------------
+  void load(const void* resource,
+            const std::function<bool(const char**)>& parse,
+            const std::function<bool(const bool)>& upload,
+            const LoadCallback& callback);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool addCallback(const void* resource, const LoadCallback& callback);
+  ///
+  /// @brief  Adds another callback to a resource being loaded.
+  /// @return true if the resource is being loaded, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool addCallback(const void* resource, const LoadCallback& callback);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void update();
+  ///
+  /// @brief  Uploads the parsed resources until the frame budget is spent
+  ///         and calls their callbacks. Called once per frame.
+  ///--------------------------------------------------------------------------
+  void update();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void flush();
+  ///
+  /// @brief  Blocks until all the requests have been finished.
+  ///--------------------------------------------------------------------------
+  void flush();
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Milliseconds per frame that can be used by the uploads.
+  float32 frame_budget_ms_;
+  /// Loading statistics.
+  LoadStats stats_;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  AsyncLoader(const AsyncLoader& copy);
+  AsyncLoader& operator=(const AsyncLoader& copy);
+
+  struct Request {
+    const void* resource;
+    std::function<bool(const bool)> upload;
+    std::vector<LoadCallback> callbacks;
+    bool parsed;
+    float32 parse_ms;
+    /// Left by the parse step, nullptr if there was no error.
+    const char* error;
+  };
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 process(const bool use_budget);
+  ///
+  /// @brief  Finishes the parsed requests.
+  /// @return Number of requests finished.
+  ///--------------------------------------------------------------------------
+  uint32 process(const bool use_budget);
+
+  /// Finishes a request, uploads it and calls its callbacks.
+  void finish(Request* request);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Requests being loaded, main thread only.
+  std::vector<Request*> in_flight_;
+  /// Requests parsed by the workers, waiting for the upload.
+  std::deque<Request*> parsed_;
+  /// Protects parsed_.
+  std::mutex mutex_;
+
+}; /* AsyncLoader */
+
+///--------------------------------------------------------------------------
+/// @fn   void ReportLoadError(const char* message, const char** error);
+///
+/// @brief  Shows an error message box or, from the parse step of a load,
+///         leaves the message for the main thread. Workers never block on
+///         a message box that way.
+/// @param  message Error message, a string literal.
+/// @param  error Where to leave the message, nullptr to show it now.
+///--------------------------------------------------------------------------
+void ReportLoadError(const char* message, const char** error);
+
+}; /* W3D */
+
+#endif
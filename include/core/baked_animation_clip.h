@@ -0,0 +1,154 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __BAKED_ANIMATION_CLIP_H__
+#define __BAKED_ANIMATION_CLIP_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/skeleton.h"
+#include "core/animation_clip.h"
+#include <DirectXMath.h>
+#include <vector>
+
+namespace W3D {
+
+/// Looping clip sampled beforehand at a fixed rate, so playing it is a
+/// lookup of the frames around the time and, optionally, a lerp between
+/// them. Frames keep either the local pose of every bone, or its matrix in
+/// model space with the hierarchy already composed. The last frame is the
+/// end of the clip, and the frames are evenly spaced. Every frame holds all
+/// the bones, the ones without keys in the rest pose given to init. Unlike
+/// sampling the clip, playing it resets those bones to the rest pose.
+class BakedAnimationClip {
+
+ public:
+
+  enum Format {
+    /// Translation and rotation of every bone relative to its parent,
+    /// 28 bytes per bone and frame.
+    kFormat_Pose = 0,
+    /// Matrix of every bone relative to the model, 48 bytes per bone and
+    /// frame, no composition needed.
+    kFormat_ModelMatrices = 1,
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  BakedAnimationClip();
+
+  /// Default class destructor.
+  ~BakedAnimationClip();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const AnimationClip& clip,
+  ///                 const Skeleton& skeleton,
+  ///                 const Pose& rest_pose,
+  ///                 const float32 sample_rate,
+  ///                 const Format format);
+  ///
+  /// @brief  Samples a clip at a fixed rate.
+  /// @param  clip Clip baked, it may be released afterwards.
+  /// @param  skeleton Bones of the clip, composed for kFormat_ModelMatrices.
+  /// @param  rest_pose Pose of the bones without keys in the clip, kept
+  ///         in every frame.
+  /// @param  sample_rate Frames per second, at least. Rounded up to fit
+  ///         the clip duration.
+  /// @param  format What every frame keeps.
+  ///--------------------------------------------------------------------------
+  void init(const AnimationClip& clip,
+            const Skeleton& skeleton,
+            const Pose& rest_pose,
+            const float32 sample_rate,
+            const Format format);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void sample(const float32 time, const bool interpolate, Pose* pose) const;
+  ///
+  /// @brief  Local pose at any time, with kFormat_Pose only.
+  /// @param  time Seconds since the start, wrapped to the clip duration.
+  /// @param  interpolate Lerps between the frames around the time, the
+  ///         nearest frame is taken otherwise.
+  /// @param  pose Pose of at least num_bones_ bones. Every bone is written,
+  ///         the ones without keys with the rest pose.
+  ///--------------------------------------------------------------------------
+  void sample(const float32 time, const bool interpolate, Pose* pose) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void sampleMatrices(const float32 time,
+  ///                           const bool interpolate,
+  ///                           const DirectX::XMMATRIX& root,
+  ///                           DirectX::XMFLOAT4X4* world_matrices) const;
+  ///
+  /// @brief  World matrices at any time, with kFormat_ModelMatrices only.
+  ///         Interpolated matrices are lerped element by element, close to
+  ///         rigid as long as the frames are close.
+  /// @param  time Seconds since the start, wrapped to the clip duration.
+  /// @param  interpolate Lerps between the frames around the time, the
+  ///         nearest frame is taken otherwise.
+  /// @param  root World matrix of the model, not transposed.
+  /// @param  world_matrices num_bones_ matrices, transposed like the model
+  ///         matrices of the transform component.
+  ///--------------------------------------------------------------------------
+  void sampleMatrices(const float32 time,
+                      const bool interpolate,
+                      const DirectX::XMMATRIX& root,
+                      DirectX::XMFLOAT4X4* world_matrices) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Bytes used by the frames.
+  uint32 memory() const;
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Clip baked, only to recognize it, and how.
+  const AnimationClip* source_;
+  float32 sample_rate_;
+  Format format_;
+  /// Copy of the rest pose given to init, to recognize it too.
+  Pose rest_pose_;
+  /// Bones of every frame, and the padded count of the pose frames.
+  uint32 num_bones_;
+  uint32 num_padded_bones_;
+  uint32 num_frames_;
+  /// Seconds between frames, and of the whole clip.
+  float32 frame_duration_;
+  float32 duration_;
+  /// kFormat_Pose frames, the seven components of every bone one after the
+  /// other, as in the poses.
+  std::vector<float32> poses_;
+  /// kFormat_ModelMatrices frames, num_bones_ matrices each.
+  std::vector<DirectX::XMFLOAT4X3> model_matrices_;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  BakedAnimationClip(const BakedAnimationClip& copy);
+  BakedAnimationClip& operator=(const BakedAnimationClip& copy);
+
+  /// Frames around a time and the weight of the second one.
+  void findFrames(const float32 time, uint32* first, uint32* second, float32* alpha) const;
+
+}; /* BakedAnimationClip */
+
+}; /* W3D */
+
+#endif
@@ -102,7 +102,9 @@ class Cam {
   ///--------------------------------------------------------------------------
   /// @fn   void render(Object* obj);
   ///
-  /// @brief Renders an object into the window.
+  /// @brief Renders an object and its children into the window. With the
+  ///        occlusion culling, the occluders are rasterized first and the
+  ///        objects they hide are skipped.
   /// @param obj object to be rendered.
   ///--------------------------------------------------------------------------
   void render(class Entity* obj);
@@ -344,6 +346,8 @@ class Cam {
   float32 rotation_speed_;
   /// Sets if the navigation is enabled (translation and rotation).
   bool is_navigation_enabled_;
+  /// Sets if the objects hidden behind the occluders are skipped.
+  bool is_occlusion_culling_enabled_;
 
   /*******************************************************************************
   ***                           Private                                        ***
@@ -414,6 +418,23 @@ class Cam {
   ///--------------------------------------------------------------------------
   void updateLerping(const float32& delta);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void addOccluders(Entity* entity);
+  ///
+  /// @brief Adds the occluders of an object and its children to the
+  ///        occlusion culler.
+  /// @param entity object whose occluders are added.
+  ///--------------------------------------------------------------------------
+  void addOccluders(class Entity* entity);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void renderEntity(Entity* entity);
+  ///
+  /// @brief Renders an object, unless it is occluded, and its children.
+  /// @param entity object to be rendered.
+  ///--------------------------------------------------------------------------
+  void renderEntity(class Entity* entity);
+
 }; /* Cam */
 
 }; /* W3D */
@@ -12,9 +12,13 @@
 #include "Wolfy3D/material.h"
 #include "Wolfy3D/geometry.h"
 #include "core/components/transform.h"
+#include "core/meshlet.h"
+#include <vector>
 
 namespace W3D {
 
+class Geo;
+
 class RenderComponent {
 
 public:
@@ -50,7 +54,33 @@ public:
   ///--------------------------------------------------------------------------
   void render(TransformComponent* transform);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   void addOccluder(TransformComponent* transform);
+  ///
+  /// @brief  Adds the occluder mesh of the geometry to the occlusion culler,
+  ///         if this component is an occluder and the geometry has one.
+  /// @param  transform TransformComponent of the entity.
+  ///--------------------------------------------------------------------------
+  void addOccluder(TransformComponent* transform);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool isOccluded(TransformComponent* transform);
+  ///
+  /// @brief  Tests the geometry bounding box against the occluders
+  ///         rasterized this frame. Occluders are never hidden.
+  /// @param  transform TransformComponent of the entity.
+  /// @return true if nothing of it can be seen, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool isOccluded(TransformComponent* transform);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
 
+  /// Whether the geometry hides the objects behind it in the occlusion
+  /// culling. Only worth it for the big ones.
+  void set_occluder(const bool occluder);
+  bool occluder() const;
 
 private:
 
@@ -59,11 +89,58 @@ private:
 *******************************************************************************/
    
   ///--------------------------------------------------------------------------
-  /// @fn   void setupDeviceContext();
+  /// @fn   void setupDeviceContext(TransformComponent* transform);
   ///
   /// @brief  setup the device context sending all the info to render.
+  /// @param  transform TransformComponent of the entity rendered.
+  ///--------------------------------------------------------------------------
+  void setupDeviceContext(TransformComponent* transform);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 selectLod(Geo* geometry, TransformComponent* transform);
+  ///
+  /// @brief  Updates the level of detail drawn from the screen size of the
+  ///         geometry error at its distance to the camera.
+  /// @param  geometry Geometry with levels of detail, ready.
+  /// @param  transform TransformComponent of the entity rendered.
+  /// @return Index of the level in geometry->lods_.
+  ///--------------------------------------------------------------------------
+  uint32 selectLod(Geo* geometry, TransformComponent* transform);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void drawMeshlets(Geo* geometry, TransformComponent* transform);
+  ///
+  /// @brief  Draws the meshlets inside the frustum and facing the camera,
+  ///         the full level of detail.
+  /// @param  geometry Geometry with meshlets, ready.
+  /// @param  transform TransformComponent of the entity rendered.
+  ///--------------------------------------------------------------------------
+  void drawMeshlets(Geo* geometry, TransformComponent* transform);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void drawTerrain(Geo* geometry, TransformComponent* transform);
+  ///
+  /// @brief  Selects the terrain quadtree nodes in range and inside the
+  ///         frustum and draws them with the terrain vertex shader.
+  /// @param  geometry Terrain geometry, ready.
+  /// @param  transform TransformComponent of the terrain.
+  ///--------------------------------------------------------------------------
+  void drawTerrain(Geo* geometry, TransformComponent* transform);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void drawTerrainTile(Geo* tile, Geo* patch,
+  ///                            const DirectX::XMMATRIX& model,
+  ///                            const DirectX::XMFLOAT3 offset);
+  ///
+  /// @brief  Draws the selected nodes of one terrain quadtree.
+  /// @param  tile Geometry with the quadtree and the height texture.
+  /// @param  patch Geometry with the patch grid buffers.
+  /// @param  model Model matrix of the terrain.
+  /// @param  offset Tile position in terrain space.
   ///--------------------------------------------------------------------------
-  void setupDeviceContext();
+  void drawTerrainTile(Geo* tile, Geo* patch,
+                       const DirectX::XMMATRIX& model,
+                       const DirectX::XMFLOAT3 offset);
 
 /*******************************************************************************
 ***                       Private Attributes                                 ***
@@ -75,6 +152,13 @@ private:
   Material* material_;
   /// Geometry of the component.
   Geometry* geometry_;
+  /// Level of detail drawn the last frame, geometries are shared so it
+  /// lives here.
+  uint32 lod_;
+  /// Meshlet ranges drawn, kept to reuse the memory.
+  std::vector<Meshlets::Range> meshlet_ranges_;
+  /// Whether it is rasterized in the occlusion culling.
+  bool occluder_;
 
 
 }; /* RenderComponent */
@@ -0,0 +1,110 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __COMPRESSED_ANIMATION_CLIP_H__
+#define __COMPRESSED_ANIMATION_CLIP_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/animation_clip.h"
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+#include <vector>
+
+namespace W3D {
+
+/// Animation clip stored in 8 bytes per key, times included. Keys which can
+/// be interpolated from their neighbours within a tolerance are removed,
+/// translations are quantized to 16 bits inside the range of their track
+/// and rotations keep the smallest three components of the quaternion in
+/// 16 bits each, with the index of the largest one in their lowest bits.
+/// Key times are quantized to 16 bits of the clip duration, in the fourth
+/// component of every key.
+class CompressedAnimationClip {
+
+ public:
+
+  /// Keys of one bone in the clip key arrays.
+  struct Track {
+    uint32 first_key;
+    uint32 num_keys;
+  };
+
+  /// Default tolerances, in world units and in radians.
+  static const float32 kTranslationTolerance;
+  static const float32 kRotationTolerance;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  CompressedAnimationClip();
+
+  /// Default class destructor.
+  ~CompressedAnimationClip();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const AnimationClip& clip,
+  ///                 const float32 translation_tolerance = kTranslationTolerance,
+  ///                 const float32 rotation_tolerance = kRotationTolerance);
+  ///
+  /// @brief  Compresses a clip. A key is only removed if every key between
+  ///         the ones kept around it is reproduced within the tolerance.
+  /// @param  clip Clip to compress.
+  /// @param  translation_tolerance Largest distance to the removed keys.
+  /// @param  rotation_tolerance Largest angle to the removed keys.
+  ///--------------------------------------------------------------------------
+  void init(const AnimationClip& clip,
+            const float32 translation_tolerance = kTranslationTolerance,
+            const float32 rotation_tolerance = kRotationTolerance);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void sample(const float32 time, Pose* pose) const;
+  ///
+  /// @brief  Evaluates every animated bone at any time of the clip, as
+  ///         AnimationClip::sample does. Keys are decompressed with vector
+  ///         instructions.
+  /// @param  time Seconds since the start of the clip.
+  /// @param  pose Pose of at least num_bones_ bones. Bones without keys are
+  ///         left as they are.
+  ///--------------------------------------------------------------------------
+  void sample(const float32 time, Pose* pose) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Bytes used by the tracks and the keys.
+  uint32 memory() const;
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Bones of the clip compressed.
+  uint32 num_bones_;
+  /// Track of every bone.
+  std::vector<Track> translation_tracks_;
+  std::vector<Track> rotation_tracks_;
+  /// Box where the translations of every bone are quantized.
+  std::vector<DirectX::XMFLOAT3> translation_min_;
+  std::vector<DirectX::XMFLOAT3> translation_extent_;
+  /// Keys of all the tracks, their time in w.
+  std::vector<DirectX::PackedVector::XMUSHORTN4> translation_keys_;
+  std::vector<DirectX::PackedVector::XMUSHORTN4> rotation_keys_;
+  /// Time of the last key, in seconds.
+  float32 duration_;
+
+}; /* CompressedAnimationClip */
+
+}; /* W3D */
+
+#endif
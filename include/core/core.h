@@ -19,6 +19,14 @@
 #include "core/texture.h"
 #include "core/input.h"
 #include "core/super_sprite.h"
+#include "core/job_system.h"
+#include "core/file_system.h"
+#include "core/async_loader.h"
+#include "core/geometry_arena.h"
+#include "core/mesh_builder.h"
+#include "core/occlusion_culler.h"
+#include "core/animation_clip_cache.h"
+#include "core/significance_manager.h"
 #include "Wolfy3D/geometry.h"
 
 
@@ -112,8 +120,24 @@ class Core {
   SuperMaterial super_material_;
   /// Geometry factory list, where we will allocate all the geometries used.
   std::vector<Geo*> geometry_factory_;
+  /// Vertex and index buffers shared by all the geometries.
+  GeometryArena geometry_arena_;
+  /// Writes the procedural geometries into the arena upload memory.
+  MeshBuilder mesh_builder_;
+  /// CPU depth buffer of the big objects, to skip the ones they hide.
+  OcclusionCuller occlusion_culler_;
+  /// Animation clips shared by every instance playing them.
+  AnimationClipCache animation_clips_;
+  /// Update rate of the objects, from their size on screen.
+  SignificanceManager significance_;
   /// Texture factory list, where we will allocate all the textures used.
   std::vector<Texture*> texture_factory_;
+  /// Worker threads pool.
+  JobSystem jobs_;
+  /// Virtual file system, every asset is opened through it.
+  VirtualFileSystem vfs_;
+  /// Asynchronous resources loader.
+  AsyncLoader loader_;
 
 /*******************************************************************************
 ***                         Private Copy Constructor                         ***
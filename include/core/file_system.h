@@ -0,0 +1,287 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __FILE_SYSTEM_H__
+#define __FILE_SYSTEM_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <Windows.h>
+#include <vector>
+#include <string>
+
+namespace W3D {
+
+class JobSystem;
+
+/*******************************************************************************
+***                              Archive format                              ***
+*******************************************************************************/
+
+/// "W3DP" in little endian.
+const uint32 kArchiveMagic = 0x50443357;
+const uint32 kArchiveVersion = 1;
+/// Entry flag, the data is stored as a LZ4 block.
+const uint32 kArchiveEntryFlag_LZ4 = 1;
+
+/// Archive layout: header, entries data, entry table, hash slots and names.
+struct ArchiveHeader {
+  uint32 magic;
+  uint32 version;
+  uint32 num_entries;
+  /// Power of two, open addressing.
+  uint32 num_slots;
+  uint64 entries_offset;
+  uint64 slots_offset;
+  uint64 names_offset;
+  uint64 names_size;
+};
+
+struct ArchiveEntry {
+  /// FNV-1a hash of the normalized path.
+  uint64 hash;
+  /// Data offset from the start of the archive.
+  uint64 offset;
+  /// Bytes stored in the archive.
+  uint32 stored_size;
+  /// Bytes once decompressed.
+  uint32 size;
+  uint32 flags;
+  /// Normalized path offset inside the names block.
+  uint32 name_offset;
+};
+
+/*******************************************************************************
+***                               Mapped file                                ***
+*******************************************************************************/
+
+class MappedFile {
+
+ public:
+
+  /// Default class constructor.
+  MappedFile();
+
+  /// Default class destructor.
+  ~MappedFile();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool open(const char* path);
+  ///
+  /// @brief  Maps a whole file in memory as read only.
+  /// @param  path File path.
+  /// @return true if successfully mapped, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool open(const char* path);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void close();
+  ///
+  /// @brief  Unmaps the file and closes its handles.
+  ///--------------------------------------------------------------------------
+  void close();
+
+  /// Mapped data getter, nullptr if the file is empty or not opened.
+  const uchar8* data() const;
+  /// File size getter.
+  uint64 size() const;
+
+ private:
+
+  MappedFile(const MappedFile& copy);
+  MappedFile& operator=(const MappedFile& copy);
+
+  /// File handle.
+  HANDLE file_;
+  /// File mapping handle.
+  HANDLE mapping_;
+  /// Mapped view.
+  const uchar8* data_;
+  /// File size.
+  uint64 size_;
+
+}; /* MappedFile */
+
+/*******************************************************************************
+***                                File view                                 ***
+*******************************************************************************/
+
+/// Read only view of a file served by the virtual file system. It stays valid
+/// while the view and the virtual file system are alive.
+class FileView {
+
+ public:
+
+  /// Default class constructor.
+  FileView();
+
+  /// Default class destructor.
+  ~FileView();
+
+  /// Releases the view.
+  void reset();
+
+  /// Data getter.
+  const uchar8* data() const;
+  /// Size getter.
+  uint32 size() const;
+
+ private:
+
+  friend class VirtualFileSystem;
+
+  FileView(const FileView& copy);
+  FileView& operator=(const FileView& copy);
+
+  /// Viewed data, inside an archive or inside loose_file_.
+  const uchar8* data_;
+  /// Viewed size.
+  uint32 size_;
+  /// Used when the file is not packed into any archive.
+  MappedFile loose_file_;
+
+}; /* FileView */
+
+/*******************************************************************************
+***                                 Archive                                  ***
+*******************************************************************************/
+
+class Archive {
+
+ public:
+
+  /// Default class constructor.
+  Archive();
+
+  /// Default class destructor.
+  ~Archive();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool mount(const char* path, JobSystem& jobs);
+  ///
+  /// @brief  Maps the archive and decodes its compressed entries in parallel.
+  /// @param  path Archive path.
+  /// @param  jobs Job system used to decode the entries.
+  /// @return true if successfully mounted, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool mount(const char* path, JobSystem& jobs);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool find(const char* normalized_path,
+  ///                 const uchar8** data,
+  ///                 uint32* size) const;
+  ///
+  /// @brief  Looks for an entry in the hashed table of contents.
+  /// @param  normalized_path Path normalized with VirtualFileSystem::NormalizePath.
+  /// @param  data Output, entry data.
+  /// @param  size Output, entry size.
+  /// @return true if the entry exists, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool find(const char* normalized_path,
+            const uchar8** data,
+            uint32* size) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   static bool Pack(const char* archive_path,
+  ///                        const std::vector<std::string>& files,
+  ///                        const std::vector<std::string>& names,
+  ///                        const bool compress);
+  ///
+  /// @brief  Writes an archive.
+  /// @param  archive_path Output archive path.
+  /// @param  files Paths of the files to pack.
+  /// @param  names Normalized names the files will be opened with.
+  /// @param  compress Whether to try to compress the entries with LZ4 or not.
+  /// @return true if successfully written, false otherwise.
+  ///--------------------------------------------------------------------------
+  static bool Pack(const char* archive_path,
+                   const std::vector<std::string>& files,
+                   const std::vector<std::string>& names,
+                   const bool compress);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   static uint64 Hash(const char* normalized_path);
+  ///
+  /// @brief  FNV-1a hash used by the table of contents.
+  ///--------------------------------------------------------------------------
+  static uint64 Hash(const char* normalized_path);
+
+ private:
+
+  Archive(const Archive& copy);
+  Archive& operator=(const Archive& copy);
+
+  /// Whole archive mapping.
+  MappedFile file_;
+  const ArchiveHeader* header_;
+  const ArchiveEntry* entries_;
+  /// Entry index + 1 per slot, 0 means empty.
+  const uint32* slots_;
+  const char* names_;
+  /// Offset inside decoded_ of every compressed entry.
+  std::vector<uint64> decoded_offsets_;
+  /// Decompressed entries.
+  std::vector<uchar8> decoded_;
+
+}; /* Archive */
+
+/*******************************************************************************
+***                           Virtual file system                            ***
+*******************************************************************************/
+
+class VirtualFileSystem {
+
+ public:
+
+  /// Default class constructor.
+  VirtualFileSystem();
+
+  /// Default class destructor.
+  ~VirtualFileSystem();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool mount(const char* archive_path);
+  ///
+  /// @brief  Mounts an archive. Archives mounted later have priority. Mount
+  ///         them before starting to load from worker threads.
+  /// @param  archive_path Archive path.
+  /// @return true if successfully mounted, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool mount(const char* archive_path);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool open(const char* path, FileView& view) const;
+  ///
+  /// @brief  Opens a file, looking for it in the mounted archives first and
+  ///         mapping the loose file otherwise. Thread safe.
+  /// @param  path File path, as used in the rest of the engine.
+  /// @param  view Output view of the file.
+  /// @return true if the file was found, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool open(const char* path, FileView& view) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   static std::string NormalizePath(const char* path);
+  ///
+  /// @brief  Archive key of a path: forward slashes, lower case and without
+  ///         the leading "./" and "../".
+  ///         "../data/textures/Grass.jpg" -> "data/textures/grass.jpg"
+  ///--------------------------------------------------------------------------
+  static std::string NormalizePath(const char* path);
+
+ private:
+
+  VirtualFileSystem(const VirtualFileSystem& copy);
+  VirtualFileSystem& operator=(const VirtualFileSystem& copy);
+
+  /// Mounted archives.
+  std::vector<Archive*> archives_;
+
+}; /* VirtualFileSystem */
+
+}; /* W3D */
+
+#endif
@@ -10,15 +10,35 @@
 
 #include "Wolfy3D.h"
 #include "DirectXMath.h"
+#include "DirectXCollision.h"
 #include "D3D11.h"
+#include "core/geometry_arena.h"
+#include "core/meshlet.h"
 #include <vector>
 
 namespace W3D {
 
+class TerrainQuadTree;
+class TerrainStreamer;
+class HeightMapSource;
+class MeshBuilder;
+
 class Geo {
   
  public:
 
+  /// Vertex buffer layouts.
+  enum VertexFormat {
+    /// VertexData, float positions, normals, uvs and colors.
+    kVertexFormat_Full = 0,
+    /// PackedVertexData, quantized. Not for the terrain patch, the morph
+    /// needs the exact grid positions.
+    kVertexFormat_Packed,
+  };
+
+  /// Defined with the attributes.
+  struct VertexData;
+
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
 *******************************************************************************/
@@ -71,6 +91,25 @@ class Geo {
                    const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
 
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initTerrainStreaming(const char* height_map_filename,
+  ///                                 const DirectX::XMFLOAT3 grid_size,
+  ///                                 const DirectX::XMFLOAT4 color,
+  ///                                 const uint64 budget_bytes);
+  ///
+  /// @brief  Initializes the Geometry. Terrain paged in tiles around the
+  ///         camera, for heightmaps too big to be resident.
+  /// @param heigh_map_filename File which contains the height map for the terrain.
+  /// @param grid_size Size of the whole terrain, Y will be the max height.
+  /// @param  color Color RGBA of the geometry.
+  /// @param  budget_bytes Memory the resident tiles can use.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initTerrainStreaming(const char* height_map_filename,
+                            const DirectX::XMFLOAT3 grid_size,
+                            const DirectX::XMFLOAT4 color,
+                            const uint64 budget_bytes);
+
   ///--------------------------------------------------------------------------
   /// @fn   bool initQuad(const float32 width, const float32 height)
   ///
@@ -132,17 +171,332 @@ class Geo {
                    const float32 height,
                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
 
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initSphere(const float32 radius,
+  ///                       const uint32 slices,
+  ///                       const uint32 stacks,
+  ///                       const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. UV sphere, poles on the Y axis.
+  /// @param  radius Radius of the sphere.
+  /// @param  slices Divisions around the Y axis, at least 3.
+  /// @param  stacks Divisions from pole to pole, at least 2.
+  /// @param  color Color RGBA of the geometry.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initSphere(const float32 radius,
+                  const uint32 slices,
+                  const uint32 stacks,
+                  const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initCylinder(const float32 radius,
+  ///                         const float32 height,
+  ///                         const uint32 slices,
+  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Capped cylinder along the Y axis.
+  /// @param  radius Radius of the cylinder.
+  /// @param  height Height of the cylinder.
+  /// @param  slices Divisions around the Y axis, at least 3.
+  /// @param  color Color RGBA of the geometry.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initCylinder(const float32 radius,
+                    const float32 height,
+                    const uint32 slices,
+                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initTorus(const float32 radius,
+  ///                      const float32 tube_radius,
+  ///                      const uint32 rings,
+  ///                      const uint32 sides,
+  ///                      const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Torus around the Y axis.
+  /// @param  radius Distance from the center to the center of the tube.
+  /// @param  tube_radius Radius of the tube.
+  /// @param  rings Divisions around the Y axis, at least 3.
+  /// @param  sides Divisions around the tube, at least 3.
+  /// @param  color Color RGBA of the geometry.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initTorus(const float32 radius,
+                 const float32 tube_radius,
+                 const uint32 rings,
+                 const uint32 sides,
+                 const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initGrid(const DirectX::XMFLOAT2 size,
+  ///                     const uint32 cells_x,
+  ///                     const uint32 cells_z,
+  ///                     const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+  ///
+  /// @brief  Initializes the Geometry. Flat grid in the XZ plane facing up.
+  /// @param  size Size in X and Z.
+  /// @param  cells_x Cells along X.
+  /// @param  cells_z Cells along Z.
+  /// @param  color Color RGBA of the geometry.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initGrid(const DirectX::XMFLOAT2 size,
+                const uint32 cells_x,
+                const uint32 cells_z,
+                const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+
   ///--------------------------------------------------------------------------
   /// @fn   bool initFromFile(const char* filename, 
-  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f })
+  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                         const VertexFormat vertex_format = kVertexFormat_Full)
   ///
   /// @brief  Initializes the Geometry.
   /// @param  filename Filename with the info of the geometry.
   /// @param  color Color of the geometry.
+  /// @param  vertex_format Layout of the vertex buffer.
   /// @return true if successfully initialized, false otherwise.
   ///--------------------------------------------------------------------------
   bool initFromFile(const char* filename, 
-                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f });
+                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                    const VertexFormat vertex_format = kVertexFormat_Full);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool parseFromFile(const char* filename, 
+  ///                          const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                          const char** error = nullptr)
+  ///
+  /// @brief  CPU part of initFromFile, fills the vertices and indices without
+  ///         creating the buffers. Can be called from a worker thread.
+  /// @param  filename Filename with the info of the geometry.
+  /// @param  color Color of the geometry.
+  /// @param  error Where to leave the error message from a worker thread,
+  ///         nullptr shows it.
+  /// @return true if successfully parsed, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool parseFromFile(const char* filename, 
+                     const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                     const char** error = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool buildTerrain(const char* height_map_filename,
+  ///                         const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+  ///                         const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  ///                         const char** error = nullptr);
+  ///
+  /// @brief  CPU part of initTerrain, reads the heights and builds the lod
+  ///         quadtree and its patch grid without creating the buffers. Can be
+  ///         called from a worker thread.
+  /// @param heigh_map_filename File which contains the height map for the terrain.
+  /// @param grid_size Size of the whole terrain, Y will be the max height.
+  /// @param  color Color RGBA of the geometry.
+  /// @param  error Where to leave the error message from a worker thread,
+  ///         nullptr shows it.
+  /// @return true if successfully generated, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool buildTerrain(const char* height_map_filename, 
+                    const DirectX::XMFLOAT3 grid_size = { 10.0f, 2.0f, 10.0f },
+                    const DirectX::XMFLOAT4 color = { 1.0f, 1.0f, 1.0f, 1.0f },
+                    const char** error = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool buildTerrainTile(const HeightMapSource& source,
+  ///                             const DirectX::XMINT2 first_sample,
+  ///                             const DirectX::XMINT2 num_samples,
+  ///                             const DirectX::XMFLOAT2 spacing,
+  ///                             const float32 max_height,
+  ///                             const DirectX::XMFLOAT4 color,
+  ///                             const int32 stride = 1);
+  ///
+  /// @brief  Reads a rectangle of the heightmap and builds its lod quadtree,
+  ///         without the patch grid. Can be called from a worker thread.
+  /// @param  source Opened heightmap.
+  /// @param  first_sample First sample of the rectangle, x and z.
+  /// @param  num_samples Samples read, x and z, stride apart.
+  /// @param  spacing Distance between two samples read, x and z.
+  /// @param  max_height Height of the maximum sample value.
+  /// @param  color Color RGBA of the geometry.
+  /// @param  stride Heightmap samples between two samples read, the ones
+  ///         past the heightmap repeat its last row or column.
+  /// @return true if successfully generated, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool buildTerrainTile(const HeightMapSource& source,
+                        const DirectX::XMINT2 first_sample,
+                        const DirectX::XMINT2 num_samples,
+                        const DirectX::XMFLOAT2 spacing,
+                        const float32 max_height,
+                        const DirectX::XMFLOAT4 color,
+                        const int32 stride = 1);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void buildTerrainPatch(const DirectX::XMFLOAT4 color);
+  ///
+  /// @brief  Fills the vertices and indices with the grid the terrain
+  ///         quadtree nodes are drawn with.
+  /// @param  color Color RGBA of the geometry.
+  ///--------------------------------------------------------------------------
+  void buildTerrainPatch(const DirectX::XMFLOAT4 color);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void optimizeMesh(const uint32 num_ranges = 1);
+  ///
+  /// @brief  Welds the vertices and reorders the triangles for the vertex
+  ///         cache and the overdraw, and the vertices for the vertex fetch.
+  ///         Triangle lists only. Can be called from a worker thread.
+  /// @param  num_ranges Equal index ranges drawn separately, kept apart.
+  ///--------------------------------------------------------------------------
+  void optimizeMesh(const uint32 num_ranges = 1);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void generateLods();
+  ///
+  /// @brief  Simplifies the mesh into coarser levels of detail, each one with
+  ///         about half the triangles of the previous one, and appends their
+  ///         indices to vertex_index_. Must be called after optimizeMesh.
+  ///         Can be called from a worker thread.
+  ///--------------------------------------------------------------------------
+  void generateLods();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void buildMeshlets();
+  ///
+  /// @brief  Splits the full level of detail in meshlets culled one by one
+  ///         when drawn, reordering its triangles. Meshes too small to gain
+  ///         anything get none. Must be called after generateLods. Can be
+  ///         called from a worker thread.
+  ///--------------------------------------------------------------------------
+  void buildMeshlets();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void buildOccluder();
+  ///
+  /// @brief  Builds the mesh drawn by the occlusion culling: the coarsest
+  ///         level of detail close enough to the full mesh, or a grid under
+  ///         the heights for the terrains. Must be called after
+  ///         generateLods. Can be called from a worker thread.
+  ///--------------------------------------------------------------------------
+  void buildOccluder();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 selectLod(const float32 pixels_per_unit,
+  ///                        const uint32 current_lod) const;
+  ///
+  /// @brief  Coarsest level whose error stays under a pixel on screen. The
+  ///         switch to a coarser level needs some margin, so the levels
+  ///         don't flicker around the switch distance.
+  /// @param  pixels_per_unit Screen pixels covered by a model unit at the
+  ///         geometry distance.
+  /// @param  current_lod Level drawn the last frame.
+  /// @return Level to draw, 0 is the full mesh.
+  ///--------------------------------------------------------------------------
+  uint32 selectLod(const float32 pixels_per_unit, const uint32 current_lod) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool createBuffers();
+  ///
+  /// @brief  Uploads the vertices and indices to the GPU. Main thread only.
+  /// @return true if successfully created, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool createBuffers();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool createHeightTexture();
+  ///
+  /// @brief  Uploads the terrain heights. Main thread only.
+  /// @return true if successfully created, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool createHeightTexture();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool heightAt(const float32 x, const float32 z, float32* height);
+  ///
+  /// @brief  Bilinear terrain height. Streamed terrains only answer where
+  ///         the tile is resident.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @param  height Height in terrain space, only written on success.
+  /// @return false if not a terrain or not loaded yet.
+  ///--------------------------------------------------------------------------
+  bool heightAt(const float32 x, const float32 z, float32* height);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool normalAt(const float32 x, const float32 z, DirectX::XMFLOAT3* normal);
+  ///
+  /// @brief  Terrain normal, same as the rendered one.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @param  normal Unit normal in terrain space, only written on success.
+  /// @return false if not a terrain or not loaded yet.
+  ///--------------------------------------------------------------------------
+  bool normalAt(const float32 x, const float32 z, DirectX::XMFLOAT3* normal);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool raycast(const DirectX::XMFLOAT3 origin,
+  ///                    const DirectX::XMFLOAT3 direction,
+  ///                    const float32 max_distance,
+  ///                    float32* distance);
+  ///
+  /// @brief  First hit of a ray with the terrain.
+  /// @param  origin Ray origin in terrain space.
+  /// @param  direction Ray direction, any length.
+  /// @param  max_distance Hits further than this are ignored.
+  /// @param  distance Distance to the hit, only written on hit.
+  /// @return true if the ray hits the terrain, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool raycast(const DirectX::XMFLOAT3 origin,
+               const DirectX::XMFLOAT3 direction,
+               const float32 max_distance,
+               float32* distance);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool initDynamic(const VertexData* vertices,
+  ///                        const uint32 num_vertices,
+  ///                        const uint32* indices,
+  ///                        const uint32 num_indices,
+  ///                        const D3D_PRIMITIVE_TOPOLOGY topology);
+  ///
+  /// @brief  Initializes a geometry whose vertices can be edited later. The
+  ///         vertices keep their order, they are not optimized.
+  /// @param  vertices Initial vertices.
+  /// @param  num_vertices Number of vertices.
+  /// @param  indices Indices, they can't be edited.
+  /// @param  num_indices Number of indices.
+  /// @param  topology Triangle or line lists, for debug lines.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool initDynamic(const VertexData* vertices,
+                   const uint32 num_vertices,
+                   const uint32* indices,
+                   const uint32 num_indices,
+                   const D3D_PRIMITIVE_TOPOLOGY topology);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   VertexData* editVertices(const uint32 first, const uint32 count);
+  ///
+  /// @brief  Marks some vertices dirty and gives them to be written in place.
+  ///         Only the dirty ranges are uploaded, at the start of the next
+  ///         frame. Dynamic geometries only, main thread only.
+  /// @param  first First vertex edited.
+  /// @param  count Vertices edited.
+  /// @return Vertex first, valid until the next call. nullptr if the range
+  ///         is outside or the geometry isn't dynamic.
+  ///--------------------------------------------------------------------------
+  VertexData* editVertices(const uint32 first, const uint32 count);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool updateVertices(const uint32 first,
+  ///                           const uint32 count,
+  ///                           const VertexData* vertices);
+  ///
+  /// @brief  Replaces some vertices, see editVertices.
+  /// @param  first First vertex replaced.
+  /// @param  count Vertices replaced.
+  /// @param  vertices New vertices.
+  /// @return false if the range is outside or the geometry isn't dynamic.
+  ///--------------------------------------------------------------------------
+  bool updateVertices(const uint32 first,
+                      const uint32 count,
+                      const VertexData* vertices);
 
 /*******************************************************************************
 ***                               Attributes                                 ***
@@ -156,19 +510,104 @@ class Geo {
     DirectX::XMFLOAT4 color;
   };
 
-  /// Verices info.
+  /// Mesh optimization results.
+  struct MeshStats {
+    /// Vertices removed by the welding.
+    uint32 num_welded;
+    /// Average cache miss ratio, transformed vertices per triangle.
+    float32 acmr_before;
+    float32 acmr_after;
+  };
+
+  /// Vertices edited but not uploaded yet.
+  struct DirtyRange {
+    uint32 first;
+    uint32 count;
+  };
+
+  /// Range of vertex_index_ drawn by a level of detail.
+  struct LodLevel {
+    uint32 first_index;
+    uint32 num_indices;
+    /// Distance to the full mesh surface, in model units.
+    float32 error;
+  };
+
+  /// Quantized vertex, 20 bytes instead of 48.
+  struct PackedVertexData {
+    /// Position inside the mesh bounds, unorm 16 bits, the last one unused.
+    uint16 position[4];
+    /// Normal * 0.5 + 0.5, unorm 10:10:10:2.
+    uint32 normal;
+    /// Half floats.
+    uint16 uv[2];
+    /// Unorm 8 bits RGBA.
+    uint32 color;
+  };
+
+  /// Verices info. Empty in the procedural geometries, written straight
+  /// into the arena by the MeshBuilder.
   std::vector<VertexData> vertex_data_;
-  /// Vertices buffer.
-  ID3D11Buffer* vertex_buffer_;
+  /// Vertices range in the geometry arena, its offset is the base vertex.
+  GeometryArena::Allocation vertex_allocation_;
+  /// Layout of the arena vertices, vertex_data_ is always full.
+  VertexFormat vertex_format_;
+  /// Position bounds of the packed vertices, slot 2. nullptr if full.
+  ID3D11Buffer* bounds_buffer_;
+  /// Whether the vertices can be edited or not, always full format.
+  bool dynamic_;
+  /// Dirty vertices, sorted and never overlapping nor touching.
+  std::vector<DirtyRange> dirty_vertices_;
 
   /// Vertices indices.
   std::vector<uint32> vertex_index_;
-  /// Indices buffer.
-  ID3D11Buffer* vertex_index_buffer_;
+  /// Indices range in the geometry arena, 16 bits if the vertices fit.
+  GeometryArena::Allocation index_allocation_;
+
+  /// Whether the mesh has been optimized or not, createBuffers does it
+  /// otherwise.
+  bool mesh_optimized_;
+  /// Last optimization results.
+  MeshStats mesh_stats_;
+
+  /// Levels of detail, the full mesh first, all of them share the vertices
+  /// and their indices follow each other in vertex_index_. Empty if the
+  /// geometry has no levels, then the whole vertex_index_ is drawn.
+  std::vector<LodLevel> lods_;
+  /// Distance from the origin to the furthest vertex, in model units.
+  float32 bounding_radius_;
+  /// Bounds of the vertices, in model units. Zero extents if unknown, the
+  /// dynamic geometries, then it's never occluded.
+  DirectX::BoundingBox bounding_box_;
+  /// Occluder mesh, triangle list. Empty if the geometry can't occlude.
+  std::vector<DirectX::XMFLOAT3> occluder_positions_;
+  std::vector<uint32> occluder_indices_;
+  /// Meshlets of the full level of detail, count 0 if it's drawn whole.
+  Meshlets::Set meshlets_;
+  /// Triangles of the meshlets drawn and culled.
+  Meshlets::Stats meshlet_stats_;
 
   /// Topology = the way vertex are rendered (TriangleStrip, TriangleList, Point)
   D3D_PRIMITIVE_TOPOLOGY topology_;
 
+  /// Loading states, geometries not ready are rendered as the error geometry.
+  enum LoadState {
+    kLoadState_Ready = 0,
+    kLoadState_Loading,
+    kLoadState_Failed,
+  };
+
+  /// Loading state, only changed in the main thread.
+  LoadState load_state_;
+
+  /// Level of detail quadtree of the terrains, nullptr for the rest. The
+  /// vertices are the patch grid every node is drawn with.
+  TerrainQuadTree* terrain_tree_;
+  /// Terrain heights read by the terrain vertex shader.
+  ID3D11ShaderResourceView* height_texture_;
+  /// Tiles of the streamed terrains, nullptr for the rest.
+  TerrainStreamer* terrain_streamer_;
+
 
 
 /*******************************************************************************
@@ -186,6 +625,12 @@ class Geo {
     kType_Extruded,
     kType_Pyramid,
     kType_ExternalFile,
+    kType_StreamedTerrain,
+    kType_Dynamic,
+    kType_Sphere,
+    kType_Cylinder,
+    kType_Torus,
+    kType_Grid,
   };
 
   struct Vec3 { float32 x, y, z; };
@@ -199,6 +644,10 @@ class Geo {
   struct TerrainInfo { Vec3 size; };
   struct PyramidInfo { uint32 num_polygon_vertex; float32 base_radius; float32 height; };
   struct ExtrudedInfo { uint32 num_polygon_vertex; float32 base_radius; float32 top_radius; float32 height; };
+  struct SphereInfo { float32 radius; uint32 slices; uint32 stacks; };
+  struct CylinderInfo { float32 radius; float32 height; uint32 slices; };
+  struct TorusInfo { float32 radius; float32 tube_radius; uint32 rings; uint32 sides; };
+  struct GridInfo { Vec2 size; uint32 cells_x; uint32 cells_z; };
   struct File {};
   
   union FactoryInfo {
@@ -209,6 +658,10 @@ class Geo {
     TerrainInfo terrain;
     PyramidInfo pyramid;
     ExtrudedInfo extruded;
+    SphereInfo sphere;
+    CylinderInfo cylinder;
+    TorusInfo torus;
+    GridInfo grid;
     File file;
   };
 
@@ -244,27 +697,37 @@ class Geo {
   ///--------------------------------------------------------------------------
    bool createVertexBuffer();
    ///--------------------------------------------------------------------------
+   /// @fn   bool createPackedVertexBuffer();
+   ///
+   /// @brief  Quantizes the vertices into the mesh bounds and creates the
+   ///         vertex buffer and the bounds buffer.
+   /// @return true if successfully initialized, false otherwise.
+   ///--------------------------------------------------------------------------
+   bool createPackedVertexBuffer();
+   ///--------------------------------------------------------------------------
    /// @fn   bool createIndexBuffer();
    ///
    /// @brief  Creates the index buffer.
    /// @return true if successfully initialized, false otherwise.
    ///--------------------------------------------------------------------------
    bool createIndexBuffer();
-
    ///--------------------------------------------------------------------------
-   /// @fn   bool parseTerrainImage();
+   /// @fn   void markDirty(const uint32 first, const uint32 count);
    ///
-   /// @brief  Parses the terrain image and saves its info into a vector.
-   /// @param  terrain_size Size of the whole geometry. Y will be the max height.
-   /// @param  filename terrain heightmap file.
-   /// @param  vertices_output Vector where we will save the vertices.
-   /// @param  grid_rows_cols_output Info of the num of rows and cols.
-   /// @return true if successfully initialized, false otherwise.
+   /// @brief  Adds a range to the dirty ranges, merging the ones it touches,
+   ///         and queues the geometry in the arena if it wasn't.
+   /// @param  first First vertex dirty.
+   /// @param  count Vertices dirty.
+   ///--------------------------------------------------------------------------
+   void markDirty(const uint32 first, const uint32 count);
+   ///--------------------------------------------------------------------------
+   /// @fn   bool endMesh(MeshBuilder& builder);
+   ///
+   /// @brief  Takes the ranges of the mesh written in the builder.
+   /// @param  builder Builder with the mesh written.
+   /// @return true if successfully uploaded, false otherwise.
    ///--------------------------------------------------------------------------
-   bool parseTerrainImage(const DirectX::XMFLOAT3 terrain_size,
-                          const char* filename,
-                          std::vector<DirectX::XMFLOAT3>& vertices_output,
-                          DirectX::XMINT2& grid_rows_cols_output);
+   bool endMesh(MeshBuilder& builder);
 
 
 }; /* Geo */
@@ -0,0 +1,261 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __GEOMETRY_ARENA_H__
+#define __GEOMETRY_ARENA_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/tlsf_allocator.h"
+#include <D3D11.h>
+#include <vector>
+
+namespace W3D {
+
+class Geo;
+
+/// Big vertex and index buffers shared by every geometry, one per layout.
+/// The geometries only keep their ranges, drawn with a base vertex and a
+/// first index, so consecutive draws of the same layout don't rebind the
+/// buffers. The buffers grow when full, keeping the ranges given.
+/// The vertices edited in the dynamic geometries are copied into a ring of
+/// staging buffers and from there into their ranges, once per frame. The
+/// procedural meshes are written straight into that staging memory.
+class GeometryArena {
+
+ public:
+
+  /// Buffers, one per vertex layout and index format.
+  enum Pool {
+    kPool_FullVertices = 0,
+    kPool_PackedVertices,
+    kPool_Indices16,
+    kPool_Indices32,
+    kPool_Count,
+  };
+
+  /// Range of a pool, in elements.
+  struct Allocation {
+    Pool pool;
+    uint32 handle;
+    uint32 offset;
+    uint32 count;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  GeometryArena();
+
+  /// Default class destructor.
+  ~GeometryArena();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool allocate(const Pool pool,
+  ///                     const uint32 count,
+  ///                     const void* data,
+  ///                     Allocation* allocation);
+  ///
+  /// @brief  Takes a range of a pool and uploads its data. Main thread only.
+  /// @param  pool Pool of the range.
+  /// @param  count Vertices or indices.
+  /// @param  data Initial data, count elements of the pool stride.
+  /// @param  allocation Range taken.
+  /// @return true if successfully allocated, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool allocate(const Pool pool,
+                const uint32 count,
+                const void* data,
+                Allocation* allocation);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void release(Allocation* allocation);
+  ///
+  /// @brief  Gives the range back to its pool, the allocation is cleared.
+  /// @param  allocation Range to release.
+  ///--------------------------------------------------------------------------
+  void release(Allocation* allocation);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void bind(const Pool vertex_pool, const Pool index_pool);
+  ///
+  /// @brief  Binds the buffers of the pools, skipped if they already are.
+  /// @param  vertex_pool Vertices pool.
+  /// @param  index_pool Indices pool.
+  ///--------------------------------------------------------------------------
+  void bind(const Pool vertex_pool, const Pool index_pool);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void beginFrame();
+  ///
+  /// @brief  Starts the upload counters of a new frame and forgets the
+  ///         buffers bound.
+  ///--------------------------------------------------------------------------
+  void beginFrame();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void markDirty(Geo* geometry);
+  ///
+  /// @brief  Queues the dirty vertices of a geometry for the next upload.
+  ///         Called by the geometry on its first dirty range.
+  /// @param  geometry Dynamic geometry, in the arena.
+  ///--------------------------------------------------------------------------
+  void markDirty(Geo* geometry);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void cancelUploads(Geo* geometry);
+  ///
+  /// @brief  Removes a geometry from the upload queue, before deleting it.
+  /// @param  geometry Geometry queued.
+  ///--------------------------------------------------------------------------
+  void cancelUploads(Geo* geometry);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void uploadDirty();
+  ///
+  /// @brief  Copies the dirty vertex ranges queued into the next staging
+  ///         buffer of the ring and from there into the arena. Ranges that
+  ///         don't fit wait for the next call. Does nothing if none is queued.
+  ///         Called once per frame by the window, one staging buffer each.
+  ///--------------------------------------------------------------------------
+  void uploadDirty();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void* beginUpload(const uint32 bytes);
+  ///
+  /// @brief  Maps staging memory to write the data of new ranges in place,
+  ///         the next staging buffer of the ring or a temporary one if it
+  ///         doesn't fit. One upload at a time, main thread only.
+  /// @param  bytes Bytes that will be written.
+  /// @return Memory to write, nullptr if it couldn't be mapped.
+  ///--------------------------------------------------------------------------
+  void* beginUpload(const uint32 bytes);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void copyUpload(const uint32 source, const Allocation& allocation);
+  ///
+  /// @brief  Queues the copy of part of the upload memory into a range.
+  /// @param  source Byte of the upload memory where the range data starts.
+  /// @param  allocation Range written, taken with allocate without data.
+  ///--------------------------------------------------------------------------
+  void copyUpload(const uint32 source, const Allocation& allocation);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void endUpload();
+  ///
+  /// @brief  Unmaps the upload memory and copies it into the ranges queued.
+  ///--------------------------------------------------------------------------
+  void endUpload();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void invalidateBindings();
+  ///
+  /// @brief  Forgets the buffers bound, call it when someone else binds
+  ///         other buffers, every frame because of the interface.
+  ///--------------------------------------------------------------------------
+  void invalidateBindings();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void shutdown();
+  ///
+  /// @brief  Releases the buffers, the allocations become invalid.
+  ///--------------------------------------------------------------------------
+  void shutdown();
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Buffer of a pool, nullptr until the first allocation.
+  ID3D11Buffer* buffer(const Pool pool) const;
+
+  /// Bytes per element of a pool.
+  uint32 stride(const Pool pool) const;
+
+  /// Elements allocated in a pool.
+  uint32 used(const Pool pool) const;
+
+  /// Elements a pool can hold without growing.
+  uint32 capacity(const Pool pool) const;
+
+  /// Buffer bindings done and skipped since the start.
+  uint64 num_binds() const;
+  uint64 num_skipped_binds() const;
+
+  /// Bytes of dirty vertices uploaded in the last whole frame.
+  uint64 uploaded_bytes_last_frame() const;
+
+  /// Bytes of dirty vertices uploaded since the start.
+  uint64 uploaded_bytes_total() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  GeometryArena(const GeometryArena& copy);
+  GeometryArena& operator=(const GeometryArena& copy);
+
+  /// Resizes the buffer of a pool so count more elements fit at its end,
+  /// copying the previous content.
+  bool growPool(const Pool pool, const uint32 count);
+
+  /// Creates the staging buffers.
+  bool createStagingRing();
+
+  /// Staging buffers, one per frame the GPU may be behind.
+  static const uint32 kStagingBuffers = 3;
+
+  /// Copy from a staging buffer to a pool, in bytes.
+  struct StagingCopy {
+    Pool pool;
+    uint32 destination;
+    uint32 source;
+    uint32 size;
+  };
+
+  struct PoolData {
+    ID3D11Buffer* buffer;
+    TlsfAllocator allocator;
+    uint32 stride;
+    uint32 capacity;
+    uint32 initial_capacity;
+    UINT bind_flags;
+  };
+
+  PoolData pools_[kPool_Count];
+  /// Pools bound the last time, kPool_Count if unknown.
+  Pool bound_vertex_pool_;
+  Pool bound_index_pool_;
+  uint64 num_binds_;
+  uint64 num_skipped_binds_;
+
+  /// Dynamic geometries with dirty vertices, in edition order.
+  std::vector<Geo*> dirty_geometries_;
+  ID3D11Buffer* staging_[kStagingBuffers];
+  /// Next staging buffer of the ring.
+  uint32 staging_index_;
+  /// Buffer mapped by beginUpload, released at the end if temporary.
+  ID3D11Buffer* upload_buffer_;
+  bool upload_temporary_;
+  /// Copies of the last upload, kept to reuse the memory.
+  std::vector<StagingCopy> staging_copies_;
+  uint64 uploaded_bytes_frame_;
+  uint64 uploaded_bytes_last_frame_;
+  uint64 uploaded_bytes_total_;
+
+}; /* GeometryArena */
+
+}; /* W3D */
+
+#endif
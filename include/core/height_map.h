@@ -0,0 +1,120 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __HEIGHT_MAP_H__
+#define __HEIGHT_MAP_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/file_system.h"
+#include <DirectXMath.h>
+
+namespace W3D {
+
+/// Reads heightmaps straight from their memory mapped file, row by row,
+/// without decoding the whole image. Supported formats:
+///   - BMP, 8 bits per sample (8, 24 or 32 bits per pixel, gray).
+///   - PGM binary (P5), 8 or 16 bits per sample.
+///   - RAW (.raw / .r16), square and 16 bits little endian per sample.
+class HeightMapSource {
+
+ public:
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  HeightMapSource();
+
+  /// Default class destructor.
+  ~HeightMapSource();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool open(const char* filename, const char** error = nullptr);
+  ///
+  /// @brief  Maps the heightmap and reads its header.
+  /// @param  filename Heightmap file.
+  /// @param  error Where to leave the error message from a worker thread,
+  ///         nullptr shows it.
+  /// @return true if the format is supported, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool open(const char* filename, const char** error = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void readRegion(const int32 first_column,
+  ///                       const int32 first_row,
+  ///                       const int32 num_columns,
+  ///                       const int32 num_rows,
+  ///                       const float32 max_height,
+  ///                       float32* output) const;
+  ///
+  /// @brief  Decodes a rectangle of samples into heights. Thread safe.
+  /// @param  first_column First column to decode.
+  /// @param  first_row First row to decode.
+  /// @param  num_columns Number of columns to decode.
+  /// @param  num_rows Number of rows to decode.
+  /// @param  max_height Height of the maximum sample value.
+  /// @param  output num_rows * num_columns heights.
+  ///--------------------------------------------------------------------------
+  void readRegion(const int32 first_column,
+                  const int32 first_row,
+                  const int32 num_columns,
+                  const int32 num_rows,
+                  const float32 max_height,
+                  float32* output) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Number of samples, width and height.
+  DirectX::XMINT2 size() const;
+
+  /// Maximum value a sample can have, 255 or 65535.
+  uint32 max_value() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  HeightMapSource(const HeightMapSource& copy);
+  HeightMapSource& operator=(const HeightMapSource& copy);
+
+  /// Reads the headers of every format.
+  bool parseBMP(const char** error);
+  bool parsePGM(const char** error);
+  bool parseRAW(const char** error);
+
+  /// Mapped file.
+  FileView file_;
+  /// First sample of the first row.
+  const uchar8* samples_;
+  /// Samples per row and number of rows.
+  int32 width_;
+  int32 height_;
+  /// Bytes between the start of two rows.
+  uint32 row_pitch_;
+  /// Bytes between two samples, only the first byte(s) are read.
+  uint32 sample_stride_;
+  /// Whether the samples are 16 bits or 8 bits.
+  bool is_16_bits_;
+  /// 16 bit samples byte order.
+  bool is_big_endian_;
+  /// Maximum sample value.
+  uint32 max_value_;
+
+}; /* HeightMapSource */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,127 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __JOB_SYSTEM_H__
+#define __JOB_SYSTEM_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace W3D {
+
+class JobSystem {
+
+ public:
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  JobSystem();
+
+  /// Default class destructor.
+  ~JobSystem();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const uint32 num_workers = 0);
+  ///
+  /// @brief  Spawns the worker threads.
+  /// @param  num_workers Number of worker threads, 0 will use one per core
+  ///         minus the main thread.
+  ///--------------------------------------------------------------------------
+  void init(const uint32 num_workers = 0);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void shutdown();
+  ///
+  /// @brief  Finishes the pending jobs and joins all the worker threads.
+  ///--------------------------------------------------------------------------
+  void shutdown();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void submit(const std::function<void()>& job);
+  ///
+  /// @brief  Queues a job to be executed by any worker thread. If there are
+  ///         no workers the job will be executed immediately.
+  /// @param  job Function to execute.
+  ///--------------------------------------------------------------------------
+  void submit(const std::function<void()>& job);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void parallelFor(const uint32 count,
+  ///                        const uint32 batch_size,
+  ///                        const std::function<void(uint32, uint32)>& job);
+  ///
+  /// @brief  Splits the range [0, count) in batches and executes them in
+  ///         parallel. The calling thread also works on the batches, so it is
+  ///         safe to call it from inside another job. Blocks until finished.
+  /// @param  count Number of elements to process.
+  /// @param  batch_size Elements per batch.
+  /// @param  job Function receiving the range [begin, end) to process.
+  ///--------------------------------------------------------------------------
+  void parallelFor(const uint32 count,
+                   const uint32 batch_size,
+                   const std::function<void(uint32, uint32)>& job);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 num_workers() const;
+  ///
+  /// @brief  Number of worker threads getter.
+  /// @return Number of worker threads running.
+  ///--------------------------------------------------------------------------
+  uint32 num_workers() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  JobSystem(const JobSystem& copy);
+  JobSystem& operator=(const JobSystem& copy);
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+  /// Worker thread main loop, pops and executes jobs until shutdown.
+  void workerLoop();
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Worker threads.
+  std::vector<std::thread> workers_;
+  /// Pending jobs.
+  std::deque<std::function<void()>> queue_;
+  /// Protects the queue.
+  std::mutex mutex_;
+  /// Wakes up the workers when there are new jobs.
+  std::condition_variable condition_;
+  /// Whether the workers have to keep running or not.
+  bool running_;
+
+}; /* JobSystem */
+
+}; /* W3D */
+
+#endif
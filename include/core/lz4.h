@@ -0,0 +1,56 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __LZ4_H__
+#define __LZ4_H__ 1
+
+#include "Wolfy3D/globals.h"
+
+namespace W3D {
+namespace LZ4 {
+
+///--------------------------------------------------------------------------
+/// @fn   uint32 CompressBound(const uint32 size);
+///
+/// @brief Worst case size of a compressed block.
+/// @param size Uncompressed size in bytes.
+/// @return Maximum number of bytes the compressed block can take.
+///--------------------------------------------------------------------------
+uint32 CompressBound(const uint32 size);
+
+///--------------------------------------------------------------------------
+/// @fn   uint32 Compress(const uchar8* src, const uint32 src_size,
+///                       uchar8* dst, const uint32 dst_capacity);
+///
+/// @brief Compresses a buffer into a LZ4 block (raw block format, no frame).
+/// @param src Data to compress.
+/// @param src_size Bytes to compress.
+/// @param dst Output buffer.
+/// @param dst_capacity Size of the output buffer.
+/// @return Compressed size, 0 if it doesn't fit into dst.
+///--------------------------------------------------------------------------
+uint32 Compress(const uchar8* src, const uint32 src_size,
+                uchar8* dst, const uint32 dst_capacity);
+
+///--------------------------------------------------------------------------
+/// @fn   bool Decompress(const uchar8* src, const uint32 src_size,
+///                       uchar8* dst, const uint32 dst_size);
+///
+/// @brief Decompresses a LZ4 block checking all the bounds.
+/// @param src Compressed block.
+/// @param src_size Size of the compressed block.
+/// @param dst Output buffer.
+/// @param dst_size Exact uncompressed size.
+/// @return true if the block was valid and filled exactly dst_size bytes.
+///--------------------------------------------------------------------------
+bool Decompress(const uchar8* src, const uint32 src_size,
+                uchar8* dst, const uint32 dst_size);
+
+}; /* LZ4 */
+}; /* W3D */
+
+#endif
@@ -0,0 +1,224 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __MESH_BUILDER_H__
+#define __MESH_BUILDER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/geo.h"
+#include <DirectXMath.h>
+#include <unordered_map>
+#include <vector>
+
+namespace W3D {
+
+/// Writes procedural meshes straight into the upload memory of the geometry
+/// arena, no intermediate vectors. The exact number of vertices and indices
+/// is known before writing, every shape has a function giving it, so the
+/// arena ranges are taken once. The sines and cosines of the circles are
+/// kept in tables, computed the first time a number of segments is used.
+/// Main thread only, one mesh at a time.
+class MeshBuilder {
+
+ public:
+
+  /// Vertices and indices of a mesh, sum them for several shapes.
+  struct Size {
+    uint32 num_vertices;
+    uint32 num_indices;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  MeshBuilder();
+
+  /// Default class destructor.
+  ~MeshBuilder();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool begin(const Size size, const DirectX::XMFLOAT4 color);
+  ///
+  /// @brief  Takes the arena ranges of a mesh and maps its upload memory.
+  /// @param  size Exact vertices and indices that will be written.
+  /// @param  color Color of every vertex.
+  /// @return true if the memory is ready, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool begin(const Size size, const DirectX::XMFLOAT4 color);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool end(Geo* geometry);
+  ///
+  /// @brief  Uploads the mesh and gives its ranges to the geometry, which
+  ///         keeps no copy of the vertices.
+  /// @param  geometry Geometry built, its previous ranges are released.
+  /// @return false if the counts written don't match the ones of begin.
+  ///--------------------------------------------------------------------------
+  bool end(Geo* geometry);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 vertex(const DirectX::XMFLOAT3 position,
+  ///                     const DirectX::XMFLOAT3 normal,
+  ///                     const DirectX::XMFLOAT2 uv);
+  ///
+  /// @brief  Writes a vertex.
+  /// @param  position Position.
+  /// @param  normal Unit normal.
+  /// @param  uv Texture coordinates.
+  /// @return Index of the vertex in the mesh.
+  ///--------------------------------------------------------------------------
+  uint32 vertex(const DirectX::XMFLOAT3 position,
+                const DirectX::XMFLOAT3 normal,
+                const DirectX::XMFLOAT2 uv);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void triangle(const uint32 a, const uint32 b, const uint32 c);
+  ///
+  /// @brief  Writes a triangle, (b - a) x (c - a) points out of the mesh.
+  /// @param  a First vertex index.
+  /// @param  b Second vertex index.
+  /// @param  c Third vertex index.
+  ///--------------------------------------------------------------------------
+  void triangle(const uint32 a, const uint32 b, const uint32 c);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void quad(const uint32 a, const uint32 b, const uint32 c, const uint32 d);
+  ///
+  /// @brief  Writes the triangles a b d and d b c, a and c are opposite.
+  /// @param  a First vertex index.
+  /// @param  b Second vertex index.
+  /// @param  c Third vertex index.
+  /// @param  d Fourth vertex index.
+  ///--------------------------------------------------------------------------
+  void quad(const uint32 a, const uint32 b, const uint32 c, const uint32 d);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void box(const DirectX::XMFLOAT3 size);
+  ///
+  /// @brief  Box centered at the origin, 4 vertices per face.
+  /// @param  size Size of the box.
+  ///--------------------------------------------------------------------------
+  void box(const DirectX::XMFLOAT3 size);
+  static Size BoxSize();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void frustum(const uint32 segments,
+  ///                    const float32 base_radius,
+  ///                    const float32 top_radius,
+  ///                    const float32 height);
+  ///
+  /// @brief  Extruded regular polygon around the Y axis, centered at the
+  ///         origin, with smooth sides. Cylinders, cones and prisms. A radius
+  ///         of 0 ends the sides in a point, without its cap.
+  /// @param  segments Vertices of the polygon.
+  /// @param  base_radius Radius of the bottom polygon.
+  /// @param  top_radius Radius of the top polygon.
+  /// @param  height Height of the extrusion.
+  ///--------------------------------------------------------------------------
+  void frustum(const uint32 segments,
+               const float32 base_radius,
+               const float32 top_radius,
+               const float32 height);
+  static Size FrustumSize(const uint32 segments,
+                          const float32 base_radius,
+                          const float32 top_radius);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void sphere(const float32 radius, const uint32 slices, const uint32 stacks);
+  ///
+  /// @brief  UV sphere centered at the origin, the poles on the Y axis.
+  /// @param  radius Radius.
+  /// @param  slices Divisions around the Y axis, at least 3.
+  /// @param  stacks Divisions from pole to pole, at least 2.
+  ///--------------------------------------------------------------------------
+  void sphere(const float32 radius, const uint32 slices, const uint32 stacks);
+  static Size SphereSize(const uint32 slices, const uint32 stacks);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void torus(const float32 radius,
+  ///                  const float32 tube_radius,
+  ///                  const uint32 rings,
+  ///                  const uint32 sides);
+  ///
+  /// @brief  Torus around the Y axis, centered at the origin.
+  /// @param  radius Distance from the center to the center of the tube.
+  /// @param  tube_radius Radius of the tube.
+  /// @param  rings Divisions around the Y axis, at least 3.
+  /// @param  sides Divisions around the tube, at least 3.
+  ///--------------------------------------------------------------------------
+  void torus(const float32 radius,
+             const float32 tube_radius,
+             const uint32 rings,
+             const uint32 sides);
+  static Size TorusSize(const uint32 rings, const uint32 sides);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void grid(const DirectX::XMFLOAT2 size,
+  ///                 const uint32 cells_x,
+  ///                 const uint32 cells_z);
+  ///
+  /// @brief  Flat grid in the XZ plane facing up, centered at the origin.
+  /// @param  size Size in X and Z.
+  /// @param  cells_x Cells along X, at least 1.
+  /// @param  cells_z Cells along Z, at least 1.
+  ///--------------------------------------------------------------------------
+  void grid(const DirectX::XMFLOAT2 size,
+            const uint32 cells_x,
+            const uint32 cells_z);
+  static Size GridSize(const uint32 cells_x, const uint32 cells_z);
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  MeshBuilder(const MeshBuilder& copy);
+  MeshBuilder& operator=(const MeshBuilder& copy);
+
+  /// Cosine and sine of segments + 1 angles around the circle, the last
+  /// one repeats the first for the texture seam.
+  const DirectX::XMFLOAT2* circle(const uint32 segments);
+
+  /// Writes a polygon cap, center first.
+  void cap(const DirectX::XMFLOAT2* angles,
+           const uint32 segments,
+           const float32 radius,
+           const float32 y,
+           const bool up);
+
+  /// Tables of circle, by number of segments.
+  std::unordered_map<uint32, std::vector<DirectX::XMFLOAT2>> circles_;
+
+  /// Mesh being written.
+  Size size_;
+  DirectX::XMFLOAT4 color_;
+  GeometryArena::Allocation vertex_allocation_;
+  GeometryArena::Allocation index_allocation_;
+  Geo::VertexData* vertices_;
+  uint16* indices16_;
+  uint32* indices32_;
+  uint32 num_vertices_;
+  uint32 num_indices_;
+  /// Squared distance to the origin of the furthest vertex.
+  float32 max_radius_sq_;
+  /// Bounds of the vertices written.
+  DirectX::XMFLOAT3 min_position_;
+  DirectX::XMFLOAT3 max_position_;
+  bool building_;
+
+}; /* MeshBuilder */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,122 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __MESH_OPTIMIZER_H__
+#define __MESH_OPTIMIZER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/geo.h"
+#include <vector>
+
+namespace W3D {
+namespace MeshOptimizer {
+
+/// Post-transform cache simulated, FIFO like most of the GPUs.
+const uint32 kCacheSize = 16;
+
+///--------------------------------------------------------------------------
+/// @fn   uint32 WeldVertices(std::vector<Geo::VertexData>& vertices,
+///                           std::vector<uint32>& indices);
+///
+/// @brief  Merges the vertices with exactly the same data.
+/// @param  vertices Vertices, the duplicates are removed.
+/// @param  indices Triangle list indices, remapped.
+/// @return Number of vertices removed.
+///--------------------------------------------------------------------------
+uint32 WeldVertices(std::vector<Geo::VertexData>& vertices,
+                    std::vector<uint32>& indices);
+
+///--------------------------------------------------------------------------
+/// @fn   void OptimizeVertexCache(uint32* indices,
+///                                const uint32 num_indices,
+///                                const uint32 num_vertices,
+///                                std::vector<uint32>* clusters);
+///
+/// @brief  Reorders the triangles for the post-transform cache (Tipsify,
+///         Sander et al. 2007). Linear time, fans around the vertices still
+///         in the cache.
+/// @param  indices Triangle list indices, reordered in place.
+/// @param  num_indices Number of indices.
+/// @param  num_vertices Number of vertices referenced.
+/// @param  clusters First triangle of every cluster, where the fanning had
+///         to jump, optional.
+///--------------------------------------------------------------------------
+void OptimizeVertexCache(uint32* indices,
+                         const uint32 num_indices,
+                         const uint32 num_vertices,
+                         std::vector<uint32>* clusters);
+
+///--------------------------------------------------------------------------
+/// @fn   void OptimizeOverdraw(const Geo::VertexData* vertices,
+///                             uint32* indices,
+///                             const uint32 num_indices,
+///                             const std::vector<uint32>& clusters);
+///
+/// @brief  Sorts the clusters so the ones facing out of the mesh are drawn
+///         first, they usually occlude the rest. Triangles keep their order
+///         inside the clusters, so the cache efficiency is kept.
+/// @param  vertices Vertices.
+/// @param  indices Triangle list indices, reordered in place.
+/// @param  num_indices Number of indices.
+/// @param  clusters Clusters given by OptimizeVertexCache.
+///--------------------------------------------------------------------------
+void OptimizeOverdraw(const Geo::VertexData* vertices,
+                      uint32* indices,
+                      const uint32 num_indices,
+                      const std::vector<uint32>& clusters);
+
+///--------------------------------------------------------------------------
+/// @fn   void OptimizeVertexFetch(std::vector<Geo::VertexData>& vertices,
+///                                std::vector<uint32>& indices);
+///
+/// @brief  Sorts the vertices by first use, so the vertex fetch reads the
+///         memory in order. Unused vertices are removed.
+/// @param  vertices Vertices, reordered.
+/// @param  indices Triangle list indices, remapped.
+///--------------------------------------------------------------------------
+void OptimizeVertexFetch(std::vector<Geo::VertexData>& vertices,
+                         std::vector<uint32>& indices);
+
+///--------------------------------------------------------------------------
+/// @fn   float32 ACMR(const uint32* indices,
+///                    const uint32 num_indices,
+///                    const uint32 num_vertices,
+///                    const uint32 cache_size = kCacheSize);
+///
+/// @brief  Average cache miss ratio of a FIFO cache, from 0.5 in the best
+///         case to 3, every vertex transformed.
+/// @param  indices Triangle list indices.
+/// @param  num_indices Number of indices.
+/// @param  num_vertices Number of vertices referenced.
+/// @param  cache_size Entries of the simulated cache.
+/// @return Transformed vertices per triangle.
+///--------------------------------------------------------------------------
+float32 ACMR(const uint32* indices,
+             const uint32 num_indices,
+             const uint32 num_vertices,
+             const uint32 cache_size = kCacheSize);
+
+///--------------------------------------------------------------------------
+/// @fn   Geo::MeshStats Optimize(std::vector<Geo::VertexData>& vertices,
+///                               std::vector<uint32>& indices,
+///                               const uint32 num_ranges = 1);
+///
+/// @brief  Welding, triangle reordering for the cache and the overdraw and
+///         vertex fetch reordering. Triangles never leave their range.
+/// @param  vertices Vertices.
+/// @param  indices Triangle list indices.
+/// @param  num_ranges Equal ranges of indices drawn by separate calls.
+/// @return ACMR before and after and the vertices welded.
+///--------------------------------------------------------------------------
+Geo::MeshStats Optimize(std::vector<Geo::VertexData>& vertices,
+                        std::vector<uint32>& indices,
+                        const uint32 num_ranges = 1);
+
+}; /* MeshOptimizer */
+}; /* W3D */
+
+#endif
@@ -0,0 +1,51 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __MESH_SIMPLIFIER_H__
+#define __MESH_SIMPLIFIER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/geo.h"
+#include <vector>
+
+namespace W3D {
+namespace MeshSimplifier {
+
+///--------------------------------------------------------------------------
+/// @fn   float32 Simplify(const std::vector<Geo::VertexData>& vertices,
+///                        const uint32* indices,
+///                        const uint32 num_indices,
+///                        const uint32 target_indices,
+///                        const float32 max_error,
+///                        std::vector<uint32>& output);
+///
+/// @brief  Edge collapse simplification driven by quadric error metrics
+///         (Garland and Heckbert 1997). Vertices collapse into one of their
+///         neighbours, so the output indexes the same vertices and the
+///         levels can share the vertex buffer. Borders only slide along
+///         themselves and attribute seams along the seams, and collapses
+///         that flip triangles are skipped.
+/// @param  vertices Vertices.
+/// @param  indices Triangle list indices.
+/// @param  num_indices Number of indices.
+/// @param  target_indices Stops once the output has this many indices.
+/// @param  max_error Stops before moving the surface further than this,
+///         in model units.
+/// @param  output Simplified triangle list indices.
+/// @return Error reached, in model units.
+///--------------------------------------------------------------------------
+float32 Simplify(const std::vector<Geo::VertexData>& vertices,
+                 const uint32* indices,
+                 const uint32 num_indices,
+                 const uint32 target_indices,
+                 const float32 max_error,
+                 std::vector<uint32>& output);
+
+}; /* MeshSimplifier */
+}; /* W3D */
+
+#endif
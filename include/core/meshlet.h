@@ -0,0 +1,114 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __MESHLET_H__
+#define __MESHLET_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <DirectXMath.h>
+#include <vector>
+
+namespace W3D {
+namespace Meshlets {
+
+/// Triangles per meshlet. Below the minimum the meshlets keep growing even
+/// if their normal cone gets too wide.
+const uint32 kMaxTriangles = 128;
+const uint32 kMinTriangles = 64;
+
+/// Meshlets of a mesh, structure of arrays padded to groups of 4 so the
+/// culling tests 4 of them at once. Padding meshlets have no indices.
+struct Set {
+  uint32 count;
+  /// Range of every meshlet in the index buffer, they follow each other.
+  std::vector<uint32> first_index;
+  std::vector<uint32> num_indices;
+  /// Bounding sphere.
+  std::vector<float32> center_x;
+  std::vector<float32> center_y;
+  std::vector<float32> center_z;
+  std::vector<float32> radius;
+  /// Normal cone, average front normal and sine of its spread. A cutoff of
+  /// 1 never culls, the triangles face too many directions.
+  std::vector<float32> axis_x;
+  std::vector<float32> axis_y;
+  std::vector<float32> axis_z;
+  std::vector<float32> cutoff;
+};
+
+/// Contiguous indices to draw.
+struct Range {
+  uint32 first_index;
+  uint32 num_indices;
+};
+
+/// Triangles tested and culled since the start.
+struct Stats {
+  uint64 num_triangles;
+  uint64 num_frustum_culled;
+  uint64 num_backface_culled;
+};
+
+///--------------------------------------------------------------------------
+/// @fn   void Build(const DirectX::XMFLOAT3* positions,
+///                  const uint32 position_stride,
+///                  uint32* indices,
+///                  const uint32 first_index,
+///                  const uint32 num_indices,
+///                  Set* meshlets);
+///
+/// @brief  Splits a triangle list in meshlets. Every meshlet grows from its
+///         first triangle through the neighbour closest to its center, and
+///         stops taking the ones facing away from the rest once it has
+///         kMinTriangles.
+///         The triangles are reordered so every meshlet is contiguous,
+///         keeping their previous order inside it for the vertex cache.
+/// @param  positions First vertex position.
+/// @param  position_stride Bytes from a position to the next.
+/// @param  indices Index buffer, the range is reordered in place.
+/// @param  first_index First index of the triangle list.
+/// @param  num_indices Number of indices.
+/// @param  meshlets Meshlets built, ranges relative to indices.
+///--------------------------------------------------------------------------
+void Build(const DirectX::XMFLOAT3* positions,
+           const uint32 position_stride,
+           uint32* indices,
+           const uint32 first_index,
+           const uint32 num_indices,
+           Set* meshlets);
+
+///--------------------------------------------------------------------------
+/// @fn   uint32 Cull(const Set& meshlets,
+///                   const DirectX::XMMATRIX& model_view_projection,
+///                   const DirectX::XMFLOAT3 camera,
+///                   const bool backface,
+///                   std::vector<Range>& ranges,
+///                   Stats* stats);
+///
+/// @brief  Rejects the meshlets outside the frustum and, if asked, the ones
+///         whose triangles all face away from the camera. 4 meshlets per
+///         test. The visible meshlets next to each other are merged.
+/// @param  meshlets Meshlets of the mesh.
+/// @param  model_view_projection Model to clip space, row vectors.
+/// @param  camera Camera position in model space.
+/// @param  backface Whether the back facing meshlets are culled, not with
+///         mirroring transforms.
+/// @param  ranges Ranges to draw, cleared first.
+/// @param  stats Counters incremented, optional.
+/// @return Number of indices in the ranges.
+///--------------------------------------------------------------------------
+uint32 Cull(const Set& meshlets,
+            const DirectX::XMMATRIX& model_view_projection,
+            const DirectX::XMFLOAT3 camera,
+            const bool backface,
+            std::vector<Range>& ranges,
+            Stats* stats);
+
+}; /* Meshlets */
+}; /* W3D */
+
+#endif
@@ -0,0 +1,229 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __OCCLUSION_CULLER_H__
+#define __OCCLUSION_CULLER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/job_system.h"
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+
+namespace W3D {
+
+/// Software occlusion culling. Simplified meshes of the big objects are
+/// rasterized on the CPU into a small depth-only buffer, one job per screen
+/// tile and 4 pixels at a time. The farthest depth of every block of pixels
+/// is kept, and the bounding boxes of the other objects are tested against
+/// those blocks before they are drawn. Depth is the D3D one, 0 near 1 far.
+/// Occluders are added and tested from the main thread, the rasterization
+/// spreads over the worker threads.
+class OcclusionCuller {
+
+ public:
+
+  /// Depth buffer size, whatever the window size is.
+  static const int32 kWidth = 320;
+  static const int32 kHeight = 192;
+  /// Screen tiles, rasterized in parallel.
+  static const int32 kTileWidth = 64;
+  static const int32 kTileHeight = 32;
+  static const int32 kTilesX = kWidth / kTileWidth;
+  static const int32 kTilesY = kHeight / kTileHeight;
+  static const int32 kNumTiles = kTilesX * kTilesY;
+  /// Pixels per side of the hierarchical depth blocks.
+  static const int32 kBlockSize = 8;
+  static const int32 kBlocksX = kWidth / kBlockSize;
+  static const int32 kBlocksY = kHeight / kBlockSize;
+
+  /// Counters of the last frame.
+  struct Stats {
+    uint32 num_occluders;
+    /// Occluder triangles submitted, and the ones left after the culling
+    /// and the near plane clipping.
+    uint32 num_triangles;
+    uint32 num_rasterized;
+    /// Boxes tested, and the ones hidden.
+    uint32 num_tested;
+    uint32 num_culled;
+    float64 rasterize_ms;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  OcclusionCuller();
+
+  /// Default class destructor.
+  ~OcclusionCuller();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void beginFrame(const DirectX::XMMATRIX& view_projection,
+  ///                       JobSystem& jobs);
+  ///
+  /// @brief  Forgets the occluders of the previous frame. Every box passes
+  ///         the test until rasterize is called.
+  /// @param  view_projection Camera view * projection, row vectors.
+  /// @param  jobs Worker threads rasterizing this frame.
+  ///--------------------------------------------------------------------------
+  void beginFrame(const DirectX::XMMATRIX& view_projection, JobSystem& jobs);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void addOccluder(const DirectX::XMFLOAT3* positions,
+  ///                        const uint32 num_positions,
+  ///                        const uint32* indices,
+  ///                        const uint32 num_indices,
+  ///                        const DirectX::XMMATRIX& model);
+  ///
+  /// @brief  Adds a triangle list to rasterize. Its memory is read by
+  ///         rasterize, it must live until then. Only the front faces are
+  ///         drawn, the mesh must be closed or seen from its front side.
+  /// @param  positions Vertex positions.
+  /// @param  num_positions Number of positions.
+  /// @param  indices Triangle list indices.
+  /// @param  num_indices Number of indices.
+  /// @param  model Model matrix, row vectors.
+  ///--------------------------------------------------------------------------
+  void addOccluder(const DirectX::XMFLOAT3* positions,
+                   const uint32 num_positions,
+                   const uint32* indices,
+                   const uint32 num_indices,
+                   const DirectX::XMMATRIX& model);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void rasterize();
+  ///
+  /// @brief  Transforms the occluders, bins their triangles in the screen
+  ///         tiles and rasterizes every tile in a job, building its blocks
+  ///         farthest depth. Blocks until finished.
+  ///--------------------------------------------------------------------------
+  void rasterize();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool testBox(const DirectX::BoundingBox& box,
+  ///                    const DirectX::XMMATRIX& model);
+  ///
+  /// @brief  Whether any part of a box could be seen in front of the
+  ///         occluders. Boxes crossing the near plane always can. The
+  ///         frustum isn't tested, boxes out of the screen pass.
+  /// @param  box Bounding box in model space.
+  /// @param  model Model matrix, row vectors.
+  /// @return false if the box is hidden for sure, true otherwise.
+  ///--------------------------------------------------------------------------
+  bool testBox(const DirectX::BoundingBox& box, const DirectX::XMMATRIX& model);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Whether the occluders of this frame have been rasterized.
+  bool ready() const;
+
+  /// Counters of the last frame.
+  const Stats& stats() const;
+
+  /// Depth buffer, row by row, 1 where there are no occluders.
+  const float32* depth() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  OcclusionCuller(const OcclusionCuller& copy);
+  OcclusionCuller& operator=(const OcclusionCuller& copy);
+
+  struct Occluder {
+    const DirectX::XMFLOAT3* positions;
+    uint32 num_positions;
+    const uint32* indices;
+    uint32 num_indices;
+    DirectX::XMFLOAT4X4 model_view_projection;
+    /// First of its vertices in clip_positions_.
+    uint32 first_vertex;
+  };
+
+  /// Vertices or triangles of an occluder processed by a job.
+  struct Job {
+    uint32 occluder;
+    uint32 first;
+    uint32 count;
+  };
+
+  /// Triangle ready to rasterize, in pixels. The functions are evaluated at
+  /// the pixel centers.
+  struct Triangle {
+    /// Edge functions a * x + b * y + c, positive inside.
+    DirectX::XMFLOAT3 edge_a;
+    DirectX::XMFLOAT3 edge_b;
+    DirectX::XMFLOAT3 edge_c;
+    /// Depth plane, a * x + b * y + c.
+    DirectX::XMFLOAT3 depth;
+    /// Pixels covered, max excluded.
+    int32 min_x;
+    int32 min_y;
+    int32 max_x;
+    int32 max_y;
+  };
+
+  /// Triangles set up by a job, and the ones touching every tile. Jobs own
+  /// their bins, so there are no locks.
+  struct Bin {
+    std::vector<Triangle> triangles;
+    std::vector<uint32> tiles[kNumTiles];
+  };
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+  /// Clips, projects and bins the triangles of a job.
+  void setupTriangles(const Job& job, Bin& bin);
+
+  /// Projects a triangle in front of the near plane and bins it.
+  void binTriangle(const DirectX::XMFLOAT4& a,
+                   const DirectX::XMFLOAT4& b,
+                   const DirectX::XMFLOAT4& c,
+                   Bin& bin);
+
+  /// Clears, rasterizes and builds the blocks of a tile.
+  void rasterizeTile(const int32 tile);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  DirectX::XMFLOAT4X4 view_projection_;
+  /// Given by beginFrame, nullptr before.
+  JobSystem* jobs_;
+  std::vector<Occluder> occluders_;
+  std::vector<Job> vertex_jobs_;
+  std::vector<Job> triangle_jobs_;
+  /// Clip space vertices of every occluder, one after the other.
+  std::vector<DirectX::XMFLOAT4> clip_positions_;
+  /// One per triangle job, kept to reuse the memory.
+  std::vector<Bin> bins_;
+  /// kWidth * kHeight depths.
+  std::vector<float32> depth_;
+  /// Farthest depth of every block, kBlocksX * kBlocksY.
+  std::vector<float32> blocks_;
+  bool ready_;
+  Stats stats_;
+
+}; /* OcclusionCuller */
+
+}; /* W3D */
+
+#endif
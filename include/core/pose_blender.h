@@ -0,0 +1,159 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __POSE_BLENDER_H__
+#define __POSE_BLENDER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/skeleton.h"
+#include <vector>
+
+namespace W3D {
+
+/// Weight of every bone of a skeleton in a blend layer, padded like the
+/// poses.
+struct BoneMask {
+  uint32 num_bones;
+  std::vector<float32> weights;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const Skeleton& skeleton, const float32 weight);
+  ///
+  /// @brief  Gives every bone of a skeleton the same weight.
+  /// @param  skeleton Bones masked.
+  /// @param  weight Weight of every bone, 0 to 1.
+  ///--------------------------------------------------------------------------
+  void init(const Skeleton& skeleton, const float32 weight);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void setBranch(const Skeleton& skeleton,
+  ///                      const uint32 bone,
+  ///                      const float32 weight);
+  ///
+  /// @brief  Sets the weight of a bone and every bone below it.
+  /// @param  skeleton Bones masked, the ones of init.
+  /// @param  bone First bone of the branch.
+  /// @param  weight Weight of the branch, 0 to 1.
+  ///--------------------------------------------------------------------------
+  void setBranch(const Skeleton& skeleton, const uint32 bone, const float32 weight);
+};
+
+/// Mixes any number of poses into one. Blend layers are averaged by their
+/// weights, translations linearly and rotations by normalized lerp, and then
+/// additive layers add their difference to a reference pose on top, one
+/// after the other. Layers may weight every bone apart through a mask.
+/// Four bones are evaluated at a time in vector registers, going through
+/// every layer before storing them, so the cost grows with the layers by a
+/// few instructions per bone only. Poses are not copied, they must live
+/// until blend is called.
+class PoseBlender {
+
+ public:
+
+  /// Pose added, and how much.
+  struct Layer {
+    const Pose* pose;
+    /// Pose the additive layers are the difference to, nullptr otherwise.
+    const Pose* reference;
+    float32 weight;
+    /// Weight of every bone, nullptr for all of them.
+    const BoneMask* mask;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  PoseBlender();
+
+  /// Default class destructor.
+  ~PoseBlender();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void clear();
+  ///
+  /// @brief  Removes every layer.
+  ///--------------------------------------------------------------------------
+  void clear();
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void addBlend(const Pose& pose,
+  ///                     const float32 weight,
+  ///                     const BoneMask* mask = nullptr);
+  ///
+  /// @brief  Adds a pose averaged with the other blend layers. The weights
+  ///         of every bone are normalized, they don't need to add up to 1.
+  /// @param  pose Pose of at least the bones blended.
+  /// @param  weight Weight of the pose.
+  /// @param  mask Weight of every bone, multiplied by the pose one.
+  ///--------------------------------------------------------------------------
+  void addBlend(const Pose& pose, const float32 weight, const BoneMask* mask = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void addAdditive(const Pose& pose,
+  ///                        const Pose& reference,
+  ///                        const float32 weight,
+  ///                        const BoneMask* mask = nullptr);
+  ///
+  /// @brief  Adds the difference between two poses on top of the blended
+  ///         one, after the additive layers added before.
+  /// @param  pose Pose of at least the bones blended.
+  /// @param  reference Pose the difference is taken from, usually the
+  ///         first keys of the clip the pose is sampled from.
+  /// @param  weight Part of the difference added, 0 to 1.
+  /// @param  mask Weight of every bone, multiplied by the pose one.
+  ///--------------------------------------------------------------------------
+  void addAdditive(const Pose& pose,
+                   const Pose& reference,
+                   const float32 weight,
+                   const BoneMask* mask = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void blend(Pose* result) const;
+  ///
+  /// @brief  Evaluates every layer into a pose. Bones no blend layer weights
+  ///         keep the pose given, and so do all of them without blend layers;
+  ///         the additive layers apply on top anyway. The result may be one
+  ///         of the layer poses.
+  /// @param  result Pose blended, its number of bones the ones evaluated.
+  ///--------------------------------------------------------------------------
+  void blend(Pose* result) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Number of layers.
+  uint32 num_layers() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  PoseBlender(const PoseBlender& copy);
+  PoseBlender& operator=(const PoseBlender& copy);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Blend layers first, then the additive ones in the order added.
+  std::vector<Layer> blend_layers_;
+  std::vector<Layer> additive_layers_;
+
+}; /* PoseBlender */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,190 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __SIGNIFICANCE_MANAGER_H__
+#define __SIGNIFICANCE_MANAGER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <DirectXMath.h>
+#include <vector>
+
+namespace W3D {
+
+/// Decides which objects update every frame. Each object is a bounding
+/// sphere scored by the part of the screen height it covers from the camera,
+/// which drops with the distance. Off screen or occluded objects fall to the
+/// last tier. Every tier updates its objects every few frames, and the due
+/// objects run from the most significant one until the frame budget is
+/// spent; the rest wait for the next frame. Skipped time is accumulated, so
+/// an object catches up on its next update. Used from the main thread.
+class SignificanceManager {
+
+ public:
+
+  /// Tiers, from the most significant one.
+  static const uint32 kNumTiers = 4;
+
+  /// Objects above a screen size update every few frames.
+  struct Tier {
+    /// Smallest part of the screen height covered.
+    float32 min_screen_size;
+    /// Frames between updates, 1 for every frame.
+    uint32 interval;
+  };
+
+  /// Counters of the last frame.
+  struct Stats {
+    uint32 num_objects;
+    uint32 num_visible;
+    uint32 num_per_tier[kNumTiers];
+    /// Objects due this frame, the ones updated and the ones left for the
+    /// next frame because of the budget.
+    uint32 num_due;
+    uint32 num_updated;
+    uint32 num_deferred;
+    /// Cost expected of the objects updated this frame, and the one
+    /// measured in the previous frame.
+    float64 expected_ms;
+    float64 spent_ms;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  SignificanceManager();
+
+  /// Default class destructor.
+  ~SignificanceManager();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 add(const DirectX::XMFLOAT3& center, const float32 radius);
+  ///
+  /// @brief  Adds an object. Objects added together are spread over the
+  ///         frames of their tier.
+  /// @param  center World position of the bounding sphere.
+  /// @param  radius Radius of the bounding sphere.
+  /// @return Handle of the object.
+  ///--------------------------------------------------------------------------
+  uint32 add(const DirectX::XMFLOAT3& center, const float32 radius);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void update(const float32 delta_time,
+  ///                   const DirectX::XMMATRIX& view,
+  ///                   const DirectX::XMMATRIX& projection);
+  ///
+  /// @brief  Scores every object, places it in its tier and chooses the ones
+  ///         updated this frame. Called once per frame before the objects
+  ///         update. The occlusion test uses the depth of the last frame.
+  /// @param  delta_time Time since the last frame, accumulated by every
+  ///         object until it updates.
+  /// @param  view Camera view matrix, row vectors.
+  /// @param  projection Camera perspective projection matrix, row vectors.
+  ///--------------------------------------------------------------------------
+  void update(const float32 delta_time,
+              const DirectX::XMMATRIX& view,
+              const DirectX::XMMATRIX& projection);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void beginUpdate(const uint32 object);
+  ///
+  /// @brief  Starts measuring the update of an object.
+  /// @param  object Handle of the object.
+  ///--------------------------------------------------------------------------
+  void beginUpdate(const uint32 object);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void endUpdate(const uint32 object);
+  ///
+  /// @brief  Stops measuring the update of an object, whose cost is expected
+  ///         again next time, and restarts its elapsed time.
+  /// @param  object Handle of the object.
+  ///--------------------------------------------------------------------------
+  void endUpdate(const uint32 object);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void restart(const uint32 object);
+  ///
+  /// @brief  Forgets the time accumulated by an object, as when it is spawned.
+  /// @param  object Handle of the object.
+  ///--------------------------------------------------------------------------
+  void restart(const uint32 object);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Moves the bounding sphere of an object.
+  void set_bounds(const uint32 object, const DirectX::XMFLOAT3& center, const float32 radius);
+  /// Whether the object updates this frame.
+  bool isDue(const uint32 object) const;
+  /// Time accumulated by the object since its last update, this frame included.
+  float32 elapsed(const uint32 object) const;
+  /// Tier of the object, 0 the most significant.
+  uint32 tier(const uint32 object) const;
+  /// Part of the screen height the object covers, or would if it was seen.
+  float32 significance(const uint32 object) const;
+  /// Counters of the last frame.
+  const Stats& stats() const;
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Tiers, from the most significant one. The first always updates.
+  Tier tiers_[kNumTiers];
+  /// Milliseconds per frame the due objects out of the first tier may spend.
+  float32 budget_ms_;
+  /// Disabled, every object updates every frame.
+  bool is_enabled_;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  struct Object {
+    DirectX::XMFLOAT3 center;
+    float32 radius;
+    float32 significance;
+    uint32 tier;
+    /// Frames since its last update.
+    uint32 frames_waited;
+    float32 elapsed;
+    /// Moving average of the cost of its updates.
+    float32 cost_ms;
+    uint64 update_start;
+    bool is_due;
+  };
+
+  SignificanceManager(const SignificanceManager& copy);
+  SignificanceManager& operator=(const SignificanceManager& copy);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  std::vector<Object> objects_;
+  /// Objects due this frame out of the first tier, kept to reuse the memory.
+  std::vector<uint32> due_;
+  /// Frames updated, spreads the objects of a tier over its interval.
+  uint32 frame_;
+  /// Measured this frame, reported by the next update.
+  float64 spent_ms_;
+  Stats stats_;
+
+}; /* SignificanceManager */
+
+}; /* W3D */
+
+#endif
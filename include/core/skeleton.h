@@ -0,0 +1,117 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __SKELETON_H__
+#define __SKELETON_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <string>
+#include <vector>
+
+namespace W3D {
+
+/// Local transform of every bone of a skeleton, structure of arrays padded to
+/// groups of 4 bones so they can be evaluated 4 at a time. Rotations are
+/// quaternions.
+struct Pose {
+  uint32 num_bones;
+  std::vector<float32> translation_x;
+  std::vector<float32> translation_y;
+  std::vector<float32> translation_z;
+  std::vector<float32> rotation_x;
+  std::vector<float32> rotation_y;
+  std::vector<float32> rotation_z;
+  std::vector<float32> rotation_w;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void resize(const uint32 bones);
+  ///
+  /// @brief  Sets the number of bones, all of them at the origin with no
+  ///         rotation.
+  /// @param  bones Number of bones.
+  ///--------------------------------------------------------------------------
+  void resize(const uint32 bones);
+};
+
+/// Bones of a character, addressed by index. Parents always come before
+/// their children, so the hierarchy is composed in a single pass.
+class Skeleton {
+
+ public:
+
+  /// Parent of the root bones, and result of looking for a missing bone.
+  static const uint32 kNoBone = 0xFFFFFFFF;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  Skeleton();
+
+  /// Default class destructor.
+  ~Skeleton();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 addBone(const char* name, const uint32 parent);
+  ///
+  /// @brief  Adds a bone at the end of the skeleton.
+  /// @param  name Name of the bone, as the animation files call it.
+  /// @param  parent Index of the parent bone, already added, or kNoBone.
+  /// @return Index of the bone, kNoBone if the parent doesn't exist yet.
+  ///--------------------------------------------------------------------------
+  uint32 addBone(const char* name, const uint32 parent);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 find(const char* name) const;
+  ///
+  /// @brief  Looks for a bone by name.
+  /// @param  name Name of the bone.
+  /// @return Index of the bone, kNoBone if there is none with that name.
+  ///--------------------------------------------------------------------------
+  uint32 find(const char* name) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Number of bones.
+  uint32 num_bones() const;
+
+  /// Name of a bone.
+  const std::string& name(const uint32 bone) const;
+
+  /// Parent of a bone, kNoBone for the roots.
+  uint32 parent(const uint32 bone) const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  Skeleton(const Skeleton& copy);
+  Skeleton& operator=(const Skeleton& copy);
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Name of every bone.
+  std::vector<std::string> names_;
+  /// Parent of every bone.
+  std::vector<uint32> parents_;
+
+}; /* Skeleton */
+
+}; /* W3D */
+
+#endif
@@ -38,6 +38,30 @@ struct MaterialSettings {
   // ESTO ES PORQUE LOS CONSTANT BUFFER TIENEN QUE IR EN BLOQUES DE 16Bytes
 };
 
+/// Terrain vertex shader data, updated for every quadtree node drawn.
+struct TerrainSettings {
+  /// First sample x and z, samples covered and patch grid quads.
+  DirectX::XMFLOAT4 node;
+  /// Morph start and end distances, the last two are unused.
+  DirectX::XMFLOAT4 morph;
+  /// Camera position in terrain space, the last one is unused.
+  DirectX::XMFLOAT4 camera;
+  /// Sample spacing x, terrain height, sample spacing z, unused.
+  DirectX::XMFLOAT4 terrain;
+  /// Samples width and height, 1 / (width - 1) and 1 / (height - 1).
+  DirectX::XMFLOAT4 samples;
+  /// Tile position in terrain space, the last one is unused.
+  DirectX::XMFLOAT4 offset;
+};
+
+/// Bounds of the packed vertex positions, one immutable buffer per geometry.
+struct PackedVertexSettings {
+  /// Position of a 0 quantized coordinate, the last one is unused.
+  DirectX::XMFLOAT4 position_min;
+  /// Bounds size, a 65535 quantized coordinate is min + extent.
+  DirectX::XMFLOAT4 position_extent;
+};
+
 class SuperMaterial {
 
  public:
@@ -79,6 +103,18 @@ class SuperMaterial {
 
   MaterialSettings settings_;
 
+  /// Vertex shader of the quadtree terrains, same layout and pixel shader.
+  ID3D11VertexShader* terrain_vertex_shader_;
+  /// Terrain node buffer, slot 1.
+  ID3D11Buffer* terrain_buffer_;
+
+  TerrainSettings terrain_settings_;
+
+  /// Vertex shader of the packed vertices, same pixel shader.
+  ID3D11VertexShader* packed_vertex_shader_;
+  /// Input layout of Geo::PackedVertexData.
+  ID3D11InputLayout* packed_input_layout_;
+
 /*******************************************************************************
 ***                           Private                                        ***
 *******************************************************************************/
@@ -102,6 +138,14 @@ class SuperMaterial {
   ///--------------------------------------------------------------------------
   bool createMatrixBuffer();
 
+  ///--------------------------------------------------------------------------
+  /// @fn   bool createTerrainBuffer();
+  ///
+  /// @brief  Creates the terrain node buffer.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool createTerrainBuffer();
+
 
 }; /* CoreMaterial */
 
@@ -0,0 +1,42 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __TERRAIN_MESH_H__
+#define __TERRAIN_MESH_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/geo.h"
+#include <DirectXMath.h>
+
+namespace W3D {
+namespace TerrainMesh {
+
+///--------------------------------------------------------------------------
+/// @fn   void GeneratePatch(const int32 num_quads,
+///                          const DirectX::XMFLOAT4 color,
+///                          std::vector<Geo::VertexData>& vertices,
+///                          std::vector<uint32>& indices);
+///
+/// @brief  Generates the grid every terrain quadtree node is drawn with.
+///         Positions go from 0 to 1 in x and z, the heights are read in the
+///         vertex shader. Triangle list indices are sorted by quadrant,
+///         (x-, z-), (x+, z-), (x-, z+), (x+, z+), so every quadrant can be
+///         drawn on its own with a quarter of the indices.
+/// @param  num_quads Quads per side, even.
+/// @param  color Vertex color.
+/// @param  vertices Output vertices.
+/// @param  indices Output indices.
+///--------------------------------------------------------------------------
+void GeneratePatch(const int32 num_quads,
+                   const DirectX::XMFLOAT4 color,
+                   std::vector<Geo::VertexData>& vertices,
+                   std::vector<uint32>& indices);
+
+}; /* TerrainMesh */
+}; /* W3D */
+
+#endif
@@ -0,0 +1,241 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __TERRAIN_QUADTREE_H__
+#define __TERRAIN_QUADTREE_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include <vector>
+
+namespace W3D {
+
+/// Continuous distance dependent level of detail (CDLOD) for heightmap
+/// terrains. Every node is drawn with the same patch grid, scaled to the node
+/// size, so coarser levels cover more terrain with the same triangles. The
+/// vertex shader reads the heights and morphs the vertices into the next
+/// level before the switch, so there are no cracks nor pops.
+/// The heights are kept, so the ground can be queried without the GPU.
+class TerrainQuadTree {
+
+ public:
+
+  /// Every node is drawn with this grid, kPatchQuads x kPatchQuads quads.
+  static const int32 kPatchQuads = 32;
+
+  struct Node {
+    /// First sample covered, x and z.
+    int32 x;
+    int32 z;
+    /// Quads covered in each axis, kPatchQuads << level.
+    int32 size;
+    /// 0 for the leaves, the most detailed level.
+    int32 level;
+    /// Heights limits, in terrain units.
+    float32 min_height;
+    float32 max_height;
+    /// Node index of every quadrant, -1 if outside the terrain.
+    int32 children[4];
+  };
+
+  /// Node selected to be drawn. Quadrants whose children are not drawn by
+  /// themselves are drawn by the parent.
+  struct Selection {
+    int32 node;
+    /// Bit per quadrant to draw, kAllQuadrants draws the whole node.
+    uint32 quadrants;
+  };
+
+  /// Every quadrant of a node.
+  static const uint32 kAllQuadrants = 0xF;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  TerrainQuadTree();
+
+  /// Default class destructor.
+  ~TerrainQuadTree();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void build(std::vector<uint16>& heights,
+  ///                  const DirectX::XMINT2 samples,
+  ///                  const DirectX::XMFLOAT2 spacing,
+  ///                  const float32 max_height);
+  ///
+  /// @brief  Builds the nodes with their heights limits and the lod ranges.
+  ///         The heights are moved into the tree, heights is left empty.
+  /// @param  heights Samples, row by row, 0 to 65535 is 0 to max_height.
+  /// @param  samples Number of samples (width, height).
+  /// @param  spacing Distance between two samples, x and z.
+  /// @param  max_height Height of the maximum sample value.
+  ///--------------------------------------------------------------------------
+  void build(std::vector<uint16>& heights,
+             const DirectX::XMINT2 samples,
+             const DirectX::XMFLOAT2 spacing,
+             const float32 max_height);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   const std::vector<Selection>& select(const DirectX::XMFLOAT3 camera_position,
+  ///                                            const DirectX::BoundingFrustum& frustum);
+  ///
+  /// @brief  Selects the nodes to draw this frame. Nodes outside the frustum
+  ///         are skipped.
+  /// @param  camera_position Camera position in terrain space.
+  /// @param  frustum Camera frustum in terrain space.
+  /// @return Selected nodes, valid until the next call.
+  ///--------------------------------------------------------------------------
+  const std::vector<Selection>& select(const DirectX::XMFLOAT3 camera_position,
+                                       const DirectX::BoundingFrustum& frustum);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   float32 heightAt(const float32 x, const float32 z) const;
+  ///
+  /// @brief  Bilinear height, clamped to the terrain borders.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @return Height in terrain units.
+  ///--------------------------------------------------------------------------
+  float32 heightAt(const float32 x, const float32 z) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   DirectX::XMFLOAT3 normalAt(const float32 x, const float32 z) const;
+  ///
+  /// @brief  Normal from the heights around, same one the shader uses.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @return Unit normal in terrain space.
+  ///--------------------------------------------------------------------------
+  DirectX::XMFLOAT3 normalAt(const float32 x, const float32 z) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool raycast(const DirectX::XMFLOAT3 origin,
+  ///                    const DirectX::XMFLOAT3 direction,
+  ///                    const float32 max_distance,
+  ///                    float32* distance) const;
+  ///
+  /// @brief  First hit of a ray with the terrain triangles. Only the nodes
+  ///         whose height limits the ray crosses are visited, nearest first,
+  ///         and the cells of the leaves are walked along the ray.
+  /// @param  origin Ray origin in terrain space.
+  /// @param  direction Ray direction, unit length.
+  /// @param  max_distance Hits further than this are ignored.
+  /// @param  distance Distance to the hit, only written on hit.
+  /// @return true if the ray hits the terrain, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool raycast(const DirectX::XMFLOAT3 origin,
+               const DirectX::XMFLOAT3 direction,
+               const float32 max_distance,
+               float32* distance) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Node getter.
+  const Node& node(const int32 index) const;
+
+  /// Distance where the level stops being drawn.
+  float32 lod_range(const int32 level) const;
+
+  /// Distance where the vertices of the level start morphing to the next one.
+  float32 morph_start(const int32 level) const;
+
+  /// Terrain space distance between two samples, x and z.
+  DirectX::XMFLOAT2 sample_spacing() const;
+
+  /// Number of samples (width, height).
+  DirectX::XMINT2 samples() const;
+
+  /// Height of the maximum sample value.
+  float32 max_height() const;
+
+  /// Number of nodes.
+  uint32 num_nodes() const;
+
+  /// Samples, row by row, 0 to 65535 is 0 to max_height.
+  const std::vector<uint16>& heights() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  TerrainQuadTree(const TerrainQuadTree& copy);
+  TerrainQuadTree& operator=(const TerrainQuadTree& copy);
+
+  /// Creates a node and its children, returns its index.
+  int32 buildNode(const int32 x, const int32 z, const int32 level);
+
+  /// Recursive selection, false if the node is out of its lod range.
+  bool selectNode(const int32 index,
+                  const DirectX::XMFLOAT3& camera_position,
+                  const DirectX::BoundingFrustum& frustum);
+
+  /// Node bounding box in terrain space.
+  DirectX::BoundingBox bounds(const Node& node) const;
+
+  /// Whether the sphere of the camera range touches the node or not.
+  bool isInRange(const Node& node,
+                 const DirectX::XMFLOAT3& camera_position,
+                 const float32 range) const;
+
+  /// Sample height in terrain units, coordinates must be inside.
+  float32 sampleHeight(const int32 x, const int32 z) const;
+
+  /// Distances where the ray enters and leaves the node box, false if missed.
+  bool rayNodeLimits(const Node& node,
+                     const DirectX::XMFLOAT3& origin,
+                     const DirectX::XMFLOAT3& direction,
+                     float32* enter,
+                     float32* exit) const;
+
+  /// Recursive raycast, children nearest first.
+  bool raycastNode(const int32 index,
+                   const DirectX::XMFLOAT3& origin,
+                   const DirectX::XMFLOAT3& direction,
+                   const float32 enter,
+                   const float32 exit,
+                   float32* distance) const;
+
+  /// Walks the cells of a leaf between enter and exit, testing their triangles.
+  bool raycastLeaf(const Node& node,
+                   const DirectX::XMFLOAT3& origin,
+                   const DirectX::XMFLOAT3& direction,
+                   const float32 enter,
+                   const float32 exit,
+                   float32* distance) const;
+
+  /// Terrain heights.
+  std::vector<uint16> heights_;
+  /// All the nodes, the root is the first one.
+  std::vector<Node> nodes_;
+  /// lod_ranges_[level] and morph_starts_[level].
+  std::vector<float32> lod_ranges_;
+  std::vector<float32> morph_starts_;
+  /// Last selection.
+  std::vector<Selection> selection_;
+
+  DirectX::XMINT2 samples_;
+  DirectX::XMFLOAT2 spacing_;
+  /// Sample value to terrain units.
+  float32 height_scale_;
+  int32 num_levels_;
+
+}; /* TerrainQuadTree */
+
+}; /* W3D */
+
+#endif
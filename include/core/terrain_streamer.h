@@ -0,0 +1,203 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __TERRAIN_STREAMER_H__
+#define __TERRAIN_STREAMER_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include "core/height_map.h"
+#include <DirectXMath.h>
+#include <unordered_map>
+#include <vector>
+
+namespace W3D {
+
+class Geo;
+
+/// Pages the tiles of a heightmap too big to be resident in the GPU. Tiles
+/// around the camera are built in the workers from the memory mapped
+/// heightmap and uploaded by the asynchronous loader within its frame budget,
+/// the least recently used ones are evicted when over the memory budget.
+/// Every tile is a lod quadtree terrain drawn with one shared patch grid.
+/// A coarse version of every tile, the root node of its quadtree alone, is
+/// requested first and drawn until the tile is ready, so no hole is left
+/// while loading. Tiles that fail are requested again a while later.
+class TerrainStreamer {
+
+ public:
+
+  /// Quads per tile side, tiles share their border samples.
+  static const int32 kTileQuads = 256;
+  /// Heightmap samples between two samples of the coarse tiles.
+  static const int32 kCoarseStride = 8;
+
+  /// Resident tile ready to be drawn this frame.
+  struct VisibleTile {
+    Geo* geometry;
+    /// Tile position in terrain space.
+    DirectX::XMFLOAT3 offset;
+  };
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  TerrainStreamer();
+
+  /// Default class destructor.
+  ~TerrainStreamer();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool init(const char* height_map_filename,
+  ///                 const DirectX::XMFLOAT3 grid_size,
+  ///                 const DirectX::XMFLOAT4 color);
+  ///
+  /// @brief  Maps the heightmap and creates the shared patch grid. No tile
+  ///         is read yet. Main thread only.
+  /// @param  height_map_filename Heightmap file, any HeightMapSource format.
+  /// @param  grid_size Size of the whole terrain, Y will be the max height.
+  /// @param  color Color RGBA of the geometry.
+  /// @return true if successfully initialized, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool init(const char* height_map_filename,
+            const DirectX::XMFLOAT3 grid_size,
+            const DirectX::XMFLOAT4 color);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void update(const DirectX::XMFLOAT3 camera_position);
+  ///
+  /// @brief  Requests the missing tiles of the ring around the camera,
+  ///         nearest first, evicts over the budget and fills the visible
+  ///         tiles, coarse ones where the tile is not ready yet. Never
+  ///         waits for a tile. Main thread only.
+  /// @param  camera_position Camera position in terrain space.
+  ///--------------------------------------------------------------------------
+  void update(const DirectX::XMFLOAT3 camera_position);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   Geo* tileAt(const float32 x, const float32 z, DirectX::XMFLOAT3* offset) const;
+  ///
+  /// @brief  Ready tile covering a terrain position, or its coarse version.
+  /// @param  x Terrain space x.
+  /// @param  z Terrain space z.
+  /// @param  offset Tile position in terrain space, only written if found.
+  /// @return The tile, nullptr if outside or not resident.
+  ///--------------------------------------------------------------------------
+  Geo* tileAt(const float32 x, const float32 z, DirectX::XMFLOAT3* offset) const;
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool raycast(const DirectX::XMFLOAT3 origin,
+  ///                    const DirectX::XMFLOAT3 direction,
+  ///                    const float32 max_distance,
+  ///                    float32* distance) const;
+  ///
+  /// @brief  Nearest hit with the ready tiles, or their coarse versions.
+  /// @param  origin Ray origin in terrain space.
+  /// @param  direction Ray direction, unit length.
+  /// @param  max_distance Hits further than this are ignored.
+  /// @param  distance Distance to the hit, only written on hit.
+  /// @return true if the ray hits a tile, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool raycast(const DirectX::XMFLOAT3 origin,
+               const DirectX::XMFLOAT3 direction,
+               const float32 max_distance,
+               float32* distance) const;
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Ready tiles of the ring, or their coarse versions, filled by update.
+  const std::vector<VisibleTile>& visible_tiles() const;
+
+  /// Patch grid every tile is drawn with.
+  Geo* patch() const;
+
+  /// Number of tiles resident or being loaded.
+  uint32 num_tiles() const;
+
+  /// Bytes used by the resident tiles.
+  uint64 resident_bytes() const;
+
+/*******************************************************************************
+***                               Attributes                                 ***
+*******************************************************************************/
+
+  /// Memory the resident tiles can use before evicting.
+  uint64 budget_bytes_;
+  /// Tiles kept around the camera tile in each direction.
+  int32 ring_radius_;
+  /// Tiles being built at the same time, not counting the coarse ones.
+  uint32 max_loading_tiles_;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  TerrainStreamer(const TerrainStreamer& copy);
+  TerrainStreamer& operator=(const TerrainStreamer& copy);
+
+  struct Tile {
+    Geo* geometry;
+    /// Root node of the tile alone, drawn while the tile is not ready.
+    Geo* coarse;
+    /// Frame the tile was last in the ring.
+    uint64 last_used_frame;
+    /// Memory used by the geometries resident, 0 while loading.
+    uint64 bytes;
+    /// Frame a failed geometry of the tile is requested again.
+    uint64 retry_frame;
+  };
+
+  /// Starts building the coarse version of a tile in the workers, the tile
+  /// itself once there is room for it.
+  void requestTile(const int32 x, const int32 z);
+
+  /// Starts building one geometry of a tile in the workers, the coarse one
+  /// if the stride is kCoarseStride.
+  void requestGeometry(const int32 x, const int32 z, Geo* geometry, const int32 stride);
+
+  /// Geometry of a tile to draw or query, the coarse one until the tile is
+  /// ready, nullptr if neither is.
+  static Geo* ReadyGeometry(const Tile& tile);
+
+  /// Evicts the least recently used tiles out of the ring until the
+  /// resident tiles fit in the budget.
+  void evict();
+
+  /// Heightmap, mapped for the whole life of the streamer.
+  HeightMapSource source_;
+  /// Tiles by (z << 32 | x).
+  std::unordered_map<uint64, Tile> tiles_;
+  /// Ring offsets sorted by distance, nearest first.
+  std::vector<DirectX::XMINT2> ring_offsets_;
+  /// Filled by update.
+  std::vector<VisibleTile> visible_;
+  /// Shared patch grid.
+  Geo* patch_;
+
+  DirectX::XMINT2 num_tiles_;
+  DirectX::XMFLOAT2 spacing_;
+  float32 max_height_;
+  DirectX::XMFLOAT4 color_;
+  int32 ring_offsets_radius_;
+  uint64 resident_bytes_;
+  uint64 frame_;
+  uint32 num_loading_;
+
+}; /* TerrainStreamer */
+
+}; /* W3D */
+
+#endif
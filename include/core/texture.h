@@ -40,6 +40,28 @@ class Texture {
   ///--------------------------------------------------------------------------
   bool initFromFile(const char* texture_path);
 
+  ///--------------------------------------------------------------------------
+  /// @fn   bool decodeFromFile(const char* texture_path,
+  ///                           const char** error = nullptr);
+  ///
+  /// @brief  First part of an asynchronous load, decodes the image into a
+  ///         staging texture. Can be called from a worker thread.
+  /// @param  texture_path Image file.
+  /// @param  error Where to leave the error message from a worker thread,
+  ///         nullptr shows it.
+  /// @return true if successfully decoded, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool decodeFromFile(const char* texture_path, const char** error = nullptr);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   bool createFromDecoded();
+  ///
+  /// @brief  Second part of an asynchronous load, copies the staging texture
+  ///         into the final one. Main thread only.
+  /// @return true if successfully created, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool createFromDecoded();
+
   ///--------------------------------------------------------------------------
   /// @fn   use(const uint32 texture_slot);
   ///
@@ -59,6 +81,16 @@ class Texture {
   /// Name, file path.
   std::string name_;
 
+  /// Loading states, textures not ready use the error texture.
+  enum LoadState {
+    kLoadState_Ready = 0,
+    kLoadState_Loading,
+    kLoadState_Failed,
+  };
+
+  /// Loading state, only changed in the main thread.
+  LoadState load_state_;
+
 
  private:
 
@@ -66,11 +98,20 @@ class Texture {
 ***                               Attributes                                 ***
 *******************************************************************************/
 
+  /// Decoded image waiting to be copied, asynchronous loads only.
+  ID3D11Texture2D* staging_texture_;
 
 /*******************************************************************************
 ***                              Private methods                             ***
 *******************************************************************************/
 
+  ///--------------------------------------------------------------------------
+  /// @fn   bool createSampler();
+  ///
+  /// @brief  Creates the texture sampler state.
+  /// @return true if successfully created, false otherwise.
+  ///--------------------------------------------------------------------------
+  bool createSampler();
 
 
 }; /* Texture */
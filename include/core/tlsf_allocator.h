@@ -0,0 +1,150 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#ifndef __TLSF_ALLOCATOR_H__
+#define __TLSF_ALLOCATOR_H__ 1
+
+#include "Wolfy3D/globals.h"
+#include <vector>
+
+namespace W3D {
+
+/// Two level segregated fit offset allocator (Masmano et al. 2004). Only the
+/// offsets inside a range are managed, the memory lives elsewhere, a GPU
+/// buffer for example. The free blocks are kept in lists by size class, two
+/// bitmaps find a list big enough in constant time, and the released blocks
+/// are merged with their free neighbours straight away.
+class TlsfAllocator {
+
+ public:
+
+  /// Returned when there is no free block big enough.
+  static const uint32 kInvalidHandle = 0xFFFFFFFF;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+  /// Default class constructor.
+  TlsfAllocator();
+
+  /// Default class destructor.
+  ~TlsfAllocator();
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void init(const uint32 size);
+  ///
+  /// @brief  Starts with the whole range free, previous allocations are lost.
+  /// @param  size Units managed, offsets go from 0 to size.
+  ///--------------------------------------------------------------------------
+  void init(const uint32 size);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   uint32 allocate(const uint32 size, uint32* offset);
+  ///
+  /// @brief  Allocates a contiguous range.
+  /// @param  size Units to allocate.
+  /// @param  offset First unit of the range, only written on success.
+  /// @return Handle to release the range, kInvalidHandle if it doesn't fit.
+  ///--------------------------------------------------------------------------
+  uint32 allocate(const uint32 size, uint32* offset);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void release(const uint32 handle);
+  ///
+  /// @brief  Frees a range given by allocate.
+  /// @param  handle Handle of the range.
+  ///--------------------------------------------------------------------------
+  void release(const uint32 handle);
+
+  ///--------------------------------------------------------------------------
+  /// @fn   void grow(const uint32 new_size);
+  ///
+  /// @brief  Adds free units at the end of the range, the allocated offsets
+  ///         are kept.
+  /// @param  new_size New number of units, bigger than the current one.
+  ///--------------------------------------------------------------------------
+  void grow(const uint32 new_size);
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+  /// Units managed.
+  uint32 size() const;
+
+  /// Units allocated.
+  uint32 used() const;
+
+  /// Ranges allocated.
+  uint32 num_allocations() const;
+
+/*******************************************************************************
+***                           Private                                        ***
+*******************************************************************************/
+
+ private:
+
+  TlsfAllocator(const TlsfAllocator& copy);
+  TlsfAllocator& operator=(const TlsfAllocator& copy);
+
+  /// Size classes, every power of two is split in kSecondLevels classes.
+  static const uint32 kSecondLevelBits = 3;
+  static const uint32 kSecondLevels = 1 << kSecondLevelBits;
+  static const uint32 kFirstLevels = 32;
+
+  struct Block {
+    uint32 offset;
+    uint32 size;
+    /// Neighbours in the range, kInvalidHandle at the ends.
+    uint32 previous_physical;
+    uint32 next_physical;
+    /// Neighbours in the free list of its size class.
+    uint32 previous_free;
+    uint32 next_free;
+    bool free;
+  };
+
+  /// Size class of a block size.
+  static void Mapping(const uint32 size, uint32* first_level, uint32* second_level);
+
+  /// Takes a block slot, reusing the released ones.
+  uint32 newBlock();
+
+  /// Adds and removes a free block to and from its size class list.
+  void insertFree(const uint32 block);
+  void removeFree(const uint32 block);
+
+  /// Free block of at least size units, kInvalidHandle if none.
+  uint32 findFree(const uint32 size) const;
+
+  /// All the blocks, free, used and unused slots.
+  std::vector<Block> blocks_;
+  /// Block slots not in the range, ready to be reused.
+  std::vector<uint32> unused_blocks_;
+  /// First free block of every size class.
+  uint32 free_heads_[kFirstLevels][kSecondLevels];
+  /// Bit per first level with free blocks.
+  uint32 first_level_bitmap_;
+  /// Bit per size class with free blocks, per first level.
+  uint32 second_level_bitmaps_[kFirstLevels];
+  /// Block at the end of the range.
+  uint32 last_block_;
+
+  uint32 size_;
+  uint32 used_;
+  uint32 num_allocations_;
+
+}; /* TlsfAllocator */
+
+}; /* W3D */
+
+#endif
@@ -0,0 +1,61 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "Wolfy3D/file_system.h"
+#include "core/file_system.h"
+#include "core/core.h"
+#include <vector>
+#include <string>
+
+namespace W3D {
+namespace FileSystem {
+
+/// Recursively collects the files of a directory, skipping the archives.
+static void CollectFiles(const std::string& directory,
+                         std::vector<std::string>& files) {
+
+  WIN32_FIND_DATAA find_data;
+  HANDLE find_handle = FindFirstFileA((directory + "/*").c_str(), &find_data);
+  if (find_handle == INVALID_HANDLE_VALUE) { return; }
+
+  do {
+    std::string name = find_data.cFileName;
+    if (name == "." || name == "..") { continue; }
+
+    std::string path = directory + "/" + name;
+    if (find_data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+      CollectFiles(path, files);
+    }
+    else if (name.size() < 4 || name.compare(name.size() - 4, 4, ".w3p") != 0) {
+      files.push_back(path);
+    }
+  } while (FindNextFileA(find_handle, &find_data));
+
+  FindClose(find_handle);
+}
+
+bool Mount(const char* archive_path) {
+  return Core::instance().vfs_.mount(archive_path);
+}
+
+bool PackDirectory(const char* directory,
+                   const char* archive_path,
+                   const bool compress) {
+
+  std::vector<std::string> files;
+  CollectFiles(directory, files);
+
+  std::vector<std::string> names(files.size());
+  for (uint32 i = 0; i < files.size(); ++i) {
+    names[i] = VirtualFileSystem::NormalizePath(files[i].c_str());
+  }
+
+  return Archive::Pack(archive_path, files, names, compress);
+}
+
+}; /* FileSystem */
+}; /* W3D */
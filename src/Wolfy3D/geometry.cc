@@ -11,6 +11,22 @@
 
 namespace W3D {
 
+static_assert(sizeof(Geometry::Vertex) == sizeof(Geo::VertexData),
+              "Geometry::Vertex must match the full vertex layout");
+
+/// Calls the callback of an asynchronous load already requested.
+static void NotifyExistingGeometry(Geo* geometry, const LoadCallback& callback) {
+  if (!callback) { return; }
+  if (Core::instance().loader_.addCallback(geometry, callback)) { return; }
+  callback(geometry->load_state_ == Geo::kLoadState_Ready);
+}
+
+/// Upload step shared by the asynchronous geometries.
+static bool UploadGeometry(Geo* geometry, const bool parsed) {
+  bool uploaded = parsed && geometry->createBuffers();
+  geometry->load_state_ = uploaded ? Geo::kLoadState_Ready : Geo::kLoadState_Failed;
+  return uploaded;
+}
 
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
@@ -144,6 +160,86 @@ void Geometry::initTerrain(const char* height_map_filename,
   geometry = nullptr;
 }
 
+void Geometry::initTerrainAsync(const char* height_map_filename,
+                                const DirectX::XMFLOAT3 grid_size,
+                                const DirectX::XMFLOAT4 color,
+                                const LoadCallback& callback) {
+
+  auto& core = Core::instance();
+  auto& factory = core.geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  std::string filename = height_map_filename;
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_Terrain) {
+      if (grid_size.x == factory[i]->info_.terrain.size.x &&
+          grid_size.y == factory[i]->info_.terrain.size.y &&
+          grid_size.z == factory[i]->info_.terrain.size.z &&
+          filename == factory[i]->name_) {
+        id_ = i;
+        NotifyExistingGeometry(factory[i], callback);
+        return;
+      }
+    }
+  }
+
+  /* The geometry is added now, it will be ready once uploaded. */
+  Geo* geometry = new Geo();
+  geometry->type_ = Geo::kType_Terrain;
+  geometry->info_.terrain.size = { grid_size.x, grid_size.y, grid_size.z };
+  geometry->name_ = filename;
+  geometry->load_state_ = Geo::kLoadState_Loading;
+  factory.push_back(geometry);
+  id_ = length;
+
+  core.loader_.load(geometry,
+                    [geometry, filename, grid_size, color](const char** error) {
+                      return geometry->buildTerrain(filename.c_str(), grid_size, color, error);
+                    },
+                    [geometry](const bool parsed) {
+                      return UploadGeometry(geometry, parsed);
+                    },
+                    callback);
+}
+
+void Geometry::initTerrainStreaming(const char* height_map_filename,
+                                    const DirectX::XMFLOAT3 grid_size,
+                                    const DirectX::XMFLOAT4 color,
+                                    const uint32 memory_budget_mb) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  std::string filename = height_map_filename;
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_StreamedTerrain) {
+      if (grid_size.x == factory[i]->info_.terrain.size.x &&
+          grid_size.y == factory[i]->info_.terrain.size.y &&
+          grid_size.z == factory[i]->info_.terrain.size.z &&
+          filename == factory[i]->name_) {
+        id_ = i;
+        return;
+      }
+    }
+  }
+
+  /* If it doesnt exist in the factory, we will generate a new geometry. */
+  Geo* geometry = new Geo();
+  if (geometry->initTerrainStreaming(height_map_filename, grid_size, color,
+                                     (uint64)memory_budget_mb * 1024 * 1024)) {
+    factory.push_back(geometry);
+    id_ = length;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
 void Geometry::initQuad(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 color) {
 
   auto& factory = Core::instance().geometry_factory_;
@@ -275,16 +371,159 @@ void Geometry::initPyramid(const uint32 num_base_vertex,
   geometry = nullptr;
 }
 
-void Geometry::initFromFile(const char* filename, const DirectX::XMFLOAT4 color) {
+void Geometry::initSphere(const float32 radius,
+                          const uint32 slices,
+                          const uint32 stacks,
+                          const DirectX::XMFLOAT4 color) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_Sphere) {
+      if (radius == factory[i]->info_.sphere.radius &&
+          slices == factory[i]->info_.sphere.slices &&
+          stacks == factory[i]->info_.sphere.stacks) {
+        id_ = i;
+        return;
+      }
+    }
+  }
+
+  /* If it doesnt exist in the factory, we will generate a new geometry. */
+  Geo* geometry = new Geo();
+  if (geometry->initSphere(radius, slices, stacks, color)) {
+    factory.push_back(geometry);
+    id_ = length;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
+void Geometry::initCylinder(const float32 radius,
+                            const float32 height,
+                            const uint32 slices,
+                            const DirectX::XMFLOAT4 color) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_Cylinder) {
+      if (radius == factory[i]->info_.cylinder.radius &&
+          height == factory[i]->info_.cylinder.height &&
+          slices == factory[i]->info_.cylinder.slices) {
+        id_ = i;
+        return;
+      }
+    }
+  }
+
+  /* If it doesnt exist in the factory, we will generate a new geometry. */
+  Geo* geometry = new Geo();
+  if (geometry->initCylinder(radius, height, slices, color)) {
+    factory.push_back(geometry);
+    id_ = length;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
+void Geometry::initTorus(const float32 radius,
+                         const float32 tube_radius,
+                         const uint32 rings,
+                         const uint32 sides,
+                         const DirectX::XMFLOAT4 color) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_Torus) {
+      if (radius == factory[i]->info_.torus.radius &&
+          tube_radius == factory[i]->info_.torus.tube_radius &&
+          rings == factory[i]->info_.torus.rings &&
+          sides == factory[i]->info_.torus.sides) {
+        id_ = i;
+        return;
+      }
+    }
+  }
+
+  /* If it doesnt exist in the factory, we will generate a new geometry. */
+  Geo* geometry = new Geo();
+  if (geometry->initTorus(radius, tube_radius, rings, sides, color)) {
+    factory.push_back(geometry);
+    id_ = length;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
+void Geometry::initGrid(const DirectX::XMFLOAT2 size,
+                        const uint32 cells_x,
+                        const uint32 cells_z,
+                        const DirectX::XMFLOAT4 color) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_Grid) {
+      if (size.x == factory[i]->info_.grid.size.x &&
+          size.y == factory[i]->info_.grid.size.y &&
+          cells_x == factory[i]->info_.grid.cells_x &&
+          cells_z == factory[i]->info_.grid.cells_z) {
+        id_ = i;
+        return;
+      }
+    }
+  }
+
+  /* If it doesnt exist in the factory, we will generate a new geometry. */
+  Geo* geometry = new Geo();
+  if (geometry->initGrid(size, cells_x, cells_z, color)) {
+    factory.push_back(geometry);
+    id_ = length;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
+void Geometry::initFromFile(const char* filename,
+                            const DirectX::XMFLOAT4 color,
+                            const bool packed_vertices) {
 
   auto& factory = Core::instance().geometry_factory_;
+  Geo::VertexFormat vertex_format = packed_vertices ? Geo::kVertexFormat_Packed :
+                                                      Geo::kVertexFormat_Full;
 
   /* check if exists in the factory. */
   uint32 length = factory.size();
   std::string name = filename;
   for (uint32 i = 0; i < length; i++) {
     if (factory[i]->type_ == Geo::kType_ExternalFile) {
-      if (name == factory[i]->name_) {
+      if (name == factory[i]->name_ && vertex_format == factory[i]->vertex_format_) {
         id_ = i;
         return;
       }
@@ -293,7 +532,7 @@ void Geometry::initFromFile(const char* filename, const DirectX::XMFLOAT4 color)
 
   /* If it doesnt exist in the factory, we will generate a new geometry. */
   Geo* geometry = new Geo();
-  if (geometry->initFromFile(filename, color)) {
+  if (geometry->initFromFile(filename, color, vertex_format)) {
     factory.push_back(geometry);
     id_ = length;
   }
@@ -305,10 +544,105 @@ void Geometry::initFromFile(const char* filename, const DirectX::XMFLOAT4 color)
   geometry = nullptr;
 }
 
+void Geometry::initFromFileAsync(const char* filename,
+                                 const DirectX::XMFLOAT4 color,
+                                 const LoadCallback& callback,
+                                 const bool packed_vertices) {
+
+  auto& core = Core::instance();
+  auto& factory = core.geometry_factory_;
+  Geo::VertexFormat vertex_format = packed_vertices ? Geo::kVertexFormat_Packed :
+                                                      Geo::kVertexFormat_Full;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  std::string name = filename;
+  for (uint32 i = 0; i < length; i++) {
+    if (factory[i]->type_ == Geo::kType_ExternalFile) {
+      if (name == factory[i]->name_ && vertex_format == factory[i]->vertex_format_) {
+        id_ = i;
+        NotifyExistingGeometry(factory[i], callback);
+        return;
+      }
+    }
+  }
+
+  /* The geometry is added now, it will be ready once uploaded. */
+  Geo* geometry = new Geo();
+  geometry->type_ = Geo::kType_ExternalFile;
+  geometry->name_ = name;
+  geometry->vertex_format_ = vertex_format;
+  geometry->load_state_ = Geo::kLoadState_Loading;
+  factory.push_back(geometry);
+  id_ = length;
+
+  core.loader_.load(geometry,
+                    [geometry, name, color](const char** error) {
+                      return geometry->parseFromFile(name.c_str(), color, error);
+                    },
+                    [geometry](const bool parsed) {
+                      return UploadGeometry(geometry, parsed);
+                    },
+                    callback);
+}
+
+void Geometry::initDynamic(const Vertex* vertices,
+                           const uint32 num_vertices,
+                           const uint32* indices,
+                           const uint32 num_indices,
+                           const bool lines) {
+
+  auto& factory = Core::instance().geometry_factory_;
+
+  /* Edited by their owner, so always a new geometry. */
+  Geo* geometry = new Geo();
+  D3D_PRIMITIVE_TOPOLOGY topology = lines ? D3D11_PRIMITIVE_TOPOLOGY_LINELIST :
+                                            D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  if (geometry->initDynamic((const Geo::VertexData*)vertices, num_vertices,
+                            indices, num_indices, topology)) {
+    factory.push_back(geometry);
+    id_ = factory.size() - 1;
+  }
+  // If the geometry doesnt create properly, we will delete it and take the error one.
+  else {
+    delete geometry;
+    id_ = Core::instance().error_geometry_.id();
+  }
+  geometry = nullptr;
+}
+
 /*******************************************************************************
 ***                               Public methods                             ***
 *******************************************************************************/
 
+float32 Geometry::heightAt(const float32 x, const float32 z) {
+  float32 height = 0.0f;
+  Core::instance().geometry_factory_[id_]->heightAt(x, z, &height);
+  return height;
+}
+
+DirectX::XMFLOAT3 Geometry::normalAt(const float32 x, const float32 z) {
+  DirectX::XMFLOAT3 normal = { 0.0f, 1.0f, 0.0f };
+  Core::instance().geometry_factory_[id_]->normalAt(x, z, &normal);
+  return normal;
+}
+
+bool Geometry::raycast(const DirectX::XMFLOAT3 origin,
+                       const DirectX::XMFLOAT3 direction,
+                       const float32 max_distance,
+                       float32* distance) {
+  return Core::instance().geometry_factory_[id_]->raycast(origin, direction, max_distance, distance);
+}
 
+Geometry::Vertex* Geometry::editVertices(const uint32 first, const uint32 count) {
+  return (Vertex*)Core::instance().geometry_factory_[id_]->editVertices(first, count);
+}
+
+bool Geometry::updateVertices(const uint32 first,
+                              const uint32 count,
+                              const Vertex* vertices) {
+  return Core::instance().geometry_factory_[id_]->updateVertices(first, count,
+                                                                 (const Geo::VertexData*)vertices);
+}
 
 }; /* W3D */
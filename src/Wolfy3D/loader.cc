@@ -0,0 +1,27 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "Wolfy3D/loader.h"
+#include "core/core.h"
+
+namespace W3D {
+namespace Loader {
+
+LoadStats Stats() {
+  return Core::instance().loader_.stats_;
+}
+
+void SetFrameBudget(const float32 milliseconds) {
+  Core::instance().loader_.frame_budget_ms_ = milliseconds;
+}
+
+void Flush() {
+  Core::instance().loader_.flush();
+}
+
+}; /* Loader */
+}; /* W3D */
@@ -71,6 +71,44 @@ void Texture2D::initFromFile(const char* filename) {
   texture = nullptr;
 }
 
+void Texture2D::initFromFileAsync(const char* filename, const LoadCallback& callback) {
+
+  auto& core = Core::instance();
+  auto& factory = core.texture_factory_;
+
+  /* check if exists in the factory. */
+  uint32 length = factory.size();
+  std::string name = filename;
+  for (uint32 i = 0; i < length; i++) {
+    if (name == factory[i]->name_) {
+      id_ = i;
+      if (callback && !core.loader_.addCallback(factory[i], callback)) {
+        callback(factory[i]->load_state_ == Texture::kLoadState_Ready);
+      }
+      return;
+    }
+  }
+
+  /* The texture is added now, it will be ready once uploaded. */
+  Texture* texture = new Texture();
+  texture->name_ = name;
+  texture->load_state_ = Texture::kLoadState_Loading;
+  factory.push_back(texture);
+  id_ = length;
+
+  core.loader_.load(texture,
+                    [texture, name](const char** error) {
+                      return texture->decodeFromFile(name.c_str(), error);
+                    },
+                    [texture](const bool parsed) {
+                      bool uploaded = parsed && texture->createFromDecoded();
+                      texture->load_state_ = uploaded ? Texture::kLoadState_Ready :
+                                                        Texture::kLoadState_Failed;
+                      return uploaded;
+                    },
+                    callback);
+}
+
 /*******************************************************************************
 ***                               Public methods                             ***
 *******************************************************************************/
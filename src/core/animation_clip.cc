@@ -0,0 +1,428 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/animation_clip.h"
+#include "core/core.h"
+#include "Wolfy3D/math.h"
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+namespace W3D {
+
+/// Channels of a bone in the file.
+enum ChannelType {
+  kChannelTranslate = 0,
+  kChannelRotateX,
+  kChannelRotateY,
+  kChannelRotateZ,
+  kNumChannelTypes,
+};
+
+/// Numbers of a float array, still as text inside the file.
+struct FloatArray {
+  const char* text;
+  uint32 count;
+};
+
+/// Times and values arrays of a channel.
+struct ChannelArrays {
+  FloatArray times;
+  FloatArray values;
+};
+
+/// Powers of ten exactly representable as doubles.
+static const float64 kPowersOfTen[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+  1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static bool IsSpace(const char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+static bool IsDigit(const char c) {
+  return c >= '0' && c <= '9';
+}
+
+/// Channel type of the suffix of an animation id, kNumChannelTypes if unknown.
+static ChannelType FindChannelType(const char* suffix, const uint32 length) {
+  const char* names[] = { "translate", "rotateX", "rotateY", "rotateZ" };
+  for (uint32 i = 0; i < kNumChannelTypes; ++i) {
+    if (strlen(names[i]) == length && strncmp(suffix, names[i], length) == 0) {
+      return (ChannelType)i;
+    }
+  }
+  return kNumChannelTypes;
+}
+
+/// Key of a track at or before the time, and how far the time is towards
+/// the following key.
+static uint32 FindKey(const float32* times,
+                      const uint32 num_keys,
+                      const float32 time,
+                      float32* alpha) {
+  const uint32 next = (uint32)(std::upper_bound(times, times + num_keys, time) - times);
+  *alpha = 0.0f;
+  if (next == 0) { return 0; }
+  if (next == num_keys) { return num_keys - 1; }
+  *alpha = (time - times[next - 1]) / (times[next] - times[next - 1]);
+  return next - 1;
+}
+
+/*******************************************************************************
+***                               Pull parser                                ***
+*******************************************************************************/
+
+/// Moves the cursor to the name of the next tag, after its '<', skipping the
+/// declarations and comments. Returns false at the end of the document.
+static bool NextTag(const char*& cursor, const char* end) {
+  while (cursor < end) {
+    cursor = (const char*)memchr(cursor, '<', end - cursor);
+    if (!cursor) { cursor = end; return false; }
+    ++cursor;
+    if (cursor < end && *cursor != '?' && *cursor != '!') { return true; }
+  }
+  return false;
+}
+
+/// Whether the tag at the cursor is the one given, closing ones included if
+/// the name starts with '/'.
+static bool IsTag(const char* cursor, const char* end, const char* name) {
+  const uint32 length = (uint32)strlen(name);
+  return (uint32)(end - cursor) > length &&
+         strncmp(cursor, name, length) == 0 &&
+         (IsSpace(cursor[length]) || cursor[length] == '>' || cursor[length] == '/');
+}
+
+/// Finds the value of an attribute of the tag at the cursor, before its '>'.
+static bool FindAttribute(const char* cursor,
+                          const char* end,
+                          const char* name,
+                          const char** value,
+                          uint32* length) {
+  const uint32 name_length = (uint32)strlen(name);
+  for (; cursor < end && *cursor != '>'; ++cursor) {
+    if (*cursor != '"') {
+      if (IsSpace(*cursor) && (uint32)(end - cursor) > name_length + 2 &&
+          strncmp(cursor + 1, name, name_length) == 0 && cursor[name_length + 1] == '=' &&
+          cursor[name_length + 2] == '"') {
+        *value = cursor + name_length + 3;
+        const char* quote = (const char*)memchr(*value, '"', end - *value);
+        if (!quote) { return false; }
+        *length = (uint32)(quote - *value);
+        return true;
+      }
+      continue;
+    }
+    // Skips quoted values, they may contain anything.
+    const char* quote = (const char*)memchr(cursor + 1, '"', end - cursor - 1);
+    if (!quote) { return false; }
+    cursor = quote;
+  }
+  return false;
+}
+
+/// Text after the tag at the cursor.
+static const char* TagText(const char* cursor, const char* end) {
+  const char* close = (const char*)memchr(cursor, '>', end - cursor);
+  return close ? close + 1 : end;
+}
+
+/// Decodes one decimal number, with optional sign, fraction and exponent,
+/// moving the cursor after it. Locale independent, and exact up to the
+/// float precision for the at most 19 significant digits of the exporters.
+static bool DecodeFloat(const char*& cursor, const char* end, float32* value) {
+  while (cursor < end && IsSpace(*cursor)) { ++cursor; }
+
+  const char* begin = cursor;
+  const bool negative = cursor < end && *cursor == '-';
+  if (cursor < end && (*cursor == '-' || *cursor == '+')) { ++cursor; }
+
+  // Significant digits beyond the 19 fitting in the mantissa are dropped.
+  uint64 mantissa = 0;
+  int32 digits = 0;
+  int32 exponent = 0;
+  const char* first_digit = cursor;
+  for (; cursor < end && IsDigit(*cursor); ++cursor) {
+    if (digits < 19) { mantissa = mantissa * 10 + (*cursor - '0'); digits += mantissa > 0; }
+    else { ++exponent; }
+  }
+  uint32 num_digits = (uint32)(cursor - first_digit);
+  if (cursor < end && *cursor == '.') {
+    first_digit = ++cursor;
+    for (; cursor < end && IsDigit(*cursor); ++cursor) {
+      if (digits < 19) { mantissa = mantissa * 10 + (*cursor - '0'); digits += mantissa > 0; --exponent; }
+    }
+    num_digits += (uint32)(cursor - first_digit);
+  }
+  if (num_digits == 0) {
+    cursor = begin;
+    return false;
+  }
+  if (cursor < end && (*cursor == 'e' || *cursor == 'E')) {
+    ++cursor;
+    const bool negative_exponent = cursor < end && *cursor == '-';
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) { ++cursor; }
+    int32 written_exponent = 0;
+    for (; cursor < end && IsDigit(*cursor); ++cursor) {
+      if (written_exponent < 1000) { written_exponent = written_exponent * 10 + (*cursor - '0'); }
+    }
+    exponent += negative_exponent ? -written_exponent : written_exponent;
+  }
+
+  float64 result = (float64)mantissa;
+  while (exponent > 22) { result *= 1e22; exponent -= 22; }
+  while (exponent < -22) { result /= 1e22; exponent += 22; }
+  result = exponent < 0 ? result / kPowersOfTen[-exponent] : result * kPowersOfTen[exponent];
+  *value = (float32)(negative ? -result : result);
+  return true;
+}
+
+/// Decodes the numbers of a float array into every stride floats of the
+/// output. Returns how many were decoded, at most max_values.
+static uint32 DecodeFloats(const FloatArray& array,
+                           const char* end,
+                           float32* output,
+                           const uint32 stride,
+                           const uint32 max_values) {
+  const char* cursor = array.text;
+  uint32 num_values = 0;
+  while (num_values < max_values && DecodeFloat(cursor, end, output + num_values * stride)) {
+    ++num_values;
+  }
+  return num_values;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+AnimationClip::AnimationClip() {
+  num_bones_ = 0;
+  duration_ = 0.0f;
+}
+
+AnimationClip::~AnimationClip() {
+  translation_tracks_.clear();
+  rotation_tracks_.clear();
+  translation_times_.clear();
+  translation_keys_.clear();
+  rotation_times_.clear();
+  rotation_keys_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+bool AnimationClip::initFromFile(const char* filename,
+                                 const Skeleton& skeleton,
+                                 const float32 translation_scale) {
+
+  FileView file;
+  const char* cursor = nullptr;
+  const char* end = nullptr;
+  if (Core::instance().vfs_.open(filename, file)) {
+    cursor = (const char*)file.data();
+    end = cursor + file.size();
+  }
+  if (!cursor || !NextTag(cursor, end)) {
+    MessageBox(NULL, "Error loading animation from file", "ERROR", MB_OK);
+    return false;
+  }
+
+  num_bones_ = skeleton.num_bones();
+  translation_tracks_.assign(num_bones_, { 0, 0 });
+  rotation_tracks_.assign(num_bones_, { 0, 0 });
+  duration_ = 0.0f;
+
+  // Single pull through the mapped file, no document is built. Every
+  // "<bone>.<channel>" animation of the skeleton gets its first float array
+  // as times and the second as values, kept as text until decoded below.
+  std::vector<ChannelArrays> channels(num_bones_ * kNumChannelTypes, { { nullptr, 0 }, { nullptr, 0 } });
+  ChannelArrays* channel = nullptr;
+  uint32 num_arrays = 0;
+  std::string bone_name;
+  do {
+    if (IsTag(cursor, end, "/animation")) {
+      channel = nullptr;
+    }
+    else if (IsTag(cursor, end, "animation")) {
+      channel = nullptr;
+      num_arrays = 0;
+      const char* id = nullptr;
+      uint32 length = 0;
+      if (!FindAttribute(cursor, end, "id", &id, &length)) { continue; }
+      const char* dot = id + length;
+      while (dot > id && *(dot - 1) != '.') { --dot; }
+      if (dot == id) { continue; }
+      const ChannelType type = FindChannelType(dot, (uint32)(id + length - dot));
+      if (type == kNumChannelTypes) { continue; }
+      bone_name.assign(id, dot - 1);
+      const uint32 bone = skeleton.find(bone_name.c_str());
+      if (bone == Skeleton::kNoBone) { continue; }
+      channel = &channels[bone * kNumChannelTypes + type];
+    }
+    else if (channel && num_arrays < 2 && IsTag(cursor, end, "float_array")) {
+      const char* count = nullptr;
+      uint32 length = 0;
+      FloatArray array = { TagText(cursor, end), 0 };
+      if (FindAttribute(cursor, end, "count", &count, &length)) {
+        for (uint32 i = 0; i < length && IsDigit(count[i]); ++i) {
+          array.count = array.count * 10 + (count[i] - '0');
+        }
+      }
+      (num_arrays++ == 0 ? channel->times : channel->values) = array;
+    }
+  } while (NextTag(cursor, end));
+
+  // Key storage allocated once, from the counts declared.
+  uint32 num_translation_keys = 0;
+  uint32 num_rotation_keys = 0;
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+    const ChannelArrays* bone_channels = &channels[bone * kNumChannelTypes];
+    if (bone_channels[kChannelTranslate].values.text) {
+      num_translation_keys += bone_channels[kChannelTranslate].times.count;
+    }
+    if (bone_channels[kChannelRotateX].values.text) {
+      num_rotation_keys += bone_channels[kChannelRotateX].times.count;
+    }
+  }
+  translation_times_.resize(num_translation_keys);
+  translation_keys_.resize(num_translation_keys);
+  rotation_times_.resize(num_rotation_keys);
+  rotation_keys_.resize(num_rotation_keys);
+  uint32 translation_end = 0;
+  uint32 rotation_end = 0;
+
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+    const ChannelArrays* bone_channels = &channels[bone * kNumChannelTypes];
+
+    // Translation, xyz per key, decoded in place into the keys.
+    const ChannelArrays& translation = bone_channels[kChannelTranslate];
+    if (translation.values.text) {
+      const uint32 max_keys = num_translation_keys - translation_end;
+      uint32 num_keys = DecodeFloats(translation.times, end,
+                                     translation_times_.data() + translation_end, 1, max_keys);
+      const uint32 num_values = DecodeFloats(translation.values, end,
+                                             (float32*)(translation_keys_.data() + translation_end),
+                                             1, num_keys * 3);
+      if (num_values / 3 < num_keys) { num_keys = num_values / 3; }
+      translation_tracks_[bone] = { translation_end, num_keys };
+      for (uint32 k = translation_end; k < translation_end + num_keys; ++k) {
+        translation_keys_[k].x *= translation_scale;
+        translation_keys_[k].y *= translation_scale;
+        translation_keys_[k].z *= translation_scale;
+      }
+      translation_end += num_keys;
+      if (num_keys > 0 && translation_times_[translation_end - 1] > duration_) {
+        duration_ = translation_times_[translation_end - 1];
+      }
+    }
+
+    // Rotation, one channel of degrees per axis, decoded into the xyz of
+    // the keys and turned into quaternions there.
+    const ChannelArrays* rotation = &bone_channels[kChannelRotateX];
+    if (!rotation[0].values.text || !rotation[1].values.text || !rotation[2].values.text) {
+      continue;
+    }
+    const uint32 max_keys = num_rotation_keys - rotation_end;
+    const uint32 num_keys = DecodeFloats(rotation[0].times, end,
+                                         rotation_times_.data() + rotation_end, 1, max_keys);
+    float32* euler = (float32*)(rotation_keys_.data() + rotation_end);
+    for (uint32 axis = 0; axis < 3; ++axis) {
+      if (rotation[axis].values.count != num_keys ||
+          DecodeFloats(rotation[axis].values, end, euler + axis, 4, num_keys) != num_keys) {
+        MessageBox(NULL, "Error loading animation, rotation axes with different keys", "ERROR", MB_OK);
+        return false;
+      }
+    }
+    rotation_tracks_[bone] = { rotation_end, num_keys };
+    for (uint32 k = rotation_end; k < rotation_end + num_keys; ++k) {
+      DirectX::XMFLOAT3 radians = { DirectX::XMConvertToRadians(rotation_keys_[k].x),
+                                    DirectX::XMConvertToRadians(rotation_keys_[k].y),
+                                    DirectX::XMConvertToRadians(rotation_keys_[k].z) };
+      rotation_keys_[k] = Math::ConvertEulerToQuaternionFloat4(radians);
+    }
+    rotation_end += num_keys;
+    if (num_keys > 0 && rotation_times_[rotation_end - 1] > duration_) {
+      duration_ = rotation_times_[rotation_end - 1];
+    }
+  }
+
+  // Arrays shorter than declared leave unused keys at the end.
+  translation_times_.resize(translation_end);
+  translation_keys_.resize(translation_end);
+  rotation_times_.resize(rotation_end);
+  rotation_keys_.resize(rotation_end);
+
+  return true;
+}
+
+void AnimationClip::sample(const float32 time, Pose* pose) const {
+  float32 alpha = 0.0f;
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+
+    const Track& translation = translation_tracks_[bone];
+    if (translation.num_keys > 0) {
+      const uint32 key = FindKey(translation_times_.data() + translation.first_key,
+                                 translation.num_keys, time, &alpha);
+      const DirectX::XMFLOAT3& origin = translation_keys_[translation.first_key + key];
+      const DirectX::XMFLOAT3& destiny = translation_keys_[translation.first_key + key +
+                                                           (key + 1 < translation.num_keys)];
+      pose->translation_x[bone] = origin.x + (destiny.x - origin.x) * alpha;
+      pose->translation_y[bone] = origin.y + (destiny.y - origin.y) * alpha;
+      pose->translation_z[bone] = origin.z + (destiny.z - origin.z) * alpha;
+    }
+
+    const Track& rotation = rotation_tracks_[bone];
+    if (rotation.num_keys > 0) {
+      const uint32 key = FindKey(rotation_times_.data() + rotation.first_key,
+                                 rotation.num_keys, time, &alpha);
+      const DirectX::XMFLOAT4& origin = rotation_keys_[rotation.first_key + key];
+      const DirectX::XMFLOAT4& destiny = rotation_keys_[rotation.first_key + key +
+                                                        (key + 1 < rotation.num_keys)];
+      DirectX::XMFLOAT4 quaternion = Math::QuaternionLerpFloat4(origin, destiny, alpha);
+      pose->rotation_x[bone] = quaternion.x;
+      pose->rotation_y[bone] = quaternion.y;
+      pose->rotation_z[bone] = quaternion.z;
+      pose->rotation_w[bone] = quaternion.w;
+    }
+  }
+}
+
+float32 AnimationClip::nextKeyTime(const float32 time) const {
+  float32 first = duration_;
+  float32 next = duration_;
+  bool found = false;
+  const std::vector<float32>* all_times[] = { &translation_times_, &rotation_times_ };
+  for (uint32 i = 0; i < 2; ++i) {
+    for (uint32 k = 0; k < all_times[i]->size(); ++k) {
+      const float32 key_time = (*all_times[i])[k];
+      if (key_time < first) { first = key_time; }
+      if (key_time > time && (!found || key_time < next)) {
+        next = key_time;
+        found = true;
+      }
+    }
+  }
+  return found ? next : first;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 AnimationClip::memory() const {
+  return (translation_tracks_.size() + rotation_tracks_.size()) * sizeof(Track) +
+         (translation_times_.size() + rotation_times_.size()) * sizeof(float32) +
+         translation_keys_.size() * sizeof(DirectX::XMFLOAT3) +
+         rotation_keys_.size() * sizeof(DirectX::XMFLOAT4);
+}
+
+}; /* W3D */
@@ -0,0 +1,106 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/animation_clip_cache.h"
+#include "core/core.h"
+
+namespace W3D {
+
+/// Whether two poses have the same bones in the same place.
+static bool SamePose(const Pose& a, const Pose& b) {
+  return a.num_bones == b.num_bones &&
+         a.translation_x == b.translation_x &&
+         a.translation_y == b.translation_y &&
+         a.translation_z == b.translation_z &&
+         a.rotation_x == b.rotation_x &&
+         a.rotation_y == b.rotation_y &&
+         a.rotation_z == b.rotation_z &&
+         a.rotation_w == b.rotation_w;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+AnimationClipCache::AnimationClipCache() {
+  stats_ = { 0, 0, 0, 0.0, 0, 0, 0.0 };
+}
+
+AnimationClipCache::~AnimationClipCache() {
+  clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+const AnimationClip* AnimationClipCache::load(const char* filename,
+                                              const Skeleton& skeleton,
+                                              const float32 translation_scale) {
+
+  auto found = clips_.find(filename);
+  if (found != clips_.end()) {
+    stats_.num_shared++;
+    return found->second.get();
+  }
+
+  uint64 start = TimeInMicroSeconds();
+  std::unique_ptr<AnimationClip> clip(new AnimationClip());
+  if (!clip->initFromFile(filename, skeleton, translation_scale)) { clip.reset(); }
+  stats_.load_ms += (float64)(TimeInMicroSeconds() - start) * 0.001;
+
+  const AnimationClip* result = clip.get();
+  if (result) {
+    stats_.num_clips++;
+    stats_.memory += result->memory();
+  }
+  clips_[filename] = std::move(clip);
+  return result;
+}
+
+const BakedAnimationClip* AnimationClipCache::bake(const AnimationClip* clip,
+                                                   const Skeleton& skeleton,
+                                                   const Pose& rest_pose,
+                                                   const float32 sample_rate,
+                                                   const BakedAnimationClip::Format format) {
+  if (!clip) { return nullptr; }
+  for (uint32 i = 0; i < baked_clips_.size(); ++i) {
+    const BakedAnimationClip* baked = baked_clips_[i].get();
+    if (baked->source_ == clip && baked->sample_rate_ == sample_rate && baked->format_ == format &&
+        SamePose(baked->rest_pose_, rest_pose)) {
+      return baked;
+    }
+  }
+
+  uint64 start = TimeInMicroSeconds();
+  std::unique_ptr<BakedAnimationClip> baked(new BakedAnimationClip());
+  baked->init(*clip, skeleton, rest_pose, sample_rate, format);
+  stats_.bake_ms += (float64)(TimeInMicroSeconds() - start) * 0.001;
+  stats_.num_baked++;
+  stats_.baked_memory += baked->memory();
+  baked_clips_.push_back(std::move(baked));
+  return baked_clips_.back().get();
+}
+
+void AnimationClipCache::clear() {
+  baked_clips_.clear();
+  clips_.clear();
+  stats_.num_clips = 0;
+  stats_.memory = 0;
+  stats_.num_baked = 0;
+  stats_.baked_memory = 0;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+const AnimationClipCache::Stats& AnimationClipCache::stats() const {
+  return stats_;
+}
+
+}; /* W3D */
@@ -0,0 +1,188 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/animation_crowd.h"
+#include "core/core.h"
+#include <math.h>
+
+namespace W3D {
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+AnimationCrowd::AnimationCrowd() {
+  skeleton_ = nullptr;
+  stats_ = { 0, 0.0, 0.0 };
+}
+
+AnimationCrowd::~AnimationCrowd() {
+  instances_.clear();
+  poses_.clear();
+  roots_.clear();
+  world_matrices_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void AnimationCrowd::init(const Skeleton* skeleton, const Pose& rest_pose) {
+  skeleton_ = skeleton;
+  rest_pose_ = rest_pose;
+  if (rest_pose_.num_bones != num_bones()) { rest_pose_.resize(num_bones()); }
+  instances_.clear();
+  poses_.clear();
+  roots_.clear();
+  world_matrices_.clear();
+}
+
+uint32 AnimationCrowd::addInstance(const AnimationClip* clip,
+                                   const DirectX::XMMATRIX& root,
+                                   const float32 time) {
+  const uint32 instance = (uint32)instances_.size();
+  instances_.push_back({ clip, nullptr, true, time, 1.0f });
+  poses_.push_back(rest_pose_);
+  roots_.push_back(DirectX::XMFLOAT4X4());
+  set_root(instance, root);
+  world_matrices_.resize(world_matrices_.size() + num_bones());
+  return instance;
+}
+
+void AnimationCrowd::play(const uint32 instance, const AnimationClip* clip, const float32 time) {
+  instances_[instance].clip = clip;
+  instances_[instance].baked = nullptr;
+  instances_[instance].time = time;
+}
+
+void AnimationCrowd::playBaked(const uint32 instance,
+                               const BakedAnimationClip* baked,
+                               const bool interpolate,
+                               const float32 time) {
+  instances_[instance].clip = baked ? baked->source_ : nullptr;
+  instances_[instance].baked = baked;
+  instances_[instance].interpolate = interpolate;
+  instances_[instance].time = time;
+}
+
+void AnimationCrowd::update(const float32 delta_time, const bool parallel) {
+  const uint32 count = num_instances();
+  auto& jobs = Core::instance().jobs_;
+
+  uint64 start = TimeInMicroSeconds();
+  if (parallel) {
+    jobs.parallelFor(count, kInstancesPerJob, [this, delta_time](uint32 begin, uint32 end) {
+      sampleInstances(begin, end, delta_time);
+    });
+  }
+  else {
+    sampleInstances(0, count, delta_time);
+  }
+  uint64 composed = TimeInMicroSeconds();
+  if (parallel) {
+    jobs.parallelFor(count, kInstancesPerJob, [this](uint32 begin, uint32 end) {
+      composeInstances(begin, end);
+    });
+  }
+  else {
+    composeInstances(0, count);
+  }
+
+  stats_.num_instances = count;
+  stats_.sample_ms = (float64)(composed - start) * 0.001;
+  stats_.compose_ms = (float64)(TimeInMicroSeconds() - composed) * 0.001;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 AnimationCrowd::num_instances() const {
+  return (uint32)instances_.size();
+}
+
+uint32 AnimationCrowd::num_bones() const {
+  return skeleton_ ? skeleton_->num_bones() : 0;
+}
+
+const Pose& AnimationCrowd::pose(const uint32 instance) const {
+  return poses_[instance];
+}
+
+const DirectX::XMFLOAT4X4* AnimationCrowd::world_matrices(const uint32 instance) const {
+  return world_matrices_.data() + instance * num_bones();
+}
+
+void AnimationCrowd::set_root(const uint32 instance, const DirectX::XMMATRIX& root) {
+  DirectX::XMStoreFloat4x4(&roots_[instance], root);
+}
+
+void AnimationCrowd::set_speed(const uint32 instance, const float32 speed) {
+  instances_[instance].speed = speed;
+}
+
+const AnimationCrowd::Stats& AnimationCrowd::stats() const {
+  return stats_;
+}
+
+/*******************************************************************************
+***                           Private methods                                ***
+*******************************************************************************/
+
+void AnimationCrowd::sampleInstances(const uint32 begin,
+                                     const uint32 end,
+                                     const float32 delta_time) {
+  for (uint32 i = begin; i < end; ++i) {
+    Instance& instance = instances_[i];
+    if (!instance.clip && !instance.baked) { continue; }
+    const float32 duration = instance.baked ? instance.baked->duration_ : instance.clip->duration_;
+    instance.time += delta_time * instance.speed;
+    if (duration > 0.0f) {
+      instance.time = fmodf(instance.time, duration);
+      if (instance.time < 0.0f) { instance.time += duration; }
+    }
+    if (!instance.baked) {
+      instance.clip->sample(instance.time, &poses_[i]);
+    }
+    else if (instance.baked->format_ == BakedAnimationClip::kFormat_Pose) {
+      instance.baked->sample(instance.time, instance.interpolate, &poses_[i]);
+    }
+  }
+}
+
+void AnimationCrowd::composeInstances(const uint32 begin, const uint32 end) {
+  const uint32 bones = num_bones();
+  for (uint32 i = begin; i < end; ++i) {
+    const Pose& pose = poses_[i];
+    const DirectX::XMMATRIX root = DirectX::XMLoadFloat4x4(&roots_[i]);
+    DirectX::XMFLOAT4X4* world = world_matrices_.data() + i * bones;
+    const BakedAnimationClip* baked = instances_[i].baked;
+    if (baked && baked->format_ == BakedAnimationClip::kFormat_ModelMatrices) {
+      baked->sampleMatrices(instances_[i].time, instances_[i].interpolate, root, world);
+      continue;
+    }
+
+    // Row vector matrices while composing, parents are always done before.
+    for (uint32 bone = 0; bone < bones; ++bone) {
+      DirectX::XMVECTOR rotation = DirectX::XMVectorSet(pose.rotation_x[bone], pose.rotation_y[bone],
+                                                        pose.rotation_z[bone], pose.rotation_w[bone]);
+      DirectX::XMMATRIX local = DirectX::XMMatrixRotationQuaternion(DirectX::XMQuaternionNormalize(rotation));
+      local.r[3] = DirectX::XMVectorSet(pose.translation_x[bone], pose.translation_y[bone],
+                                        pose.translation_z[bone], 1.0f);
+      const uint32 parent = skeleton_->parent(bone);
+      DirectX::XMMATRIX parent_world = parent != Skeleton::kNoBone ?
+                                       DirectX::XMLoadFloat4x4(&world[parent]) : root;
+      DirectX::XMStoreFloat4x4(&world[bone], DirectX::XMMatrixMultiply(local, parent_world));
+    }
+    // Transposed at the end, as the transform component stores them.
+    for (uint32 bone = 0; bone < bones; ++bone) {
+      DirectX::XMStoreFloat4x4(&world[bone], DirectX::XMMatrixTranspose(DirectX::XMLoadFloat4x4(&world[bone])));
+    }
+  }
+}
+
+}; /* W3D */
@@ -0,0 +1,159 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/async_loader.h"
+#include "core/core.h"
+#include <thread>
+
+namespace W3D {
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+AsyncLoader::AsyncLoader() {
+  frame_budget_ms_ = 2.0f;
+  ZeroMemory(&stats_, sizeof(LoadStats));
+}
+
+AsyncLoader::~AsyncLoader() {
+  for (uint32 i = 0; i < in_flight_.size(); ++i) {
+    delete in_flight_[i];
+  }
+  in_flight_.clear();
+  parsed_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void AsyncLoader::load(const void* resource,
+                       const std::function<bool(const char**)>& parse,
+                       const std::function<bool(const bool)>& upload,
+                       const LoadCallback& callback) {
+
+  Request* request = new Request();
+  request->resource = resource;
+  request->upload = upload;
+  if (callback) { request->callbacks.push_back(callback); }
+  request->parsed = false;
+  request->parse_ms = 0.0f;
+  request->error = nullptr;
+
+  in_flight_.push_back(request);
+  stats_.num_pending++;
+
+  Core::instance().jobs_.submit([this, request, parse]() {
+    uint64 start = TimeInMicroSeconds();
+    request->parsed = parse(&request->error);
+    request->parse_ms = (float32)(TimeInMicroSeconds() - start) * 0.001f;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    parsed_.push_back(request);
+  });
+}
+
+bool AsyncLoader::addCallback(const void* resource, const LoadCallback& callback) {
+  for (uint32 i = 0; i < in_flight_.size(); ++i) {
+    if (in_flight_[i]->resource == resource) {
+      if (callback) { in_flight_[i]->callbacks.push_back(callback); }
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncLoader::update() {
+  stats_.last_frame_uploads = 0;
+  stats_.last_frame_upload_ms = 0.0f;
+  if (in_flight_.empty()) { return; }
+  process(true);
+}
+
+void AsyncLoader::flush() {
+  while (!in_flight_.empty()) {
+    if (process(false) == 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+uint32 AsyncLoader::process(const bool use_budget) {
+
+  uint32 num_finished = 0;
+  uint64 start = TimeInMicroSeconds();
+
+  while (true) {
+    Request* request = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (parsed_.empty()) { break; }
+      request = parsed_.front();
+      parsed_.pop_front();
+    }
+
+    finish(request);
+    num_finished++;
+
+    // At least one upload per frame, so the loading never stalls.
+    float32 elapsed_ms = (float32)(TimeInMicroSeconds() - start) * 0.001f;
+    if (use_budget && elapsed_ms >= frame_budget_ms_) { break; }
+  }
+
+  return num_finished;
+}
+
+void AsyncLoader::finish(Request* request) {
+
+  // Reported here, the parse step runs in a worker.
+  if (request->error) { MessageBox(NULL, request->error, "ERROR", MB_OK); }
+
+  uint64 start = TimeInMicroSeconds();
+  bool loaded = request->upload(request->parsed);
+  if (request->parsed) {
+    float32 upload_ms = (float32)(TimeInMicroSeconds() - start) * 0.001f;
+    stats_.total_upload_ms += upload_ms;
+    stats_.last_frame_upload_ms += upload_ms;
+    stats_.last_frame_uploads++;
+  }
+
+  stats_.total_parse_ms += request->parse_ms;
+  stats_.num_pending--;
+  if (loaded) { stats_.num_completed++; }
+  else { stats_.num_failed++; }
+
+  for (uint32 i = 0; i < in_flight_.size(); ++i) {
+    if (in_flight_[i] == request) {
+      in_flight_.erase(in_flight_.begin() + i);
+      break;
+    }
+  }
+
+  for (uint32 i = 0; i < request->callbacks.size(); ++i) {
+    request->callbacks[i](loaded);
+  }
+  delete request;
+}
+
+/*******************************************************************************
+***                             Public functions                             ***
+*******************************************************************************/
+
+void ReportLoadError(const char* message, const char** error) {
+  if (error) {
+    *error = message;
+    return;
+  }
+  MessageBox(NULL, message, "ERROR", MB_OK);
+}
+
+}; /* W3D */
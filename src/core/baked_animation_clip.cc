@@ -0,0 +1,218 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/baked_animation_clip.h"
+#include <math.h>
+#include <string.h>
+
+namespace W3D {
+
+/// Components of every bone in a pose frame.
+const uint32 kBakedPoseComponents = 7;
+
+/// Components of a pose, in the order of the baked frames.
+static std::vector<float32>* PoseComponent(Pose& pose, const uint32 component) {
+  std::vector<float32>* components[kBakedPoseComponents] = {
+    &pose.translation_x, &pose.translation_y, &pose.translation_z,
+    &pose.rotation_x, &pose.rotation_y, &pose.rotation_z, &pose.rotation_w,
+  };
+  return components[component];
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+BakedAnimationClip::BakedAnimationClip() {
+  source_ = nullptr;
+  sample_rate_ = 0.0f;
+  format_ = kFormat_Pose;
+  num_bones_ = 0;
+  num_padded_bones_ = 0;
+  num_frames_ = 0;
+  frame_duration_ = 0.0f;
+  duration_ = 0.0f;
+}
+
+BakedAnimationClip::~BakedAnimationClip() {
+  poses_.clear();
+  model_matrices_.clear();
+  rest_pose_ = Pose();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void BakedAnimationClip::init(const AnimationClip& clip,
+                              const Skeleton& skeleton,
+                              const Pose& rest_pose,
+                              const float32 sample_rate,
+                              const Format format) {
+
+  source_ = &clip;
+  sample_rate_ = sample_rate;
+  format_ = format;
+  rest_pose_ = rest_pose;
+  num_bones_ = clip.num_bones_;
+  num_padded_bones_ = (num_bones_ + 3) & ~3;
+  duration_ = clip.duration_;
+  const uint32 intervals = duration_ > 0.0f && sample_rate > 0.0f ?
+                           (uint32)ceilf(duration_ * sample_rate) : 0;
+  num_frames_ = intervals + 1;
+  frame_duration_ = intervals > 0 ? duration_ / (float32)intervals : 0.0f;
+  poses_.clear();
+  model_matrices_.clear();
+  if (format_ == kFormat_Pose) {
+    poses_.resize(num_frames_ * kBakedPoseComponents * num_padded_bones_);
+  }
+  else {
+    model_matrices_.resize(num_frames_ * num_bones_);
+  }
+
+  Pose pose;
+  std::vector<DirectX::XMFLOAT4X4> model(num_bones_);
+  for (uint32 frame = 0; frame < num_frames_; ++frame) {
+    pose = rest_pose;
+    if (pose.num_bones < num_bones_) { pose.resize(num_bones_); }
+    clip.sample(frame_duration_ * (float32)frame, &pose);
+
+    if (format_ == kFormat_Pose) {
+      float32* frame_data = &poses_[frame * kBakedPoseComponents * num_padded_bones_];
+      for (uint32 component = 0; component < kBakedPoseComponents; ++component) {
+        memcpy(frame_data + component * num_padded_bones_, PoseComponent(pose, component)->data(),
+               num_padded_bones_ * sizeof(float32));
+      }
+      continue;
+    }
+
+    // Row vector matrices, parents are always done before.
+    for (uint32 bone = 0; bone < num_bones_; ++bone) {
+      DirectX::XMVECTOR rotation = DirectX::XMVectorSet(pose.rotation_x[bone], pose.rotation_y[bone],
+                                                        pose.rotation_z[bone], pose.rotation_w[bone]);
+      DirectX::XMMATRIX local = DirectX::XMMatrixRotationQuaternion(DirectX::XMQuaternionNormalize(rotation));
+      local.r[3] = DirectX::XMVectorSet(pose.translation_x[bone], pose.translation_y[bone],
+                                        pose.translation_z[bone], 1.0f);
+      const uint32 parent = skeleton.parent(bone);
+      if (parent != Skeleton::kNoBone) {
+        local = DirectX::XMMatrixMultiply(local, DirectX::XMLoadFloat4x4(&model[parent]));
+      }
+      DirectX::XMStoreFloat4x4(&model[bone], local);
+      DirectX::XMStoreFloat4x3(&model_matrices_[frame * num_bones_ + bone], local);
+    }
+  }
+}
+
+void BakedAnimationClip::sample(const float32 time, const bool interpolate, Pose* pose) const {
+  if (format_ != kFormat_Pose || num_frames_ == 0) { return; }
+
+  uint32 first, second;
+  float32 alpha;
+  findFrames(time, &first, &second, &alpha);
+  const float32* a = &poses_[first * kBakedPoseComponents * num_padded_bones_];
+  if (!interpolate || first == second) {
+    const float32* frame_data = alpha < 0.5f ? a : &poses_[second * kBakedPoseComponents * num_padded_bones_];
+    for (uint32 component = 0; component < kBakedPoseComponents; ++component) {
+      memcpy(PoseComponent(*pose, component)->data(), frame_data + component * num_padded_bones_,
+             num_padded_bones_ * sizeof(float32));
+    }
+    return;
+  }
+
+  // Four bones at a time, rotations by normalized lerp on the shortest path.
+  const float32* b = &poses_[second * kBakedPoseComponents * num_padded_bones_];
+  const DirectX::XMVECTOR weight = DirectX::XMVectorReplicate(alpha);
+  for (uint32 bone = 0; bone < num_padded_bones_; bone += 4) {
+    DirectX::XMVECTOR from[kBakedPoseComponents];
+    DirectX::XMVECTOR to[kBakedPoseComponents];
+    for (uint32 component = 0; component < kBakedPoseComponents; ++component) {
+      from[component] = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&a[component * num_padded_bones_ + bone]);
+      to[component] = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&b[component * num_padded_bones_ + bone]);
+    }
+    DirectX::XMVECTOR dot = DirectX::XMVectorMultiply(from[3], to[3]);
+    dot = DirectX::XMVectorMultiplyAdd(from[4], to[4], dot);
+    dot = DirectX::XMVectorMultiplyAdd(from[5], to[5], dot);
+    dot = DirectX::XMVectorMultiplyAdd(from[6], to[6], dot);
+    const DirectX::XMVECTOR flip = DirectX::XMVectorLess(dot, DirectX::XMVectorZero());
+    for (uint32 component = 3; component < kBakedPoseComponents; ++component) {
+      to[component] = DirectX::XMVectorSelect(to[component], DirectX::XMVectorNegate(to[component]), flip);
+    }
+
+    DirectX::XMVECTOR result[kBakedPoseComponents];
+    for (uint32 component = 0; component < kBakedPoseComponents; ++component) {
+      result[component] = DirectX::XMVectorLerpV(from[component], to[component], weight);
+    }
+    DirectX::XMVECTOR length_sq = DirectX::XMVectorMultiply(result[3], result[3]);
+    length_sq = DirectX::XMVectorMultiplyAdd(result[4], result[4], length_sq);
+    length_sq = DirectX::XMVectorMultiplyAdd(result[5], result[5], length_sq);
+    length_sq = DirectX::XMVectorMultiplyAdd(result[6], result[6], length_sq);
+    const DirectX::XMVECTOR inverse_length = DirectX::XMVectorReciprocalSqrt(length_sq);
+    for (uint32 component = 0; component < kBakedPoseComponents; ++component) {
+      if (component >= 3) { result[component] = DirectX::XMVectorMultiply(result[component], inverse_length); }
+      DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&(*PoseComponent(*pose, component))[bone], result[component]);
+    }
+  }
+}
+
+void BakedAnimationClip::sampleMatrices(const float32 time,
+                                        const bool interpolate,
+                                        const DirectX::XMMATRIX& root,
+                                        DirectX::XMFLOAT4X4* world_matrices) const {
+  if (format_ != kFormat_ModelMatrices || num_frames_ == 0) { return; }
+
+  uint32 first, second;
+  float32 alpha;
+  findFrames(time, &first, &second, &alpha);
+  if (!interpolate && alpha >= 0.5f) { first = second; }
+  const DirectX::XMFLOAT4X3* a = &model_matrices_[first * num_bones_];
+  const DirectX::XMFLOAT4X3* b = &model_matrices_[second * num_bones_];
+
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+    DirectX::XMMATRIX model = DirectX::XMLoadFloat4x3(&a[bone]);
+    if (interpolate && first != second) {
+      const DirectX::XMMATRIX next = DirectX::XMLoadFloat4x3(&b[bone]);
+      for (uint32 row = 0; row < 4; ++row) {
+        model.r[row] = DirectX::XMVectorLerp(model.r[row], next.r[row], alpha);
+      }
+    }
+    DirectX::XMStoreFloat4x4(&world_matrices[bone],
+                             DirectX::XMMatrixTranspose(DirectX::XMMatrixMultiply(model, root)));
+  }
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 BakedAnimationClip::memory() const {
+  return (uint32)(poses_.size() * sizeof(float32) +
+                  model_matrices_.size() * sizeof(DirectX::XMFLOAT4X3));
+}
+
+/*******************************************************************************
+***                           Private methods                                ***
+*******************************************************************************/
+
+void BakedAnimationClip::findFrames(const float32 time,
+                                    uint32* first,
+                                    uint32* second,
+                                    float32* alpha) const {
+  if (num_frames_ < 2) {
+    *first = *second = 0;
+    *alpha = 0.0f;
+    return;
+  }
+  float32 wrapped = fmodf(time, duration_);
+  if (wrapped < 0.0f) { wrapped += duration_; }
+  const float32 frame = wrapped / frame_duration_;
+  *first = (uint32)frame;
+  if (*first >= num_frames_ - 1) { *first = num_frames_ - 2; }
+  *second = *first + 1;
+  *alpha = frame - (float32)*first;
+}
+
+}; /* W3D */
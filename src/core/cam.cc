@@ -34,6 +34,7 @@ Cam::Cam() {
   rotation_speed_ = 0.005f;
   last_mouse_position_ = { 0.0f, 0.0f };
   is_navigation_enabled_ = true;
+  is_occlusion_culling_enabled_ = false;
   setupPerspective(45.0f, 1024.0f / 978.0f, 0.1f, 1000.0f);
   setupView();
 }
@@ -92,13 +93,14 @@ void Cam::setupView() {
 
 void Cam::render(Entity* entity) {
 
-  if (entity->render3D()) {
-    entity->render3D()->render(&entity->transform());
-  }
-  uint32 num_children = entity->children_.size();
-  for (uint32 i = 0; i < num_children; i++) {
-    render(entity->children_[i]);
+  if (is_occlusion_culling_enabled_) {
+    auto& culler = Core::instance().occlusion_culler_;
+    culler.beginFrame(DirectX::XMMatrixMultiply(view_matrix(), projection_matrix()),
+                      Core::instance().jobs_);
+    addOccluders(entity);
+    culler.rasterize();
   }
+  renderEntity(entity);
 }
 
 /*******************************************************************************
@@ -354,4 +356,28 @@ void Cam::updateLerping(const float32& delta) {
 
 }
 
+void Cam::addOccluders(Entity* entity) {
+
+  if (entity->render3D()) {
+    entity->render3D()->addOccluder(&entity->transform());
+  }
+  uint32 num_children = entity->children_.size();
+  for (uint32 i = 0; i < num_children; i++) {
+    addOccluders(entity->children_[i]);
+  }
+}
+
+void Cam::renderEntity(Entity* entity) {
+
+  // Children are tested apart, they may stick out of their parent.
+  if (entity->render3D() &&
+      !(is_occlusion_culling_enabled_ && entity->render3D()->isOccluded(&entity->transform()))) {
+    entity->render3D()->render(&entity->transform());
+  }
+  uint32 num_children = entity->children_.size();
+  for (uint32 i = 0; i < num_children; i++) {
+    renderEntity(entity->children_[i]);
+  }
+}
+
 }; /* W3D */
@@ -8,6 +8,8 @@
 #include "core/components/render.h"
 #include "core/geo.h"
 #include "core/super_material.h"
+#include "core/terrain_quadtree.h"
+#include "core/terrain_streamer.h"
 #include "core/entity.h"
 #include "core/core.h"
 
@@ -20,6 +22,8 @@ namespace W3D {
 
 RenderComponent::RenderComponent() {
   initialized_ = false;
+  lod_ = 0;
+  occluder_ = false;
 }
 
 RenderComponent::~RenderComponent() {
@@ -34,6 +38,7 @@ RenderComponent::~RenderComponent() {
 void RenderComponent::init(Material* mat, Geometry* geo) {
   material_ = mat;
   geometry_ = geo;
+  lod_ = 0;
   if (!geo) { geometry_ = &Core::instance().error_geometry_; }
   if (mat) { initialized_ = true; }
 }
@@ -52,20 +57,66 @@ void RenderComponent::render(TransformComponent* transform) {
     // Setup the super material depending on the type of user's material associated.
     material_->setupSuperMaterial();
     // Preparing the device context to draw.
-    setupDeviceContext();
+    setupDeviceContext(transform);
       
   }
 }
 
+void RenderComponent::addOccluder(TransformComponent* transform) {
+  if (!initialized_ || !occluder_) { return; }
+
+  auto& core = Core::instance();
+  Geo* geometry = core.geometry_factory_[geometry_->id()];
+  if (geometry->load_state_ != Geo::kLoadState_Ready || geometry->occluder_indices_.empty()) {
+    return;
+  }
+  core.occlusion_culler_.addOccluder(geometry->occluder_positions_.data(),
+                                     geometry->occluder_positions_.size(),
+                                     geometry->occluder_indices_.data(),
+                                     geometry->occluder_indices_.size(),
+                                     DirectX::XMMatrixTranspose(transform->global_model_matrix()));
+}
+
+bool RenderComponent::isOccluded(TransformComponent* transform) {
+  if (!initialized_ || occluder_) { return false; }
+
+  auto& core = Core::instance();
+  Geo* geometry = core.geometry_factory_[geometry_->id()];
+  // Unknown bounds, drawn always.
+  const DirectX::XMFLOAT3& extents = geometry->bounding_box_.Extents;
+  if (geometry->load_state_ != Geo::kLoadState_Ready ||
+      (extents.x == 0.0f && extents.y == 0.0f && extents.z == 0.0f)) {
+    return false;
+  }
+  return !core.occlusion_culler_.testBox(geometry->bounding_box_,
+                                         DirectX::XMMatrixTranspose(transform->global_model_matrix()));
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+void RenderComponent::set_occluder(const bool occluder) {
+  occluder_ = occluder;
+}
+
+bool RenderComponent::occluder() const {
+  return occluder_;
+}
+
 /*******************************************************************************
 ***                              Private methods                             ***
 *******************************************************************************/
 
-void RenderComponent::setupDeviceContext() {
+void RenderComponent::setupDeviceContext(TransformComponent* transform) {
   auto& core = Core::instance();
   auto* device_context = core.d3d_.deviceContext();
   auto& super_mat = core.super_material_;
   Geo* geometry = core.geometry_factory_[geometry_->id()];
+  // Geometries still loading are rendered as the error geometry.
+  if (geometry->load_state_ != Geo::kLoadState_Ready) {
+    geometry = core.geometry_factory_[core.error_geometry_.id()];
+  }
 
   D3D11_MAPPED_SUBRESOURCE shader_constant_buffer;
   ZeroMemory(&shader_constant_buffer, sizeof(D3D11_MAPPED_SUBRESOURCE));
@@ -73,19 +124,185 @@ void RenderComponent::setupDeviceContext() {
   memcpy(shader_constant_buffer.pData, &super_mat.settings_, sizeof(MaterialSettings));
   device_context->Unmap(super_mat.buffer_, 0);
 
-  uint32 stride = sizeof(Geo::VertexData);
-  uint32 offset = 0;
-
   device_context->OMSetBlendState(core.d3d_.blendState(), 0, 0xffffffff);
-  device_context->IASetVertexBuffers(0, 1, &geometry->vertex_buffer_, &stride, &offset);
-  device_context->IASetIndexBuffer(geometry->vertex_index_buffer_, DXGI_FORMAT_R32_UINT, 0);
+  core.geometry_arena_.bind(geometry->vertex_allocation_.pool, geometry->index_allocation_.pool);
   device_context->IASetPrimitiveTopology(geometry->topology_);
-  device_context->VSSetShader(super_mat.vertex_shader_, 0, 0);
   device_context->PSSetShader(super_mat.pixel_shader_, 0, 0);
   device_context->VSSetConstantBuffers(0, 1, &super_mat.buffer_);
   device_context->PSSetConstantBuffers(0, 1, &super_mat.buffer_);
-  device_context->IASetInputLayout(super_mat.input_layout_);
-  device_context->DrawIndexed(geometry->vertex_index_.size(), 0, 0);
+  if (geometry->vertex_format_ == Geo::kVertexFormat_Packed) {
+    device_context->VSSetShader(super_mat.packed_vertex_shader_, 0, 0);
+    device_context->VSSetConstantBuffers(2, 1, &geometry->bounds_buffer_);
+    device_context->IASetInputLayout(super_mat.packed_input_layout_);
+  }
+  else {
+    device_context->VSSetShader(super_mat.vertex_shader_, 0, 0);
+    device_context->IASetInputLayout(super_mat.input_layout_);
+  }
+
+  if (geometry->terrain_tree_ || geometry->terrain_streamer_) {
+    drawTerrain(geometry, transform);
+  }
+  else if (!geometry->lods_.empty()) {
+    const uint32 lod_index = selectLod(geometry, transform);
+    const Geo::LodLevel& lod = geometry->lods_[lod_index];
+    if (lod_index == 0 && geometry->meshlets_.count > 0) {
+      drawMeshlets(geometry, transform);
+      return;
+    }
+    device_context->DrawIndexed(lod.num_indices,
+                                geometry->index_allocation_.offset + lod.first_index,
+                                geometry->vertex_allocation_.offset);
+  }
+  else {
+    device_context->DrawIndexed(geometry->index_allocation_.count,
+                                geometry->index_allocation_.offset,
+                                geometry->vertex_allocation_.offset);
+  }
+}
+
+uint32 RenderComponent::selectLod(Geo* geometry, TransformComponent* transform) {
+  auto& core = Core::instance();
+  DirectX::XMMATRIX model = DirectX::XMMatrixTranspose(transform->global_model_matrix());
+
+  float32 scale = 0.0f;
+  for (uint32 i = 0; i < 3; ++i) {
+    float32 axis_scale = DirectX::XMVectorGetX(DirectX::XMVector3Length(model.r[i]));
+    if (axis_scale > scale) { scale = axis_scale; }
+  }
+
+  // Distance to the nearest point of the bounding sphere.
+  float32 distance = DirectX::XMVectorGetX(
+    DirectX::XMVector3Length(DirectX::XMVectorSubtract(core.cam_.position_vector(), model.r[3])));
+  distance -= geometry->bounding_radius_ * scale;
+  if (distance <= 0.0f) {
+    lod_ = 0;
+    return lod_;
+  }
+
+  // Projection _22 is cotan(fovy / 2), half the screen height at distance 1.
+  float32 pixels_per_unit = scale * (float32)core.window_.height_ * 0.5f *
+                            core.cam_.projection_float4x4()._22 / distance;
+  lod_ = geometry->selectLod(pixels_per_unit, lod_);
+  return lod_;
+}
+
+void RenderComponent::drawMeshlets(Geo* geometry, TransformComponent* transform) {
+  auto& core = Core::instance();
+  auto* device_context = core.d3d_.deviceContext();
+  DirectX::XMMATRIX model = DirectX::XMMatrixTranspose(transform->global_model_matrix());
+  DirectX::XMMATRIX model_view_projection =
+    DirectX::XMMatrixMultiply(DirectX::XMMatrixMultiply(model, core.cam_.view_matrix()),
+                              core.cam_.projection_matrix());
+
+  DirectX::XMFLOAT3 camera_position;
+  DirectX::XMStoreFloat3(&camera_position,
+                         DirectX::XMVector3TransformCoord(core.cam_.position_vector(),
+                                                          DirectX::XMMatrixInverse(nullptr, model)));
+  // Mirroring transforms swap the front faces, not worth handling.
+  const bool backface = DirectX::XMVectorGetX(DirectX::XMMatrixDeterminant(model)) > 0.0f;
+
+  Meshlets::Cull(geometry->meshlets_, model_view_projection, camera_position, backface,
+                 meshlet_ranges_, &geometry->meshlet_stats_);
+  for (uint32 i = 0; i < meshlet_ranges_.size(); ++i) {
+    device_context->DrawIndexed(meshlet_ranges_[i].num_indices,
+                                geometry->index_allocation_.offset + meshlet_ranges_[i].first_index,
+                                geometry->vertex_allocation_.offset);
+  }
+}
+
+void RenderComponent::drawTerrain(Geo* geometry, TransformComponent* transform) {
+  auto& core = Core::instance();
+  DirectX::XMMATRIX model = DirectX::XMMatrixTranspose(transform->global_model_matrix());
+
+  if (!geometry->terrain_streamer_) {
+    drawTerrainTile(geometry, geometry, model, { 0.0f, 0.0f, 0.0f });
+    return;
+  }
+
+  // Streamed terrains draw the ready tiles around the camera.
+  TerrainStreamer* streamer = geometry->terrain_streamer_;
+  DirectX::XMFLOAT3 camera_position;
+  DirectX::XMStoreFloat3(&camera_position,
+                         DirectX::XMVector3TransformCoord(core.cam_.position_vector(),
+                                                          DirectX::XMMatrixInverse(nullptr, model)));
+  streamer->update(camera_position);
+
+  const auto& tiles = streamer->visible_tiles();
+  for (uint32 i = 0; i < tiles.size(); ++i) {
+    drawTerrainTile(tiles[i].geometry, streamer->patch(), model, tiles[i].offset);
+  }
+}
+
+void RenderComponent::drawTerrainTile(Geo* tile, Geo* patch,
+                                      const DirectX::XMMATRIX& model,
+                                      const DirectX::XMFLOAT3 offset) {
+  auto& core = Core::instance();
+  auto* device_context = core.d3d_.deviceContext();
+  auto& super_mat = core.super_material_;
+  TerrainQuadTree* tree = tile->terrain_tree_;
+
+  // Camera and frustum in tile space, the selection works with tile nodes.
+  DirectX::XMMATRIX tile_model = DirectX::XMMatrixMultiply(
+    DirectX::XMMatrixTranslation(offset.x, offset.y, offset.z), model);
+  DirectX::XMMATRIX model_view = DirectX::XMMatrixMultiply(tile_model, core.cam_.view_matrix());
+  DirectX::BoundingFrustum frustum(core.cam_.projection_matrix());
+  frustum.Transform(frustum, DirectX::XMMatrixInverse(nullptr, model_view));
+  DirectX::XMFLOAT3 camera_position;
+  DirectX::XMStoreFloat3(&camera_position,
+                         DirectX::XMVector3TransformCoord(core.cam_.position_vector(),
+                                                          DirectX::XMMatrixInverse(nullptr, tile_model)));
+
+  const auto& selection = tree->select(camera_position, frustum);
+  if (selection.empty()) { return; }
+
+  // The shader adds the offset before measuring the morph distance.
+  DirectX::XMINT2 samples = tree->samples();
+  DirectX::XMFLOAT2 spacing = tree->sample_spacing();
+  auto& settings = super_mat.terrain_settings_;
+  settings.camera = { camera_position.x + offset.x, camera_position.y + offset.y,
+                      camera_position.z + offset.z, 0.0f };
+  settings.terrain = { spacing.x, tree->max_height(), spacing.y, 0.0f };
+  settings.samples = { (float32)samples.x, (float32)samples.y,
+                       1.0f / (float32)(samples.x - 1), 1.0f / (float32)(samples.y - 1) };
+  settings.offset = { offset.x, offset.y, offset.z, 0.0f };
+
+  core.geometry_arena_.bind(patch->vertex_allocation_.pool, patch->index_allocation_.pool);
+  device_context->IASetPrimitiveTopology(patch->topology_);
+  device_context->VSSetShader(super_mat.terrain_vertex_shader_, 0, 0);
+  device_context->VSSetConstantBuffers(1, 1, &super_mat.terrain_buffer_);
+  device_context->VSSetShaderResources(5, 1, &tile->height_texture_);
+
+  // Indices are sorted by quadrant, a quarter each.
+  const uint32 first_index = patch->index_allocation_.offset;
+  const uint32 base_vertex = patch->vertex_allocation_.offset;
+  uint32 num_indices = patch->index_allocation_.count;
+  uint32 quadrant_indices = num_indices / 4;
+
+  for (uint32 i = 0; i < selection.size(); ++i) {
+    const TerrainQuadTree::Node& node = tree->node(selection[i].node);
+    settings.node = { (float32)node.x, (float32)node.z, (float32)node.size,
+                      (float32)TerrainQuadTree::kPatchQuads };
+    settings.morph = { tree->morph_start(node.level), tree->lod_range(node.level), 0.0f, 0.0f };
+
+    D3D11_MAPPED_SUBRESOURCE terrain_constant_buffer;
+    ZeroMemory(&terrain_constant_buffer, sizeof(D3D11_MAPPED_SUBRESOURCE));
+    device_context->Map(super_mat.terrain_buffer_, 0, D3D11_MAP_WRITE_DISCARD, 0, &terrain_constant_buffer);
+    memcpy(terrain_constant_buffer.pData, &settings, sizeof(TerrainSettings));
+    device_context->Unmap(super_mat.terrain_buffer_, 0);
+
+    if (selection[i].quadrants == TerrainQuadTree::kAllQuadrants) {
+      device_context->DrawIndexed(num_indices, first_index, base_vertex);
+    }
+    else {
+      for (uint32 quadrant = 0; quadrant < 4; ++quadrant) {
+        if (selection[i].quadrants & (1 << quadrant)) {
+          device_context->DrawIndexed(quadrant_indices, first_index + quadrant * quadrant_indices,
+                                      base_vertex);
+        }
+      }
+    }
+  }
 }
 
 }; /* W3D */
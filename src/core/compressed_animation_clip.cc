@@ -0,0 +1,296 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/compressed_animation_clip.h"
+#include <math.h>
+
+namespace W3D {
+
+const float32 CompressedAnimationClip::kTranslationTolerance = 0.001f;
+const float32 CompressedAnimationClip::kRotationTolerance = 0.001f;
+
+/// Largest value of the three smallest components of a unit quaternion.
+const float32 kSmallestThreeRange = 0.70710678f;
+/// Largest quantized value.
+const float32 kQuantizedMax = 65535.0f;
+
+/*******************************************************************************
+***                              Key reduction                               ***
+*******************************************************************************/
+
+/// Distance from a key to the interpolation of two others at its time.
+static float32 KeyError(const DirectX::XMFLOAT3* keys,
+                        const float32* times,
+                        const uint32 origin,
+                        const uint32 destiny,
+                        const uint32 key) {
+  const float32 alpha = (times[key] - times[origin]) / (times[destiny] - times[origin]);
+  DirectX::XMVECTOR interpolated = DirectX::XMVectorLerp(DirectX::XMLoadFloat3(&keys[origin]),
+                                                         DirectX::XMLoadFloat3(&keys[destiny]), alpha);
+  DirectX::XMVECTOR difference = DirectX::XMVectorSubtract(interpolated, DirectX::XMLoadFloat3(&keys[key]));
+  return DirectX::XMVectorGetX(DirectX::XMVector3Length(difference));
+}
+
+/// Angle from a key to the interpolation of two others at its time.
+static float32 KeyError(const DirectX::XMFLOAT4* keys,
+                        const float32* times,
+                        const uint32 origin,
+                        const uint32 destiny,
+                        const uint32 key) {
+  const float32 alpha = (times[key] - times[origin]) / (times[destiny] - times[origin]);
+  DirectX::XMVECTOR interpolated = DirectX::XMQuaternionSlerp(DirectX::XMLoadFloat4(&keys[origin]),
+                                                              DirectX::XMLoadFloat4(&keys[destiny]), alpha);
+  float32 cosine = fabsf(DirectX::XMVectorGetX(DirectX::XMVector4Dot(interpolated,
+                                                                      DirectX::XMLoadFloat4(&keys[key]))));
+  return 2.0f * acosf(cosine < 1.0f ? cosine : 1.0f);
+}
+
+/// Keys of a track to keep, so every removed one is within the tolerance of
+/// the interpolation of the kept keys around it.
+template<typename Key>
+static void ReduceKeys(const Key* keys,
+                       const float32* times,
+                       const uint32 num_keys,
+                       const float32 tolerance,
+                       std::vector<uint32>& kept) {
+  kept.clear();
+  if (num_keys == 0) { return; }
+  kept.push_back(0);
+
+  uint32 origin = 0;
+  for (uint32 destiny = 2; destiny < num_keys; ++destiny) {
+    bool fits = times[destiny] > times[origin];
+    for (uint32 key = origin + 1; key < destiny && fits; ++key) {
+      fits = KeyError(keys, times, origin, destiny, key) <= tolerance;
+    }
+    if (!fits) {
+      origin = destiny - 1;
+      kept.push_back(origin);
+    }
+  }
+  if (num_keys > 1) { kept.push_back(num_keys - 1); }
+
+  // Constant tracks need a single key.
+  const float32 constant_times[] = { 0.0f, 1.0f, 0.5f };
+  bool constant = kept.size() == 2;
+  for (uint32 key = 1; key < num_keys && constant; ++key) {
+    const Key first_and_key[] = { keys[0], keys[0], keys[key] };
+    constant = KeyError(first_and_key, constant_times, 0, 1, 2) <= tolerance;
+  }
+  if (constant) { kept.pop_back(); }
+}
+
+/*******************************************************************************
+***                              Quantization                                ***
+*******************************************************************************/
+
+static uint16 Quantize(const float32 normalized) {
+  const float32 value = normalized * kQuantizedMax + 0.5f;
+  return (uint16)(value < 0.0f ? 0.0f : (value > kQuantizedMax ? kQuantizedMax : value));
+}
+
+/// Smallest three components, and the index of the largest in the lowest
+/// bits of x and y.
+static DirectX::PackedVector::XMUSHORTN4 QuantizeRotation(const DirectX::XMFLOAT4& rotation,
+                                                          const uint16 time) {
+  float32 components[] = { rotation.x, rotation.y, rotation.z, rotation.w };
+  uint32 largest = 0;
+  for (uint32 i = 1; i < 4; ++i) {
+    if (fabsf(components[i]) > fabsf(components[largest])) { largest = i; }
+  }
+  // q and -q are the same rotation, the largest is kept positive.
+  const float32 sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+
+  uint16 smallest[3];
+  for (uint32 i = 0, j = 0; i < 4; ++i) {
+    if (i == largest) { continue; }
+    smallest[j++] = Quantize((components[i] * sign + kSmallestThreeRange) / (2.0f * kSmallestThreeRange));
+  }
+
+  DirectX::PackedVector::XMUSHORTN4 key;
+  key.x = (smallest[0] & 0xFFFE) | (largest & 1);
+  key.y = (smallest[1] & 0xFFFE) | (largest >> 1);
+  key.z = smallest[2];
+  key.w = time;
+  return key;
+}
+
+static DirectX::XMVECTOR DequantizeRotation(const DirectX::PackedVector::XMUSHORTN4& key) {
+  DirectX::XMVECTOR smallest = DirectX::XMVectorMultiplyAdd(DirectX::PackedVector::XMLoadUShortN4(&key),
+                                                            DirectX::XMVectorReplicate(2.0f * kSmallestThreeRange),
+                                                            DirectX::XMVectorReplicate(-kSmallestThreeRange));
+  DirectX::XMVECTOR largest = DirectX::XMVectorSqrt(DirectX::XMVectorMax(
+      DirectX::XMVectorSubtract(DirectX::XMVectorSplatOne(), DirectX::XMVector3Dot(smallest, smallest)),
+      DirectX::XMVectorZero()));
+  DirectX::XMVECTOR rotation = DirectX::XMVectorSelect(smallest, largest, DirectX::g_XMSelect0001);
+  switch ((key.x & 1) | ((key.y & 1) << 1)) {
+    case 0: return DirectX::XMVectorSwizzle<3, 0, 1, 2>(rotation);
+    case 1: return DirectX::XMVectorSwizzle<0, 3, 1, 2>(rotation);
+    case 2: return DirectX::XMVectorSwizzle<0, 1, 3, 2>(rotation);
+    default: return rotation;
+  }
+}
+
+/// Key at or before the quantized time, and how far the time is towards
+/// the following key.
+static uint32 FindKey(const DirectX::PackedVector::XMUSHORTN4* keys,
+                      const uint32 num_keys,
+                      const float32 time,
+                      float32* alpha) {
+  uint32 first = 0;
+  uint32 count = num_keys;
+  while (count > 0) {
+    const uint32 half = count / 2;
+    if ((float32)keys[first + half].w <= time) {
+      first += half + 1;
+      count -= half + 1;
+    }
+    else {
+      count = half;
+    }
+  }
+  *alpha = 0.0f;
+  if (first == 0) { return 0; }
+  if (first == num_keys) { return num_keys - 1; }
+  *alpha = (time - (float32)keys[first - 1].w) / (float32)(keys[first].w - keys[first - 1].w);
+  return first - 1;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+CompressedAnimationClip::CompressedAnimationClip() {
+  num_bones_ = 0;
+  duration_ = 0.0f;
+}
+
+CompressedAnimationClip::~CompressedAnimationClip() {
+  translation_tracks_.clear();
+  rotation_tracks_.clear();
+  translation_keys_.clear();
+  rotation_keys_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void CompressedAnimationClip::init(const AnimationClip& clip,
+                                   const float32 translation_tolerance,
+                                   const float32 rotation_tolerance) {
+
+  num_bones_ = clip.num_bones_;
+  duration_ = clip.duration_;
+  translation_tracks_.assign(num_bones_, { 0, 0 });
+  rotation_tracks_.assign(num_bones_, { 0, 0 });
+  translation_min_.assign(num_bones_, { 0.0f, 0.0f, 0.0f });
+  translation_extent_.assign(num_bones_, { 0.0f, 0.0f, 0.0f });
+  translation_keys_.clear();
+  rotation_keys_.clear();
+
+  const float32 time_scale = duration_ > 0.0f ? 1.0f / duration_ : 0.0f;
+  std::vector<uint32> kept;
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+
+    // Translations, quantized inside the box of the kept keys.
+    const AnimationClip::Track& translation = clip.translation_tracks_[bone];
+    const DirectX::XMFLOAT3* positions = clip.translation_keys_.data() + translation.first_key;
+    const float32* times = clip.translation_times_.data() + translation.first_key;
+    ReduceKeys(positions, times, translation.num_keys, translation_tolerance, kept);
+    if (!kept.empty()) {
+      DirectX::XMVECTOR min = DirectX::XMLoadFloat3(&positions[kept[0]]);
+      DirectX::XMVECTOR max = min;
+      for (uint32 i = 1; i < kept.size(); ++i) {
+        min = DirectX::XMVectorMin(min, DirectX::XMLoadFloat3(&positions[kept[i]]));
+        max = DirectX::XMVectorMax(max, DirectX::XMLoadFloat3(&positions[kept[i]]));
+      }
+      translation_tracks_[bone] = { (uint32)translation_keys_.size(), (uint32)kept.size() };
+      DirectX::XMStoreFloat3(&translation_min_[bone], min);
+      DirectX::XMStoreFloat3(&translation_extent_[bone], DirectX::XMVectorSubtract(max, min));
+
+      const DirectX::XMFLOAT3& box_min = translation_min_[bone];
+      const DirectX::XMFLOAT3& box_extent = translation_extent_[bone];
+      const float32 extent[] = { box_extent.x, box_extent.y, box_extent.z };
+      const float32 origin[] = { box_min.x, box_min.y, box_min.z };
+      for (uint32 i = 0; i < kept.size(); ++i) {
+        const float32 position[] = { positions[kept[i]].x, positions[kept[i]].y, positions[kept[i]].z };
+        uint16 quantized[3];
+        for (uint32 axis = 0; axis < 3; ++axis) {
+          quantized[axis] = extent[axis] > 0.0f ? Quantize((position[axis] - origin[axis]) / extent[axis]) : 0;
+        }
+        DirectX::PackedVector::XMUSHORTN4 key;
+        key.x = quantized[0];
+        key.y = quantized[1];
+        key.z = quantized[2];
+        key.w = Quantize(times[kept[i]] * time_scale);
+        translation_keys_.push_back(key);
+      }
+    }
+
+    // Rotations, smallest three.
+    const AnimationClip::Track& rotation = clip.rotation_tracks_[bone];
+    const DirectX::XMFLOAT4* rotations = clip.rotation_keys_.data() + rotation.first_key;
+    times = clip.rotation_times_.data() + rotation.first_key;
+    ReduceKeys(rotations, times, rotation.num_keys, rotation_tolerance, kept);
+    if (!kept.empty()) {
+      rotation_tracks_[bone] = { (uint32)rotation_keys_.size(), (uint32)kept.size() };
+      for (uint32 i = 0; i < kept.size(); ++i) {
+        rotation_keys_.push_back(QuantizeRotation(rotations[kept[i]], Quantize(times[kept[i]] * time_scale)));
+      }
+    }
+  }
+}
+
+void CompressedAnimationClip::sample(const float32 time, Pose* pose) const {
+  const float32 quantized_time = duration_ > 0.0f ? time / duration_ * kQuantizedMax : 0.0f;
+  float32 alpha = 0.0f;
+  DirectX::XMFLOAT4 value;
+  for (uint32 bone = 0; bone < num_bones_; ++bone) {
+
+    const Track& translation = translation_tracks_[bone];
+    if (translation.num_keys > 0) {
+      const DirectX::PackedVector::XMUSHORTN4* keys = translation_keys_.data() + translation.first_key;
+      const uint32 key = FindKey(keys, translation.num_keys, quantized_time, &alpha);
+      const uint32 next = key + (key + 1 < translation.num_keys);
+      DirectX::XMVECTOR normalized = DirectX::XMVectorLerp(DirectX::PackedVector::XMLoadUShortN4(&keys[key]),
+                                                           DirectX::PackedVector::XMLoadUShortN4(&keys[next]),
+                                                           alpha);
+      DirectX::XMStoreFloat4(&value, DirectX::XMVectorMultiplyAdd(normalized,
+                                                                  DirectX::XMLoadFloat3(&translation_extent_[bone]),
+                                                                  DirectX::XMLoadFloat3(&translation_min_[bone])));
+      pose->translation_x[bone] = value.x;
+      pose->translation_y[bone] = value.y;
+      pose->translation_z[bone] = value.z;
+    }
+
+    const Track& rotation = rotation_tracks_[bone];
+    if (rotation.num_keys > 0) {
+      const DirectX::PackedVector::XMUSHORTN4* keys = rotation_keys_.data() + rotation.first_key;
+      const uint32 key = FindKey(keys, rotation.num_keys, quantized_time, &alpha);
+      const uint32 next = key + (key + 1 < rotation.num_keys);
+      DirectX::XMStoreFloat4(&value, DirectX::XMQuaternionNormalize(
+          DirectX::XMQuaternionSlerp(DequantizeRotation(keys[key]), DequantizeRotation(keys[next]), alpha)));
+      pose->rotation_x[bone] = value.x;
+      pose->rotation_y[bone] = value.y;
+      pose->rotation_z[bone] = value.z;
+      pose->rotation_w[bone] = value.w;
+    }
+  }
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 CompressedAnimationClip::memory() const {
+  return (translation_tracks_.size() + rotation_tracks_.size()) * sizeof(Track) +
+         (translation_min_.size() + translation_extent_.size()) * sizeof(DirectX::XMFLOAT3) +
+         (translation_keys_.size() + rotation_keys_.size()) * sizeof(DirectX::PackedVector::XMUSHORTN4);
+}
+
+}; /* W3D */
@@ -94,6 +94,9 @@ Core::~Core() {}
 
 
 void Core::init() {
+  jobs_.init();
+  // The packed assets are optional, loose files are used otherwise.
+  vfs_.mount(FileSystem::kDefaultArchivePath);
   error_geometry_.initCube();
   base_quad_geometry_.initQuad();
   error_texture_.initFromFile("../data/textures/error_texture.jpg");
@@ -0,0 +1,413 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/file_system.h"
+#include "core/job_system.h"
+#include "core/lz4.h"
+#include "core/core.h"
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+
+namespace W3D {
+
+/*******************************************************************************
+***                               Mapped file                                ***
+*******************************************************************************/
+
+MappedFile::MappedFile() {
+  file_ = INVALID_HANDLE_VALUE;
+  mapping_ = NULL;
+  data_ = nullptr;
+  size_ = 0;
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+bool MappedFile::open(const char* path) {
+
+  close();
+
+  file_ = CreateFileA(path,
+                      GENERIC_READ,
+                      FILE_SHARE_READ,
+                      NULL,
+                      OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                      NULL);
+  if (file_ == INVALID_HANDLE_VALUE) { return false; }
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file_, &file_size)) {
+    close();
+    return false;
+  }
+  size_ = (uint64)file_size.QuadPart;
+
+  // Empty files can't be mapped, but they are valid files.
+  if (size_ == 0) { return true; }
+
+  mapping_ = CreateFileMappingA(file_, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (!mapping_) {
+    close();
+    return false;
+  }
+
+  data_ = (const uchar8*)MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0);
+  if (!data_) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+    data_ = nullptr;
+  }
+  if (mapping_) {
+    CloseHandle(mapping_);
+    mapping_ = NULL;
+  }
+  if (file_ != INVALID_HANDLE_VALUE) {
+    CloseHandle(file_);
+    file_ = INVALID_HANDLE_VALUE;
+  }
+  size_ = 0;
+}
+
+const uchar8* MappedFile::data() const {
+  return data_;
+}
+
+uint64 MappedFile::size() const {
+  return size_;
+}
+
+/*******************************************************************************
+***                                File view                                 ***
+*******************************************************************************/
+
+FileView::FileView() {
+  data_ = nullptr;
+  size_ = 0;
+}
+
+FileView::~FileView() {}
+
+void FileView::reset() {
+  loose_file_.close();
+  data_ = nullptr;
+  size_ = 0;
+}
+
+const uchar8* FileView::data() const {
+  return data_;
+}
+
+uint32 FileView::size() const {
+  return size_;
+}
+
+/*******************************************************************************
+***                                 Archive                                  ***
+*******************************************************************************/
+
+Archive::Archive() {
+  header_ = nullptr;
+  entries_ = nullptr;
+  slots_ = nullptr;
+  names_ = nullptr;
+}
+
+Archive::~Archive() {}
+
+bool Archive::mount(const char* path, JobSystem& jobs) {
+
+  if (!file_.open(path)) { return false; }
+
+  const uchar8* data = file_.data();
+  uint64 size = file_.size();
+
+  if (size < sizeof(ArchiveHeader)) {
+    MessageBox(NULL, "ERROR - Archive header incorrect.", "ERROR", MB_OK);
+    return false;
+  }
+  header_ = (const ArchiveHeader*)data;
+  if (header_->magic != kArchiveMagic || header_->version != kArchiveVersion) {
+    MessageBox(NULL, "ERROR - Archive format or version not supported.", "ERROR", MB_OK);
+    return false;
+  }
+
+  // Check that every table is inside the archive.
+  uint64 entries_size = (uint64)header_->num_entries * sizeof(ArchiveEntry);
+  uint64 slots_size = (uint64)header_->num_slots * sizeof(uint32);
+  if (header_->num_slots == 0 ||
+      (header_->num_slots & (header_->num_slots - 1)) != 0 ||
+      header_->num_slots < header_->num_entries ||
+      header_->entries_offset + entries_size > size ||
+      header_->slots_offset + slots_size > size ||
+      header_->names_offset + header_->names_size > size) {
+    MessageBox(NULL, "ERROR - Archive table of contents incorrect.", "ERROR", MB_OK);
+    return false;
+  }
+  entries_ = (const ArchiveEntry*)(data + header_->entries_offset);
+  slots_ = (const uint32*)(data + header_->slots_offset);
+  names_ = (const char*)(data + header_->names_offset);
+
+  // Slots keep an entry index plus one, or 0 when empty.
+  for (uint32 i = 0; i < header_->num_slots; ++i) {
+    if (slots_[i] > header_->num_entries) {
+      MessageBox(NULL, "ERROR - Archive slot out of bounds.", "ERROR", MB_OK);
+      return false;
+    }
+  }
+
+  // Compressed entries are decoded once, all of them in parallel.
+  std::vector<uint32> compressed;
+  decoded_offsets_.resize(header_->num_entries);
+  uint64 decoded_size = 0;
+  for (uint32 i = 0; i < header_->num_entries; ++i) {
+    const ArchiveEntry& entry = entries_[i];
+    if (entry.offset + entry.stored_size > size ||
+        entry.name_offset >= header_->names_size) {
+      MessageBox(NULL, "ERROR - Archive entry out of bounds.", "ERROR", MB_OK);
+      return false;
+    }
+    if (entry.flags & kArchiveEntryFlag_LZ4) {
+      compressed.push_back(i);
+      decoded_offsets_[i] = decoded_size;
+      decoded_size += entry.size;
+    }
+  }
+  decoded_.resize((size_t)decoded_size);
+
+  std::atomic<bool> decoded_ok(true);
+  jobs.parallelFor(compressed.size(), 1, [&](uint32 begin, uint32 end) {
+    for (uint32 i = begin; i < end; ++i) {
+      const ArchiveEntry& entry = entries_[compressed[i]];
+      if (!LZ4::Decompress(data + entry.offset, entry.stored_size,
+                           decoded_.data() + decoded_offsets_[compressed[i]],
+                           entry.size)) {
+        decoded_ok = false;
+      }
+    }
+  });
+
+  if (!decoded_ok) {
+    MessageBox(NULL, "ERROR - Archive compressed entry corrupted.", "ERROR", MB_OK);
+    return false;
+  }
+
+  return true;
+}
+
+bool Archive::find(const char* normalized_path,
+                   const uchar8** data,
+                   uint32* size) const {
+
+  if (!header_) { return false; }
+
+  uint64 hash = Hash(normalized_path);
+  uint32 mask = header_->num_slots - 1;
+  uint32 slot = (uint32)hash & mask;
+
+  for (uint32 probe = 0; probe < header_->num_slots; ++probe) {
+    uint32 value = slots_[slot];
+    if (value == 0) { return false; }
+
+    const ArchiveEntry& entry = entries_[value - 1];
+    if (entry.hash == hash && strcmp(names_ + entry.name_offset, normalized_path) == 0) {
+      if (entry.flags & kArchiveEntryFlag_LZ4) {
+        *data = decoded_.data() + decoded_offsets_[value - 1];
+      }
+      else {
+        *data = file_.data() + entry.offset;
+      }
+      *size = entry.size;
+      return true;
+    }
+    slot = (slot + 1) & mask;
+  }
+  return false;
+}
+
+bool Archive::Pack(const char* archive_path,
+                   const std::vector<std::string>& files,
+                   const std::vector<std::string>& names,
+                   const bool compress) {
+
+  if (files.size() != names.size()) { return false; }
+
+  uint32 num_entries = files.size();
+  uint32 num_slots = 16;
+  while (num_slots < num_entries * 2) { num_slots *= 2; }
+
+  FILE* file = nullptr;
+  fopen_s(&file, archive_path, "wb");
+  if (!file) {
+    MessageBox(NULL, "ERROR - Archive can't be created.", "ERROR", MB_OK);
+    return false;
+  }
+
+  // Header is rewritten at the end, once all the offsets are known.
+  ArchiveHeader header;
+  ZeroMemory(&header, sizeof(ArchiveHeader));
+  fwrite(&header, sizeof(ArchiveHeader), 1, file);
+  uint64 offset = sizeof(ArchiveHeader);
+
+  std::vector<ArchiveEntry> entries(num_entries);
+  std::vector<uint32> slots(num_slots, 0);
+  std::string names_block;
+  std::vector<uchar8> compressed;
+
+  for (uint32 i = 0; i < num_entries; ++i) {
+    MappedFile source;
+    if (!source.open(files[i].c_str())) {
+      fclose(file);
+      MessageBox(NULL, "ERROR - File to pack can't be opened.", "ERROR", MB_OK);
+      return false;
+    }
+
+    ArchiveEntry& entry = entries[i];
+    entry.hash = Hash(names[i].c_str());
+    entry.offset = offset;
+    entry.size = (uint32)source.size();
+    entry.stored_size = entry.size;
+    entry.flags = 0;
+    entry.name_offset = names_block.size();
+    names_block.append(names[i]);
+    names_block.push_back('\0');
+
+    const uchar8* stored_data = source.data();
+    if (compress && entry.size > 0) {
+      compressed.resize(LZ4::CompressBound(entry.size));
+      uint32 compressed_size = LZ4::Compress(source.data(), entry.size,
+                                             compressed.data(), compressed.size());
+      // Only worth it if it saves something.
+      if (compressed_size > 0 && compressed_size < entry.size) {
+        stored_data = compressed.data();
+        entry.stored_size = compressed_size;
+        entry.flags |= kArchiveEntryFlag_LZ4;
+      }
+    }
+    if (entry.stored_size > 0) {
+      fwrite(stored_data, 1, entry.stored_size, file);
+    }
+    offset += entry.stored_size;
+
+    uint32 slot = (uint32)entry.hash & (num_slots - 1);
+    while (slots[slot] != 0) { slot = (slot + 1) & (num_slots - 1); }
+    slots[slot] = i + 1;
+  }
+
+  header.magic = kArchiveMagic;
+  header.version = kArchiveVersion;
+  header.num_entries = num_entries;
+  header.num_slots = num_slots;
+
+  header.entries_offset = offset;
+  if (num_entries > 0) {
+    fwrite(entries.data(), sizeof(ArchiveEntry), num_entries, file);
+  }
+  offset += num_entries * sizeof(ArchiveEntry);
+
+  header.slots_offset = offset;
+  fwrite(slots.data(), sizeof(uint32), num_slots, file);
+  offset += num_slots * sizeof(uint32);
+
+  header.names_offset = offset;
+  header.names_size = names_block.size();
+  fwrite(names_block.data(), 1, names_block.size(), file);
+
+  fseek(file, 0, SEEK_SET);
+  fwrite(&header, sizeof(ArchiveHeader), 1, file);
+  fclose(file);
+
+  return true;
+}
+
+uint64 Archive::Hash(const char* normalized_path) {
+  uint64 hash = 14695981039346656037ull;
+  while (*normalized_path) {
+    hash ^= (uchar8)(*normalized_path++);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/*******************************************************************************
+***                           Virtual file system                            ***
+*******************************************************************************/
+
+VirtualFileSystem::VirtualFileSystem() {}
+
+VirtualFileSystem::~VirtualFileSystem() {
+  for (uint32 i = 0; i < archives_.size(); ++i) {
+    delete archives_[i];
+  }
+  archives_.clear();
+}
+
+bool VirtualFileSystem::mount(const char* archive_path) {
+  Archive* archive = new Archive();
+  if (!archive->mount(archive_path, Core::instance().jobs_)) {
+    delete archive;
+    return false;
+  }
+  archives_.push_back(archive);
+  return true;
+}
+
+bool VirtualFileSystem::open(const char* path, FileView& view) const {
+
+  view.reset();
+  if (!path) { return false; }
+
+  if (!archives_.empty()) {
+    std::string key = NormalizePath(path);
+    for (int32 i = archives_.size() - 1; i >= 0; --i) {
+      if (archives_[i]->find(key.c_str(), &view.data_, &view.size_)) {
+        return true;
+      }
+    }
+  }
+
+  // Not packed, one mapping of the loose file.
+  if (!view.loose_file_.open(path)) { return false; }
+  view.data_ = view.loose_file_.data();
+  view.size_ = (uint32)view.loose_file_.size();
+  return true;
+}
+
+std::string VirtualFileSystem::NormalizePath(const char* path) {
+
+  std::string result;
+  if (!path) { return result; }
+  result.reserve(strlen(path));
+
+  for (const char* c = path; *c; ++c) {
+    char character = (*c == '\\') ? '/' : *c;
+    if (character >= 'A' && character <= 'Z') { character += 'a' - 'A'; }
+    result.push_back(character);
+  }
+
+  // Strip the relative prefixes, "./../data/x" -> "data/x".
+  uint32 start = 0;
+  while (true) {
+    if (result.compare(start, 2, "./") == 0) { start += 2; }
+    else if (result.compare(start, 3, "../") == 0) { start += 3; }
+    else { break; }
+  }
+  return result.substr(start);
+}
+
+}; /* W3D */
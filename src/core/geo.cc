@@ -8,11 +8,75 @@
 #include "Wolfy3D/globals.h"
 #include "core/geo.h"
 #include "core/core.h"
+#include "core/terrain_mesh.h"
+#include "core/height_map.h"
+#include "core/terrain_quadtree.h"
+#include "core/terrain_streamer.h"
+#include "core/super_material.h"
+#include "core/mesh_optimizer.h"
+#include "core/mesh_simplifier.h"
+#include "core/mesh_builder.h"
+#include <DirectXPackedVector.h>
+#include <algorithm>
+#include <float.h>
+#include <math.h>
 #include <string>
-#include <fstream>
 
 namespace W3D {
 
+/// Heightmap rows decoded by every job while building a terrain.
+const uint32 kTerrainRowsPerJob = 16;
+
+/// Levels of detail of the file geometries, the full one included.
+const uint32 kMaxLodLevels = 4;
+/// Simplification stops before this error, relative to the mesh radius.
+const float32 kLodMaxErrorRatio = 0.1f;
+/// Levels removing less than this fraction of the triangles are useless.
+const float32 kLodMinReduction = 0.15f;
+/// Screen error allowed to a level, in pixels.
+const float32 kLodPixelError = 1.0f;
+/// Coarser levels must stay under this fraction of kLodPixelError, so the
+/// level doesn't flicker around the switch distance.
+const float32 kLodHysteresis = 0.5f;
+/// Meshes with fewer triangles are drawn whole, a couple of meshlets can't
+/// pay the culling and the extra draw calls.
+const uint32 kMinMeshletsTriangles = Meshlets::kMaxTriangles * 2;
+/// Occluder levels of detail must stay under this error, relative to the
+/// mesh radius, the ones bulging out would hide what's behind them.
+const float32 kOccluderMaxErrorRatio = 0.01f;
+/// Cells per side of the terrain occluder grid.
+const int32 kOccluderTerrainCells = 64;
+
+/// Reads the lines of a file view, replaces the std::ifstream + std::getline
+/// parsing without copying the whole file.
+class MemoryLineReader {
+
+ public:
+
+  MemoryLineReader(const uchar8* data, const uint32 size) {
+    current_ = (const char*)data;
+    end_ = current_ + size;
+  }
+
+  bool eof() const {
+    return current_ >= end_;
+  }
+
+  void getline(std::string& line) {
+    const char* line_start = current_;
+    while (current_ < end_ && *current_ != '\n') { current_++; }
+    const char* line_end = current_;
+    if (line_end > line_start && *(line_end - 1) == '\r') { line_end--; }
+    line.assign(line_start, line_end);
+    if (current_ < end_) { current_++; } // Skip '\n'.
+  }
+
+ private:
+
+  const char* current_;
+  const char* end_;
+
+}; /* MemoryLineReader */
   
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
@@ -20,17 +84,36 @@ namespace W3D {
 
 Geo::Geo() {
   topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-  vertex_buffer_ = nullptr;
-  vertex_index_buffer_ = nullptr;
+  vertex_allocation_ = { GeometryArena::kPool_FullVertices, TlsfAllocator::kInvalidHandle, 0, 0 };
+  index_allocation_ = { GeometryArena::kPool_Indices32, TlsfAllocator::kInvalidHandle, 0, 0 };
   name_ = "";
   type_ = kType_None;
+  load_state_ = kLoadState_Ready;
+  terrain_tree_ = nullptr;
+  height_texture_ = nullptr;
+  terrain_streamer_ = nullptr;
+  vertex_format_ = kVertexFormat_Full;
+  bounds_buffer_ = nullptr;
+  mesh_optimized_ = false;
+  mesh_stats_ = { 0, 0.0f, 0.0f };
+  bounding_radius_ = 0.0f;
+  meshlets_.count = 0;
+  meshlet_stats_ = { 0, 0, 0 };
+  bounding_box_.Center = { 0.0f, 0.0f, 0.0f };
+  bounding_box_.Extents = { 0.0f, 0.0f, 0.0f };
+  dynamic_ = false;
 }
 
 Geo::~Geo() {
+  if (!dirty_vertices_.empty()) { Core::instance().geometry_arena_.cancelUploads(this); }
   vertex_index_.clear();
   vertex_data_.clear();
-  if (vertex_buffer_) { vertex_buffer_->Release(); }
-  if (vertex_index_buffer_) { vertex_index_buffer_->Release(); }
+  Core::instance().geometry_arena_.release(&vertex_allocation_);
+  Core::instance().geometry_arena_.release(&index_allocation_);
+  if (bounds_buffer_) { bounds_buffer_->Release(); }
+  if (height_texture_) { height_texture_->Release(); }
+  if (terrain_tree_) { delete terrain_tree_; }
+  if (terrain_streamer_) { delete terrain_streamer_; }
 }
 
 /*******************************************************************************
@@ -39,36 +122,19 @@ Geo::~Geo() {
 
 bool Geo::initTriangle(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 color) {
 
-  num_vertices_ = 3;
-  num_indices_ = 3;
   float32 half_width = size.x * 0.5f;
   float32 half_height = size.y * 0.5f;
+  DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 1.0f };
 
-  // Vertices info.
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin({ 3, 3 }, color)) { return false; }
 
-  vertex_data_[0] = { { 0.0f, half_height, 0.0f },      // Position
-                      { 0.0f, 0.0f, 1.0f },             // Normal
-                      { 0.5f, 0.0f },                   // UV / TexCoord
-                      color };                          // Color
-  vertex_data_[1] = { { half_width, -half_height, 0.0f },
-                      { 0.0f, 0.0f, 1.0f },
-                      { 1.0f, 1.0f },
-                      color };
-  vertex_data_[2] = { { -half_width, -half_height, 0.0f },
-                      { 0.0f, 0.0f, 1.0f },
-                      { 0.0f, 1.0f },
-                      color };
-  
-  vertex_index_[0] = 0;
-  vertex_index_[1] = 2;
-  vertex_index_[2] = 1;
-  
-  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  builder.vertex({ 0.0f, half_height, 0.0f }, normal, { 0.5f, 0.0f });
+  builder.vertex({ half_width, -half_height, 0.0f }, normal, { 1.0f, 1.0f });
+  builder.vertex({ -half_width, -half_height, 0.0f }, normal, { 0.0f, 1.0f });
+  builder.triangle(0, 2, 1);
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  if (!endMesh(builder)) { return false; }
   
   type_ = kType_Triangle;
   info_.triangle.size = { size.x, size.y };
@@ -79,14 +145,12 @@ bool Geo::initTriangle(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 col
 
 bool Geo::initQuad(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 color) {
 
-  num_vertices_ = 4;
-  num_indices_ = 6;
   float32 half_width = size.x * 0.5f;
   float32 half_height = size.y * 0.5f;
+  DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 1.0f };
 
-  // Vertices info.
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin({ 4, 6 }, color)) { return false; }
 
   /*
         0         1
@@ -97,35 +161,13 @@ bool Geo::initQuad(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 color)
         3         2
   */
 
+  builder.vertex({ -half_width, half_height, 0.0f }, normal, { 1.0f, 0.0f });
+  builder.vertex({ half_width, half_height, 0.0f }, normal, { 0.0f, 0.0f });
+  builder.vertex({ half_width, -half_height, 0.0f }, normal, { 0.0f, 1.0f });
+  builder.vertex({ -half_width, -half_height, 0.0f }, normal, { 1.0f, 1.0f });
+  builder.quad(0, 3, 2, 1);
 
-  vertex_data_[0] = { { -half_width, half_height, 0.0f },       // Position
-                      { 0.0f, 0.0f, 1.0f },                     // Normal
-                      { 1.0f, 0.0f },                           // UV / TexCoord
-                        color };                                // Color
-  vertex_data_[1] = { { half_width, half_height, 0.0f },
-                      { 0.0f, 0.0f, 1.0f },
-                      { 0.0f, 0.0f },
-                        color };
-  vertex_data_[2] = { { half_width, -half_height, 0.0f },
-                      { 0.0f, 0.0f, 1.0f },
-                      { 0.0f, 1.0f },
-                        color };
-  vertex_data_[3] = { { -half_width, -half_height, 0.0f },
-                      { 0.0f, 0.0f, 1.0f },
-                      { 1.0f, 1.0f },
-                        color };
-
-  vertex_index_[0] = 0;
-  vertex_index_[1] = 2;
-  vertex_index_[2] = 1;
-  vertex_index_[3] = 0;
-  vertex_index_[4] = 3;
-  vertex_index_[5] = 2;
-
-  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  if (!endMesh(builder)) { return false; }
 
   // Factory info.
   type_ = kType_Quad;
@@ -136,108 +178,11 @@ bool Geo::initQuad(const DirectX::XMFLOAT2 size, const DirectX::XMFLOAT4 color)
 }
 
 bool Geo::initCube(const DirectX::XMFLOAT3 size, const DirectX::XMFLOAT4 color) {
- 
-  num_vertices_ = 24;
-  num_indices_ = 36;
-
-  // Vertices info.
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
-
-  DirectX::XMFLOAT3 h_size = { size.x * 0.5f, size.y * 0.5f, size.z * 0.5f };
-  DirectX::XMFLOAT3 normal_x = { 1.0f, 0.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_y = { 0.0f, 1.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_z = { 0.0f, 0.0f, 1.0f };
-  DirectX::XMFLOAT3 normal_x_neg = { -1.0f, 0.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_y_neg = { 0.0f, -1.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_z_neg = { 0.0f, 0.0f, -1.0f };
-  DirectX::XMFLOAT2 uv_top_l = { 0.0f, 0.0f };
-  DirectX::XMFLOAT2 uv_top_r = { 1.0f, 0.0f };
-  DirectX::XMFLOAT2 uv_bot_r = { 1.0f, 1.0f };
-  DirectX::XMFLOAT2 uv_bot_l = { 0.0f, 1.0f };
-
-  // FACE Z + 
-  vertex_data_[0] = { { -h_size.x, h_size.y, h_size.z }, normal_z, uv_top_l, color };
-  vertex_data_[1] = { { h_size.x, h_size.y, h_size.z }, normal_z, uv_top_r, color };
-  vertex_data_[2] = { { h_size.x, -h_size.y, h_size.z }, normal_z, uv_bot_r, color };
-  vertex_data_[3] = { { -h_size.x, -h_size.y, h_size.z }, normal_z, uv_bot_l, color };
-
-  // FACE X+
-  vertex_data_[4] = { { h_size.x, h_size.y, h_size.z }, normal_x, uv_top_l, color };
-  vertex_data_[5] = { { h_size.x, h_size.y, -h_size.z }, normal_x, uv_top_r, color };
-  vertex_data_[6] = { { h_size.x, -h_size.y, -h_size.z }, normal_x, uv_bot_r, color };
-  vertex_data_[7] = { { h_size.x, -h_size.y, h_size.z }, normal_x, uv_bot_l, color };
-
-  // FACE Z -
-  vertex_data_[8] = { { h_size.x, h_size.y, -h_size.z }, normal_z_neg, uv_top_l, color };
-  vertex_data_[9] = { { -h_size.x, h_size.y, -h_size.z }, normal_z_neg, uv_top_r, color };
-  vertex_data_[10] = { { -h_size.x, -h_size.y, -h_size.z }, normal_z_neg, uv_bot_r, color };
-  vertex_data_[11] = { { h_size.x, -h_size.y, -h_size.z }, normal_z_neg, uv_bot_l, color };
-
-  // FACE X- 
-  vertex_data_[12] = { { -h_size.x, h_size.y, -h_size.z }, normal_x_neg, uv_top_l, color };
-  vertex_data_[13] = { { -h_size.x, h_size.y, h_size.z }, normal_x_neg, uv_top_r, color };
-  vertex_data_[14] = { { -h_size.x, -h_size.y, h_size.z }, normal_x_neg, uv_bot_r, color };
-  vertex_data_[15] = { { -h_size.x, -h_size.y, -h_size.z }, normal_x_neg, uv_bot_l, color };
-
-  // FACE Y -
-  vertex_data_[16] = { { -h_size.x, -h_size.y, h_size.z }, normal_y_neg, uv_top_l, color };
-  vertex_data_[17] = { { h_size.x, -h_size.y, h_size.z }, normal_y_neg, uv_top_r, color };
-  vertex_data_[18] = { { h_size.x, -h_size.y, -h_size.z }, normal_y_neg, uv_bot_r, color };
-  vertex_data_[19] = { { -h_size.x, -h_size.y, -h_size.z }, normal_y_neg, uv_bot_l, color };
-
-  // FACE Y +
-  vertex_data_[20] = { { -h_size.x, h_size.y, -h_size.z }, normal_y, uv_top_l, color };
-  vertex_data_[21] = { { h_size.x, h_size.y, -h_size.z }, normal_y, uv_top_r, color };
-  vertex_data_[22] = { { h_size.x, h_size.y, h_size.z }, normal_y, uv_bot_r, color };
-  vertex_data_[23] = { { -h_size.x, h_size.y, h_size.z }, normal_y, uv_bot_l, color };
-
-  vertex_index_[0] = 0;
-  vertex_index_[1] = 2;
-  vertex_index_[2] = 1;
-  vertex_index_[3] = 0;
-  vertex_index_[4] = 3;
-  vertex_index_[5] = 2;
-
-  vertex_index_[6] = 4;
-  vertex_index_[7] = 6;
-  vertex_index_[8] = 5;
-  vertex_index_[9] = 4;
-  vertex_index_[10] = 7;
-  vertex_index_[11] = 6;
-
-  vertex_index_[12] = 8;
-  vertex_index_[13] = 10;
-  vertex_index_[14] = 9;
-  vertex_index_[15] = 8;
-  vertex_index_[16] = 11;
-  vertex_index_[17] = 10;
-
-  vertex_index_[18] = 12;
-  vertex_index_[19] = 14;
-  vertex_index_[20] = 13;
-  vertex_index_[21] = 12;
-  vertex_index_[22] = 15;
-  vertex_index_[23] = 14;
-  
-  vertex_index_[24] = 16;
-  vertex_index_[25] = 18;
-  vertex_index_[26] = 17;
-  vertex_index_[27] = 16;
-  vertex_index_[28] = 19;
-  vertex_index_[29] = 18;
-
-  vertex_index_[30] = 20;
-  vertex_index_[31] = 22;
-  vertex_index_[32] = 21;
-  vertex_index_[33] = 20;
-  vertex_index_[34] = 23;
-  vertex_index_[35] = 22;
-
-  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::BoxSize(), color)) { return false; }
+  builder.box(size);
+  if (!endMesh(builder)) { return false; }
 
   // Factory info.
   type_ = kType_Cube;
@@ -248,110 +193,60 @@ bool Geo::initCube(const DirectX::XMFLOAT3 size, const DirectX::XMFLOAT4 color)
 }
 
 bool Geo::initSkyBoxCube(const DirectX::XMFLOAT3 size, const DirectX::XMFLOAT4 color) {
-  
-  num_vertices_ = 24;
-  num_indices_ = 36;
-
-  // Vertices info.
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
 
   DirectX::XMFLOAT3 h_size = { size.x * 0.5f, size.y * 0.5f, size.z * 0.5f };
-  DirectX::XMFLOAT3 normal_x = { 1.0f, 0.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_y = { 0.0f, 1.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_z = { 0.0f, 0.0f, 1.0f };
-  DirectX::XMFLOAT3 normal_x_neg = { -1.0f, 0.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_y_neg = { 0.0f, -1.0f, 0.0f };
-  DirectX::XMFLOAT3 normal_z_neg = { 0.0f, 0.0f, -1.0f };
-  DirectX::XMFLOAT2 uv_top_l = { 0.0f, 0.0f };
-  DirectX::XMFLOAT2 uv_top_r = { 1.0f, 0.0f };
-  DirectX::XMFLOAT2 uv_bot_r = { 1.0f, 1.0f };
-  DirectX::XMFLOAT2 uv_bot_l = { 0.0f, 1.0f };
   float32 uv_div = 1.0f / 3.0f;
   float32 uv_div2 = uv_div * 2.0f;
 
-  // FACE Z + 
-  vertex_data_[0] = { { -h_size.x, h_size.y, h_size.z }, normal_z_neg, { 0.25f, uv_div }, color };
-  vertex_data_[1] = { { h_size.x, h_size.y, h_size.z }, normal_z_neg, { 0.50f, uv_div }, color };
-  vertex_data_[2] = { { h_size.x, -h_size.y, h_size.z }, normal_z_neg, { 0.50f, uv_div2 }, color };
-  vertex_data_[3] = { { -h_size.x, -h_size.y, h_size.z }, normal_z_neg, { 0.25f, uv_div2 }, color };
-
-  // FACE X+
-  vertex_data_[4] = { { h_size.x, h_size.y, h_size.z }, normal_x_neg, { 0.50f, uv_div }, color };
-  vertex_data_[5] = { { h_size.x, h_size.y, -h_size.z }, normal_x_neg, { 0.75f, uv_div }, color };
-  vertex_data_[6] = { { h_size.x, -h_size.y, -h_size.z }, normal_x_neg, { 0.75f, uv_div2 }, color };
-  vertex_data_[7] = { { h_size.x, -h_size.y, h_size.z }, normal_x_neg, { 0.50f, uv_div2 }, color };
-
-  // FACE Z -
-  vertex_data_[8] = { { h_size.x, h_size.y, -h_size.z }, normal_z, { 0.75f, uv_div }, color };
-  vertex_data_[9] = { { -h_size.x, h_size.y, -h_size.z }, normal_z, { 1.0f, uv_div }, color };
-  vertex_data_[10] = { { -h_size.x, -h_size.y, -h_size.z }, normal_z, { 1.0f, uv_div2 }, color };
-  vertex_data_[11] = { { h_size.x, -h_size.y, -h_size.z }, normal_z, { 0.75f, uv_div2 }, color };
-
-  // FACE X- 
-  vertex_data_[12] = { { -h_size.x, h_size.y, -h_size.z }, normal_x, { 0.0f, uv_div }, color };
-  vertex_data_[13] = { { -h_size.x, h_size.y, h_size.z }, normal_x, { 0.25f, uv_div }, color };
-  vertex_data_[14] = { { -h_size.x, -h_size.y, h_size.z }, normal_x, { 0.25f, uv_div2 }, color };
-  vertex_data_[15] = { { -h_size.x, -h_size.y, -h_size.z }, normal_x, { 0.0f, uv_div2 }, color };
-
-  // FACE Y -
-  vertex_data_[16] = { { -h_size.x, -h_size.y, h_size.z }, normal_y, { 0.25f, uv_div2 }, color };
-  vertex_data_[17] = { { h_size.x, -h_size.y, h_size.z }, normal_y, { 0.50f, uv_div2 }, color };
-  vertex_data_[18] = { { h_size.x, -h_size.y, -h_size.z }, normal_y, { 0.50f, 1.0f }, color };
-  vertex_data_[19] = { { -h_size.x, -h_size.y, -h_size.z }, normal_y, { 0.25f, 1.0f }, color };
-
-  // FACE Y +
-  vertex_data_[20] = { { -h_size.x, h_size.y, -h_size.z }, normal_y_neg, { 0.25f, 0.0f }, color };
-  vertex_data_[21] = { { h_size.x, h_size.y, -h_size.z }, normal_y_neg, { 0.50f, 0.0f }, color };
-  vertex_data_[22] = { { h_size.x, h_size.y, h_size.z }, normal_y_neg, { 0.50f, uv_div }, color };
-  vertex_data_[23] = { { -h_size.x, h_size.y, h_size.z }, normal_y_neg, { 0.25f, uv_div  }, color };
-
-  vertex_index_[0] = 0;
-  vertex_index_[1] = 1;
-  vertex_index_[2] = 2;
-  vertex_index_[3] = 0;
-  vertex_index_[4] = 2;
-  vertex_index_[5] = 3;
-
-  vertex_index_[6] = 4;
-  vertex_index_[7] = 5;
-  vertex_index_[8] = 6;
-  vertex_index_[9] = 4;
-  vertex_index_[10] = 6;
-  vertex_index_[11] = 7;
-
-  vertex_index_[12] = 8;
-  vertex_index_[13] = 9;
-  vertex_index_[14] = 10;
-  vertex_index_[15] = 8;
-  vertex_index_[16] = 10;
-  vertex_index_[17] = 11;
-
-  vertex_index_[18] = 12;
-  vertex_index_[19] = 13;
-  vertex_index_[20] = 14;
-  vertex_index_[21] = 12;
-  vertex_index_[22] = 14;
-  vertex_index_[23] = 15;
-
-  vertex_index_[24] = 16;
-  vertex_index_[25] = 17;
-  vertex_index_[26] = 18;
-  vertex_index_[27] = 16;
-  vertex_index_[28] = 18;
-  vertex_index_[29] = 19;
-
-  vertex_index_[30] = 20;
-  vertex_index_[31] = 21;
-  vertex_index_[32] = 22;
-  vertex_index_[33] = 20;
-  vertex_index_[34] = 22;
-  vertex_index_[35] = 23;
-
-  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
-
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  // Seen from inside, the faces of a cross shaped texture.
+  struct Face {
+    DirectX::XMFLOAT3 normal;
+    DirectX::XMFLOAT3 corners[4];
+    DirectX::XMFLOAT2 uvs[4];
+  };
+  const Face faces[6] = {
+    // FACE Z +
+    { { 0.0f, 0.0f, -1.0f },
+      { { -h_size.x, h_size.y, h_size.z }, { h_size.x, h_size.y, h_size.z },
+        { h_size.x, -h_size.y, h_size.z }, { -h_size.x, -h_size.y, h_size.z } },
+      { { 0.25f, uv_div }, { 0.50f, uv_div }, { 0.50f, uv_div2 }, { 0.25f, uv_div2 } } },
+    // FACE X+
+    { { -1.0f, 0.0f, 0.0f },
+      { { h_size.x, h_size.y, h_size.z }, { h_size.x, h_size.y, -h_size.z },
+        { h_size.x, -h_size.y, -h_size.z }, { h_size.x, -h_size.y, h_size.z } },
+      { { 0.50f, uv_div }, { 0.75f, uv_div }, { 0.75f, uv_div2 }, { 0.50f, uv_div2 } } },
+    // FACE Z -
+    { { 0.0f, 0.0f, 1.0f },
+      { { h_size.x, h_size.y, -h_size.z }, { -h_size.x, h_size.y, -h_size.z },
+        { -h_size.x, -h_size.y, -h_size.z }, { h_size.x, -h_size.y, -h_size.z } },
+      { { 0.75f, uv_div }, { 1.0f, uv_div }, { 1.0f, uv_div2 }, { 0.75f, uv_div2 } } },
+    // FACE X-
+    { { 1.0f, 0.0f, 0.0f },
+      { { -h_size.x, h_size.y, -h_size.z }, { -h_size.x, h_size.y, h_size.z },
+        { -h_size.x, -h_size.y, h_size.z }, { -h_size.x, -h_size.y, -h_size.z } },
+      { { 0.0f, uv_div }, { 0.25f, uv_div }, { 0.25f, uv_div2 }, { 0.0f, uv_div2 } } },
+    // FACE Y -
+    { { 0.0f, 1.0f, 0.0f },
+      { { -h_size.x, -h_size.y, h_size.z }, { h_size.x, -h_size.y, h_size.z },
+        { h_size.x, -h_size.y, -h_size.z }, { -h_size.x, -h_size.y, -h_size.z } },
+      { { 0.25f, uv_div2 }, { 0.50f, uv_div2 }, { 0.50f, 1.0f }, { 0.25f, 1.0f } } },
+    // FACE Y +
+    { { 0.0f, -1.0f, 0.0f },
+      { { -h_size.x, h_size.y, -h_size.z }, { h_size.x, h_size.y, -h_size.z },
+        { h_size.x, h_size.y, h_size.z }, { -h_size.x, h_size.y, h_size.z } },
+      { { 0.25f, 0.0f }, { 0.50f, 0.0f }, { 0.50f, uv_div }, { 0.25f, uv_div } } },
+  };
+
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::BoxSize(), color)) { return false; }
+  for (uint32 i = 0; i < 6; ++i) {
+    uint32 first = builder.vertex(faces[i].corners[0], faces[i].normal, faces[i].uvs[0]);
+    for (uint32 j = 1; j < 4; ++j) {
+      builder.vertex(faces[i].corners[j], faces[i].normal, faces[i].uvs[j]);
+    }
+    builder.quad(first, first + 1, first + 2, first + 3);
+  }
+  if (!endMesh(builder)) { return false; }
 
   // Factory info.
   type_ = kType_Skybox;
@@ -365,112 +260,111 @@ bool Geo::initTerrain(const char * height_map_filename,
                       const DirectX::XMFLOAT3 grid_size, 
                       const DirectX::XMFLOAT4 color) {
 
-  DirectX::XMINT2 heightmap_size;
-  std::vector<DirectX::XMFLOAT3> height_map_data;
+  if (!buildTerrain(height_map_filename, grid_size, color)) { return false; }
+  if (!createBuffers()) { return false; }
 
-  if (!parseTerrainImage(grid_size, height_map_filename, height_map_data, heightmap_size)) {
-    return false;
-  }
+  // Factory info.
+  type_ = kType_Terrain;
+  info_.terrain.size = { grid_size.x, grid_size.y, grid_size.z };
+  name_ = height_map_filename;
 
-  /* GEOMETRY CREATION */
-  int32 num_points_per_row = heightmap_size.x;
-  int32 num_squares_per_row = num_points_per_row - 1;
-  int32 num_points_per_col = heightmap_size.y;
-  int32 num_squares_per_col = num_points_per_col - 1;
+  return true;
+}
 
-  num_vertices_ = num_points_per_row * num_points_per_col;
-  num_indices_ = num_squares_per_col * num_points_per_row * 2;
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
+bool Geo::buildTerrain(const char * height_map_filename, 
+                       const DirectX::XMFLOAT3 grid_size, 
+                       const DirectX::XMFLOAT4 color,
+                       const char** error) {
 
-  for (int32 y = 0; y < num_points_per_col; y++) {
-	  for (int32 x = 0; x < num_points_per_row; x++) {
-
-		  // NORMALS
-		  DirectX::XMVECTOR up, down, right, left;
-		  DirectX::XMFLOAT3 normal;
-		  int32 idx = y * num_points_per_row + x;
-
-		  // left
-		  if (x == 0) { left = { -1.0f, 0.0f, 0.0f }; }
-		  else {
-			  left = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&height_map_data[idx - 1]), DirectX::XMLoadFloat3(&height_map_data[idx]));
-		  }
-		  // Right
-		  if (x == num_squares_per_row) { right = { 1.0f, 0.0f, 0.0f }; }
-		  else {
-			  right = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&height_map_data[idx + 1]), DirectX::XMLoadFloat3(&height_map_data[idx]));
-		  }
-
-		  // Up 
-		  if (y == 0) { up = { 0.0f, 0.0f, -1.0f }; }
-		  else {
-			  up = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&height_map_data[idx - num_points_per_row]), DirectX::XMLoadFloat3(&height_map_data[idx]));
-		  }
-		  // Down
-		  if (y == num_squares_per_row) { down = { 0.0f, 0.0f, 1.0f }; }
-		  else {
-			  down = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&height_map_data[idx + num_points_per_row]), DirectX::XMLoadFloat3(&height_map_data[idx]));
-		  }
-
-
-		  // Calculating the normals for both vertex. Doing the average between its 4 normals from its 4 neighbors.
-		  DirectX::XMVECTOR tmp_normal;
-		  tmp_normal = DirectX::XMVectorAdd(DirectX::XMVector3Normalize(DirectX::XMVector3Normalize(DirectX::XMVector3Cross(right, up))), DirectX::XMVector3Normalize(DirectX::XMVector3Cross(up, left)));
-		  tmp_normal = DirectX::XMVectorAdd(tmp_normal, DirectX::XMVector3Normalize(DirectX::XMVector3Cross(left, down)));
-		  tmp_normal = DirectX::XMVectorAdd(tmp_normal, DirectX::XMVector3Normalize(DirectX::XMVector3Cross(down, right)));
-		  XMStoreFloat3(&normal, tmp_normal);
-
-		  vertex_data_[idx].position = height_map_data[idx];
-		  vertex_data_[idx].normal = normal;
-		  vertex_data_[idx].uv = { (float32)x / (float32)(num_points_per_row - 1), 
-                               1.0f - (float32)y / (float32)(num_points_per_col - 1) };
-		  vertex_data_[idx].color = color;
-	  }
+  // The heightmap stays mapped while the rows are decoded.
+  HeightMapSource source;
+  if (!source.open(height_map_filename, error)) { return false; }
+
+  DirectX::XMINT2 heightmap_size = source.size();
+  if (heightmap_size.x < 2 || heightmap_size.y < 2) {
+    ReportLoadError("ERROR - Heightmap too small.", error);
+    return false;
   }
 
-  // ELEMENTS
-
-  int32 index = 0;
-  int32 map_index = 0;
-  int32 direction = -1;
-
-  for (int32 y = 0; y < num_squares_per_col; y++) {
-	  direction *= -1;
-	  for (int32 x = 0; x < num_points_per_row; x++) {
-
-		  if (direction > 0) { // Going to the right direction. X+
-							   // 1.
-			  vertex_index_[index] = y * num_points_per_row + map_index;
-			  index++;
-			  // 2.
-			  vertex_index_[index] = (y + 1) * num_points_per_row + map_index;
-			  index++;
-		  }
-		  else { // X-
-				 // 2.
-			  vertex_index_[index] = (y + 1) * num_points_per_row + map_index;
-			  index++;
-			  // 1.
-			  vertex_index_[index] = y * num_points_per_row + map_index;
-			  index++;
-		  }
-
-		  map_index += direction;
-		  // To repeat both side limits twice.
-		  if (map_index > num_squares_per_row) { map_index = num_squares_per_row; }
-		  else if (map_index < 0) { map_index = 0; }
-
-	  }
+  // Same spacing the terrain always had.
+  DirectX::XMFLOAT2 spacing = { grid_size.x / (float32)heightmap_size.x,
+                                grid_size.z / (float32)heightmap_size.y };
+  if (!buildTerrainTile(source, { 0, 0 }, heightmap_size, spacing, grid_size.y, color)) {
+    return false;
   }
-  
-  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP;
+  buildTerrainPatch(color);
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  const TerrainQuadTree::Node& root = terrain_tree_->node(0);
+  const DirectX::XMFLOAT2 size = { (float32)(heightmap_size.x - 1) * spacing.x,
+                                   (float32)(heightmap_size.y - 1) * spacing.y };
+  bounding_box_.Center = { size.x * 0.5f, (root.min_height + root.max_height) * 0.5f, size.y * 0.5f };
+  bounding_box_.Extents = { size.x * 0.5f, (root.max_height - root.min_height) * 0.5f, size.y * 0.5f };
+  buildOccluder();
+
+  return true;
+}
+
+bool Geo::buildTerrainTile(const HeightMapSource& source,
+                           const DirectX::XMINT2 first_sample,
+                           const DirectX::XMINT2 num_samples,
+                           const DirectX::XMFLOAT2 spacing,
+                           const float32 max_height,
+                           const DirectX::XMFLOAT4 color,
+                           const int32 stride) {
+
+  // Heights are kept as 16 bits samples, 65535 is max_height.
+  // Rows in parallel.
+  std::vector<uint16> heights((size_t)num_samples.x * num_samples.y);
+  uint16* samples = heights.data();
+  const DirectX::XMINT2 last_sample = { source.size().x - 1, source.size().y - 1 };
+  int32 row_samples = (num_samples.x - 1) * stride + 1;
+  if (row_samples > last_sample.x - first_sample.x + 1) { row_samples = last_sample.x - first_sample.x + 1; }
+  Core::instance().jobs_.parallelFor(num_samples.y, kTerrainRowsPerJob,
+    [&source, samples, first_sample, num_samples, last_sample, row_samples, stride](uint32 begin, uint32 end) {
+      std::vector<float32> row(row_samples);
+      for (uint32 j = begin; j < end; ++j) {
+        int32 z = first_sample.y + (int32)j * stride;
+        if (z > last_sample.y) { z = last_sample.y; }
+        source.readRegion(first_sample.x, z, row_samples, 1, 65535.0f, row.data());
+        uint16* output = samples + (uint64)j * num_samples.x;
+        for (int32 i = 0; i < num_samples.x; ++i) {
+          const int32 column = i * stride < row_samples ? i * stride : row_samples - 1;
+          output[i] = (uint16)(row[column] + 0.5f);
+        }
+      }
+    });
+
+  // Level of detail nodes, all of them drawn with the same patch grid.
+  // The tree keeps the heights for the ground queries.
+  if (!terrain_tree_) { terrain_tree_ = new TerrainQuadTree(); }
+  terrain_tree_->build(heights, num_samples, spacing, max_height);
+
+  return true;
+}
+
+void Geo::buildTerrainPatch(const DirectX::XMFLOAT4 color) {
+  TerrainMesh::GeneratePatch(TerrainQuadTree::kPatchQuads, color, vertex_data_, vertex_index_);
+  num_vertices_ = vertex_data_.size();
+  num_indices_ = vertex_index_.size();
+
+  topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+
+  // Quadrants are drawn by separate calls.
+  optimizeMesh(4);
+}
+
+bool Geo::initTerrainStreaming(const char* height_map_filename,
+                               const DirectX::XMFLOAT3 grid_size,
+                               const DirectX::XMFLOAT4 color,
+                               const uint64 budget_bytes) {
+
+  // Nothing is read here, the tiles are requested once rendered.
+  terrain_streamer_ = new TerrainStreamer();
+  terrain_streamer_->budget_bytes_ = budget_bytes;
+  if (!terrain_streamer_->init(height_map_filename, grid_size, color)) { return false; }
 
   // Factory info.
-  type_ = kType_Terrain;
+  type_ = kType_StreamedTerrain;
   info_.terrain.size = { grid_size.x, grid_size.y, grid_size.z };
   name_ = height_map_filename;
 
@@ -483,309 +377,155 @@ bool Geo::initExtruded(const uint32 num_polygon_vertex,
                        const float32 height,
                        const DirectX::XMFLOAT4 color) {
 
-  float32 angle = DirectX::XM_2PI / (float32)num_polygon_vertex;
-  float half_height = height * 0.5f;
-  uint32 index = 0, i = 0;
+  if (num_polygon_vertex < 3) { return false; }
 
-  DirectX::XMFLOAT3 base_center = { 0.0f, -half_height, 0.0f };
-  DirectX::XMFLOAT3 top_center = { 0.0f, half_height, 0.0f };
-  std::vector <DirectX::XMFLOAT3> base(num_polygon_vertex);
-  std::vector <DirectX::XMFLOAT3> top(num_polygon_vertex);
+  auto& builder = Core::instance().mesh_builder_;
+  MeshBuilder::Size size = MeshBuilder::FrustumSize(num_polygon_vertex, base_radius, top_radius);
+  if (!builder.begin(size, color)) { return false; }
+  builder.frustum(num_polygon_vertex, base_radius, top_radius, height);
+  if (!endMesh(builder)) { return false; }
 
-  // Generate the regular poligons.
-  for (i = 0; i < num_polygon_vertex; i++) {
-    top[i] = { top_radius * DirectX::XMScalarCos(i * angle), half_height,
-               top_radius * DirectX::XMScalarSin(i * angle) };
+  // Factory info.
+  type_ = kType_Extruded;
+  info_.extruded.base_radius = base_radius;
+  info_.extruded.top_radius = top_radius;
+  info_.extruded.height = height;
+  info_.extruded.num_polygon_vertex = num_polygon_vertex;
+  name_ = "Extruded";
 
-    base[i] = { base_radius * DirectX::XMScalarCos(i * angle), -half_height,
-                base_radius * DirectX::XMScalarSin(i * angle) };
-  }
+  return true;
+}
 
-  num_vertices_ = num_polygon_vertex * 2 + 2 + (num_polygon_vertex - 1) * 4;
-  num_indices_ = num_polygon_vertex * 12;
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
+bool Geo::initPyramid(const uint32 num_base_vertex,
+                      const float32 base_radius,
+                      const float32 height, 
+                      const DirectX::XMFLOAT4 color) {
 
-  // Fill the base.
-  index = 0;
-  vertex_data_[index] = { base_center, { 0.0f, -1.0f, 0.0f }, { 1.0f, 1.0f }, color };
-  index++;
-  for (i = 0; i < num_polygon_vertex; i++) {
-    vertex_data_[index] = { base[i] ,{ 0.0f, -1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-    index++;
-  }
-  // Fill the top.
-  vertex_data_[index] = { top_center,{ 0.0f, 1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-  index++;
-  for (i = 0; i < num_polygon_vertex; i++) {
-    vertex_data_[index] = { top[i] ,{ 0.0f, 1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-    index++;
-  }
-  // Fill the sides.
-  DirectX::XMFLOAT3 normal;
-  DirectX::XMVECTOR n1, n2, vertical, horizontal; 
-  for (i = 0; i < num_polygon_vertex - 1; i++) {
-
-    // 1
-    if (i == 0) { 
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[num_polygon_vertex - 1]), DirectX::XMLoadFloat3(&top[i]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i - 1]), DirectX::XMLoadFloat3(&top[i]));
-    }
-    vertical = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i]), DirectX::XMLoadFloat3(&base[i]));
-    n1 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i]), DirectX::XMLoadFloat3(&top[i + 1]));
-    n2 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorAdd(n1, n2)));
-    vertex_data_[index] = { top[i] , normal ,{ 0.0f, 0.0f }, color };
-    index++;
-
-    // 2
-    if (i == 0) {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[num_polygon_vertex - 1]), DirectX::XMLoadFloat3(&base[i]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i - 1]), DirectX::XMLoadFloat3(&base[i]));
-    }
-    vertical = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i]), DirectX::XMLoadFloat3(&base[i]));
-    n1 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i]), DirectX::XMLoadFloat3(&base[i + 1]));
-    n2 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorAdd(n1, n2)));
-    vertex_data_[index] = { base[i] , normal ,{ 0.0f, 1.0f }, color };
-    index++;
-
-    // 3 
-    horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i]), DirectX::XMLoadFloat3(&top[i + 1]));
-    vertical = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i + 1]), DirectX::XMLoadFloat3(&base[i + 1]));
-    n1 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    if (i + 2 == num_polygon_vertex) {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i + 1]), DirectX::XMLoadFloat3(&top[0]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i + 1]), DirectX::XMLoadFloat3(&top[i + 2]));
-    }
-    n2 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorAdd(n1, n2)));
-    vertex_data_[index] = { top[i + 1] , normal ,{ 1.0f, 0.0f }, color };
-    index++;
-
-    // 4
-    horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i]), DirectX::XMLoadFloat3(&base[i + 1]));
-    vertical = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top[i + 1]), DirectX::XMLoadFloat3(&base[i + 1]));
-    n1 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    if (i + 2 == num_polygon_vertex) {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i + 1]), DirectX::XMLoadFloat3(&base[0]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i + 1]), DirectX::XMLoadFloat3(&base[i + 2]));
-    }
-    n2 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorAdd(n1, n2)));
-    vertex_data_[index] = { base[i + 1] , normal ,{ 1.0f, 1.0f }, color };
-    index++;
-  }
+  if (num_base_vertex < 3) { return false; }
 
-  // Base elements
-  index = 0;
-  for (i = 0; i < num_polygon_vertex - 1; i++) {
-    vertex_index_[index] = 0; // base center
-    index++;
-    vertex_index_[index] = i + 1;
-    index++;
-    vertex_index_[index] = i + 2;
-    index++;
-  }
-  // To connect the last one with the first one
-  vertex_index_[index] = 0; // base center
-  index++;
-  vertex_index_[index] = num_polygon_vertex;
-  index++;
-  vertex_index_[index] = 1;
-  index++;
-
-  // Top elements
-  for (i = 0; i < num_polygon_vertex - 1; i++) {
-    vertex_index_[index] = num_polygon_vertex + 1; // top center
-    index++;
-    vertex_index_[index] = i + num_polygon_vertex + 3;
-    index++;
-    vertex_index_[index] = i + num_polygon_vertex + 2;
-    index++;
-  }
-  // To connect the last one with the first one
-  vertex_index_[index] = num_polygon_vertex + 1; // top center
-  index++;
-  vertex_index_[index] = num_polygon_vertex + 2;
-  index++;
-  vertex_index_[index] = i + num_polygon_vertex + 2;
-  index++;
-
-  // Sides elements
-  uint32 first_element_number = num_polygon_vertex * 2 + 2;
-  for (i = 0; i < num_polygon_vertex - 1; i++) {
-    vertex_index_[index] = i * 4 + first_element_number;
-    index++;
-    vertex_index_[index] = i * 4 + first_element_number + 2;
-    index++;
-    vertex_index_[index] = i * 4 + first_element_number + 1;
-    index++;
-    vertex_index_[index] = i * 4 + first_element_number + 1; 
-    index++;
-    vertex_index_[index] = i * 4 + first_element_number + 2;
-    index++;
-    vertex_index_[index] = i * 4 + first_element_number + 3;
-    index++;
+  // A frustum without top.
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::FrustumSize(num_base_vertex, base_radius, 0.0f), color)) {
+    return false;
   }
-  vertex_index_[index] = i * 4 + first_element_number - 2;
-  index++;
-  vertex_index_[index] = first_element_number;
-  index++;
-  vertex_index_[index] = i * 4 + first_element_number - 1;
-  index++;
-  vertex_index_[index] = i * 4 + first_element_number - 1;
-  index++;
-  vertex_index_[index] = first_element_number;
-  index++;
-  vertex_index_[index] = first_element_number + 1;
-  index++;
+  builder.frustum(num_base_vertex, base_radius, 0.0f, height);
+  if (!endMesh(builder)) { return false; }
 
-  topology_ = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  // Factory info.
+  type_ = kType_Pyramid;
+  info_.pyramid.base_radius = base_radius;
+  info_.pyramid.height = height;
+  info_.pyramid.num_polygon_vertex = num_base_vertex;
+  name_ = "Pyramid";
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  return true;
+}
+
+bool Geo::initSphere(const float32 radius,
+                     const uint32 slices,
+                     const uint32 stacks,
+                     const DirectX::XMFLOAT4 color) {
+
+  if (slices < 3 || stacks < 2) { return false; }
+
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::SphereSize(slices, stacks), color)) { return false; }
+  builder.sphere(radius, slices, stacks);
+  if (!endMesh(builder)) { return false; }
 
   // Factory info.
-  type_ = kType_Extruded;
-  info_.extruded.base_radius = base_radius;
-  info_.extruded.top_radius = top_radius;
-  info_.extruded.height = height;
-  info_.extruded.num_polygon_vertex = num_polygon_vertex;
-  name_ = "Extruded";
+  type_ = kType_Sphere;
+  info_.sphere = { radius, slices, stacks };
+  name_ = "Sphere";
 
   return true;
 }
 
-bool Geo::initPyramid(const uint32 num_base_vertex, 
-                               const float32 base_radius, 
-                               const float32 height, 
-                               const DirectX::XMFLOAT4 color) {
+bool Geo::initCylinder(const float32 radius,
+                       const float32 height,
+                       const uint32 slices,
+                       const DirectX::XMFLOAT4 color) {
 
-  float32 angle = DirectX::XM_2PI / (float32)num_base_vertex;
-  float half_height = height * 0.5f;
-  uint32 index = 0, i = 0;
+  if (slices < 3) { return false; }
 
-  DirectX::XMFLOAT3 base_center = { 0.0f, -half_height, 0.0f };
-  DirectX::XMFLOAT3 top_center = { 0.0f, half_height, 0.0f };
-  std::vector <DirectX::XMFLOAT3> base(num_base_vertex);
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::FrustumSize(slices, radius, radius), color)) { return false; }
+  builder.frustum(slices, radius, radius, height);
+  if (!endMesh(builder)) { return false; }
 
-  // Generate the regular poligon.
-  for (i = 0; i < num_base_vertex; i++) {
-    base[i] = { base_radius * DirectX::XMScalarCos(i * angle), -half_height,
-                base_radius * DirectX::XMScalarSin(i * angle) };
-  }
+  // Factory info.
+  type_ = kType_Cylinder;
+  info_.cylinder = { radius, height, slices };
+  name_ = "Cylinder";
 
-  num_vertices_ = num_base_vertex * 2 + 2;
-  num_indices_ = num_base_vertex * 6;
-  vertex_data_.resize(num_vertices_);
-  vertex_index_.resize(num_indices_);
+  return true;
+}
 
-  // Fill the base.
-  index = 0;
-  vertex_data_[index] = { base_center, { 0.0f, -1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-  index++;
-  for (i = 0; i < num_base_vertex; i++) {
-    vertex_data_[index] = { base[i] ,{ 0.0f, -1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-    index++;
-  }
+bool Geo::initTorus(const float32 radius,
+                    const float32 tube_radius,
+                    const uint32 rings,
+                    const uint32 sides,
+                    const DirectX::XMFLOAT4 color) {
 
-  // Fill the sides.
-  vertex_data_[index] = { top_center,{ 0.0f, 1.0f, 0.0f },{ 1.0f, 1.0f }, color };
-  index++;
-  DirectX::XMFLOAT3 normal;
-  DirectX::XMVECTOR n1, n2, vertical, horizontal;
-  for (i = 0; i < num_base_vertex; i++) {
-    if (i == 0) {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[num_base_vertex - 1]), DirectX::XMLoadFloat3(&base[i]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i - 1]), DirectX::XMLoadFloat3(&base[i]));
-    }
-    vertical = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&top_center), DirectX::XMLoadFloat3(&base[i]));
-    n1 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    if (i == num_base_vertex - 1) {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i]), DirectX::XMLoadFloat3(&base[0]));
-    }
-    else {
-      horizontal = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&base[i]), DirectX::XMLoadFloat3(&base[i + 1]));
-    }
-    n2 = DirectX::XMVector3Normalize(DirectX::XMVector3Cross(DirectX::XMVector3Normalize(horizontal), DirectX::XMVector3Normalize(vertical)));
-    DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMVectorAdd(n2, n1)));
-    vertex_data_[index] = { base[i] , normal ,{ 1.0f, 1.0f }, color };
-    index++;
-  }
+  if (rings < 3 || sides < 3) { return false; }
 
-  index = 0;
-  // Base elements
-  for (i = 0; i < num_base_vertex - 1; i++) {
-    vertex_index_[index] = 0; // base center
-    index++;
-    vertex_index_[index] = i + 1;
-    index++;
-    vertex_index_[index] = i + 2;
-    index++;
-  }
-  // To connect the last one with the first one
-  vertex_index_[index] = 0; // base center
-  index++;
-  vertex_index_[index] = num_base_vertex;
-  index++;
-  vertex_index_[index] = 1;
-  index++;
-
-  // Sides elements
-  for (i = 0; i < num_base_vertex - 1; i++) {
-    vertex_index_[index] = num_base_vertex + 1; // top center
-    index++;
-    vertex_index_[index] = i + 2 + num_base_vertex + 1;
-    index++;
-    vertex_index_[index] = i + 1 + num_base_vertex + 1;
-    index++;
-  }
-  // To connect the last one with the first one
-  vertex_index_[index] = num_base_vertex + 1; // top center
-  index++;
-  vertex_index_[index] = num_base_vertex + 2;
-  index++;
-  vertex_index_[index] = num_base_vertex + num_base_vertex + 1;
-  index++;
-  
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::TorusSize(rings, sides), color)) { return false; }
+  builder.torus(radius, tube_radius, rings, sides);
+  if (!endMesh(builder)) { return false; }
 
-  topology_ = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  // Factory info.
+  type_ = kType_Torus;
+  info_.torus = { radius, tube_radius, rings, sides };
+  name_ = "Torus";
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
+  return true;
+}
+
+bool Geo::initGrid(const DirectX::XMFLOAT2 size,
+                   const uint32 cells_x,
+                   const uint32 cells_z,
+                   const DirectX::XMFLOAT4 color) {
+
+  if (cells_x == 0 || cells_z == 0) { return false; }
+
+  auto& builder = Core::instance().mesh_builder_;
+  if (!builder.begin(MeshBuilder::GridSize(cells_x, cells_z), color)) { return false; }
+  builder.grid(size, cells_x, cells_z);
+  if (!endMesh(builder)) { return false; }
 
   // Factory info.
-  type_ = kType_Pyramid;
-  info_.pyramid.base_radius = base_radius;
-  info_.pyramid.height = height;
-  info_.pyramid.num_polygon_vertex = num_base_vertex;
-  name_ = "Pyramid";
+  type_ = kType_Grid;
+  info_.grid = { { size.x, size.y }, cells_x, cells_z };
+  name_ = "Grid";
 
   return true;
 }
 
-bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
+bool Geo::initFromFile(const char * filename,
+                       const DirectX::XMFLOAT4 color,
+                       const VertexFormat vertex_format) {
 
-  std::ifstream file;
-  file.open(filename);
+  vertex_format_ = vertex_format;
+  if (!parseFromFile(filename, color)) { return false; }
+  if (!createBuffers()) { return false; }
 
-  if (!file) {
-    MessageBox(NULL, "ERROR - Geometry can't be initialized, error filename", "ERROR", MB_OK);
+  type_ = kType_ExternalFile;
+  name_ = filename;
+
+  return true;
+}
+
+bool Geo::parseFromFile(const char * filename,
+                        const DirectX::XMFLOAT4 color,
+                        const char** error) {
+
+  FileView view;
+  if (!Core::instance().vfs_.open(filename, view)) {
+    ReportLoadError("ERROR - Geometry can't be initialized, error filename", error);
     return false;
   }
+  MemoryLineReader file(view.data(), view.size());
   
   // Looking for the mesh. Parsing the file line by line.
   std::string line;
@@ -797,11 +537,11 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
 
   while (!file.eof()) {
-    std::getline(file, line);
+    file.getline(line);
     if (line.find("Mesh") != std::string::npos) {
       number = "";
-      std::getline(file, line);
-      std::getline(file, line);
+      file.getline(line);
+      file.getline(line);
       line_length = line.length();
       while (id < line_length && line[id] != ';') {
         if (line[id] != ' ' && line[id] != '\t') {
@@ -817,7 +557,7 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
   // Save the vertex positions.
   for (W3D::int32 i = 0; i < num_vertices_; ++i) {
-    std::getline(file, line);
+    file.getline(line);
     line_length = line.length();
     number = "";
     id = 0;
@@ -852,7 +592,7 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
   }
 
   // Get the number of elements.
-  std::getline(file, line);
+  file.getline(line);
   line_length = line.length();
   number = "";
   id = 0;
@@ -868,7 +608,7 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
   // Save the indices or elements.
   for (W3D::int32 i = 0; i < num_indices_; i += 3) {
-    std::getline(file, line);
+    file.getline(line);
     line_length = line.length();
 
     id = line.find_first_of(';');
@@ -908,11 +648,11 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
   uint32 num_normals = 0;
   id = 0;
   while (!file.eof()) {
-    std::getline(file, line);
+    file.getline(line);
     if (line.find("MeshNormals") != std::string::npos) {
       number = "";
-      std::getline(file, line);
-      std::getline(file, line);
+      file.getline(line);
+      file.getline(line);
       line_length = line.length();
       while (id < line_length && line[id] != ';') {
         if (line[id] != ' ' && line[id] != '\t') {
@@ -928,7 +668,7 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
   // Save the temp normals.
   for (uint32 i = 0; i < num_normals; ++i) {
-    std::getline(file, line);
+    file.getline(line);
     line_length = line.length();
     number = "";
     id = 0;
@@ -961,9 +701,9 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
   }
 
   // Save the normals using the indices.
-  std::getline(file, line);
+  file.getline(line);
   for (W3D::int32 i = 0; i < num_indices_; i += 3) {
-    std::getline(file, line);
+    file.getline(line);
     line_length = line.length();
 
     id = line.find_first_of(';');
@@ -999,17 +739,17 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
   // Go to the uv section.
   while (!file.eof()) {
-    std::getline(file, line);
+    file.getline(line);
     if (line.find("MeshTextureCoords") != std::string::npos) {
-      std::getline(file, line);
-      std::getline(file, line);
+      file.getline(line);
+      file.getline(line);
       break;
     }
   }
 
   // Save the vertex uv.
   for (W3D::int32 i = 0; i < num_vertices_; ++i) {
-    std::getline(file, line);
+    file.getline(line);
     line_length = line.length();
     number = "";
     id = 0;
@@ -1035,161 +775,477 @@ bool Geo::initFromFile(const char * filename, const DirectX::XMFLOAT4 color) {
 
   topology_ = D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
 
-  if (!createVertexBuffer()) { return false; }
-  if (!createIndexBuffer()) { return false; }
-
-  type_ = kType_ExternalFile;
-  name_ = filename;
+  // Done here so the asynchronous loads optimize in the workers.
+  optimizeMesh();
+  generateLods();
+  buildMeshlets();
+  buildOccluder();
 
   return true;
 }
 
+void Geo::optimizeMesh(const uint32 num_ranges) {
+  lods_.clear();
+  meshlets_.count = 0;
+  occluder_positions_.clear();
+  occluder_indices_.clear();
+  mesh_stats_ = MeshOptimizer::Optimize(vertex_data_, vertex_index_, num_ranges);
+  num_vertices_ = vertex_data_.size();
+  num_indices_ = vertex_index_.size();
+  mesh_optimized_ = true;
+}
 
+void Geo::generateLods() {
 
-/*******************************************************************************
-***                              Private methods                             ***
-*******************************************************************************/
+  lods_.clear();
+  bounding_radius_ = 0.0f;
+  if (vertex_index_.empty() || topology_ != D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST) { return; }
 
-bool Geo::createVertexBuffer() {
-  // Creamos un buffer para subir la informacion de los vertices a la grafica.
-  D3D11_BUFFER_DESC vertex_description;
-  ZeroMemory(&vertex_description, sizeof(D3D11_BUFFER_DESC));
+  for (uint32 i = 0; i < vertex_data_.size(); ++i) {
+    const DirectX::XMFLOAT3& p = vertex_data_[i].position;
+    float32 radius = sqrtf(p.x * p.x + p.y * p.y + p.z * p.z);
+    if (radius > bounding_radius_) { bounding_radius_ = radius; }
+  }
+  DirectX::BoundingBox::CreateFromPoints(bounding_box_, vertex_data_.size(),
+                                         &vertex_data_[0].position, sizeof(VertexData));
+
+  LodLevel full = { 0, (uint32)vertex_index_.size(), 0.0f };
+  lods_.push_back(full);
+
+  // Every level simplifies the previous one, so the errors add up.
+  const float32 max_error = bounding_radius_ * kLodMaxErrorRatio;
+  std::vector<uint32> lod_indices;
+  while (lods_.size() < kMaxLodLevels) {
+    const LodLevel previous = lods_.back();
+    uint32 target = previous.num_indices / 6 * 3;
+    float32 error = MeshSimplifier::Simplify(vertex_data_, &vertex_index_[previous.first_index],
+                                             previous.num_indices, target,
+                                             max_error - previous.error, lod_indices);
+    if (lod_indices.size() < 3 ||
+        lod_indices.size() > previous.num_indices * (1.0f - kLodMinReduction)) {
+      break;
+    }
 
-  vertex_description.Usage = D3D11_USAGE_DEFAULT;
-  vertex_description.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-  vertex_description.ByteWidth = sizeof(VertexData) * num_vertices_;
+    MeshOptimizer::OptimizeVertexCache(lod_indices.data(), lod_indices.size(),
+                                       vertex_data_.size(), nullptr);
+    LodLevel level = { (uint32)vertex_index_.size(), (uint32)lod_indices.size(),
+                       previous.error + error };
+    vertex_index_.insert(vertex_index_.end(), lod_indices.begin(), lod_indices.end());
+    lods_.push_back(level);
+  }
 
-  D3D11_SUBRESOURCE_DATA vertex_data;
-  ZeroMemory(&vertex_data, sizeof(D3D11_SUBRESOURCE_DATA));
-  vertex_data.pSysMem = vertex_data_.data();
+  num_indices_ = vertex_index_.size();
+}
 
-  auto* device = Core::instance().d3d_.device();
+void Geo::buildMeshlets() {
 
-  if (FAILED(device->CreateBuffer(&vertex_description, &vertex_data, &vertex_buffer_))) {
-    MessageBox(NULL, "ERROR - Vertex buffer not created", "ERROR", MB_OK);
-    return false;
+  meshlets_.count = 0;
+  if (lods_.empty() || lods_[0].num_indices / 3 < kMinMeshletsTriangles) { return; }
+
+  // Reorders inside the full level only, the coarser ones follow it.
+  Meshlets::Build(&vertex_data_[0].position, sizeof(VertexData),
+                  vertex_index_.data(), lods_[0].first_index, lods_[0].num_indices,
+                  &meshlets_);
+}
+
+void Geo::buildOccluder() {
+
+  occluder_positions_.clear();
+  occluder_indices_.clear();
+
+  if (terrain_tree_) {
+    // Every vertex at the lowest height of the cells around it, so the
+    // grid stays under the terrain.
+    const DirectX::XMINT2 samples = terrain_tree_->samples();
+    const DirectX::XMFLOAT2 spacing = terrain_tree_->sample_spacing();
+    const uint16* heights = terrain_tree_->heights().data();
+    const float32 height_scale = terrain_tree_->max_height() / 65535.0f;
+    const int32 quads_x = samples.x - 1;
+    const int32 quads_z = samples.y - 1;
+    const int32 cells_x = quads_x < kOccluderTerrainCells ? quads_x : kOccluderTerrainCells;
+    const int32 cells_z = quads_z < kOccluderTerrainCells ? quads_z : kOccluderTerrainCells;
+    if (cells_x < 1 || cells_z < 1) { return; }
+
+    std::vector<uint16> cell_min((size_t)cells_x * cells_z);
+    uint16* lowest = cell_min.data();
+    Core::instance().jobs_.parallelFor(cells_z, 1,
+      [heights, samples, quads_x, quads_z, cells_x, cells_z, lowest](uint32 begin, uint32 end) {
+        for (uint32 cz = begin; cz < end; ++cz) {
+          const int32 first_z = cz * quads_z / cells_z;
+          const int32 last_z = (cz + 1) * quads_z / cells_z;
+          for (int32 cx = 0; cx < cells_x; ++cx) {
+            const int32 first_x = cx * quads_x / cells_x;
+            const int32 last_x = (cx + 1) * quads_x / cells_x;
+            uint16 value = 0xFFFF;
+            for (int32 z = first_z; z <= last_z; ++z) {
+              const uint16* row = heights + (uint64)z * samples.x;
+              for (int32 x = first_x; x <= last_x; ++x) {
+                if (row[x] < value) { value = row[x]; }
+              }
+            }
+            lowest[cz * cells_x + cx] = value;
+          }
+        }
+      });
+
+    occluder_positions_.reserve((cells_x + 1) * (cells_z + 1));
+    for (int32 vz = 0; vz <= cells_z; ++vz) {
+      for (int32 vx = 0; vx <= cells_x; ++vx) {
+        uint16 value = 0xFFFF;
+        for (int32 cz = vz - 1; cz <= vz; ++cz) {
+          for (int32 cx = vx - 1; cx <= vx; ++cx) {
+            if (cz < 0 || cz >= cells_z || cx < 0 || cx >= cells_x) { continue; }
+            if (lowest[cz * cells_x + cx] < value) { value = lowest[cz * cells_x + cx]; }
+          }
+        }
+        const float32 x = (float32)(vx * quads_x / cells_x) * spacing.x;
+        const float32 z = (float32)(vz * quads_z / cells_z) * spacing.y;
+        occluder_positions_.push_back({ x, (float32)value * height_scale, z });
+      }
+    }
+
+    // Facing up.
+    occluder_indices_.reserve(cells_x * cells_z * 6);
+    for (int32 cz = 0; cz < cells_z; ++cz) {
+      for (int32 cx = 0; cx < cells_x; ++cx) {
+        const uint32 p00 = cz * (cells_x + 1) + cx;
+        const uint32 p01 = p00 + cells_x + 1;
+        const uint32 p10 = p00 + 1;
+        const uint32 p11 = p01 + 1;
+        const uint32 quad[6] = { p00, p01, p10, p10, p01, p11 };
+        occluder_indices_.insert(occluder_indices_.end(), quad, quad + 6);
+      }
+    }
+    return;
+  }
+
+  if (lods_.empty()) { return; }
+
+  // Only the vertices of the level are kept.
+  uint32 lod = 0;
+  while (lod + 1 < lods_.size() && lods_[lod + 1].error <= bounding_radius_ * kOccluderMaxErrorRatio) {
+    lod++;
+  }
+  const LodLevel& level = lods_[lod];
+  std::vector<uint32> remap(vertex_data_.size(), 0xFFFFFFFF);
+  occluder_indices_.resize(level.num_indices);
+  for (uint32 i = 0; i < level.num_indices; ++i) {
+    const uint32 vertex = vertex_index_[level.first_index + i];
+    if (remap[vertex] == 0xFFFFFFFF) {
+      remap[vertex] = occluder_positions_.size();
+      occluder_positions_.push_back(vertex_data_[vertex].position);
+    }
+    occluder_indices_[i] = remap[vertex];
   }
-  return true;
 }
 
+uint32 Geo::selectLod(const float32 pixels_per_unit, const uint32 current_lod) const {
 
-bool Geo::createIndexBuffer() {
-  // Creamos un buffer para subir la informacion de los indices a la grafica.
-  D3D11_BUFFER_DESC index_description;
-  ZeroMemory(&index_description, sizeof(D3D11_BUFFER_DESC));
+  if (lods_.size() < 2) { return 0; }
+  uint32 lod = current_lod < lods_.size() ? current_lod : lods_.size() - 1;
 
-  index_description.Usage = D3D11_USAGE_DEFAULT;
-  index_description.BindFlags = D3D11_BIND_INDEX_BUFFER;
-  index_description.ByteWidth = sizeof(uint32) * num_indices_;
+  // Finer as soon as the error shows, coarser only once it is well hidden.
+  while (lod > 0 && lods_[lod].error * pixels_per_unit > kLodPixelError) { lod--; }
+  while (lod + 1 < lods_.size() &&
+         lods_[lod + 1].error * pixels_per_unit < kLodPixelError * kLodHysteresis) {
+    lod++;
+  }
+  return lod;
+}
 
-  D3D11_SUBRESOURCE_DATA index_data;
-  ZeroMemory(&index_data, sizeof(D3D11_SUBRESOURCE_DATA));
-  index_data.pSysMem = vertex_index_.data();
+bool Geo::createBuffers() {
+  if (!mesh_optimized_ && !dynamic_) { optimizeMesh(); }
+  if (vertex_format_ == kVertexFormat_Packed) {
+    if (!createPackedVertexBuffer()) { return false; }
+  }
+  else if (!createVertexBuffer()) { return false; }
+  if (!createIndexBuffer()) { return false; }
+  if (terrain_tree_ && !createHeightTexture()) { return false; }
+  return true;
+}
+
+bool Geo::createHeightTexture() {
+  DirectX::XMINT2 samples = terrain_tree_->samples();
+
+  D3D11_TEXTURE2D_DESC texture_description;
+  ZeroMemory(&texture_description, sizeof(D3D11_TEXTURE2D_DESC));
+  texture_description.Width = samples.x;
+  texture_description.Height = samples.y;
+  texture_description.MipLevels = 1;
+  texture_description.ArraySize = 1;
+  texture_description.Format = DXGI_FORMAT_R16_UNORM;
+  texture_description.SampleDesc.Count = 1;
+  texture_description.Usage = D3D11_USAGE_IMMUTABLE;
+  texture_description.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+  D3D11_SUBRESOURCE_DATA texture_data;
+  ZeroMemory(&texture_data, sizeof(D3D11_SUBRESOURCE_DATA));
+  texture_data.pSysMem = terrain_tree_->heights().data();
+  texture_data.SysMemPitch = samples.x * sizeof(uint16);
 
   auto* device = Core::instance().d3d_.device();
 
-  if (FAILED(device->CreateBuffer(&index_description, &index_data, &vertex_index_buffer_))) {
-    MessageBox(NULL, "ERROR - Vertex buffer not created", "ERROR", MB_OK);
+  ID3D11Texture2D* texture = nullptr;
+  if (FAILED(device->CreateTexture2D(&texture_description, &texture_data, &texture))) {
+    MessageBox(NULL, "ERROR - Terrain height texture not created", "ERROR", MB_OK);
+    return false;
+  }
+  HRESULT result = device->CreateShaderResourceView(texture, NULL, &height_texture_);
+  texture->Release();
+  if (FAILED(result)) {
+    MessageBox(NULL, "ERROR - Terrain height texture view not created", "ERROR", MB_OK);
     return false;
   }
+
   return true;
 }
 
+bool Geo::heightAt(const float32 x, const float32 z, float32* height) {
 
+  if (load_state_ != kLoadState_Ready) { return false; }
 
-bool Geo::parseTerrainImage(const DirectX::XMFLOAT3 terrain_size, 
-                                     const char * filename, 
-                                     std::vector<DirectX::XMFLOAT3>& vertices_output, 
-                                     DirectX::XMINT2 & grid_rows_cols_output) {
+  if (terrain_streamer_) {
+    DirectX::XMFLOAT3 offset;
+    Geo* tile = terrain_streamer_->tileAt(x, z, &offset);
+    if (!tile) { return false; }
+    *height = tile->terrain_tree_->heightAt(x - offset.x, z - offset.z) + offset.y;
+    return true;
+  }
 
-  FILE* filePtr;
-  int32 error;
-  uint32 count;
-  BITMAPFILEHEADER bitmapFileHeader;
-  BITMAPINFOHEADER bitmapInfoHeader;
-  int32 imageSize, i, j, k, index;
-  uchar8* bitmapImage;
-  uchar8 height;
-  
+  if (!terrain_tree_) { return false; }
+  *height = terrain_tree_->heightAt(x, z);
+  return true;
+}
 
-  // Open the height map file in binary.
-  if (fopen_s(&filePtr, filename, "rb")) {
-    MessageBox(NULL, "ERROR - Heightmap filename incorrect.", "ERROR", MB_OK);
-    return false;
+bool Geo::normalAt(const float32 x, const float32 z, DirectX::XMFLOAT3* normal) {
+
+  if (load_state_ != kLoadState_Ready) { return false; }
+
+  if (terrain_streamer_) {
+    DirectX::XMFLOAT3 offset;
+    Geo* tile = terrain_streamer_->tileAt(x, z, &offset);
+    if (!tile) { return false; }
+    *normal = tile->terrain_tree_->normalAt(x - offset.x, z - offset.z);
+    return true;
   }
 
-  // Read in the file header.
-  count = fread(&bitmapFileHeader, sizeof(BITMAPFILEHEADER), 1, filePtr);
-  if (count != 1) {
-    MessageBox(NULL, "ERROR - Heightmap file is empty.", "ERROR", MB_OK);
-    return false;
+  if (!terrain_tree_) { return false; }
+  *normal = terrain_tree_->normalAt(x, z);
+  return true;
+}
+
+bool Geo::raycast(const DirectX::XMFLOAT3 origin,
+                  const DirectX::XMFLOAT3 direction,
+                  const float32 max_distance,
+                  float32* distance) {
+
+  if (load_state_ != kLoadState_Ready) { return false; }
+
+  DirectX::XMVECTOR length = DirectX::XMVector3Length(DirectX::XMLoadFloat3(&direction));
+  if (DirectX::XMVectorGetX(length) <= 0.0f) { return false; }
+  DirectX::XMFLOAT3 unit_direction;
+  DirectX::XMStoreFloat3(&unit_direction,
+                         DirectX::XMVectorDivide(DirectX::XMLoadFloat3(&direction), length));
+
+  if (terrain_streamer_) {
+    return terrain_streamer_->raycast(origin, unit_direction, max_distance, distance);
   }
 
-  // Read in the bitmap info header.
-  count = fread(&bitmapInfoHeader, sizeof(BITMAPINFOHEADER), 1, filePtr);
-  if (count != 1) {
-    MessageBox(NULL, "ERROR - Heightmap info header incorrect.", "ERROR", MB_OK);
-    return false;
+  if (!terrain_tree_) { return false; }
+  return terrain_tree_->raycast(origin, unit_direction, max_distance, distance);
+}
+
+bool Geo::initDynamic(const VertexData* vertices,
+                      const uint32 num_vertices,
+                      const uint32* indices,
+                      const uint32 num_indices,
+                      const D3D_PRIMITIVE_TOPOLOGY topology) {
+
+  if (!vertices || !indices || num_vertices == 0 || num_indices == 0) { return false; }
+
+  num_vertices_ = num_vertices;
+  num_indices_ = num_indices;
+  vertex_data_.assign(vertices, vertices + num_vertices);
+  vertex_index_.assign(indices, indices + num_indices);
+  topology_ = topology;
+
+  // Edited by index, so no welding nor reordering, and no packing.
+  dynamic_ = true;
+  vertex_format_ = kVertexFormat_Full;
+  lods_.clear();
+  meshlets_.count = 0;
+  // The vertices can move anywhere, so no bounds to test nor occluder.
+  bounding_box_.Extents = { 0.0f, 0.0f, 0.0f };
+  occluder_positions_.clear();
+  occluder_indices_.clear();
+
+  if (!createBuffers()) { return false; }
+
+  type_ = kType_Dynamic;
+  name_ = "Dynamic";
+
+  return true;
+}
+
+Geo::VertexData* Geo::editVertices(const uint32 first, const uint32 count) {
+  if (!dynamic_ || count == 0 || first >= num_vertices_ || count > num_vertices_ - first) {
+    return nullptr;
   }
+  markDirty(first, count);
+  return &vertex_data_[first];
+}
 
-  // Save the dimensions of the terrain.
-  grid_rows_cols_output = { bitmapInfoHeader.biWidth, bitmapInfoHeader.biHeight };
+bool Geo::updateVertices(const uint32 first,
+                         const uint32 count,
+                         const VertexData* vertices) {
+  VertexData* destination = editVertices(first, count);
+  if (!destination) { return false; }
+  memcpy(destination, vertices, count * sizeof(VertexData));
+  return true;
+}
 
-  // Calculate the size of the bitmap image data.
-  imageSize = grid_rows_cols_output.x * grid_rows_cols_output.y * 3;
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
 
-  // Allocate memory for the bitmap image data.
-  bitmapImage = new unsigned char[imageSize];
-  if (!bitmapImage) {
-    MessageBox(NULL, "ERROR - Allocating memory for the bitmap image data.", "ERROR", MB_OK);
-    return false;
+void Geo::markDirty(const uint32 first, const uint32 count) {
+
+  const bool was_clean = dirty_vertices_.empty();
+
+  // First range ending at or after first, it and the next ones may merge.
+  uint32 start = first;
+  uint32 end = first + count;
+  auto range = std::lower_bound(dirty_vertices_.begin(), dirty_vertices_.end(), start,
+                                [](const DirtyRange& dirty, const uint32 vertex) {
+                                  return dirty.first + dirty.count < vertex;
+                                });
+  auto last = range;
+  while (last != dirty_vertices_.end() && last->first <= end) {
+    start = last->first < start ? last->first : start;
+    end = last->first + last->count > end ? last->first + last->count : end;
+    ++last;
+  }
+  range = dirty_vertices_.erase(range, last);
+  dirty_vertices_.insert(range, { start, end - start });
+
+  if (was_clean && vertex_allocation_.handle != TlsfAllocator::kInvalidHandle) {
+    Core::instance().geometry_arena_.markDirty(this);
   }
+}
 
-  // Move to the beginning of the bitmap data.
-  fseek(filePtr, bitmapFileHeader.bfOffBits, SEEK_SET);
+bool Geo::endMesh(MeshBuilder& builder) {
+  if (!builder.end(this)) { return false; }
+  num_vertices_ = vertex_allocation_.count;
+  num_indices_ = index_allocation_.count;
+  return true;
+}
 
-  // Read in the bitmap image data.
-  count = fread(bitmapImage, 1, imageSize, filePtr);
-  if (count != imageSize) {
-    delete[] bitmapImage;
-    MessageBox(NULL, "ERROR - Allocating memory for the bitmap image data.", "ERROR", MB_OK);
+bool Geo::createVertexBuffer() {
+  // The vertices go to their range of the shared buffer.
+  auto& arena = Core::instance().geometry_arena_;
+  arena.release(&vertex_allocation_);
+  if (!arena.allocate(GeometryArena::kPool_FullVertices, num_vertices_,
+                      vertex_data_.data(), &vertex_allocation_)) {
+    MessageBox(NULL, "ERROR - Vertex buffer not created", "ERROR", MB_OK);
     return false;
   }
+  return true;
+}
 
-  // Close the file.
-  error = fclose(filePtr);
-  if (error != 0) {
-    delete[] bitmapImage;
-    MessageBox(NULL, "ERROR - File couldnt be closed.", "ERROR", MB_OK);
-    return false;
+bool Geo::createPackedVertexBuffer() {
+
+  // Positions are quantized inside the mesh bounds.
+  DirectX::XMVECTOR bounds_min = DirectX::XMVectorReplicate(FLT_MAX);
+  DirectX::XMVECTOR bounds_max = DirectX::XMVectorReplicate(-FLT_MAX);
+  for (int32 i = 0; i < num_vertices_; ++i) {
+    DirectX::XMVECTOR position = DirectX::XMLoadFloat3(&vertex_data_[i].position);
+    bounds_min = DirectX::XMVectorMin(bounds_min, position);
+    bounds_max = DirectX::XMVectorMax(bounds_max, position);
+  }
+  // Flat meshes keep a valid extent in their flat axis.
+  DirectX::XMVECTOR extent = DirectX::XMVectorMax(DirectX::XMVectorSubtract(bounds_max, bounds_min),
+                                                  DirectX::XMVectorReplicate(FLT_EPSILON));
+  DirectX::XMVECTOR inverse_extent = DirectX::XMVectorReciprocal(extent);
+  DirectX::XMVECTOR half = DirectX::XMVectorReplicate(0.5f);
+
+  std::vector<PackedVertexData> packed(num_vertices_);
+  for (int32 i = 0; i < num_vertices_; ++i) {
+    const VertexData& vertex = vertex_data_[i];
+    PackedVertexData& output = packed[i];
+
+    DirectX::PackedVector::XMUSHORTN4 position;
+    DirectX::PackedVector::XMStoreUShortN4(&position,
+      DirectX::XMVectorMultiply(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&vertex.position),
+                                                          bounds_min),
+                                inverse_extent));
+    output.position[0] = position.x;
+    output.position[1] = position.y;
+    output.position[2] = position.z;
+    output.position[3] = 0;
+
+    DirectX::PackedVector::XMUDECN4 normal;
+    DirectX::PackedVector::XMStoreUDecN4(&normal,
+      DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat3(&vertex.normal), half, half));
+    output.normal = normal.v;
+
+    output.uv[0] = DirectX::PackedVector::XMConvertFloatToHalf(vertex.uv.x);
+    output.uv[1] = DirectX::PackedVector::XMConvertFloatToHalf(vertex.uv.y);
+
+    DirectX::PackedVector::XMUBYTEN4 color;
+    DirectX::PackedVector::XMStoreUByteN4(&color, DirectX::XMLoadFloat4(&vertex.color));
+    output.color = color.v;
   }
 
-  // Initialize the position in the image data buffer.
-  k = 0;
+  auto& arena = Core::instance().geometry_arena_;
+  arena.release(&vertex_allocation_);
+  if (!arena.allocate(GeometryArena::kPool_PackedVertices, num_vertices_,
+                      packed.data(), &vertex_allocation_)) {
+    MessageBox(NULL, "ERROR - Vertex buffer not created", "ERROR", MB_OK);
+    return false;
+  }
 
-  // Save the heightmap_data.
-  vertices_output.resize(grid_rows_cols_output.x * grid_rows_cols_output.y);
+  // The bounds never change, read by the packed vertex shader.
+  PackedVertexSettings settings;
+  DirectX::XMStoreFloat4(&settings.position_min, bounds_min);
+  DirectX::XMStoreFloat4(&settings.position_extent, extent);
 
-  // Read the image data into the height map.
-  for (j = 0; j< grid_rows_cols_output.y; j++)
-  {
-    for (i = 0; i<grid_rows_cols_output.x; i++)
-    {
-      height = bitmapImage[k];
+  D3D11_BUFFER_DESC bounds_description;
+  ZeroMemory(&bounds_description, sizeof(D3D11_BUFFER_DESC));
+  bounds_description.Usage = D3D11_USAGE_IMMUTABLE;
+  bounds_description.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+  bounds_description.ByteWidth = sizeof(PackedVertexSettings);
 
-      index = (grid_rows_cols_output.y * j) + i;
+  D3D11_SUBRESOURCE_DATA bounds_data;
+  ZeroMemory(&bounds_data, sizeof(D3D11_SUBRESOURCE_DATA));
+  bounds_data.pSysMem = &settings;
 
-      vertices_output[index].x = (float32)i / (float32)grid_rows_cols_output.x * terrain_size.x;
-      vertices_output[index].y = terrain_size.y * (float32)height / 256.0f;
-      vertices_output[index].z = (float32)j / (float32)grid_rows_cols_output.y * terrain_size.z;
+  auto* device = Core::instance().d3d_.device();
+  if (bounds_buffer_) { bounds_buffer_->Release(); }
+  if (FAILED(device->CreateBuffer(&bounds_description, &bounds_data, &bounds_buffer_))) {
+    MessageBox(NULL, "ERROR - Vertex bounds buffer not created", "ERROR", MB_OK);
+    return false;
+  }
+  return true;
+}
 
-      k += 3;
-    }
+bool Geo::createIndexBuffer() {
+  // Indices are relative to the base vertex, so 16 bits are enough when the
+  // vertices fit. 0xFFFF is left as the strip cut value.
+  GeometryArena::Pool pool = GeometryArena::kPool_Indices32;
+  const void* data = vertex_index_.data();
+  std::vector<uint16> short_indices;
+  if (num_vertices_ < 0xFFFF) {
+    short_indices.assign(vertex_index_.begin(), vertex_index_.end());
+    pool = GeometryArena::kPool_Indices16;
+    data = short_indices.data();
   }
 
-  // Release the bitmap image data.
-  delete[] bitmapImage;
-  bitmapImage = nullptr;
+  auto& arena = Core::instance().geometry_arena_;
+  arena.release(&index_allocation_);
+  if (!arena.allocate(pool, num_indices_, data, &index_allocation_)) {
+    MessageBox(NULL, "ERROR - Index buffer not created", "ERROR", MB_OK);
+    return false;
+  }
   return true;
 }
 
@@ -0,0 +1,385 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/geometry_arena.h"
+#include "core/geo.h"
+#include "core/core.h"
+#include <algorithm>
+
+namespace W3D {
+
+/// Elements of every pool when created, they double when full.
+const uint32 kArenaInitialVertices = 64 * 1024;
+const uint32 kArenaInitialIndices = 256 * 1024;
+/// Size of every staging buffer, bytes uploaded at most per upload.
+const uint32 kStagingBytes = 1024 * 1024;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+GeometryArena::GeometryArena() {
+  for (uint32 i = 0; i < kPool_Count; ++i) {
+    pools_[i].buffer = nullptr;
+    pools_[i].capacity = 0;
+  }
+  pools_[kPool_FullVertices].stride = sizeof(Geo::VertexData);
+  pools_[kPool_FullVertices].initial_capacity = kArenaInitialVertices;
+  pools_[kPool_FullVertices].bind_flags = D3D11_BIND_VERTEX_BUFFER;
+  pools_[kPool_PackedVertices].stride = sizeof(Geo::PackedVertexData);
+  pools_[kPool_PackedVertices].initial_capacity = kArenaInitialVertices;
+  pools_[kPool_PackedVertices].bind_flags = D3D11_BIND_VERTEX_BUFFER;
+  pools_[kPool_Indices16].stride = sizeof(uint16);
+  pools_[kPool_Indices16].initial_capacity = kArenaInitialIndices;
+  pools_[kPool_Indices16].bind_flags = D3D11_BIND_INDEX_BUFFER;
+  pools_[kPool_Indices32].stride = sizeof(uint32);
+  pools_[kPool_Indices32].initial_capacity = kArenaInitialIndices;
+  pools_[kPool_Indices32].bind_flags = D3D11_BIND_INDEX_BUFFER;
+
+  bound_vertex_pool_ = kPool_Count;
+  bound_index_pool_ = kPool_Count;
+  num_binds_ = 0;
+  num_skipped_binds_ = 0;
+
+  for (uint32 i = 0; i < kStagingBuffers; ++i) { staging_[i] = nullptr; }
+  staging_index_ = 0;
+  upload_buffer_ = nullptr;
+  upload_temporary_ = false;
+  uploaded_bytes_frame_ = 0;
+  uploaded_bytes_last_frame_ = 0;
+  uploaded_bytes_total_ = 0;
+}
+
+GeometryArena::~GeometryArena() {
+  shutdown();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+bool GeometryArena::allocate(const Pool pool,
+                             const uint32 count,
+                             const void* data,
+                             Allocation* allocation) {
+
+  PoolData& pool_data = pools_[pool];
+  uint32 offset;
+  uint32 handle = pool_data.allocator.allocate(count, &offset);
+  if (handle == TlsfAllocator::kInvalidHandle) {
+    if (!growPool(pool, count)) { return false; }
+    handle = pool_data.allocator.allocate(count, &offset);
+    if (handle == TlsfAllocator::kInvalidHandle) { return false; }
+  }
+
+  if (data && count > 0) {
+    D3D11_BOX box = { offset * pool_data.stride, 0, 0,
+                      (offset + count) * pool_data.stride, 1, 1 };
+    Core::instance().d3d_.deviceContext()->UpdateSubresource(pool_data.buffer, 0, &box, data, 0, 0);
+  }
+
+  allocation->pool = pool;
+  allocation->handle = handle;
+  allocation->offset = offset;
+  allocation->count = count;
+  return true;
+}
+
+void GeometryArena::release(Allocation* allocation) {
+  if (allocation->handle == TlsfAllocator::kInvalidHandle) { return; }
+  pools_[allocation->pool].allocator.release(allocation->handle);
+  allocation->handle = TlsfAllocator::kInvalidHandle;
+  allocation->offset = 0;
+  allocation->count = 0;
+}
+
+void GeometryArena::bind(const Pool vertex_pool, const Pool index_pool) {
+  auto* device_context = Core::instance().d3d_.deviceContext();
+
+  if (vertex_pool != bound_vertex_pool_) {
+    uint32 stride = pools_[vertex_pool].stride;
+    uint32 offset = 0;
+    device_context->IASetVertexBuffers(0, 1, &pools_[vertex_pool].buffer, &stride, &offset);
+    bound_vertex_pool_ = vertex_pool;
+    num_binds_++;
+  }
+  else {
+    num_skipped_binds_++;
+  }
+
+  if (index_pool != bound_index_pool_) {
+    DXGI_FORMAT format = index_pool == kPool_Indices16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    device_context->IASetIndexBuffer(pools_[index_pool].buffer, format, 0);
+    bound_index_pool_ = index_pool;
+    num_binds_++;
+  }
+  else {
+    num_skipped_binds_++;
+  }
+}
+
+void GeometryArena::invalidateBindings() {
+  bound_vertex_pool_ = kPool_Count;
+  bound_index_pool_ = kPool_Count;
+}
+
+void GeometryArena::beginFrame() {
+  uploaded_bytes_last_frame_ = uploaded_bytes_frame_;
+  uploaded_bytes_frame_ = 0;
+  invalidateBindings();
+}
+
+void GeometryArena::markDirty(Geo* geometry) {
+  dirty_geometries_.push_back(geometry);
+}
+
+void GeometryArena::cancelUploads(Geo* geometry) {
+  dirty_geometries_.erase(std::remove(dirty_geometries_.begin(), dirty_geometries_.end(), geometry),
+                          dirty_geometries_.end());
+}
+
+void GeometryArena::uploadDirty() {
+
+  if (dirty_geometries_.empty()) { return; }
+  if (!staging_[0] && !createStagingRing()) { return; }
+
+  auto* device_context = Core::instance().d3d_.deviceContext();
+  ID3D11Buffer* staging = staging_[staging_index_];
+  staging_index_ = (staging_index_ + 1) % kStagingBuffers;
+
+  // Waits only if the GPU is still copying from it, kStagingBuffers ago.
+  D3D11_MAPPED_SUBRESOURCE mapped;
+  if (FAILED(device_context->Map(staging, 0, D3D11_MAP_WRITE, 0, &mapped))) { return; }
+
+  staging_copies_.clear();
+  uint32 staging_offset = 0;
+  uint32 num_done = 0;
+  for (; num_done < dirty_geometries_.size(); ++num_done) {
+    Geo* geometry = dirty_geometries_[num_done];
+    const GeometryArena::Allocation& allocation = geometry->vertex_allocation_;
+    const uint32 stride = pools_[allocation.pool].stride;
+    auto& ranges = geometry->dirty_vertices_;
+
+    uint32 num_ranges = 0;
+    for (; num_ranges < ranges.size(); ++num_ranges) {
+      Geo::DirtyRange& range = ranges[num_ranges];
+      uint32 count = (kStagingBytes - staging_offset) / stride;
+      if (count == 0) { break; }
+      if (count > range.count) { count = range.count; }
+
+      memcpy((uchar8*)mapped.pData + staging_offset, &geometry->vertex_data_[range.first], count * stride);
+      staging_copies_.push_back({ allocation.pool, (allocation.offset + range.first) * stride,
+                                  staging_offset, count * stride });
+      staging_offset += count * stride;
+
+      // Split, the rest goes in the next upload.
+      if (count < range.count) {
+        range.first += count;
+        range.count -= count;
+        break;
+      }
+    }
+    ranges.erase(ranges.begin(), ranges.begin() + num_ranges);
+    if (!ranges.empty()) { break; }
+  }
+  dirty_geometries_.erase(dirty_geometries_.begin(), dirty_geometries_.begin() + num_done);
+
+  device_context->Unmap(staging, 0);
+
+  for (uint32 i = 0; i < staging_copies_.size(); ++i) {
+    const StagingCopy& copy = staging_copies_[i];
+    D3D11_BOX box = { copy.source, 0, 0, copy.source + copy.size, 1, 1 };
+    device_context->CopySubresourceRegion(pools_[copy.pool].buffer, 0, copy.destination, 0, 0,
+                                          staging, 0, &box);
+  }
+
+  uploaded_bytes_frame_ += staging_offset;
+  uploaded_bytes_total_ += staging_offset;
+}
+
+void* GeometryArena::beginUpload(const uint32 bytes) {
+
+  if (upload_buffer_ || bytes == 0) { return nullptr; }
+
+  auto& d3d = Core::instance().d3d_;
+  if (bytes <= kStagingBytes) {
+    if (!staging_[0] && !createStagingRing()) { return nullptr; }
+    upload_buffer_ = staging_[staging_index_];
+    staging_index_ = (staging_index_ + 1) % kStagingBuffers;
+    upload_temporary_ = false;
+  }
+  else {
+    // Too big for the ring, meshes this size are rare and built at load.
+    D3D11_BUFFER_DESC description;
+    ZeroMemory(&description, sizeof(D3D11_BUFFER_DESC));
+    description.Usage = D3D11_USAGE_STAGING;
+    description.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    description.ByteWidth = bytes;
+    if (FAILED(d3d.device()->CreateBuffer(&description, nullptr, &upload_buffer_))) {
+      MessageBox(NULL, "ERROR - Geometry upload buffer not created", "ERROR", MB_OK);
+      upload_buffer_ = nullptr;
+      return nullptr;
+    }
+    upload_temporary_ = true;
+  }
+
+  D3D11_MAPPED_SUBRESOURCE mapped;
+  if (FAILED(d3d.deviceContext()->Map(upload_buffer_, 0, D3D11_MAP_WRITE, 0, &mapped))) {
+    if (upload_temporary_) { upload_buffer_->Release(); }
+    upload_buffer_ = nullptr;
+    return nullptr;
+  }
+
+  staging_copies_.clear();
+  return mapped.pData;
+}
+
+void GeometryArena::copyUpload(const uint32 source, const Allocation& allocation) {
+  const uint32 stride = pools_[allocation.pool].stride;
+  staging_copies_.push_back({ allocation.pool, allocation.offset * stride,
+                              source, allocation.count * stride });
+}
+
+void GeometryArena::endUpload() {
+
+  if (!upload_buffer_) { return; }
+
+  auto* device_context = Core::instance().d3d_.deviceContext();
+  device_context->Unmap(upload_buffer_, 0);
+
+  // The pool buffers may have grown since the ranges were taken, copies
+  // go to the current ones.
+  for (uint32 i = 0; i < staging_copies_.size(); ++i) {
+    const StagingCopy& copy = staging_copies_[i];
+    if (copy.size == 0) { continue; }
+    D3D11_BOX box = { copy.source, 0, 0, copy.source + copy.size, 1, 1 };
+    device_context->CopySubresourceRegion(pools_[copy.pool].buffer, 0, copy.destination, 0, 0,
+                                          upload_buffer_, 0, &box);
+  }
+  staging_copies_.clear();
+
+  if (upload_temporary_) { upload_buffer_->Release(); }
+  upload_buffer_ = nullptr;
+  upload_temporary_ = false;
+}
+
+void GeometryArena::shutdown() {
+  for (uint32 i = 0; i < kStagingBuffers; ++i) {
+    if (staging_[i]) {
+      staging_[i]->Release();
+      staging_[i] = nullptr;
+    }
+  }
+  dirty_geometries_.clear();
+  for (uint32 i = 0; i < kPool_Count; ++i) {
+    if (pools_[i].buffer) {
+      pools_[i].buffer->Release();
+      pools_[i].buffer = nullptr;
+    }
+    pools_[i].capacity = 0;
+    pools_[i].allocator.init(0);
+  }
+  invalidateBindings();
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+ID3D11Buffer* GeometryArena::buffer(const Pool pool) const {
+  return pools_[pool].buffer;
+}
+
+uint32 GeometryArena::stride(const Pool pool) const {
+  return pools_[pool].stride;
+}
+
+uint32 GeometryArena::used(const Pool pool) const {
+  return pools_[pool].allocator.used();
+}
+
+uint32 GeometryArena::capacity(const Pool pool) const {
+  return pools_[pool].capacity;
+}
+
+uint64 GeometryArena::num_binds() const {
+  return num_binds_;
+}
+
+uint64 GeometryArena::num_skipped_binds() const {
+  return num_skipped_binds_;
+}
+
+uint64 GeometryArena::uploaded_bytes_last_frame() const {
+  return uploaded_bytes_last_frame_;
+}
+
+uint64 GeometryArena::uploaded_bytes_total() const {
+  return uploaded_bytes_total_;
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+bool GeometryArena::growPool(const Pool pool, const uint32 count) {
+
+  // The new space at the end must fit the range by itself.
+  PoolData& pool_data = pools_[pool];
+  uint32 capacity = pool_data.capacity > 0 ? pool_data.capacity * 2 : pool_data.initial_capacity;
+  while (capacity < pool_data.capacity + count) { capacity *= 2; }
+
+  D3D11_BUFFER_DESC description;
+  ZeroMemory(&description, sizeof(D3D11_BUFFER_DESC));
+  description.Usage = D3D11_USAGE_DEFAULT;
+  description.BindFlags = pool_data.bind_flags;
+  description.ByteWidth = capacity * pool_data.stride;
+
+  auto& d3d = Core::instance().d3d_;
+  ID3D11Buffer* buffer = nullptr;
+  if (FAILED(d3d.device()->CreateBuffer(&description, nullptr, &buffer))) {
+    MessageBox(NULL, "ERROR - Geometry arena buffer not created", "ERROR", MB_OK);
+    return false;
+  }
+
+  // The ranges given keep their offsets.
+  if (pool_data.buffer) {
+    D3D11_BOX box = { 0, 0, 0, pool_data.capacity * pool_data.stride, 1, 1 };
+    d3d.deviceContext()->CopySubresourceRegion(buffer, 0, 0, 0, 0, pool_data.buffer, 0, &box);
+    pool_data.buffer->Release();
+  }
+
+  pool_data.buffer = buffer;
+  pool_data.capacity = capacity;
+  pool_data.allocator.grow(capacity);
+  invalidateBindings();
+  return true;
+}
+
+bool GeometryArena::createStagingRing() {
+
+  D3D11_BUFFER_DESC description;
+  ZeroMemory(&description, sizeof(D3D11_BUFFER_DESC));
+  description.Usage = D3D11_USAGE_STAGING;
+  description.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+  description.ByteWidth = kStagingBytes;
+
+  auto* device = Core::instance().d3d_.device();
+  for (uint32 i = 0; i < kStagingBuffers; ++i) {
+    if (FAILED(device->CreateBuffer(&description, nullptr, &staging_[i]))) {
+      MessageBox(NULL, "ERROR - Geometry staging buffer not created", "ERROR", MB_OK);
+      for (uint32 j = 0; j < i; ++j) {
+        staging_[j]->Release();
+        staging_[j] = nullptr;
+      }
+      return false;
+    }
+  }
+  return true;
+}
+
+}; /* W3D */
@@ -0,0 +1,232 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/height_map.h"
+#include "core/core.h"
+#include <string.h>
+#include <math.h>
+
+namespace W3D {
+
+/// Case insensitive check of the file extension.
+static bool HasExtension(const char* filename, const char* extension) {
+  uint32 name_length = strlen(filename);
+  uint32 extension_length = strlen(extension);
+  if (name_length < extension_length) { return false; }
+  return _stricmp(filename + name_length - extension_length, extension) == 0;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+HeightMapSource::HeightMapSource() {
+  samples_ = nullptr;
+  width_ = 0;
+  height_ = 0;
+  row_pitch_ = 0;
+  sample_stride_ = 1;
+  is_16_bits_ = false;
+  is_big_endian_ = false;
+  max_value_ = 255;
+}
+
+HeightMapSource::~HeightMapSource() {}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+bool HeightMapSource::open(const char* filename, const char** error) {
+
+  if (!Core::instance().vfs_.open(filename, file_)) {
+    ReportLoadError("ERROR - Heightmap filename incorrect.", error);
+    return false;
+  }
+
+  bool parsed = false;
+  if (file_.size() >= 2 && file_.data()[0] == 'B' && file_.data()[1] == 'M') {
+    parsed = parseBMP(error);
+  }
+  else if (file_.size() >= 2 && file_.data()[0] == 'P' && file_.data()[1] == '5') {
+    parsed = parsePGM(error);
+  }
+  else if (HasExtension(filename, ".raw") || HasExtension(filename, ".r16")) {
+    parsed = parseRAW(error);
+  }
+  else {
+    ReportLoadError("ERROR - Heightmap format not supported.", error);
+    return false;
+  }
+
+  if (!parsed) { return false; }
+
+  // Check that the last row is inside the file.
+  uint64 last_row_end = (uint64)samples_ - (uint64)file_.data() +
+                        (uint64)row_pitch_ * (height_ - 1) +
+                        (uint64)sample_stride_ * width_;
+  if (width_ <= 0 || height_ <= 0 || last_row_end > file_.size()) {
+    ReportLoadError("ERROR - Heightmap image data incorrect.", error);
+    return false;
+  }
+
+  return true;
+}
+
+void HeightMapSource::readRegion(const int32 first_column,
+                                 const int32 first_row,
+                                 const int32 num_columns,
+                                 const int32 num_rows,
+                                 const float32 max_height,
+                                 float32* output) const {
+
+  const float32 scale = max_height / (float32)(max_value_ + 1);
+
+  for (int32 j = 0; j < num_rows; ++j) {
+    const uchar8* sample = samples_ + (uint64)row_pitch_ * (first_row + j) +
+                           (uint64)sample_stride_ * first_column;
+    float32* heights = output + (uint64)j * num_columns;
+
+    if (!is_16_bits_) {
+      for (int32 i = 0; i < num_columns; ++i) {
+        heights[i] = scale * (float32)(*sample);
+        sample += sample_stride_;
+      }
+    }
+    else if (is_big_endian_) {
+      for (int32 i = 0; i < num_columns; ++i) {
+        heights[i] = scale * (float32)((sample[0] << 8) | sample[1]);
+        sample += sample_stride_;
+      }
+    }
+    else {
+      for (int32 i = 0; i < num_columns; ++i) {
+        heights[i] = scale * (float32)(sample[0] | (sample[1] << 8));
+        sample += sample_stride_;
+      }
+    }
+  }
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+DirectX::XMINT2 HeightMapSource::size() const {
+  return { width_, height_ };
+}
+
+uint32 HeightMapSource::max_value() const {
+  return max_value_;
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+bool HeightMapSource::parseBMP(const char** error) {
+
+  BITMAPFILEHEADER file_header;
+  BITMAPINFOHEADER info_header;
+
+  if (file_.size() < sizeof(BITMAPFILEHEADER) + sizeof(BITMAPINFOHEADER)) {
+    ReportLoadError("ERROR - Heightmap file is empty.", error);
+    return false;
+  }
+  memcpy(&file_header, file_.data(), sizeof(BITMAPFILEHEADER));
+  memcpy(&info_header, file_.data() + sizeof(BITMAPFILEHEADER), sizeof(BITMAPINFOHEADER));
+
+  if (info_header.biCompression != BI_RGB ||
+      (info_header.biBitCount != 8 && info_header.biBitCount != 24 && info_header.biBitCount != 32)) {
+    ReportLoadError("ERROR - Heightmap bitmap format not supported.", error);
+    return false;
+  }
+
+  // Rows are used in the order they are stored, as the terrain always did.
+  width_ = info_header.biWidth;
+  height_ = info_header.biHeight < 0 ? -info_header.biHeight : info_header.biHeight;
+  sample_stride_ = info_header.biBitCount / 8;
+  row_pitch_ = ((width_ * info_header.biBitCount + 31) / 32) * 4;
+  is_16_bits_ = false;
+  max_value_ = 255;
+
+  if (file_header.bfOffBits >= file_.size()) {
+    ReportLoadError("ERROR - Heightmap image data incorrect.", error);
+    return false;
+  }
+  samples_ = file_.data() + file_header.bfOffBits;
+  return true;
+}
+
+bool HeightMapSource::parsePGM(const char** error) {
+
+  // "P5" <width> <height> <max value> <one whitespace> <data>, with comments.
+  const char* current = (const char*)file_.data() + 2;
+  const char* end = (const char*)file_.data() + file_.size();
+  uint32 values[3];
+
+  for (uint32 i = 0; i < 3; ++i) {
+    while (current < end && (*current == ' ' || *current == '\t' ||
+                             *current == '\r' || *current == '\n' || *current == '#')) {
+      if (*current == '#') {
+        while (current < end && *current != '\n') { current++; }
+      }
+      else {
+        current++;
+      }
+    }
+    if (current >= end || *current < '0' || *current > '9') {
+      ReportLoadError("ERROR - Heightmap PGM header incorrect.", error);
+      return false;
+    }
+    values[i] = 0;
+    while (current < end && *current >= '0' && *current <= '9') {
+      values[i] = values[i] * 10 + (*current - '0');
+      current++;
+    }
+  }
+  // Single whitespace before the samples.
+  current++;
+
+  if (values[2] == 0 || values[2] > 65535 || current > end) {
+    ReportLoadError("ERROR - Heightmap PGM header incorrect.", error);
+    return false;
+  }
+
+  width_ = values[0];
+  height_ = values[1];
+  max_value_ = values[2];
+  is_16_bits_ = max_value_ > 255;
+  is_big_endian_ = true;
+  sample_stride_ = is_16_bits_ ? 2 : 1;
+  row_pitch_ = width_ * sample_stride_;
+  samples_ = (const uchar8*)current;
+  return true;
+}
+
+bool HeightMapSource::parseRAW(const char** error) {
+
+  // No header, square and 16 bits per sample.
+  uint32 num_samples = file_.size() / 2;
+  uint32 side = (uint32)(sqrt((float64)num_samples) + 0.5);
+  if (side == 0 || side * side * 2 != file_.size()) {
+    ReportLoadError("ERROR - Heightmap RAW file must be square, 16 bits per sample.", error);
+    return false;
+  }
+
+  width_ = side;
+  height_ = side;
+  max_value_ = 65535;
+  is_16_bits_ = true;
+  is_big_endian_ = false;
+  sample_stride_ = 2;
+  row_pitch_ = width_ * 2;
+  samples_ = file_.data();
+  return true;
+}
+
+}; /* W3D */
@@ -0,0 +1,155 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/job_system.h"
+#include <atomic>
+#include <memory>
+
+namespace W3D {
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+JobSystem::JobSystem() {
+  running_ = false;
+}
+
+JobSystem::~JobSystem() {
+  shutdown();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void JobSystem::init(const uint32 num_workers) {
+  if (running_) { return; }
+
+  uint32 workers = num_workers;
+  if (workers == 0) {
+    uint32 cores = std::thread::hardware_concurrency();
+    workers = cores > 1 ? cores - 1 : 1;
+  }
+
+  running_ = true;
+  workers_.reserve(workers);
+  for (uint32 i = 0; i < workers; ++i) {
+    workers_.push_back(std::thread(&JobSystem::workerLoop, this));
+  }
+}
+
+void JobSystem::shutdown() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) { return; }
+    running_ = false;
+  }
+  condition_.notify_all();
+  uint32 num_threads = workers_.size();
+  for (uint32 i = 0; i < num_threads; ++i) {
+    if (workers_[i].joinable()) { workers_[i].join(); }
+  }
+  workers_.clear();
+}
+
+void JobSystem::submit(const std::function<void()>& job) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (running_) {
+      queue_.push_back(job);
+      lock.unlock();
+      condition_.notify_one();
+      return;
+    }
+  }
+  // No workers, execute it in the calling thread.
+  job();
+}
+
+void JobSystem::parallelFor(const uint32 count,
+                            const uint32 batch_size,
+                            const std::function<void(uint32, uint32)>& job) {
+
+  if (count == 0) { return; }
+  uint32 batch = batch_size > 0 ? batch_size : 1;
+  uint32 num_batches = (count + batch - 1) / batch;
+
+  if (num_batches == 1 || workers_.empty()) {
+    job(0, count);
+    return;
+  }
+
+  // Shared between the helpers, as they could start after we have returned.
+  struct ParallelForState {
+    std::function<void(uint32, uint32)> job;
+    std::atomic<uint32> next_batch;
+    std::atomic<uint32> finished_batches;
+    uint32 num_batches;
+    uint32 batch_size;
+    uint32 count;
+  };
+  std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+  state->job = job;
+  state->next_batch = 0;
+  state->finished_batches = 0;
+  state->num_batches = num_batches;
+  state->batch_size = batch;
+  state->count = count;
+
+  auto work = [state]() {
+    uint32 batch_index = state->next_batch.fetch_add(1);
+    while (batch_index < state->num_batches) {
+      uint32 begin = batch_index * state->batch_size;
+      uint32 end = begin + state->batch_size;
+      if (end > state->count) { end = state->count; }
+      state->job(begin, end);
+      state->finished_batches.fetch_add(1);
+      batch_index = state->next_batch.fetch_add(1);
+    }
+  };
+
+  uint32 num_helpers = num_batches - 1;
+  if (num_helpers > workers_.size()) { num_helpers = workers_.size(); }
+  for (uint32 i = 0; i < num_helpers; ++i) {
+    submit(work);
+  }
+
+  // The calling thread works too, then waits for the batches in flight.
+  work();
+  while (state->finished_batches.load() < num_batches) {
+    std::this_thread::yield();
+  }
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 JobSystem::num_workers() const {
+  return workers_.size();
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+void JobSystem::workerLoop() {
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      condition_.wait(lock, [this]() { return !running_ || !queue_.empty(); });
+      if (queue_.empty()) { return; } // Not running and nothing left to do.
+      job = queue_.front();
+      queue_.pop_front();
+    }
+    job();
+  }
+}
+
+}; /* W3D */
@@ -0,0 +1,203 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/lz4.h"
+#include <string.h>
+#include <vector>
+
+namespace W3D {
+namespace LZ4 {
+
+/*******************************************************************************
+***                              Block format                                ***
+*******************************************************************************/
+
+// Spec constants: matches are at least 4 bytes, the last 5 bytes are always
+// literals and the last match has to start 12 bytes before the end.
+const uint32 kMinMatch = 4;
+const uint32 kLastLiterals = 5;
+const uint32 kMatchFindLimit = 12;
+const uint32 kMaxOffset = 65535;
+const uint32 kHashLog = 12;
+
+static uint32 Read32(const uchar8* ptr) {
+  uint32 value;
+  memcpy(&value, ptr, sizeof(uint32));
+  return value;
+}
+
+static uint32 Hash(const uint32 sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashLog);
+}
+
+static bool WriteLength(uint32 length, uchar8*& op, const uchar8* oend) {
+  while (length >= 255) {
+    if (op >= oend) { return false; }
+    *op++ = 255;
+    length -= 255;
+  }
+  if (op >= oend) { return false; }
+  *op++ = (uchar8)length;
+  return true;
+}
+
+static bool WriteSequence(const uchar8* literals, const uint32 num_literals,
+                          const uint32 offset, const uint32 match_length,
+                          uchar8*& op, const uchar8* oend) {
+
+  if (op >= oend) { return false; }
+  uchar8* token = op++;
+  *token = 0;
+
+  // Literals.
+  if (num_literals >= 15) {
+    *token = (15 << 4);
+    if (!WriteLength(num_literals - 15, op, oend)) { return false; }
+  }
+  else {
+    *token = (uchar8)(num_literals << 4);
+  }
+  if ((uint32)(oend - op) < num_literals) { return false; }
+  memcpy(op, literals, num_literals);
+  op += num_literals;
+
+  // Last sequence has no match.
+  if (match_length == 0) { return true; }
+
+  if (oend - op < 2) { return false; }
+  *op++ = (uchar8)(offset & 0xFF);
+  *op++ = (uchar8)(offset >> 8);
+
+  uint32 length = match_length - kMinMatch;
+  if (length >= 15) {
+    *token |= 15;
+    if (!WriteLength(length - 15, op, oend)) { return false; }
+  }
+  else {
+    *token |= (uchar8)length;
+  }
+  return true;
+}
+
+/*******************************************************************************
+***                             Public functions                             ***
+*******************************************************************************/
+
+uint32 CompressBound(const uint32 size) {
+  return size + size / 255 + 16;
+}
+
+uint32 Compress(const uchar8* src, const uint32 src_size,
+                uchar8* dst, const uint32 dst_capacity) {
+
+  uchar8* op = dst;
+  const uchar8* oend = dst + dst_capacity;
+  uint32 anchor = 0;
+  uint32 pos = 0;
+
+  if (src_size > kMatchFindLimit) {
+    // Positions are stored + 1 so 0 means empty.
+    std::vector<uint32> table(1 << kHashLog, 0);
+    uint32 match_start_limit = src_size - kMatchFindLimit;
+    uint32 match_end_limit = src_size - kLastLiterals;
+
+    while (pos <= match_start_limit) {
+      uint32 sequence = Read32(src + pos);
+      uint32 hash = Hash(sequence);
+      uint32 candidate = table[hash];
+      table[hash] = pos + 1;
+
+      if (candidate != 0 &&
+          pos - (candidate - 1) <= kMaxOffset &&
+          Read32(src + candidate - 1) == sequence) {
+        uint32 reference = candidate - 1;
+        uint32 match_end = pos + kMinMatch;
+        while (match_end < match_end_limit &&
+               src[match_end] == src[reference + (match_end - pos)]) {
+          match_end++;
+        }
+        if (!WriteSequence(src + anchor, pos - anchor, pos - reference,
+                           match_end - pos, op, oend)) {
+          return 0;
+        }
+        pos = match_end;
+        anchor = pos;
+      }
+      else {
+        pos++;
+      }
+    }
+  }
+
+  // Last literals.
+  if (!WriteSequence(src + anchor, src_size - anchor, 0, 0, op, oend)) {
+    return 0;
+  }
+  return (uint32)(op - dst);
+}
+
+bool Decompress(const uchar8* src, const uint32 src_size,
+                uchar8* dst, const uint32 dst_size) {
+
+  const uchar8* ip = src;
+  const uchar8* iend = src + src_size;
+  uchar8* op = dst;
+  const uchar8* oend = dst + dst_size;
+
+  while (ip < iend) {
+    uint32 token = *ip++;
+
+    // Literals.
+    uint32 num_literals = token >> 4;
+    if (num_literals == 15) {
+      uint32 extra;
+      do {
+        if (ip >= iend) { return false; }
+        extra = *ip++;
+        num_literals += extra;
+      } while (extra == 255);
+    }
+    if ((uint32)(iend - ip) < num_literals || (uint32)(oend - op) < num_literals) {
+      return false;
+    }
+    memcpy(op, ip, num_literals);
+    op += num_literals;
+    ip += num_literals;
+
+    // The last sequence ends after its literals.
+    if (ip >= iend) { break; }
+
+    // Match.
+    if (iend - ip < 2) { return false; }
+    uint32 offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    if (offset == 0 || offset > (uint32)(op - dst)) { return false; }
+
+    uint32 match_length = token & 15;
+    if (match_length == 15) {
+      uint32 extra;
+      do {
+        if (ip >= iend) { return false; }
+        extra = *ip++;
+        match_length += extra;
+      } while (extra == 255);
+    }
+    match_length += kMinMatch;
+    if ((uint32)(oend - op) < match_length) { return false; }
+
+    // Byte by byte as the match can overlap the output.
+    const uchar8* match = op - offset;
+    for (uint32 i = 0; i < match_length; ++i) {
+      *op++ = *match++;
+    }
+  }
+
+  return op == oend;
+}
+
+}; /* LZ4 */
+}; /* W3D */
@@ -0,0 +1,389 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/mesh_builder.h"
+#include "core/core.h"
+#include <float.h>
+#include <math.h>
+
+namespace W3D {
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+MeshBuilder::MeshBuilder() {
+  size_ = { 0, 0 };
+  color_ = { 1.0f, 1.0f, 1.0f, 1.0f };
+  vertex_allocation_ = { GeometryArena::kPool_FullVertices, TlsfAllocator::kInvalidHandle, 0, 0 };
+  index_allocation_ = { GeometryArena::kPool_Indices32, TlsfAllocator::kInvalidHandle, 0, 0 };
+  vertices_ = nullptr;
+  indices16_ = nullptr;
+  indices32_ = nullptr;
+  num_vertices_ = 0;
+  num_indices_ = 0;
+  max_radius_sq_ = 0.0f;
+  min_position_ = { 0.0f, 0.0f, 0.0f };
+  max_position_ = { 0.0f, 0.0f, 0.0f };
+  building_ = false;
+}
+
+MeshBuilder::~MeshBuilder() {
+  circles_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+bool MeshBuilder::begin(const Size size, const DirectX::XMFLOAT4 color) {
+
+  if (building_ || size.num_vertices == 0 || size.num_indices == 0) { return false; }
+
+  // Same index format rule as the rest of geometries.
+  auto& arena = Core::instance().geometry_arena_;
+  GeometryArena::Pool index_pool = size.num_vertices < 0xFFFF ? GeometryArena::kPool_Indices16 :
+                                                                 GeometryArena::kPool_Indices32;
+  if (!arena.allocate(GeometryArena::kPool_FullVertices, size.num_vertices, nullptr,
+                      &vertex_allocation_)) {
+    return false;
+  }
+  if (!arena.allocate(index_pool, size.num_indices, nullptr, &index_allocation_)) {
+    arena.release(&vertex_allocation_);
+    return false;
+  }
+
+  // Vertices first, indices right after them.
+  const uint32 vertex_bytes = size.num_vertices * sizeof(Geo::VertexData);
+  const uint32 index_bytes = size.num_indices * arena.stride(index_pool);
+  uchar8* memory = (uchar8*)arena.beginUpload(vertex_bytes + index_bytes);
+  if (!memory) {
+    arena.release(&vertex_allocation_);
+    arena.release(&index_allocation_);
+    return false;
+  }
+  arena.copyUpload(0, vertex_allocation_);
+  arena.copyUpload(vertex_bytes, index_allocation_);
+
+  vertices_ = (Geo::VertexData*)memory;
+  indices16_ = index_pool == GeometryArena::kPool_Indices16 ? (uint16*)(memory + vertex_bytes) : nullptr;
+  indices32_ = index_pool == GeometryArena::kPool_Indices32 ? (uint32*)(memory + vertex_bytes) : nullptr;
+  size_ = size;
+  color_ = color;
+  num_vertices_ = 0;
+  num_indices_ = 0;
+  max_radius_sq_ = 0.0f;
+  min_position_ = { FLT_MAX, FLT_MAX, FLT_MAX };
+  max_position_ = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+  building_ = true;
+  return true;
+}
+
+bool MeshBuilder::end(Geo* geometry) {
+
+  if (!building_) { return false; }
+  building_ = false;
+  vertices_ = nullptr;
+  indices16_ = nullptr;
+  indices32_ = nullptr;
+
+  auto& arena = Core::instance().geometry_arena_;
+  arena.endUpload();
+
+  if (num_vertices_ != size_.num_vertices || num_indices_ != size_.num_indices) {
+    MessageBox(NULL, "ERROR - Mesh builder size doesn't match the mesh written", "ERROR", MB_OK);
+    arena.release(&vertex_allocation_);
+    arena.release(&index_allocation_);
+    return false;
+  }
+
+  arena.release(&geometry->vertex_allocation_);
+  arena.release(&geometry->index_allocation_);
+  geometry->vertex_allocation_ = vertex_allocation_;
+  geometry->index_allocation_ = index_allocation_;
+  vertex_allocation_.handle = TlsfAllocator::kInvalidHandle;
+  index_allocation_.handle = TlsfAllocator::kInvalidHandle;
+
+  geometry->vertex_data_.clear();
+  geometry->vertex_index_.clear();
+  geometry->lods_.clear();
+  geometry->meshlets_.count = 0;
+  geometry->vertex_format_ = Geo::kVertexFormat_Full;
+  geometry->topology_ = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+  geometry->bounding_radius_ = sqrtf(max_radius_sq_);
+  DirectX::BoundingBox::CreateFromPoints(geometry->bounding_box_,
+                                         DirectX::XMLoadFloat3(&min_position_),
+                                         DirectX::XMLoadFloat3(&max_position_));
+  // No CPU copy of the vertices to simplify, so never an occluder.
+  geometry->occluder_positions_.clear();
+  geometry->occluder_indices_.clear();
+  // Written in a cache friendly order already.
+  geometry->mesh_optimized_ = true;
+  return true;
+}
+
+uint32 MeshBuilder::vertex(const DirectX::XMFLOAT3 position,
+                           const DirectX::XMFLOAT3 normal,
+                           const DirectX::XMFLOAT2 uv) {
+
+  // Counted anyway, so end reports the mismatch.
+  const uint32 index = num_vertices_++;
+  if (index >= size_.num_vertices) { return index; }
+
+  vertices_[index] = { position, normal, uv, color_ };
+  float32 radius_sq = position.x * position.x + position.y * position.y + position.z * position.z;
+  if (radius_sq > max_radius_sq_) { max_radius_sq_ = radius_sq; }
+  min_position_.x = fminf(min_position_.x, position.x);
+  min_position_.y = fminf(min_position_.y, position.y);
+  min_position_.z = fminf(min_position_.z, position.z);
+  max_position_.x = fmaxf(max_position_.x, position.x);
+  max_position_.y = fmaxf(max_position_.y, position.y);
+  max_position_.z = fmaxf(max_position_.z, position.z);
+  return index;
+}
+
+void MeshBuilder::triangle(const uint32 a, const uint32 b, const uint32 c) {
+
+  if (num_indices_ + 3 > size_.num_indices) {
+    num_indices_ += 3;
+    return;
+  }
+
+  if (indices16_) {
+    indices16_[num_indices_] = (uint16)a;
+    indices16_[num_indices_ + 1] = (uint16)b;
+    indices16_[num_indices_ + 2] = (uint16)c;
+  }
+  else {
+    indices32_[num_indices_] = a;
+    indices32_[num_indices_ + 1] = b;
+    indices32_[num_indices_ + 2] = c;
+  }
+  num_indices_ += 3;
+}
+
+void MeshBuilder::quad(const uint32 a, const uint32 b, const uint32 c, const uint32 d) {
+  triangle(a, b, d);
+  triangle(d, b, c);
+}
+
+void MeshBuilder::box(const DirectX::XMFLOAT3 size) {
+
+  const DirectX::XMFLOAT3 h = { size.x * 0.5f, size.y * 0.5f, size.z * 0.5f };
+
+  // Per face: normal and the corners top left, top right, bottom right and
+  // bottom left, seen from outside.
+  struct Face {
+    DirectX::XMFLOAT3 normal;
+    DirectX::XMFLOAT3 corners[4];
+  };
+  const Face faces[6] = {
+    { { 0.0f, 0.0f, 1.0f },  { { -h.x, h.y, h.z }, { h.x, h.y, h.z }, { h.x, -h.y, h.z }, { -h.x, -h.y, h.z } } },
+    { { 1.0f, 0.0f, 0.0f },  { { h.x, h.y, h.z }, { h.x, h.y, -h.z }, { h.x, -h.y, -h.z }, { h.x, -h.y, h.z } } },
+    { { 0.0f, 0.0f, -1.0f }, { { h.x, h.y, -h.z }, { -h.x, h.y, -h.z }, { -h.x, -h.y, -h.z }, { h.x, -h.y, -h.z } } },
+    { { -1.0f, 0.0f, 0.0f }, { { -h.x, h.y, -h.z }, { -h.x, h.y, h.z }, { -h.x, -h.y, h.z }, { -h.x, -h.y, -h.z } } },
+    { { 0.0f, -1.0f, 0.0f }, { { -h.x, -h.y, h.z }, { h.x, -h.y, h.z }, { h.x, -h.y, -h.z }, { -h.x, -h.y, -h.z } } },
+    { { 0.0f, 1.0f, 0.0f },  { { -h.x, h.y, -h.z }, { h.x, h.y, -h.z }, { h.x, h.y, h.z }, { -h.x, h.y, h.z } } },
+  };
+  const DirectX::XMFLOAT2 uvs[4] = { { 0.0f, 0.0f }, { 1.0f, 0.0f }, { 1.0f, 1.0f }, { 0.0f, 1.0f } };
+
+  for (uint32 i = 0; i < 6; ++i) {
+    uint32 first = vertex(faces[i].corners[0], faces[i].normal, uvs[0]);
+    for (uint32 j = 1; j < 4; ++j) { vertex(faces[i].corners[j], faces[i].normal, uvs[j]); }
+    quad(first, first + 3, first + 2, first + 1);
+  }
+}
+
+MeshBuilder::Size MeshBuilder::BoxSize() {
+  return { 24, 36 };
+}
+
+void MeshBuilder::frustum(const uint32 segments,
+                          const float32 base_radius,
+                          const float32 top_radius,
+                          const float32 height) {
+
+  const DirectX::XMFLOAT2* angles = circle(segments);
+  const float32 half_height = height * 0.5f;
+
+  if (base_radius > 0.0f) { cap(angles, segments, base_radius, -half_height, false); }
+  if (top_radius > 0.0f) { cap(angles, segments, top_radius, half_height, true); }
+
+  // Sides, a column of two vertices per angle, the normals are the ones of
+  // the smooth surface.
+  DirectX::XMVECTOR slope = DirectX::XMVector2Normalize(DirectX::XMVectorSet(height, base_radius - top_radius, 0.0f, 0.0f));
+  const float32 normal_xz = DirectX::XMVectorGetX(slope);
+  const float32 normal_y = DirectX::XMVectorGetY(slope);
+  const uint32 first = num_vertices_;
+  for (uint32 i = 0; i <= segments; ++i) {
+    const DirectX::XMFLOAT2& angle = angles[i];
+    const DirectX::XMFLOAT3 normal = { normal_xz * angle.x, normal_y, normal_xz * angle.y };
+    const float32 u = (float32)i / (float32)segments;
+    vertex({ top_radius * angle.x, half_height, top_radius * angle.y }, normal, { u, 0.0f });
+    vertex({ base_radius * angle.x, -half_height, base_radius * angle.y }, normal, { u, 1.0f });
+  }
+  for (uint32 i = 0; i < segments; ++i) {
+    const uint32 top = first + i * 2;
+    // A radius of 0 collapses one of the triangles.
+    if (top_radius > 0.0f) { triangle(top, top + 2, top + 1); }
+    if (base_radius > 0.0f) { triangle(top + 1, top + 2, top + 3); }
+  }
+}
+
+MeshBuilder::Size MeshBuilder::FrustumSize(const uint32 segments,
+                                           const float32 base_radius,
+                                           const float32 top_radius) {
+  Size size = { (segments + 1) * 2, 0 };
+  if (base_radius > 0.0f) {
+    size.num_vertices += segments + 1;
+    size.num_indices += segments * 6;
+  }
+  if (top_radius > 0.0f) {
+    size.num_vertices += segments + 1;
+    size.num_indices += segments * 6;
+  }
+  return size;
+}
+
+void MeshBuilder::sphere(const float32 radius, const uint32 slices, const uint32 stacks) {
+
+  const DirectX::XMFLOAT2* around = circle(slices);
+  // Half of a circle of twice the stacks goes from pole to pole.
+  const DirectX::XMFLOAT2* down = circle(stacks * 2);
+
+  const uint32 first = num_vertices_;
+  for (uint32 i = 0; i <= stacks; ++i) {
+    const float32 y = down[i].x;
+    const float32 ring = i == stacks ? 0.0f : down[i].y;
+    const float32 v = (float32)i / (float32)stacks;
+    for (uint32 j = 0; j <= slices; ++j) {
+      const DirectX::XMFLOAT3 normal = { ring * around[j].x, y, ring * around[j].y };
+      vertex({ normal.x * radius, normal.y * radius, normal.z * radius }, normal,
+             { (float32)j / (float32)slices, v });
+    }
+  }
+
+  // The first and last stacks are fans around the poles.
+  const uint32 row = slices + 1;
+  for (uint32 i = 0; i < stacks; ++i) {
+    for (uint32 j = 0; j < slices; ++j) {
+      const uint32 a = first + i * row + j;
+      if (i > 0) { triangle(a, a + 1, a + row); }
+      if (i < stacks - 1) { triangle(a + row, a + 1, a + row + 1); }
+    }
+  }
+}
+
+MeshBuilder::Size MeshBuilder::SphereSize(const uint32 slices, const uint32 stacks) {
+  return { (slices + 1) * (stacks + 1), slices * (stacks - 1) * 6 };
+}
+
+void MeshBuilder::torus(const float32 radius,
+                        const float32 tube_radius,
+                        const uint32 rings,
+                        const uint32 sides) {
+
+  const DirectX::XMFLOAT2* around = circle(rings);
+  const DirectX::XMFLOAT2* tube = circle(sides);
+
+  const uint32 first = num_vertices_;
+  for (uint32 i = 0; i <= rings; ++i) {
+    const float32 u = (float32)i / (float32)rings;
+    for (uint32 j = 0; j <= sides; ++j) {
+      const DirectX::XMFLOAT3 normal = { tube[j].x * around[i].x, tube[j].y, tube[j].x * around[i].y };
+      vertex({ radius * around[i].x + tube_radius * normal.x,
+               tube_radius * normal.y,
+               radius * around[i].y + tube_radius * normal.z },
+             normal, { u, (float32)j / (float32)sides });
+    }
+  }
+
+  const uint32 row = sides + 1;
+  for (uint32 i = 0; i < rings; ++i) {
+    for (uint32 j = 0; j < sides; ++j) {
+      const uint32 a = first + i * row + j;
+      quad(a, a + 1, a + row + 1, a + row);
+    }
+  }
+}
+
+MeshBuilder::Size MeshBuilder::TorusSize(const uint32 rings, const uint32 sides) {
+  return { (rings + 1) * (sides + 1), rings * sides * 6 };
+}
+
+void MeshBuilder::grid(const DirectX::XMFLOAT2 size,
+                       const uint32 cells_x,
+                       const uint32 cells_z) {
+
+  const DirectX::XMFLOAT3 up = { 0.0f, 1.0f, 0.0f };
+  const float32 step_x = size.x / (float32)cells_x;
+  const float32 step_z = size.y / (float32)cells_z;
+
+  // Rows along X, the cells are drawn row after row.
+  const uint32 first = num_vertices_;
+  for (uint32 i = 0; i <= cells_z; ++i) {
+    const float32 z = size.y * 0.5f - i * step_z;
+    for (uint32 j = 0; j <= cells_x; ++j) {
+      vertex({ size.x * -0.5f + j * step_x, 0.0f, z }, up,
+             { (float32)j / (float32)cells_x, (float32)i / (float32)cells_z });
+    }
+  }
+
+  const uint32 row = cells_x + 1;
+  for (uint32 i = 0; i < cells_z; ++i) {
+    for (uint32 j = 0; j < cells_x; ++j) {
+      const uint32 a = first + i * row + j;
+      quad(a, a + 1, a + row + 1, a + row);
+    }
+  }
+}
+
+MeshBuilder::Size MeshBuilder::GridSize(const uint32 cells_x, const uint32 cells_z) {
+  return { (cells_x + 1) * (cells_z + 1), cells_x * cells_z * 6 };
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+const DirectX::XMFLOAT2* MeshBuilder::circle(const uint32 segments) {
+
+  // Nodes don't move when the map grows, the pointers given stay valid.
+  std::vector<DirectX::XMFLOAT2>& table = circles_[segments];
+  if (table.empty()) {
+    table.resize(segments + 1);
+    const float32 step = DirectX::XM_2PI / (float32)segments;
+    for (uint32 i = 0; i < segments; ++i) {
+      DirectX::XMScalarSinCos(&table[i].y, &table[i].x, step * (float32)i);
+    }
+    table[segments] = table[0];
+  }
+  return table.data();
+}
+
+void MeshBuilder::cap(const DirectX::XMFLOAT2* angles,
+                      const uint32 segments,
+                      const float32 radius,
+                      const float32 y,
+                      const bool up) {
+
+  const DirectX::XMFLOAT3 normal = { 0.0f, up ? 1.0f : -1.0f, 0.0f };
+  const uint32 center = vertex({ 0.0f, y, 0.0f }, normal, { 0.5f, 0.5f });
+  for (uint32 i = 0; i < segments; ++i) {
+    const DirectX::XMFLOAT2& angle = angles[i];
+    vertex({ radius * angle.x, y, radius * angle.y }, normal,
+           { 0.5f + angle.x * 0.5f, 0.5f - angle.y * 0.5f });
+  }
+  for (uint32 i = 0; i < segments; ++i) {
+    const uint32 current = center + 1 + i;
+    const uint32 next = center + 1 + (i + 1) % segments;
+    if (up) { triangle(center, next, current); }
+    else { triangle(center, current, next); }
+  }
+}
+
+}; /* W3D */
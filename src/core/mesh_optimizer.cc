@@ -0,0 +1,309 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/mesh_optimizer.h"
+#include <algorithm>
+#include <string.h>
+
+namespace W3D {
+namespace MeshOptimizer {
+
+/// Marks an empty slot or a vertex not remapped yet.
+const uint32 kInvalidIndex = 0xFFFFFFFF;
+/// ACMR the overdraw sorting can add to the cache optimized order.
+const float32 kOverdrawCacheTolerance = 1.05f;
+
+/// FNV-1a of the vertex bytes.
+static uint32 HashVertex(const Geo::VertexData& vertex) {
+  const uchar8* bytes = (const uchar8*)&vertex;
+  uint32 hash = 2166136261u;
+  for (uint32 i = 0; i < sizeof(Geo::VertexData); ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+/// Vertex stack and fanning candidates of Tipsify.
+static int32 SkipDeadEnd(const std::vector<uint32>& live_triangles,
+                         std::vector<uint32>& dead_end_stack,
+                         uint32& cursor,
+                         const uint32 num_vertices) {
+
+  // Recently emitted vertices first, they may still be in the cache.
+  while (!dead_end_stack.empty()) {
+    uint32 vertex = dead_end_stack.back();
+    dead_end_stack.pop_back();
+    if (live_triangles[vertex] > 0) { return (int32)vertex; }
+  }
+  while (cursor < num_vertices) {
+    if (live_triangles[cursor] > 0) { return (int32)cursor; }
+    cursor++;
+  }
+  return -1;
+}
+
+uint32 WeldVertices(std::vector<Geo::VertexData>& vertices,
+                    std::vector<uint32>& indices) {
+
+  const uint32 num_vertices = vertices.size();
+  if (num_vertices == 0) { return 0; }
+
+  // Open addressing, at most half full.
+  uint32 table_size = 1;
+  while (table_size < num_vertices * 2) { table_size <<= 1; }
+  std::vector<uint32> table(table_size, kInvalidIndex);
+  std::vector<uint32> remap(num_vertices);
+
+  uint32 num_unique = 0;
+  for (uint32 i = 0; i < num_vertices; ++i) {
+    uint32 slot = HashVertex(vertices[i]) & (table_size - 1);
+    while (table[slot] != kInvalidIndex &&
+           memcmp(&vertices[table[slot]], &vertices[i], sizeof(Geo::VertexData)) != 0) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    if (table[slot] == kInvalidIndex) {
+      // Unique vertices are compacted in place, never ahead of i.
+      vertices[num_unique] = vertices[i];
+      table[slot] = num_unique++;
+    }
+    remap[i] = table[slot];
+  }
+
+  for (uint32 i = 0; i < indices.size(); ++i) {
+    indices[i] = remap[indices[i]];
+  }
+  vertices.resize(num_unique);
+
+  return num_vertices - num_unique;
+}
+
+void OptimizeVertexCache(uint32* indices,
+                         const uint32 num_indices,
+                         const uint32 num_vertices,
+                         std::vector<uint32>* clusters) {
+
+  const uint32 num_triangles = num_indices / 3;
+  if (clusters) { clusters->clear(); }
+  if (num_triangles == 0) { return; }
+
+  // Triangles of every vertex, packed.
+  std::vector<uint32> live_triangles(num_vertices, 0);
+  for (uint32 i = 0; i < num_indices; ++i) { live_triangles[indices[i]]++; }
+  std::vector<uint32> adjacency_offset(num_vertices + 1, 0);
+  for (uint32 v = 0; v < num_vertices; ++v) {
+    adjacency_offset[v + 1] = adjacency_offset[v] + live_triangles[v];
+  }
+  std::vector<uint32> adjacency(num_indices);
+  std::vector<uint32> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+  for (uint32 i = 0; i < num_indices; ++i) {
+    adjacency[fill[indices[i]]++] = i / 3;
+  }
+
+  std::vector<uint32> cache_time(num_vertices, 0);
+  std::vector<uchar8> emitted(num_triangles, 0);
+  std::vector<uint32> dead_end_stack;
+  std::vector<uint32> candidates;
+  std::vector<uint32> output;
+  output.reserve(num_indices);
+
+  uint32 time = kCacheSize + 1;
+  uint32 cursor = 0;
+  int32 fanning = (int32)indices[0];
+  if (clusters) { clusters->push_back(0); }
+
+  while (fanning >= 0) {
+    // Every triangle around the fanning vertex.
+    candidates.clear();
+    for (uint32 a = adjacency_offset[fanning]; a < adjacency_offset[fanning + 1]; ++a) {
+      uint32 triangle = adjacency[a];
+      if (emitted[triangle]) { continue; }
+      for (uint32 corner = 0; corner < 3; ++corner) {
+        uint32 vertex = indices[triangle * 3 + corner];
+        output.push_back(vertex);
+        dead_end_stack.push_back(vertex);
+        candidates.push_back(vertex);
+        live_triangles[vertex]--;
+        if (time - cache_time[vertex] > kCacheSize) {
+          cache_time[vertex] = time++;
+        }
+      }
+      emitted[triangle] = 1;
+    }
+
+    // Next fanning vertex, the oldest one in the cache that will still be
+    // there after emitting all its triangles.
+    int32 next = -1;
+    int32 best_priority = -1;
+    for (uint32 c = 0; c < candidates.size(); ++c) {
+      uint32 vertex = candidates[c];
+      if (live_triangles[vertex] == 0) { continue; }
+      int32 priority = 0;
+      if (time - cache_time[vertex] + 2 * live_triangles[vertex] <= kCacheSize) {
+        priority = (int32)(time - cache_time[vertex]);
+      }
+      if (priority > best_priority) {
+        best_priority = priority;
+        next = (int32)vertex;
+      }
+    }
+
+    if (next < 0) {
+      next = SkipDeadEnd(live_triangles, dead_end_stack, cursor, num_vertices);
+      if (next >= 0 && clusters) { clusters->push_back(output.size() / 3); }
+    }
+    fanning = next;
+  }
+
+  memcpy(indices, output.data(), num_indices * sizeof(uint32));
+}
+
+void OptimizeOverdraw(const Geo::VertexData* vertices,
+                      uint32* indices,
+                      const uint32 num_indices,
+                      const std::vector<uint32>& clusters) {
+
+  const uint32 num_triangles = num_indices / 3;
+  const uint32 num_clusters = clusters.size();
+  if (num_clusters < 2) { return; }
+
+  struct Cluster {
+    uint32 first;
+    uint32 last;
+    DirectX::XMFLOAT3 centroid;
+    DirectX::XMFLOAT3 normal;
+    float32 sort_key;
+  };
+  std::vector<Cluster> sorted(num_clusters);
+
+  // Area weighted centroids and normals.
+  DirectX::XMVECTOR mesh_centroid = DirectX::XMVectorZero();
+  float32 mesh_area = 0.0f;
+  for (uint32 c = 0; c < num_clusters; ++c) {
+    Cluster& cluster = sorted[c];
+    cluster.first = clusters[c];
+    cluster.last = c + 1 < num_clusters ? clusters[c + 1] : num_triangles;
+
+    DirectX::XMVECTOR centroid = DirectX::XMVectorZero();
+    DirectX::XMVECTOR normal = DirectX::XMVectorZero();
+    float32 area = 0.0f;
+    for (uint32 t = cluster.first; t < cluster.last; ++t) {
+      DirectX::XMVECTOR p0 = DirectX::XMLoadFloat3(&vertices[indices[t * 3]].position);
+      DirectX::XMVECTOR p1 = DirectX::XMLoadFloat3(&vertices[indices[t * 3 + 1]].position);
+      DirectX::XMVECTOR p2 = DirectX::XMLoadFloat3(&vertices[indices[t * 3 + 2]].position);
+      DirectX::XMVECTOR cross = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(p1, p0),
+                                                        DirectX::XMVectorSubtract(p2, p0));
+      float32 triangle_area = DirectX::XMVectorGetX(DirectX::XMVector3Length(cross));
+      DirectX::XMVECTOR triangle_centroid = DirectX::XMVectorScale(
+        DirectX::XMVectorAdd(DirectX::XMVectorAdd(p0, p1), p2), 1.0f / 3.0f);
+      centroid = DirectX::XMVectorAdd(centroid, DirectX::XMVectorScale(triangle_centroid, triangle_area));
+      normal = DirectX::XMVectorAdd(normal, cross);
+      area += triangle_area;
+    }
+
+    mesh_centroid = DirectX::XMVectorAdd(mesh_centroid, centroid);
+    mesh_area += area;
+    if (area > 0.0f) { centroid = DirectX::XMVectorScale(centroid, 1.0f / area); }
+    DirectX::XMStoreFloat3(&cluster.centroid, centroid);
+    DirectX::XMStoreFloat3(&cluster.normal, DirectX::XMVector3Normalize(normal));
+  }
+  if (mesh_area > 0.0f) { mesh_centroid = DirectX::XMVectorScale(mesh_centroid, 1.0f / mesh_area); }
+
+  // Clusters looking away from the center are in front of the rest.
+  for (uint32 c = 0; c < num_clusters; ++c) {
+    DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&sorted[c].centroid),
+                                                         mesh_centroid);
+    sorted[c].sort_key = DirectX::XMVectorGetX(
+      DirectX::XMVector3Dot(offset, DirectX::XMLoadFloat3(&sorted[c].normal)));
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Cluster& a, const Cluster& b) { return a.sort_key > b.sort_key; });
+
+  std::vector<uint32> output;
+  output.reserve(num_indices);
+  for (uint32 c = 0; c < num_clusters; ++c) {
+    output.insert(output.end(), indices + sorted[c].first * 3, indices + sorted[c].last * 3);
+  }
+  memcpy(indices, output.data(), num_indices * sizeof(uint32));
+}
+
+void OptimizeVertexFetch(std::vector<Geo::VertexData>& vertices,
+                         std::vector<uint32>& indices) {
+
+  std::vector<uint32> remap(vertices.size(), kInvalidIndex);
+  std::vector<Geo::VertexData> sorted;
+  sorted.reserve(vertices.size());
+
+  for (uint32 i = 0; i < indices.size(); ++i) {
+    uint32& index = indices[i];
+    if (remap[index] == kInvalidIndex) {
+      remap[index] = sorted.size();
+      sorted.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+
+  vertices.swap(sorted);
+}
+
+float32 ACMR(const uint32* indices,
+             const uint32 num_indices,
+             const uint32 num_vertices,
+             const uint32 cache_size) {
+
+  if (num_indices < 3) { return 0.0f; }
+
+  // A vertex is in the cache if it entered less than cache_size misses ago.
+  std::vector<uint32> entered(num_vertices, 0);
+  uint32 misses = 0;
+  for (uint32 i = 0; i < num_indices; ++i) {
+    uint32 vertex = indices[i];
+    if (entered[vertex] == 0 || misses - entered[vertex] >= cache_size) {
+      misses++;
+      entered[vertex] = misses;
+    }
+  }
+
+  return (float32)misses / (float32)(num_indices / 3);
+}
+
+Geo::MeshStats Optimize(std::vector<Geo::VertexData>& vertices,
+                        std::vector<uint32>& indices,
+                        const uint32 num_ranges) {
+
+  Geo::MeshStats stats;
+  stats.num_welded = 0;
+  stats.acmr_before = ACMR(indices.data(), indices.size(), vertices.size());
+  stats.acmr_after = stats.acmr_before;
+  if (indices.size() < 3 || num_ranges == 0) { return stats; }
+
+  stats.num_welded = WeldVertices(vertices, indices);
+
+  std::vector<uint32> clusters;
+  std::vector<uint32> sorted;
+  const uint32 num_vertices = vertices.size();
+  const uint32 range_size = indices.size() / num_ranges;
+  for (uint32 range = 0; range < num_ranges; ++range) {
+    uint32* first = indices.data() + range * range_size;
+    OptimizeVertexCache(first, range_size, num_vertices, &clusters);
+
+    // Small clusters may cost too much cache, then the order is kept.
+    sorted.assign(first, first + range_size);
+    OptimizeOverdraw(vertices.data(), sorted.data(), range_size, clusters);
+    if (ACMR(sorted.data(), range_size, num_vertices) <=
+        ACMR(first, range_size, num_vertices) * kOverdrawCacheTolerance) {
+      memcpy(first, sorted.data(), range_size * sizeof(uint32));
+    }
+  }
+
+  OptimizeVertexFetch(vertices, indices);
+  stats.acmr_after = ACMR(indices.data(), indices.size(), vertices.size());
+
+  return stats;
+}
+
+}; /* MeshOptimizer */
+}; /* W3D */
@@ -0,0 +1,400 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/mesh_simplifier.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+namespace W3D {
+namespace MeshSimplifier {
+
+/// Marks an empty slot.
+const uint32 kInvalidIndex = 0xFFFFFFFF;
+/// Weight of the planes keeping the borders, relative to the triangles.
+const float64 kBorderWeight = 10.0;
+/// Minimum cosine between a triangle normal before and after a collapse.
+const float64 kMinFlipCosine = 0.25;
+
+/// Symmetric 4x4 matrix of the squared distances to some planes.
+struct Quadric {
+  float64 a2, b2, c2, d2;
+  float64 ab, ac, ad;
+  float64 bc, bd;
+  float64 cd;
+  /// Sum of the planes weights, the error is averaged with it.
+  float64 weight;
+};
+
+/// Edge collapse candidate, from is moved into to.
+struct Collapse {
+  uint32 from;
+  uint32 to;
+  float64 error;
+};
+
+/// Mesh connectivity by position, the attribute seams are not edges.
+struct Adjacency {
+  /// Triangles around every position, offsets[p] to offsets[p + 1].
+  std::vector<uint32> offsets;
+  std::vector<uint32> triangles;
+};
+
+static void AddPlane(Quadric& quadric,
+                     const float64 a, const float64 b, const float64 c, const float64 d,
+                     const float64 weight) {
+  quadric.a2 += weight * a * a;
+  quadric.b2 += weight * b * b;
+  quadric.c2 += weight * c * c;
+  quadric.d2 += weight * d * d;
+  quadric.ab += weight * a * b;
+  quadric.ac += weight * a * c;
+  quadric.ad += weight * a * d;
+  quadric.bc += weight * b * c;
+  quadric.bd += weight * b * d;
+  quadric.cd += weight * c * d;
+  quadric.weight += weight;
+}
+
+static void AddQuadric(Quadric& quadric, const Quadric& other) {
+  quadric.a2 += other.a2;
+  quadric.b2 += other.b2;
+  quadric.c2 += other.c2;
+  quadric.d2 += other.d2;
+  quadric.ab += other.ab;
+  quadric.ac += other.ac;
+  quadric.ad += other.ad;
+  quadric.bc += other.bc;
+  quadric.bd += other.bd;
+  quadric.cd += other.cd;
+  quadric.weight += other.weight;
+}
+
+/// Mean squared distance of the point to the planes of both quadrics.
+static float64 CollapseError(const Quadric& q0, const Quadric& q1,
+                             const DirectX::XMFLOAT3& point) {
+  Quadric q = q0;
+  AddQuadric(q, q1);
+  if (q.weight <= 0.0) { return 0.0; }
+
+  const float64 x = point.x, y = point.y, z = point.z;
+  float64 error = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2 +
+                  2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z +
+                         q.ad * x + q.bd * y + q.cd * z);
+  error /= q.weight;
+  return error > 0.0 ? error : 0.0;
+}
+
+/// Unnormalized triangle normal, its length is twice the area.
+static void TriangleNormal(const DirectX::XMFLOAT3& p0,
+                           const DirectX::XMFLOAT3& p1,
+                           const DirectX::XMFLOAT3& p2,
+                           float64 normal[3]) {
+  const float64 e0[3] = { p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+  const float64 e1[3] = { p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+  normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+  normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+  normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+/// Position id of every vertex, vertices with the same position share it.
+static uint32 WeldPositions(const std::vector<Geo::VertexData>& vertices,
+                            std::vector<uint32>& position_of,
+                            std::vector<DirectX::XMFLOAT3>& positions) {
+
+  const uint32 num_vertices = vertices.size();
+  uint32 table_size = 1;
+  while (table_size < num_vertices * 2) { table_size <<= 1; }
+  std::vector<uint32> table(table_size, kInvalidIndex);
+
+  position_of.resize(num_vertices);
+  positions.clear();
+  for (uint32 i = 0; i < num_vertices; ++i) {
+    const uchar8* bytes = (const uchar8*)&vertices[i].position;
+    uint32 hash = 2166136261u;
+    for (uint32 b = 0; b < sizeof(DirectX::XMFLOAT3); ++b) {
+      hash = (hash ^ bytes[b]) * 16777619u;
+    }
+
+    uint32 slot = hash & (table_size - 1);
+    while (table[slot] != kInvalidIndex &&
+           memcmp(&positions[table[slot]], &vertices[i].position, sizeof(DirectX::XMFLOAT3)) != 0) {
+      slot = (slot + 1) & (table_size - 1);
+    }
+    if (table[slot] == kInvalidIndex) {
+      table[slot] = positions.size();
+      positions.push_back(vertices[i].position);
+    }
+    position_of[i] = table[slot];
+  }
+
+  return positions.size();
+}
+
+static void BuildAdjacency(const std::vector<uint32>& indices,
+                           const std::vector<uint32>& position_of,
+                           const uint32 num_positions,
+                           Adjacency& adjacency) {
+
+  adjacency.offsets.assign(num_positions + 1, 0);
+  for (uint32 i = 0; i < indices.size(); ++i) {
+    adjacency.offsets[position_of[indices[i]] + 1]++;
+  }
+  for (uint32 p = 0; p < num_positions; ++p) {
+    adjacency.offsets[p + 1] += adjacency.offsets[p];
+  }
+
+  std::vector<uint32> cursor(adjacency.offsets.begin(), adjacency.offsets.end() - 1);
+  adjacency.triangles.resize(indices.size());
+  for (uint32 i = 0; i < indices.size(); ++i) {
+    adjacency.triangles[cursor[position_of[indices[i]]]++] = i / 3;
+  }
+}
+
+/// Triangles around the position a that use the position b too.
+static uint32 SharedTriangles(const Adjacency& adjacency,
+                              const std::vector<uint32>& indices,
+                              const std::vector<uint32>& position_of,
+                              const uint32 a,
+                              const uint32 b) {
+  uint32 count = 0;
+  for (uint32 t = adjacency.offsets[a]; t < adjacency.offsets[a + 1]; ++t) {
+    const uint32* triangle = &indices[adjacency.triangles[t] * 3];
+    if (position_of[triangle[0]] == b || position_of[triangle[1]] == b ||
+        position_of[triangle[2]] == b) {
+      count++;
+    }
+  }
+  return count;
+}
+
+/// Whether moving the position from into to turns any triangle around.
+static bool CollapseFlips(const Adjacency& adjacency,
+                          const std::vector<uint32>& indices,
+                          const std::vector<uint32>& position_of,
+                          const std::vector<DirectX::XMFLOAT3>& positions,
+                          const uint32 from,
+                          const uint32 to) {
+
+  for (uint32 t = adjacency.offsets[from]; t < adjacency.offsets[from + 1]; ++t) {
+    const uint32* triangle = &indices[adjacency.triangles[t] * 3];
+    uint32 corners[3] = { position_of[triangle[0]], position_of[triangle[1]],
+                          position_of[triangle[2]] };
+    // Triangles with both positions disappear.
+    if (corners[0] == to || corners[1] == to || corners[2] == to) { continue; }
+
+    DirectX::XMFLOAT3 moved[3];
+    for (uint32 c = 0; c < 3; ++c) {
+      moved[c] = positions[corners[c] == from ? to : corners[c]];
+    }
+
+    float64 before[3], after[3];
+    TriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]], before);
+    TriangleNormal(moved[0], moved[1], moved[2], after);
+    float64 dot = before[0] * after[0] + before[1] * after[1] + before[2] * after[2];
+    float64 lengths = sqrt((before[0] * before[0] + before[1] * before[1] + before[2] * before[2]) *
+                           (after[0] * after[0] + after[1] * after[1] + after[2] * after[2]));
+    if (dot <= kMinFlipCosine * lengths) { return true; }
+  }
+  return false;
+}
+
+/// Vertex of the position to with the attributes nearest to vertex.
+static uint32 ClosestWedge(const std::vector<Geo::VertexData>& vertices,
+                           const uint32 vertex,
+                           const uint32* wedges,
+                           const uint32 num_wedges) {
+  const Geo::VertexData& source = vertices[vertex];
+  uint32 best = wedges[0];
+  float32 best_distance = FLT_MAX;
+  for (uint32 w = 0; w < num_wedges; ++w) {
+    const Geo::VertexData& wedge = vertices[wedges[w]];
+    float32 nx = wedge.normal.x - source.normal.x;
+    float32 ny = wedge.normal.y - source.normal.y;
+    float32 nz = wedge.normal.z - source.normal.z;
+    float32 u = wedge.uv.x - source.uv.x;
+    float32 v = wedge.uv.y - source.uv.y;
+    float32 distance = nx * nx + ny * ny + nz * nz + u * u + v * v;
+    if (distance < best_distance) {
+      best_distance = distance;
+      best = wedges[w];
+    }
+  }
+  return best;
+}
+
+float32 Simplify(const std::vector<Geo::VertexData>& vertices,
+                 const uint32* indices,
+                 const uint32 num_indices,
+                 const uint32 target_indices,
+                 const float32 max_error,
+                 std::vector<uint32>& output) {
+
+  output.assign(indices, indices + num_indices);
+  if (num_indices <= target_indices || vertices.empty()) { return 0.0f; }
+
+  std::vector<uint32> position_of;
+  std::vector<DirectX::XMFLOAT3> positions;
+  const uint32 num_positions = WeldPositions(vertices, position_of, positions);
+
+  // Vertices of every position used, their attributes are the wedges.
+  std::vector<uint32> wedge_offsets(num_positions + 1, 0);
+  std::vector<uint32> wedges;
+  {
+    std::vector<bool> used(vertices.size(), false);
+    for (uint32 i = 0; i < num_indices; ++i) { used[indices[i]] = true; }
+    for (uint32 v = 0; v < vertices.size(); ++v) {
+      if (used[v]) { wedge_offsets[position_of[v] + 1]++; }
+    }
+    for (uint32 p = 0; p < num_positions; ++p) { wedge_offsets[p + 1] += wedge_offsets[p]; }
+    std::vector<uint32> cursor(wedge_offsets.begin(), wedge_offsets.end() - 1);
+    wedges.resize(wedge_offsets[num_positions]);
+    for (uint32 v = 0; v < vertices.size(); ++v) {
+      if (used[v]) { wedges[cursor[position_of[v]]++] = v; }
+    }
+  }
+
+  Adjacency adjacency;
+  BuildAdjacency(output, position_of, num_positions, adjacency);
+
+  // Triangle planes, weighted by area, and the planes keeping the borders.
+  std::vector<Quadric> quadrics(num_positions);
+  memset(quadrics.data(), 0, sizeof(Quadric) * num_positions);
+  std::vector<bool> border(num_positions, false);
+  for (uint32 i = 0; i < num_indices; i += 3) {
+    uint32 corners[3] = { position_of[output[i]], position_of[output[i + 1]],
+                          position_of[output[i + 2]] };
+    float64 normal[3];
+    TriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]], normal);
+    float64 length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length <= 0.0) { continue; }
+    normal[0] /= length; normal[1] /= length; normal[2] /= length;
+
+    const DirectX::XMFLOAT3& p0 = positions[corners[0]];
+    float64 d = -(normal[0] * p0.x + normal[1] * p0.y + normal[2] * p0.z);
+    for (uint32 c = 0; c < 3; ++c) {
+      AddPlane(quadrics[corners[c]], normal[0], normal[1], normal[2], d, length * 0.5);
+    }
+
+    for (uint32 e = 0; e < 3; ++e) {
+      uint32 a = corners[e];
+      uint32 b = corners[(e + 1) % 3];
+      if (SharedTriangles(adjacency, output, position_of, a, b) != 1) { continue; }
+      border[a] = true;
+      border[b] = true;
+
+      // Plane through the edge, perpendicular to the triangle.
+      const DirectX::XMFLOAT3& pa = positions[a];
+      const DirectX::XMFLOAT3& pb = positions[b];
+      float64 edge[3] = { pb.x - pa.x, pb.y - pa.y, pb.z - pa.z };
+      float64 plane[3] = { edge[1] * normal[2] - edge[2] * normal[1],
+                           edge[2] * normal[0] - edge[0] * normal[2],
+                           edge[0] * normal[1] - edge[1] * normal[0] };
+      float64 plane_length = sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+      if (plane_length <= 0.0) { continue; }
+      plane[0] /= plane_length; plane[1] /= plane_length; plane[2] /= plane_length;
+      float64 plane_d = -(plane[0] * pa.x + plane[1] * pa.y + plane[2] * pa.z);
+      float64 edge_length2 = edge[0] * edge[0] + edge[1] * edge[1] + edge[2] * edge[2];
+      AddPlane(quadrics[a], plane[0], plane[1], plane[2], plane_d, edge_length2 * kBorderWeight);
+      AddPlane(quadrics[b], plane[0], plane[1], plane[2], plane_d, edge_length2 * kBorderWeight);
+    }
+  }
+
+  const float64 max_error2 = (float64)max_error * (float64)max_error;
+  float64 result_error2 = 0.0;
+  std::vector<uint32> vertex_remap(vertices.size());
+  for (uint32 v = 0; v < vertices.size(); ++v) { vertex_remap[v] = v; }
+  std::vector<bool> locked(num_positions);
+  std::vector<Collapse> collapses;
+
+  // Passes of independent collapses, cheapest first, until the target.
+  while (output.size() > target_indices) {
+
+    collapses.clear();
+    for (uint32 i = 0; i < output.size(); i += 3) {
+      for (uint32 e = 0; e < 3; ++e) {
+        uint32 a = position_of[output[i + e]];
+        uint32 b = position_of[output[i + (e + 1) % 3]];
+        if (a == b) { continue; }
+
+        // Borders slide along the borders, seams along the seams.
+        bool border_edge = (border[a] && border[b]) &&
+                           SharedTriangles(adjacency, output, position_of, a, b) == 1;
+        bool seam[2] = { wedge_offsets[a + 1] - wedge_offsets[a] > 1,
+                         wedge_offsets[b + 1] - wedge_offsets[b] > 1 };
+        bool a_to_b = (!border[a] || border_edge) && (!seam[0] || seam[1]);
+        bool b_to_a = (!border[b] || border_edge) && (!seam[1] || seam[0]);
+
+        float64 a_error = a_to_b ? CollapseError(quadrics[a], quadrics[b], positions[b]) : DBL_MAX;
+        float64 b_error = b_to_a ? CollapseError(quadrics[a], quadrics[b], positions[a]) : DBL_MAX;
+        if (a_error <= b_error && a_to_b && a_error <= max_error2) {
+          collapses.push_back({ a, b, a_error });
+        }
+        else if (b_to_a && b_error <= max_error2) {
+          collapses.push_back({ b, a, b_error });
+        }
+      }
+    }
+    if (collapses.empty()) { break; }
+
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse& x, const Collapse& y) { return x.error < y.error; });
+
+    // Every collapse removes two triangles in a closed mesh.
+    uint32 triangles_left = (output.size() - target_indices) / 3;
+    uint32 max_collapses = triangles_left / 2 > 0 ? triangles_left / 2 : 1;
+    uint32 num_collapses = 0;
+    std::fill(locked.begin(), locked.end(), false);
+    for (uint32 c = 0; c < collapses.size() && num_collapses < max_collapses; ++c) {
+      const Collapse& collapse = collapses[c];
+      if (locked[collapse.from] || locked[collapse.to]) { continue; }
+      if (CollapseFlips(adjacency, output, position_of, positions, collapse.from, collapse.to)) {
+        continue;
+      }
+
+      const uint32* to_wedges = &wedges[wedge_offsets[collapse.to]];
+      const uint32 num_to_wedges = wedge_offsets[collapse.to + 1] - wedge_offsets[collapse.to];
+      for (uint32 w = wedge_offsets[collapse.from]; w < wedge_offsets[collapse.from + 1]; ++w) {
+        vertex_remap[wedges[w]] = ClosestWedge(vertices, wedges[w], to_wedges, num_to_wedges);
+      }
+      AddQuadric(quadrics[collapse.to], quadrics[collapse.from]);
+
+      // The triangles around from changed, their positions wait a pass.
+      for (uint32 t = adjacency.offsets[collapse.from]; t < adjacency.offsets[collapse.from + 1]; ++t) {
+        const uint32* triangle = &output[adjacency.triangles[t] * 3];
+        locked[position_of[triangle[0]]] = true;
+        locked[position_of[triangle[1]]] = true;
+        locked[position_of[triangle[2]]] = true;
+      }
+
+      if (collapse.error > result_error2) { result_error2 = collapse.error; }
+      num_collapses++;
+    }
+    if (num_collapses == 0) { break; }
+
+    // Remaps the collapsed vertices and removes the degenerated triangles.
+    uint32 num_output = 0;
+    for (uint32 i = 0; i < output.size(); i += 3) {
+      uint32 v0 = vertex_remap[output[i]];
+      uint32 v1 = vertex_remap[output[i + 1]];
+      uint32 v2 = vertex_remap[output[i + 2]];
+      uint32 p0 = position_of[v0], p1 = position_of[v1], p2 = position_of[v2];
+      if (p0 == p1 || p1 == p2 || p0 == p2) { continue; }
+      output[num_output++] = v0;
+      output[num_output++] = v1;
+      output[num_output++] = v2;
+    }
+    output.resize(num_output);
+    BuildAdjacency(output, position_of, num_positions, adjacency);
+  }
+
+  return (float32)sqrt(result_error2);
+}
+
+}; /* MeshSimplifier */
+}; /* W3D */
@@ -0,0 +1,356 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/meshlet.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+
+namespace W3D {
+namespace Meshlets {
+
+/// Triangles past kMinTriangles must face less than 60 degrees away from the
+/// meshlet normal.
+const float32 kGrowMinCosine = 0.5f;
+/// Cones wider than ~84 degrees from the axis can't be culled in practice.
+const float32 kCullMinCosine = 0.1f;
+const uint32 kNone = 0xFFFFFFFF;
+
+static DirectX::XMVECTOR LoadPosition(const DirectX::XMFLOAT3* positions,
+                                      const uint32 stride,
+                                      const uint32 index) {
+  return DirectX::XMLoadFloat3((const DirectX::XMFLOAT3*)((const uchar8*)positions + (uint64)index * stride));
+}
+
+/// Whether a normal fits in the cone of the normals summed, degenerate
+/// triangles fit anywhere.
+static bool FitsCone(const DirectX::XMVECTOR normal_sum, const DirectX::XMFLOAT3& normal) {
+  DirectX::XMVECTOR length = DirectX::XMVector3Length(normal_sum);
+  if (DirectX::XMVectorGetX(length) <= 0.0f) { return true; }
+  if (normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f) { return true; }
+  DirectX::XMVECTOR dot = DirectX::XMVector3Dot(normal_sum, DirectX::XMLoadFloat3(&normal));
+  return DirectX::XMVectorGetX(dot) >= kGrowMinCosine * DirectX::XMVectorGetX(length);
+}
+
+void Build(const DirectX::XMFLOAT3* positions,
+           const uint32 position_stride,
+           uint32* indices,
+           const uint32 first_index,
+           const uint32 num_indices,
+           Set* meshlets) {
+
+  Set& set = *meshlets;
+  set.count = 0;
+  set.first_index.clear();
+  set.num_indices.clear();
+  set.center_x.clear();
+  set.center_y.clear();
+  set.center_z.clear();
+  set.radius.clear();
+  set.axis_x.clear();
+  set.axis_y.clear();
+  set.axis_z.clear();
+  set.cutoff.clear();
+
+  const uint32 num_triangles = num_indices / 3;
+  if (num_triangles == 0) { return; }
+  uint32* triangles = indices + first_index;
+
+  // Front normals, (b - a) x (c - a), and the triangles of every vertex.
+  uint32 num_vertices = 0;
+  for (uint32 i = 0; i < num_triangles * 3; ++i) {
+    if (triangles[i] + 1 > num_vertices) { num_vertices = triangles[i] + 1; }
+  }
+  std::vector<DirectX::XMFLOAT3> normals(num_triangles);
+  std::vector<DirectX::XMFLOAT3> centroids(num_triangles);
+  std::vector<uint32> adjacency_offsets(num_vertices + 1, 0);
+  for (uint32 t = 0; t < num_triangles; ++t) {
+    const uint32* triangle = &triangles[t * 3];
+    DirectX::XMVECTOR a = LoadPosition(positions, position_stride, triangle[0]);
+    DirectX::XMVECTOR b = LoadPosition(positions, position_stride, triangle[1]);
+    DirectX::XMVECTOR c = LoadPosition(positions, position_stride, triangle[2]);
+    DirectX::XMVECTOR normal = DirectX::XMVector3Cross(DirectX::XMVectorSubtract(b, a),
+                                                       DirectX::XMVectorSubtract(c, a));
+    DirectX::XMStoreFloat3(&normals[t], DirectX::XMVector3Normalize(normal));
+    DirectX::XMStoreFloat3(&centroids[t], DirectX::XMVectorScale(DirectX::XMVectorAdd(DirectX::XMVectorAdd(a, b), c),
+                                                                  1.0f / 3.0f));
+    if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(normal)) <= 0.0f) {
+      normals[t] = { 0.0f, 0.0f, 0.0f };
+    }
+    for (uint32 k = 0; k < 3; ++k) { adjacency_offsets[triangle[k] + 1]++; }
+  }
+  for (uint32 v = 0; v < num_vertices; ++v) { adjacency_offsets[v + 1] += adjacency_offsets[v]; }
+  std::vector<uint32> adjacency(num_triangles * 3);
+  std::vector<uint32> fill(adjacency_offsets.begin(), adjacency_offsets.end() - 1);
+  for (uint32 t = 0; t < num_triangles; ++t) {
+    for (uint32 k = 0; k < 3; ++k) { adjacency[fill[triangles[t * 3 + k]]++] = t; }
+  }
+
+  // Meshlets grow from the first triangle left through the neighbour
+  // closest to their centroid, so they stay round.
+  std::vector<uint32> assigned(num_triangles, kNone);
+  std::vector<uint32> queued(num_triangles, kNone);
+  std::vector<uint32> order;
+  order.reserve(num_triangles);
+  std::vector<uint32> frontier;
+  std::vector<uint32> members;
+  std::vector<uint32> meshlet_sizes;
+  uint32 cursor = 0;
+
+  while (order.size() < num_triangles) {
+    const uint32 meshlet = meshlet_sizes.size();
+    DirectX::XMVECTOR normal_sum = DirectX::XMVectorZero();
+    DirectX::XMVECTOR centroid_sum = DirectX::XMVectorZero();
+    members.clear();
+    frontier.clear();
+
+    while (members.size() < kMaxTriangles) {
+      uint32 next = kNone;
+      uint32 next_slot = 0;
+      float32 next_distance = FLT_MAX;
+      DirectX::XMVECTOR centroid = DirectX::XMVectorScale(centroid_sum, 1.0f / (float32)(members.size() > 0 ? members.size() : 1));
+      for (uint32 slot = 0; slot < frontier.size(); ++slot) {
+        const uint32 candidate = frontier[slot];
+        if (assigned[candidate] != kNone) {
+          frontier[slot--] = frontier.back();
+          frontier.pop_back();
+          continue;
+        }
+        if (members.size() >= kMinTriangles && !FitsCone(normal_sum, normals[candidate])) {
+          continue;
+        }
+        DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&centroids[candidate]), centroid);
+        float32 distance = DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(offset));
+        if (distance < next_distance) {
+          next = candidate;
+          next_slot = slot;
+          next_distance = distance;
+        }
+      }
+      if (next != kNone) {
+        frontier[next_slot] = frontier.back();
+        frontier.pop_back();
+      }
+
+      // Nothing connected left, small meshlets take the next triangle of
+      // the previous order, usually close.
+      if (next == kNone) {
+        if (members.size() >= kMinTriangles) { break; }
+        while (cursor < num_triangles && assigned[cursor] != kNone) { cursor++; }
+        if (cursor == num_triangles) { break; }
+        next = cursor;
+      }
+
+      assigned[next] = meshlet;
+      members.push_back(next);
+      normal_sum = DirectX::XMVectorAdd(normal_sum, DirectX::XMLoadFloat3(&normals[next]));
+      centroid_sum = DirectX::XMVectorAdd(centroid_sum, DirectX::XMLoadFloat3(&centroids[next]));
+      for (uint32 k = 0; k < 3; ++k) {
+        const uint32 vertex = triangles[next * 3 + k];
+        for (uint32 j = adjacency_offsets[vertex]; j < adjacency_offsets[vertex + 1]; ++j) {
+          const uint32 neighbour = adjacency[j];
+          if (assigned[neighbour] == kNone && queued[neighbour] != meshlet) {
+            queued[neighbour] = meshlet;
+            frontier.push_back(neighbour);
+          }
+        }
+      }
+    }
+
+    // Previous order inside the meshlet, the vertex cache one.
+    std::sort(members.begin(), members.end());
+    order.insert(order.end(), members.begin(), members.end());
+    meshlet_sizes.push_back(members.size());
+  }
+
+  // Triangles reordered in place.
+  std::vector<uint32> reordered(num_triangles * 3);
+  for (uint32 i = 0; i < num_triangles; ++i) {
+    for (uint32 k = 0; k < 3; ++k) { reordered[i * 3 + k] = triangles[order[i] * 3 + k]; }
+  }
+  std::copy(reordered.begin(), reordered.end(), triangles);
+
+  // Bounds and cones, padded to groups of 4.
+  set.count = meshlet_sizes.size();
+  const uint32 padded = (set.count + 3) & ~3u;
+  set.first_index.assign(padded, first_index);
+  set.num_indices.assign(padded, 0);
+  set.center_x.assign(padded, 0.0f);
+  set.center_y.assign(padded, 0.0f);
+  set.center_z.assign(padded, 0.0f);
+  set.radius.assign(padded, 0.0f);
+  set.axis_x.assign(padded, 0.0f);
+  set.axis_y.assign(padded, 0.0f);
+  set.axis_z.assign(padded, 0.0f);
+  set.cutoff.assign(padded, 1.0f);
+
+  uint32 first_triangle = 0;
+  for (uint32 m = 0; m < set.count; ++m) {
+    const uint32 count = meshlet_sizes[m];
+    const uint32* meshlet_indices = &triangles[first_triangle * 3];
+    set.first_index[m] = first_index + first_triangle * 3;
+    set.num_indices[m] = count * 3;
+
+    DirectX::XMVECTOR min = LoadPosition(positions, position_stride, meshlet_indices[0]);
+    DirectX::XMVECTOR max = min;
+    DirectX::XMVECTOR normal_sum = DirectX::XMVectorZero();
+    for (uint32 i = 0; i < count * 3; ++i) {
+      DirectX::XMVECTOR position = LoadPosition(positions, position_stride, meshlet_indices[i]);
+      min = DirectX::XMVectorMin(min, position);
+      max = DirectX::XMVectorMax(max, position);
+    }
+    for (uint32 t = 0; t < count; ++t) {
+      normal_sum = DirectX::XMVectorAdd(normal_sum, DirectX::XMLoadFloat3(&normals[order[first_triangle + t]]));
+    }
+
+    DirectX::XMVECTOR center = DirectX::XMVectorScale(DirectX::XMVectorAdd(min, max), 0.5f);
+    float32 radius_sq = 0.0f;
+    for (uint32 i = 0; i < count * 3; ++i) {
+      DirectX::XMVECTOR offset = DirectX::XMVectorSubtract(
+        LoadPosition(positions, position_stride, meshlet_indices[i]), center);
+      float32 distance_sq = DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(offset));
+      if (distance_sq > radius_sq) { radius_sq = distance_sq; }
+    }
+    set.center_x[m] = DirectX::XMVectorGetX(center);
+    set.center_y[m] = DirectX::XMVectorGetY(center);
+    set.center_z[m] = DirectX::XMVectorGetZ(center);
+    set.radius[m] = sqrtf(radius_sq);
+
+    // Cone from the widest normal, only if it can ever be culled.
+    if (DirectX::XMVectorGetX(DirectX::XMVector3LengthSq(normal_sum)) > 0.0f) {
+      DirectX::XMVECTOR axis = DirectX::XMVector3Normalize(normal_sum);
+      float32 min_cosine = 1.0f;
+      for (uint32 t = 0; t < count; ++t) {
+        const DirectX::XMFLOAT3& normal = normals[order[first_triangle + t]];
+        if (normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f) { continue; }
+        float32 cosine = DirectX::XMVectorGetX(DirectX::XMVector3Dot(axis, DirectX::XMLoadFloat3(&normal)));
+        if (cosine < min_cosine) { min_cosine = cosine; }
+      }
+      if (min_cosine >= kCullMinCosine) {
+        set.axis_x[m] = DirectX::XMVectorGetX(axis);
+        set.axis_y[m] = DirectX::XMVectorGetY(axis);
+        set.axis_z[m] = DirectX::XMVectorGetZ(axis);
+        set.cutoff[m] = sqrtf(1.0f - min_cosine * min_cosine);
+      }
+    }
+
+    first_triangle += count;
+  }
+}
+
+uint32 Cull(const Set& meshlets,
+            const DirectX::XMMATRIX& model_view_projection,
+            const DirectX::XMFLOAT3 camera,
+            const bool backface,
+            std::vector<Range>& ranges,
+            Stats* stats) {
+
+  ranges.clear();
+  if (meshlets.count == 0) { return 0; }
+
+  // Clip planes in model space from the columns, z from 0 to w.
+  DirectX::XMMATRIX columns = DirectX::XMMatrixTranspose(model_view_projection);
+  DirectX::XMVECTOR planes[6] = {
+    DirectX::XMVectorAdd(columns.r[3], columns.r[0]),
+    DirectX::XMVectorSubtract(columns.r[3], columns.r[0]),
+    DirectX::XMVectorAdd(columns.r[3], columns.r[1]),
+    DirectX::XMVectorSubtract(columns.r[3], columns.r[1]),
+    columns.r[2],
+    DirectX::XMVectorSubtract(columns.r[3], columns.r[2]),
+  };
+  DirectX::XMVECTOR plane_x[6], plane_y[6], plane_z[6], plane_w[6];
+  for (uint32 p = 0; p < 6; ++p) {
+    planes[p] = DirectX::XMPlaneNormalize(planes[p]);
+    plane_x[p] = DirectX::XMVectorSplatX(planes[p]);
+    plane_y[p] = DirectX::XMVectorSplatY(planes[p]);
+    plane_z[p] = DirectX::XMVectorSplatZ(planes[p]);
+    plane_w[p] = DirectX::XMVectorSplatW(planes[p]);
+  }
+  const DirectX::XMVECTOR camera_x = DirectX::XMVectorReplicate(camera.x);
+  const DirectX::XMVECTOR camera_y = DirectX::XMVectorReplicate(camera.y);
+  const DirectX::XMVECTOR camera_z = DirectX::XMVectorReplicate(camera.z);
+
+  uint64 num_triangles = 0;
+  uint64 num_frustum_culled = 0;
+  uint64 num_backface_culled = 0;
+  uint32 num_visible_indices = 0;
+
+  for (uint32 i = 0; i < meshlets.count; i += 4) {
+    DirectX::XMVECTOR center_x = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.center_x[i]);
+    DirectX::XMVECTOR center_y = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.center_y[i]);
+    DirectX::XMVECTOR center_z = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.center_z[i]);
+    DirectX::XMVECTOR radius = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.radius[i]);
+
+    // Outside if the sphere is behind any plane.
+    DirectX::XMVECTOR negative_radius = DirectX::XMVectorNegate(radius);
+    DirectX::XMVECTOR outside = DirectX::XMVectorFalseInt();
+    for (uint32 p = 0; p < 6; ++p) {
+      DirectX::XMVECTOR distance = DirectX::XMVectorMultiplyAdd(plane_x[p], center_x,
+                                   DirectX::XMVectorMultiplyAdd(plane_y[p], center_y,
+                                   DirectX::XMVectorMultiplyAdd(plane_z[p], center_z, plane_w[p])));
+      outside = DirectX::XMVectorOrInt(outside, DirectX::XMVectorLess(distance, negative_radius));
+    }
+
+    // Back facing if the camera is behind the cone of every point of the
+    // sphere: dot(center - camera, axis) >= cutoff * |center - camera| + radius.
+    DirectX::XMVECTOR back = DirectX::XMVectorFalseInt();
+    if (backface) {
+      DirectX::XMVECTOR to_x = DirectX::XMVectorSubtract(center_x, camera_x);
+      DirectX::XMVECTOR to_y = DirectX::XMVectorSubtract(center_y, camera_y);
+      DirectX::XMVECTOR to_z = DirectX::XMVectorSubtract(center_z, camera_z);
+      DirectX::XMVECTOR distance = DirectX::XMVectorSqrt(
+        DirectX::XMVectorMultiplyAdd(to_x, to_x,
+        DirectX::XMVectorMultiplyAdd(to_y, to_y, DirectX::XMVectorMultiply(to_z, to_z))));
+      DirectX::XMVECTOR axis_x = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.axis_x[i]);
+      DirectX::XMVECTOR axis_y = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.axis_y[i]);
+      DirectX::XMVECTOR axis_z = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.axis_z[i]);
+      DirectX::XMVECTOR cutoff = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&meshlets.cutoff[i]);
+      DirectX::XMVECTOR dot = DirectX::XMVectorMultiplyAdd(to_x, axis_x,
+                              DirectX::XMVectorMultiplyAdd(to_y, axis_y, DirectX::XMVectorMultiply(to_z, axis_z)));
+      back = DirectX::XMVectorGreaterOrEqual(dot, DirectX::XMVectorMultiplyAdd(cutoff, distance, radius));
+    }
+
+    uint32 outside_mask[4];
+    uint32 back_mask[4];
+    DirectX::XMStoreInt4(outside_mask, outside);
+    DirectX::XMStoreInt4(back_mask, back);
+
+    // Compaction, scalar.
+    for (uint32 lane = 0; lane < 4 && i + lane < meshlets.count; ++lane) {
+      const uint32 meshlet = i + lane;
+      const uint32 count = meshlets.num_indices[meshlet];
+      num_triangles += count / 3;
+      if (outside_mask[lane]) {
+        num_frustum_culled += count / 3;
+        continue;
+      }
+      if (back_mask[lane]) {
+        num_backface_culled += count / 3;
+        continue;
+      }
+
+      const uint32 first = meshlets.first_index[meshlet];
+      if (!ranges.empty() && ranges.back().first_index + ranges.back().num_indices == first) {
+        ranges.back().num_indices += count;
+      }
+      else {
+        ranges.push_back({ first, count });
+      }
+      num_visible_indices += count;
+    }
+  }
+
+  if (stats) {
+    stats->num_triangles += num_triangles;
+    stats->num_frustum_culled += num_frustum_culled;
+    stats->num_backface_culled += num_backface_culled;
+  }
+  return num_visible_indices;
+}
+
+}; /* Meshlets */
+}; /* W3D */
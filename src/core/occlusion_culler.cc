@@ -0,0 +1,390 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/occlusion_culler.h"
+#include <algorithm>
+#include <chrono>
+#include <float.h>
+#include <math.h>
+
+namespace W3D {
+
+/// Vertices transformed and triangles set up by every job.
+const uint32 kOcclusionVerticesPerJob = 4096;
+const uint32 kOcclusionTrianglesPerJob = 1024;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+OcclusionCuller::OcclusionCuller() {
+  DirectX::XMStoreFloat4x4(&view_projection_, DirectX::XMMatrixIdentity());
+  jobs_ = nullptr;
+  depth_.assign(kWidth * kHeight, 1.0f);
+  blocks_.assign(kBlocksX * kBlocksY, 1.0f);
+  ready_ = false;
+  stats_ = { 0, 0, 0, 0, 0, 0.0 };
+}
+
+OcclusionCuller::~OcclusionCuller() {
+  occluders_.clear();
+  bins_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void OcclusionCuller::beginFrame(const DirectX::XMMATRIX& view_projection, JobSystem& jobs) {
+  DirectX::XMStoreFloat4x4(&view_projection_, view_projection);
+  jobs_ = &jobs;
+  occluders_.clear();
+  ready_ = false;
+  stats_ = { 0, 0, 0, 0, 0, 0.0 };
+}
+
+void OcclusionCuller::addOccluder(const DirectX::XMFLOAT3* positions,
+                                  const uint32 num_positions,
+                                  const uint32* indices,
+                                  const uint32 num_indices,
+                                  const DirectX::XMMATRIX& model) {
+
+  if (!positions || !indices || num_positions == 0 || num_indices < 3) { return; }
+
+  Occluder occluder;
+  occluder.positions = positions;
+  occluder.num_positions = num_positions;
+  occluder.indices = indices;
+  occluder.num_indices = num_indices - num_indices % 3;
+  DirectX::XMStoreFloat4x4(&occluder.model_view_projection,
+                           DirectX::XMMatrixMultiply(model, DirectX::XMLoadFloat4x4(&view_projection_)));
+  occluder.first_vertex = 0;
+  occluders_.push_back(occluder);
+  stats_.num_occluders++;
+  stats_.num_triangles += occluder.num_indices / 3;
+}
+
+void OcclusionCuller::rasterize() {
+
+  const auto start = std::chrono::steady_clock::now();
+  ready_ = false;
+  if (occluders_.empty() || !jobs_) { return; }
+
+  // Every occluder split in jobs, its vertices one after the other.
+  vertex_jobs_.clear();
+  triangle_jobs_.clear();
+  uint32 num_vertices = 0;
+  for (uint32 i = 0; i < occluders_.size(); ++i) {
+    Occluder& occluder = occluders_[i];
+    occluder.first_vertex = num_vertices;
+    num_vertices += occluder.num_positions;
+    for (uint32 first = 0; first < occluder.num_positions; first += kOcclusionVerticesPerJob) {
+      uint32 count = std::min(kOcclusionVerticesPerJob, occluder.num_positions - first);
+      vertex_jobs_.push_back({ i, first, count });
+    }
+    const uint32 num_triangles = occluder.num_indices / 3;
+    for (uint32 first = 0; first < num_triangles; first += kOcclusionTrianglesPerJob) {
+      uint32 count = std::min(kOcclusionTrianglesPerJob, num_triangles - first);
+      triangle_jobs_.push_back({ i, first, count });
+    }
+  }
+  clip_positions_.resize(num_vertices);
+  if (bins_.size() < triangle_jobs_.size()) { bins_.resize(triangle_jobs_.size()); }
+
+  JobSystem& jobs = *jobs_;
+  jobs.parallelFor(vertex_jobs_.size(), 1, [this](uint32 begin, uint32 end) {
+    for (uint32 i = begin; i < end; ++i) {
+      const Job& job = vertex_jobs_[i];
+      const Occluder& occluder = occluders_[job.occluder];
+      DirectX::XMVector3TransformStream(&clip_positions_[occluder.first_vertex + job.first],
+                                        sizeof(DirectX::XMFLOAT4),
+                                        occluder.positions + job.first,
+                                        sizeof(DirectX::XMFLOAT3),
+                                        job.count,
+                                        DirectX::XMLoadFloat4x4(&occluder.model_view_projection));
+    }
+  });
+
+  jobs.parallelFor(triangle_jobs_.size(), 1, [this](uint32 begin, uint32 end) {
+    for (uint32 i = begin; i < end; ++i) { setupTriangles(triangle_jobs_[i], bins_[i]); }
+  });
+
+  jobs.parallelFor(kNumTiles, 1, [this](uint32 begin, uint32 end) {
+    for (uint32 i = begin; i < end; ++i) { rasterizeTile(i); }
+  });
+
+  for (uint32 i = 0; i < triangle_jobs_.size(); ++i) {
+    stats_.num_rasterized += bins_[i].triangles.size();
+  }
+  stats_.rasterize_ms = std::chrono::duration<float64, std::milli>(std::chrono::steady_clock::now() - start).count();
+  ready_ = true;
+}
+
+bool OcclusionCuller::testBox(const DirectX::BoundingBox& box, const DirectX::XMMATRIX& model) {
+
+  if (!ready_) { return true; }
+  stats_.num_tested++;
+
+  DirectX::XMFLOAT3 corners[DirectX::BoundingBox::CORNER_COUNT];
+  DirectX::XMFLOAT4 clip[DirectX::BoundingBox::CORNER_COUNT];
+  box.GetCorners(corners);
+  DirectX::XMVector3TransformStream(clip, sizeof(DirectX::XMFLOAT4),
+                                    corners, sizeof(DirectX::XMFLOAT3),
+                                    DirectX::BoundingBox::CORNER_COUNT,
+                                    DirectX::XMMatrixMultiply(model, DirectX::XMLoadFloat4x4(&view_projection_)));
+
+  // Screen rectangle and nearest depth.
+  float32 min_x = FLT_MAX;
+  float32 min_y = FLT_MAX;
+  float32 max_x = -FLT_MAX;
+  float32 max_y = -FLT_MAX;
+  float32 min_z = FLT_MAX;
+  for (uint32 i = 0; i < DirectX::BoundingBox::CORNER_COUNT; ++i) {
+    if (clip[i].z < 0.0f || clip[i].w <= 0.0f) { return true; }
+    const float32 inv_w = 1.0f / clip[i].w;
+    const float32 x = (clip[i].x * inv_w * 0.5f + 0.5f) * (float32)kWidth;
+    const float32 y = (0.5f - clip[i].y * inv_w * 0.5f) * (float32)kHeight;
+    min_x = std::min(min_x, x);
+    max_x = std::max(max_x, x);
+    min_y = std::min(min_y, y);
+    max_y = std::max(max_y, y);
+    min_z = std::min(min_z, clip[i].z * inv_w);
+  }
+  if (max_x < 0.0f || max_y < 0.0f || min_x >= (float32)kWidth || min_y >= (float32)kHeight) {
+    return true;
+  }
+
+  // The pixels are covered when their center is, so the occluders spread
+  // up to a pixel over their edges. The box grows the same.
+  min_x -= 1.0f;
+  min_y -= 1.0f;
+  max_x += 1.0f;
+  max_y += 1.0f;
+
+  const int32 first_x = (int32)std::max(min_x, 0.0f) / kBlockSize;
+  const int32 first_y = (int32)std::max(min_y, 0.0f) / kBlockSize;
+  const int32 last_x = (int32)std::min(max_x, (float32)(kWidth - 1)) / kBlockSize;
+  const int32 last_y = (int32)std::min(max_y, (float32)(kHeight - 1)) / kBlockSize;
+  for (int32 y = first_y; y <= last_y; ++y) {
+    const float32* row = &blocks_[y * kBlocksX];
+    for (int32 x = first_x; x <= last_x; ++x) {
+      if (min_z <= row[x]) { return true; }
+    }
+  }
+
+  stats_.num_culled++;
+  return false;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+bool OcclusionCuller::ready() const {
+  return ready_;
+}
+
+const OcclusionCuller::Stats& OcclusionCuller::stats() const {
+  return stats_;
+}
+
+const float32* OcclusionCuller::depth() const {
+  return depth_.data();
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+void OcclusionCuller::setupTriangles(const Job& job, Bin& bin) {
+
+  bin.triangles.clear();
+  for (int32 i = 0; i < kNumTiles; ++i) { bin.tiles[i].clear(); }
+
+  const Occluder& occluder = occluders_[job.occluder];
+  const DirectX::XMFLOAT4* vertices = &clip_positions_[occluder.first_vertex];
+  const uint32* indices = occluder.indices + job.first * 3;
+
+  for (uint32 t = 0; t < job.count; ++t) {
+    const uint32 i0 = indices[t * 3];
+    const uint32 i1 = indices[t * 3 + 1];
+    const uint32 i2 = indices[t * 3 + 2];
+    if (i0 >= occluder.num_positions || i1 >= occluder.num_positions ||
+        i2 >= occluder.num_positions) {
+      continue;
+    }
+    const DirectX::XMFLOAT4 v[3] = { vertices[i0], vertices[i1], vertices[i2] };
+
+    // Whole triangle outside one of the planes.
+    if ((v[0].x > v[0].w && v[1].x > v[1].w && v[2].x > v[2].w) ||
+        (v[0].x < -v[0].w && v[1].x < -v[1].w && v[2].x < -v[2].w) ||
+        (v[0].y > v[0].w && v[1].y > v[1].w && v[2].y > v[2].w) ||
+        (v[0].y < -v[0].w && v[1].y < -v[1].w && v[2].y < -v[2].w) ||
+        (v[0].z > v[0].w && v[1].z > v[1].w && v[2].z > v[2].w) ||
+        (v[0].z < 0.0f && v[1].z < 0.0f && v[2].z < 0.0f)) {
+      continue;
+    }
+
+    if (v[0].z >= 0.0f && v[1].z >= 0.0f && v[2].z >= 0.0f) {
+      binTriangle(v[0], v[1], v[2], bin);
+      continue;
+    }
+
+    // Clipped by the near plane, z = 0, into a triangle or a quad.
+    DirectX::XMFLOAT4 polygon[4];
+    uint32 num_points = 0;
+    for (uint32 k = 0; k < 3; ++k) {
+      const DirectX::XMFLOAT4& a = v[k];
+      const DirectX::XMFLOAT4& b = v[(k + 1) % 3];
+      if (a.z >= 0.0f) { polygon[num_points++] = a; }
+      if ((a.z >= 0.0f) != (b.z >= 0.0f)) {
+        const float32 s = a.z / (a.z - b.z);
+        polygon[num_points++] = { a.x + (b.x - a.x) * s, a.y + (b.y - a.y) * s,
+                                  0.0f, a.w + (b.w - a.w) * s };
+      }
+    }
+    for (uint32 k = 2; k < num_points; ++k) {
+      binTriangle(polygon[0], polygon[k - 1], polygon[k], bin);
+    }
+  }
+}
+
+void OcclusionCuller::binTriangle(const DirectX::XMFLOAT4& a,
+                                  const DirectX::XMFLOAT4& b,
+                                  const DirectX::XMFLOAT4& c,
+                                  Bin& bin) {
+
+  if (a.w <= 0.0f || b.w <= 0.0f || c.w <= 0.0f) { return; }
+
+  // Pixels, y down.
+  const DirectX::XMFLOAT4* points[3] = { &a, &b, &c };
+  float32 x[3], y[3], z[3];
+  for (uint32 k = 0; k < 3; ++k) {
+    const float32 inv_w = 1.0f / points[k]->w;
+    x[k] = (points[k]->x * inv_w * 0.5f + 0.5f) * (float32)kWidth;
+    y[k] = (0.5f - points[k]->y * inv_w * 0.5f) * (float32)kHeight;
+    z[k] = points[k]->z * inv_w;
+  }
+
+  // Clockwise on the screen is the front face. The renderer never binds the
+  // rasterizer state of DirectXFramework, so the D3D default is what draws.
+  const float32 area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (!(area > 0.0f)) { return; }
+
+  // Clamped as floats first, the vertices can be far off the screen.
+  const float32 min_x = std::max(std::min(std::min(x[0], x[1]), x[2]), 0.0f);
+  const float32 min_y = std::max(std::min(std::min(y[0], y[1]), y[2]), 0.0f);
+  const float32 max_x = std::min(std::max(std::max(x[0], x[1]), x[2]), (float32)kWidth);
+  const float32 max_y = std::min(std::max(std::max(y[0], y[1]), y[2]), (float32)kHeight);
+  Triangle triangle;
+  triangle.min_x = (int32)min_x;
+  triangle.min_y = (int32)min_y;
+  triangle.max_x = (int32)ceilf(max_x);
+  triangle.max_y = (int32)ceilf(max_y);
+  if (triangle.min_x >= triangle.max_x || triangle.min_y >= triangle.max_y) { return; }
+
+  // Edge from vertex k to the next one, its opposite vertex weight.
+  float32 edge_a[3], edge_b[3], edge_c[3];
+  for (uint32 k = 0; k < 3; ++k) {
+    const uint32 next = (k + 1) % 3;
+    edge_a[k] = y[k] - y[next];
+    edge_b[k] = x[next] - x[k];
+    edge_c[k] = (y[next] - y[k]) * x[k] - (x[next] - x[k]) * y[k];
+  }
+  triangle.edge_a = { edge_a[0], edge_a[1], edge_a[2] };
+  triangle.edge_b = { edge_b[0], edge_b[1], edge_b[2] };
+  triangle.edge_c = { edge_c[0], edge_c[1], edge_c[2] };
+
+  // z = z0 * e12 + z1 * e20 + z2 * e01, over the area. Moved to the
+  // farthest corner of the pixel, so no part of it is nearer than stored.
+  const float32 inv_area = 1.0f / area;
+  triangle.depth = {
+    (z[0] * edge_a[1] + z[1] * edge_a[2] + z[2] * edge_a[0]) * inv_area,
+    (z[0] * edge_b[1] + z[1] * edge_b[2] + z[2] * edge_b[0]) * inv_area,
+    (z[0] * edge_c[1] + z[1] * edge_c[2] + z[2] * edge_c[0]) * inv_area,
+  };
+  triangle.depth.z += 0.5f * (fabsf(triangle.depth.x) + fabsf(triangle.depth.y));
+
+  const uint32 index = bin.triangles.size();
+  bin.triangles.push_back(triangle);
+  const int32 first_tile_x = triangle.min_x / kTileWidth;
+  const int32 first_tile_y = triangle.min_y / kTileHeight;
+  const int32 last_tile_x = (triangle.max_x - 1) / kTileWidth;
+  const int32 last_tile_y = (triangle.max_y - 1) / kTileHeight;
+  for (int32 tile_y = first_tile_y; tile_y <= last_tile_y; ++tile_y) {
+    for (int32 tile_x = first_tile_x; tile_x <= last_tile_x; ++tile_x) {
+      bin.tiles[tile_y * kTilesX + tile_x].push_back(index);
+    }
+  }
+}
+
+void OcclusionCuller::rasterizeTile(const int32 tile) {
+
+  const int32 tile_x = (tile % kTilesX) * kTileWidth;
+  const int32 tile_y = (tile / kTilesX) * kTileHeight;
+  float32* depth = depth_.data();
+  for (int32 y = tile_y; y < tile_y + kTileHeight; ++y) {
+    std::fill(depth + y * kWidth + tile_x, depth + y * kWidth + tile_x + kTileWidth, 1.0f);
+  }
+
+  const DirectX::XMVECTOR zero = DirectX::XMVectorZero();
+  const DirectX::XMVECTOR offsets = DirectX::XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+  for (uint32 b = 0; b < triangle_jobs_.size(); ++b) {
+    const Bin& bin = bins_[b];
+    const std::vector<uint32>& tile_triangles = bin.tiles[tile];
+    for (uint32 t = 0; t < tile_triangles.size(); ++t) {
+      const Triangle& triangle = bin.triangles[tile_triangles[t]];
+
+      // Groups of 4 pixels, aligned so they never leave the tile.
+      const int32 min_x = std::max(triangle.min_x, tile_x) & ~3;
+      const int32 max_x = std::min(triangle.max_x, tile_x + kTileWidth);
+      const int32 min_y = std::max(triangle.min_y, tile_y);
+      const int32 max_y = std::min(triangle.max_y, tile_y + kTileHeight);
+
+      const DirectX::XMVECTOR a0 = DirectX::XMVectorReplicate(triangle.edge_a.x);
+      const DirectX::XMVECTOR a1 = DirectX::XMVectorReplicate(triangle.edge_a.y);
+      const DirectX::XMVECTOR a2 = DirectX::XMVectorReplicate(triangle.edge_a.z);
+      const DirectX::XMVECTOR depth_a = DirectX::XMVectorReplicate(triangle.depth.x);
+      for (int32 y = min_y; y < max_y; ++y) {
+        const float32 center_y = (float32)y + 0.5f;
+        const DirectX::XMVECTOR row0 = DirectX::XMVectorReplicate(triangle.edge_b.x * center_y + triangle.edge_c.x);
+        const DirectX::XMVECTOR row1 = DirectX::XMVectorReplicate(triangle.edge_b.y * center_y + triangle.edge_c.y);
+        const DirectX::XMVECTOR row2 = DirectX::XMVectorReplicate(triangle.edge_b.z * center_y + triangle.edge_c.z);
+        const DirectX::XMVECTOR row_depth = DirectX::XMVectorReplicate(triangle.depth.y * center_y + triangle.depth.z);
+        float32* pixels = depth + y * kWidth;
+        for (int32 x = min_x; x < max_x; x += 4) {
+          const DirectX::XMVECTOR center_x = DirectX::XMVectorAdd(DirectX::XMVectorReplicate((float32)x), offsets);
+          DirectX::XMVECTOR inside = DirectX::XMVectorGreaterOrEqual(DirectX::XMVectorMultiplyAdd(a0, center_x, row0), zero);
+          inside = DirectX::XMVectorAndInt(inside, DirectX::XMVectorGreaterOrEqual(DirectX::XMVectorMultiplyAdd(a1, center_x, row1), zero));
+          inside = DirectX::XMVectorAndInt(inside, DirectX::XMVectorGreaterOrEqual(DirectX::XMVectorMultiplyAdd(a2, center_x, row2), zero));
+          const DirectX::XMVECTOR z = DirectX::XMVectorMultiplyAdd(depth_a, center_x, row_depth);
+          const DirectX::XMVECTOR previous = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)(pixels + x));
+          inside = DirectX::XMVectorAndInt(inside, DirectX::XMVectorLess(z, previous));
+          DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)(pixels + x), DirectX::XMVectorSelect(previous, z, inside));
+        }
+      }
+    }
+  }
+
+  // Farthest depth of every block of the tile.
+  for (int32 block_y = tile_y; block_y < tile_y + kTileHeight; block_y += kBlockSize) {
+    for (int32 block_x = tile_x; block_x < tile_x + kTileWidth; block_x += kBlockSize) {
+      DirectX::XMVECTOR farthest = zero;
+      for (int32 y = block_y; y < block_y + kBlockSize; ++y) {
+        const float32* pixels = depth + y * kWidth + block_x;
+        for (int32 x = 0; x < kBlockSize; x += 4) {
+          farthest = DirectX::XMVectorMax(farthest, DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)(pixels + x)));
+        }
+      }
+      farthest = DirectX::XMVectorMax(farthest, DirectX::XMVectorSwizzle<2, 3, 0, 1>(farthest));
+      farthest = DirectX::XMVectorMax(farthest, DirectX::XMVectorSwizzle<1, 0, 3, 2>(farthest));
+      blocks_[(block_y / kBlockSize) * kBlocksX + block_x / kBlockSize] = DirectX::XMVectorGetX(farthest);
+    }
+  }
+}
+
+}; /* W3D */
@@ -0,0 +1,250 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/pose_blender.h"
+#include <DirectXMath.h>
+
+namespace W3D {
+
+/// Four bones of a pose, one component of all of them per register.
+struct PoseGroup {
+  DirectX::XMVECTOR translation_x;
+  DirectX::XMVECTOR translation_y;
+  DirectX::XMVECTOR translation_z;
+  DirectX::XMVECTOR rotation_x;
+  DirectX::XMVECTOR rotation_y;
+  DirectX::XMVECTOR rotation_z;
+  DirectX::XMVECTOR rotation_w;
+};
+
+static PoseGroup LoadGroup(const Pose& pose, const uint32 bone) {
+  PoseGroup group;
+  group.translation_x = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.translation_x[bone]);
+  group.translation_y = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.translation_y[bone]);
+  group.translation_z = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.translation_z[bone]);
+  group.rotation_x = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.rotation_x[bone]);
+  group.rotation_y = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.rotation_y[bone]);
+  group.rotation_z = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.rotation_z[bone]);
+  group.rotation_w = DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&pose.rotation_w[bone]);
+  return group;
+}
+
+static void StoreGroup(const PoseGroup& group, const uint32 bone, Pose* pose) {
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->translation_x[bone], group.translation_x);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->translation_y[bone], group.translation_y);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->translation_z[bone], group.translation_z);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->rotation_x[bone], group.rotation_x);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->rotation_y[bone], group.rotation_y);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->rotation_z[bone], group.rotation_z);
+  DirectX::XMStoreFloat4((DirectX::XMFLOAT4*)&pose->rotation_w[bone], group.rotation_w);
+}
+
+/// Weight of four bones in a layer.
+static DirectX::XMVECTOR LayerWeight(const PoseBlender::Layer& layer, const uint32 bone) {
+  DirectX::XMVECTOR weight = DirectX::XMVectorReplicate(layer.weight);
+  if (layer.mask) {
+    weight = DirectX::XMVectorMultiply(weight,
+             DirectX::XMLoadFloat4((const DirectX::XMFLOAT4*)&layer.mask->weights[bone]));
+  }
+  return weight;
+}
+
+/// Normalizes four quaternions.
+static void NormalizeRotations(PoseGroup& group) {
+  DirectX::XMVECTOR length_sq = DirectX::XMVectorMultiply(group.rotation_x, group.rotation_x);
+  length_sq = DirectX::XMVectorMultiplyAdd(group.rotation_y, group.rotation_y, length_sq);
+  length_sq = DirectX::XMVectorMultiplyAdd(group.rotation_z, group.rotation_z, length_sq);
+  length_sq = DirectX::XMVectorMultiplyAdd(group.rotation_w, group.rotation_w, length_sq);
+  const DirectX::XMVECTOR inverse_length = DirectX::XMVectorReciprocalSqrt(length_sq);
+  group.rotation_x = DirectX::XMVectorMultiply(group.rotation_x, inverse_length);
+  group.rotation_y = DirectX::XMVectorMultiply(group.rotation_y, inverse_length);
+  group.rotation_z = DirectX::XMVectorMultiply(group.rotation_z, inverse_length);
+  group.rotation_w = DirectX::XMVectorMultiply(group.rotation_w, inverse_length);
+}
+
+/*******************************************************************************
+***                                BoneMask                                  ***
+*******************************************************************************/
+
+void BoneMask::init(const Skeleton& skeleton, const float32 weight) {
+  num_bones = skeleton.num_bones();
+  weights.assign((num_bones + 3) & ~3, weight);
+}
+
+void BoneMask::setBranch(const Skeleton& skeleton, const uint32 bone, const float32 weight) {
+  if (bone >= num_bones) { return; }
+
+  // Parents come first, so the branch is the bone and the ones after it
+  // whose parent is in the branch.
+  std::vector<bool> in_branch(num_bones, false);
+  for (uint32 i = bone; i < num_bones; ++i) {
+    const uint32 parent = skeleton.parent(i);
+    in_branch[i] = i == bone || (parent != Skeleton::kNoBone && in_branch[parent]);
+    if (in_branch[i]) { weights[i] = weight; }
+  }
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+PoseBlender::PoseBlender() {}
+
+PoseBlender::~PoseBlender() {
+  blend_layers_.clear();
+  additive_layers_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void PoseBlender::clear() {
+  blend_layers_.clear();
+  additive_layers_.clear();
+}
+
+void PoseBlender::addBlend(const Pose& pose, const float32 weight, const BoneMask* mask) {
+  blend_layers_.push_back({ &pose, nullptr, weight, mask });
+}
+
+void PoseBlender::addAdditive(const Pose& pose,
+                              const Pose& reference,
+                              const float32 weight,
+                              const BoneMask* mask) {
+  additive_layers_.push_back({ &pose, &reference, weight, mask });
+}
+
+void PoseBlender::blend(Pose* result) const {
+
+  const DirectX::XMVECTOR zero = DirectX::XMVectorZero();
+  const DirectX::XMVECTOR one = DirectX::XMVectorSplatOne();
+  const uint32 num_blend_layers = (uint32)blend_layers_.size();
+  const uint32 num_additive_layers = (uint32)additive_layers_.size();
+
+  for (uint32 bone = 0; bone < result->num_bones; bone += 4) {
+    PoseGroup group = LoadGroup(*result, bone);
+
+    if (num_blend_layers > 0) {
+      // Rotations are flipped to the side of the first layer ones before
+      // adding them, so the shortest path is taken.
+      const PoseGroup first = LoadGroup(*blend_layers_[0].pose, bone);
+      PoseGroup sum = { zero, zero, zero, zero, zero, zero, zero };
+      DirectX::XMVECTOR weight_sum = zero;
+      for (uint32 i = 0; i < num_blend_layers; ++i) {
+        const PoseGroup layer = i == 0 ? first : LoadGroup(*blend_layers_[i].pose, bone);
+        const DirectX::XMVECTOR weight = LayerWeight(blend_layers_[i], bone);
+        DirectX::XMVECTOR dot = DirectX::XMVectorMultiply(layer.rotation_x, first.rotation_x);
+        dot = DirectX::XMVectorMultiplyAdd(layer.rotation_y, first.rotation_y, dot);
+        dot = DirectX::XMVectorMultiplyAdd(layer.rotation_z, first.rotation_z, dot);
+        dot = DirectX::XMVectorMultiplyAdd(layer.rotation_w, first.rotation_w, dot);
+        const DirectX::XMVECTOR rotation_weight = DirectX::XMVectorSelect(weight, DirectX::XMVectorNegate(weight),
+                                                                          DirectX::XMVectorLess(dot, zero));
+        sum.translation_x = DirectX::XMVectorMultiplyAdd(layer.translation_x, weight, sum.translation_x);
+        sum.translation_y = DirectX::XMVectorMultiplyAdd(layer.translation_y, weight, sum.translation_y);
+        sum.translation_z = DirectX::XMVectorMultiplyAdd(layer.translation_z, weight, sum.translation_z);
+        sum.rotation_x = DirectX::XMVectorMultiplyAdd(layer.rotation_x, rotation_weight, sum.rotation_x);
+        sum.rotation_y = DirectX::XMVectorMultiplyAdd(layer.rotation_y, rotation_weight, sum.rotation_y);
+        sum.rotation_z = DirectX::XMVectorMultiplyAdd(layer.rotation_z, rotation_weight, sum.rotation_z);
+        sum.rotation_w = DirectX::XMVectorMultiplyAdd(layer.rotation_w, rotation_weight, sum.rotation_w);
+        weight_sum = DirectX::XMVectorAdd(weight_sum, weight);
+      }
+
+      // Bones without weight keep the result ones.
+      const DirectX::XMVECTOR weighted = DirectX::XMVectorGreater(weight_sum, zero);
+      const DirectX::XMVECTOR inverse_weight = DirectX::XMVectorDivide(one,
+                                               DirectX::XMVectorSelect(one, weight_sum, weighted));
+      sum.translation_x = DirectX::XMVectorMultiply(sum.translation_x, inverse_weight);
+      sum.translation_y = DirectX::XMVectorMultiply(sum.translation_y, inverse_weight);
+      sum.translation_z = DirectX::XMVectorMultiply(sum.translation_z, inverse_weight);
+      sum.rotation_w = DirectX::XMVectorSelect(one, sum.rotation_w, weighted);
+      NormalizeRotations(sum);
+      group.translation_x = DirectX::XMVectorSelect(group.translation_x, sum.translation_x, weighted);
+      group.translation_y = DirectX::XMVectorSelect(group.translation_y, sum.translation_y, weighted);
+      group.translation_z = DirectX::XMVectorSelect(group.translation_z, sum.translation_z, weighted);
+      group.rotation_x = DirectX::XMVectorSelect(group.rotation_x, sum.rotation_x, weighted);
+      group.rotation_y = DirectX::XMVectorSelect(group.rotation_y, sum.rotation_y, weighted);
+      group.rotation_z = DirectX::XMVectorSelect(group.rotation_z, sum.rotation_z, weighted);
+      group.rotation_w = DirectX::XMVectorSelect(group.rotation_w, sum.rotation_w, weighted);
+    }
+
+    for (uint32 i = 0; i < num_additive_layers; ++i) {
+      const Layer& additive = additive_layers_[i];
+      const PoseGroup layer = LoadGroup(*additive.pose, bone);
+      const PoseGroup reference = LoadGroup(*additive.reference, bone);
+      const DirectX::XMVECTOR weight = LayerWeight(additive, bone);
+
+      group.translation_x = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSubtract(layer.translation_x, reference.translation_x),
+                                                         weight, group.translation_x);
+      group.translation_y = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSubtract(layer.translation_y, reference.translation_y),
+                                                         weight, group.translation_y);
+      group.translation_z = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorSubtract(layer.translation_z, reference.translation_z),
+                                                         weight, group.translation_z);
+
+      // Difference, conjugate(reference) * pose, so reference * difference
+      // is the layer pose.
+      PoseGroup difference;
+      difference.rotation_w = DirectX::XMVectorMultiply(reference.rotation_w, layer.rotation_w);
+      difference.rotation_w = DirectX::XMVectorMultiplyAdd(reference.rotation_x, layer.rotation_x, difference.rotation_w);
+      difference.rotation_w = DirectX::XMVectorMultiplyAdd(reference.rotation_y, layer.rotation_y, difference.rotation_w);
+      difference.rotation_w = DirectX::XMVectorMultiplyAdd(reference.rotation_z, layer.rotation_z, difference.rotation_w);
+      difference.rotation_x = DirectX::XMVectorMultiply(reference.rotation_w, layer.rotation_x);
+      difference.rotation_x = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_x, layer.rotation_w, difference.rotation_x);
+      difference.rotation_x = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_y, layer.rotation_z, difference.rotation_x);
+      difference.rotation_x = DirectX::XMVectorMultiplyAdd(reference.rotation_z, layer.rotation_y, difference.rotation_x);
+      difference.rotation_y = DirectX::XMVectorMultiply(reference.rotation_w, layer.rotation_y);
+      difference.rotation_y = DirectX::XMVectorMultiplyAdd(reference.rotation_x, layer.rotation_z, difference.rotation_y);
+      difference.rotation_y = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_y, layer.rotation_w, difference.rotation_y);
+      difference.rotation_y = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_z, layer.rotation_x, difference.rotation_y);
+      difference.rotation_z = DirectX::XMVectorMultiply(reference.rotation_w, layer.rotation_z);
+      difference.rotation_z = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_x, layer.rotation_y, difference.rotation_z);
+      difference.rotation_z = DirectX::XMVectorMultiplyAdd(reference.rotation_y, layer.rotation_x, difference.rotation_z);
+      difference.rotation_z = DirectX::XMVectorNegativeMultiplySubtract(reference.rotation_z, layer.rotation_w, difference.rotation_z);
+
+      // Scaled by the weight from no rotation, by the shortest path.
+      const DirectX::XMVECTOR sign_weight = DirectX::XMVectorSelect(weight, DirectX::XMVectorNegate(weight),
+                                                                    DirectX::XMVectorLess(difference.rotation_w, zero));
+      const DirectX::XMVECTOR rest = DirectX::XMVectorSubtract(one, weight);
+      difference.rotation_x = DirectX::XMVectorMultiply(difference.rotation_x, sign_weight);
+      difference.rotation_y = DirectX::XMVectorMultiply(difference.rotation_y, sign_weight);
+      difference.rotation_z = DirectX::XMVectorMultiply(difference.rotation_z, sign_weight);
+      difference.rotation_w = DirectX::XMVectorMultiplyAdd(difference.rotation_w, sign_weight, rest);
+      NormalizeRotations(difference);
+
+      // group * difference.
+      const PoseGroup rotation = group;
+      group.rotation_w = DirectX::XMVectorMultiply(rotation.rotation_w, difference.rotation_w);
+      group.rotation_w = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_x, difference.rotation_x, group.rotation_w);
+      group.rotation_w = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_y, difference.rotation_y, group.rotation_w);
+      group.rotation_w = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_z, difference.rotation_z, group.rotation_w);
+      group.rotation_x = DirectX::XMVectorMultiply(rotation.rotation_w, difference.rotation_x);
+      group.rotation_x = DirectX::XMVectorMultiplyAdd(rotation.rotation_x, difference.rotation_w, group.rotation_x);
+      group.rotation_x = DirectX::XMVectorMultiplyAdd(rotation.rotation_y, difference.rotation_z, group.rotation_x);
+      group.rotation_x = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_z, difference.rotation_y, group.rotation_x);
+      group.rotation_y = DirectX::XMVectorMultiply(rotation.rotation_w, difference.rotation_y);
+      group.rotation_y = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_x, difference.rotation_z, group.rotation_y);
+      group.rotation_y = DirectX::XMVectorMultiplyAdd(rotation.rotation_y, difference.rotation_w, group.rotation_y);
+      group.rotation_y = DirectX::XMVectorMultiplyAdd(rotation.rotation_z, difference.rotation_x, group.rotation_y);
+      group.rotation_z = DirectX::XMVectorMultiply(rotation.rotation_w, difference.rotation_z);
+      group.rotation_z = DirectX::XMVectorMultiplyAdd(rotation.rotation_x, difference.rotation_y, group.rotation_z);
+      group.rotation_z = DirectX::XMVectorNegativeMultiplySubtract(rotation.rotation_y, difference.rotation_x, group.rotation_z);
+      group.rotation_z = DirectX::XMVectorMultiplyAdd(rotation.rotation_z, difference.rotation_w, group.rotation_z);
+    }
+
+    StoreGroup(group, bone, result);
+  }
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 PoseBlender::num_layers() const {
+  return (uint32)(blend_layers_.size() + additive_layers_.size());
+}
+
+}; /* W3D */
@@ -0,0 +1,193 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/significance_manager.h"
+#include "core/core.h"
+#include <DirectXCollision.h>
+#include <algorithm>
+
+namespace W3D {
+
+/// Weight of the last update in the expected cost of an object.
+const float32 kSignificanceCostWeight = 0.25f;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+SignificanceManager::SignificanceManager() {
+  tiers_[0] = { 0.15f, 1 };
+  tiers_[1] = { 0.05f, 2 };
+  tiers_[2] = { 0.015f, 4 };
+  tiers_[3] = { 0.0f, 8 };
+  budget_ms_ = 1.0f;
+  is_enabled_ = true;
+  frame_ = 0;
+  spent_ms_ = 0.0;
+  stats_ = { 0, 0, { 0, 0, 0, 0 }, 0, 0, 0, 0.0, 0.0 };
+}
+
+SignificanceManager::~SignificanceManager() {
+  objects_.clear();
+  due_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+uint32 SignificanceManager::add(const DirectX::XMFLOAT3& center, const float32 radius) {
+  Object object;
+  object.center = center;
+  object.radius = radius;
+  object.significance = 0.0f;
+  object.tier = 0;
+  object.frames_waited = 0;
+  object.elapsed = 0.0f;
+  object.cost_ms = 0.0f;
+  object.update_start = 0;
+  object.is_due = false;
+  objects_.push_back(object);
+  return (uint32)objects_.size() - 1;
+}
+
+void SignificanceManager::update(const float32 delta_time,
+                                 const DirectX::XMMATRIX& view,
+                                 const DirectX::XMMATRIX& projection) {
+
+  auto& core = Core::instance();
+  const bool occlusion = core.cam_.is_occlusion_culling_enabled_ && core.occlusion_culler_.ready();
+  const DirectX::XMMATRIX inverse_view = DirectX::XMMatrixInverse(nullptr, view);
+  const DirectX::XMVECTOR eye = inverse_view.r[3];
+  DirectX::BoundingFrustum frustum(projection);
+  frustum.Transform(frustum, inverse_view);
+  // Height of the screen at distance 1, the perspective scale in y.
+  DirectX::XMFLOAT4X4 projection_float4x4;
+  DirectX::XMStoreFloat4x4(&projection_float4x4, projection);
+  const float32 scale_y = projection_float4x4._22;
+
+  stats_ = { (uint32)objects_.size(), 0, { 0, 0, 0, 0 }, 0, 0, 0, 0.0, spent_ms_ };
+  spent_ms_ = 0.0;
+  due_.clear();
+
+  for (uint32 i = 0; i < objects_.size(); ++i) {
+    Object& object = objects_[i];
+    object.frames_waited++;
+    object.elapsed += delta_time;
+    object.is_due = false;
+
+    const DirectX::XMVECTOR center = DirectX::XMLoadFloat3(&object.center);
+    const float32 distance = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(center, eye)));
+    object.significance = distance > object.radius ?
+                          std::min(object.radius * scale_y / distance, 1.0f) : 1.0f;
+
+    bool visible = frustum.Contains(DirectX::BoundingSphere(object.center, object.radius)) != DirectX::DISJOINT;
+    if (visible && occlusion) {
+      const DirectX::BoundingBox box(object.center, DirectX::XMFLOAT3(object.radius, object.radius, object.radius));
+      visible = core.occlusion_culler_.testBox(box, DirectX::XMMatrixIdentity());
+    }
+    object.tier = kNumTiers - 1;
+    if (visible) {
+      stats_.num_visible++;
+      object.tier = 0;
+      while (object.tier < kNumTiers - 1 && object.significance < tiers_[object.tier].min_screen_size) {
+        object.tier++;
+      }
+    }
+    stats_.num_per_tier[object.tier]++;
+
+    if (!is_enabled_) {
+      object.is_due = true;
+      stats_.num_due++;
+      stats_.num_updated++;
+      stats_.expected_ms += object.cost_ms;
+      continue;
+    }
+
+    // Due on its own frame of the interval, or once it has waited that long.
+    const uint32 interval = std::max(tiers_[object.tier].interval, 1u);
+    if ((frame_ + i) % interval != 0 && object.frames_waited < interval) { continue; }
+    stats_.num_due++;
+    // The first tier and the objects skipped for a whole interval never wait.
+    if (object.tier == 0 || object.frames_waited >= interval * 2) {
+      object.is_due = true;
+      stats_.num_updated++;
+      stats_.expected_ms += object.cost_ms;
+    }
+    else {
+      due_.push_back(i);
+    }
+  }
+
+  // The longer an object waits the sooner it runs, even when small.
+  std::sort(due_.begin(), due_.end(), [this](const uint32 a, const uint32 b) {
+    return objects_[a].significance * (float32)objects_[a].frames_waited >
+           objects_[b].significance * (float32)objects_[b].frames_waited;
+  });
+  for (uint32 i = 0; i < due_.size(); ++i) {
+    Object& object = objects_[due_[i]];
+    if (stats_.expected_ms + object.cost_ms > budget_ms_) {
+      stats_.num_deferred++;
+      continue;
+    }
+    object.is_due = true;
+    stats_.num_updated++;
+    stats_.expected_ms += object.cost_ms;
+  }
+
+  frame_++;
+}
+
+void SignificanceManager::beginUpdate(const uint32 object) {
+  objects_[object].update_start = TimeInMicroSeconds();
+}
+
+void SignificanceManager::endUpdate(const uint32 object) {
+  Object& data = objects_[object];
+  const float32 cost_ms = (float32)(TimeInMicroSeconds() - data.update_start) * 0.001f;
+  data.cost_ms += (cost_ms - data.cost_ms) * kSignificanceCostWeight;
+  data.frames_waited = 0;
+  data.elapsed = 0.0f;
+  spent_ms_ += cost_ms;
+}
+
+void SignificanceManager::restart(const uint32 object) {
+  objects_[object].elapsed = 0.0f;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+void SignificanceManager::set_bounds(const uint32 object,
+                                     const DirectX::XMFLOAT3& center,
+                                     const float32 radius) {
+  objects_[object].center = center;
+  objects_[object].radius = radius;
+}
+
+bool SignificanceManager::isDue(const uint32 object) const {
+  return objects_[object].is_due;
+}
+
+float32 SignificanceManager::elapsed(const uint32 object) const {
+  return objects_[object].elapsed;
+}
+
+uint32 SignificanceManager::tier(const uint32 object) const {
+  return objects_[object].tier;
+}
+
+float32 SignificanceManager::significance(const uint32 object) const {
+  return objects_[object].significance;
+}
+
+const SignificanceManager::Stats& SignificanceManager::stats() const {
+  return stats_;
+}
+
+}; /* W3D */
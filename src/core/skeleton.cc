@@ -0,0 +1,74 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/skeleton.h"
+
+namespace W3D {
+
+/*******************************************************************************
+***                                  Pose                                    ***
+*******************************************************************************/
+
+void Pose::resize(const uint32 bones) {
+  num_bones = bones;
+  const uint32 padded = (bones + 3) & ~3;
+  translation_x.assign(padded, 0.0f);
+  translation_y.assign(padded, 0.0f);
+  translation_z.assign(padded, 0.0f);
+  rotation_x.assign(padded, 0.0f);
+  rotation_y.assign(padded, 0.0f);
+  rotation_z.assign(padded, 0.0f);
+  rotation_w.assign(padded, 1.0f);
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+Skeleton::Skeleton() {}
+
+Skeleton::~Skeleton() {
+  names_.clear();
+  parents_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+uint32 Skeleton::addBone(const char* name, const uint32 parent) {
+  if (parent != kNoBone && parent >= parents_.size()) { return kNoBone; }
+
+  names_.push_back(name);
+  parents_.push_back(parent);
+  return parents_.size() - 1;
+}
+
+uint32 Skeleton::find(const char* name) const {
+  for (uint32 i = 0; i < names_.size(); ++i) {
+    if (names_[i] == name) { return i; }
+  }
+  return kNoBone;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 Skeleton::num_bones() const {
+  return parents_.size();
+}
+
+const std::string& Skeleton::name(const uint32 bone) const {
+  return names_[bone];
+}
+
+uint32 Skeleton::parent(const uint32 bone) const {
+  return parents_[bone];
+}
+
+}; /* W3D */
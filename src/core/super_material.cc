@@ -12,13 +12,18 @@
 
 namespace W3D {
 
+/// Super material shader file.
+const char kShaderPath[] = "../data/materials/super_material.shader";
   
 /*******************************************************************************
 ***                        Constructor and destructor                        ***
 *******************************************************************************/
 
 SuperMaterial::SuperMaterial() {
-    
+  terrain_vertex_shader_ = nullptr;
+  terrain_buffer_ = nullptr;
+  packed_vertex_shader_ = nullptr;
+  packed_input_layout_ = nullptr;
 }
 
 SuperMaterial::~SuperMaterial() {
@@ -26,6 +31,10 @@ SuperMaterial::~SuperMaterial() {
   if (pixel_shader_) { pixel_shader_->Release(); }
   if (input_layout_) { input_layout_->Release(); }
   if (buffer_) { buffer_->Release(); }
+  if (terrain_vertex_shader_) { terrain_vertex_shader_->Release(); }
+  if (terrain_buffer_) { terrain_buffer_->Release(); }
+  if (packed_vertex_shader_) { packed_vertex_shader_->Release(); }
+  if (packed_input_layout_) { packed_input_layout_->Release(); }
 }
 
 /*******************************************************************************
@@ -35,12 +44,22 @@ SuperMaterial::~SuperMaterial() {
 bool SuperMaterial::init() {
 
   ID3D10Blob* vertex_shader;
+  ID3D10Blob* terrain_vertex_shader;
+  ID3D10Blob* packed_vertex_shader;
   ID3D10Blob* pixel_shader;
-  ID3D10Blob* error;
+  ID3D10Blob* error = nullptr;
+
+  FileView file;
+  if (!Core::instance().vfs_.open(kShaderPath, file)) {
+    MessageBox(NULL, "Shader Path Incorrrect", "Vertex Shader ERROR", MB_OK);
+    return false;
+  }
 
   // Vertex Shader
-  HRESULT result = D3DX11CompileFromFile("../data/materials/super_material.shader", 
-                                          NULL, 
+  HRESULT result = D3DX11CompileFromMemory((const char*)file.data(),
+                                          file.size(),
+                                          kShaderPath,
+                                          NULL,
                                           NULL, 
                                           "VertexShaderFunction", 
                                           "vs_4_0", 
@@ -62,10 +81,69 @@ bool SuperMaterial::init() {
   }
 
   if (error) { error->Release(); } // To clean vertex shader errors.
+  error = nullptr;
+
+  // Terrain Vertex Shader
+  result = D3DX11CompileFromMemory((const char*)file.data(),
+                                   file.size(),
+                                   kShaderPath,
+                                   NULL,
+                                   NULL,
+                                   "TerrainVertexShaderFunction",
+                                   "vs_4_0",
+                                   0,
+                                   0,
+                                   0,
+                                   &terrain_vertex_shader,
+                                   &error,
+                                   0);
+
+  if (result != S_OK) {
+    if (error) {
+      MessageBox(NULL, (char*)error->GetBufferPointer(), "Terrain Vertex Shader ERROR", MB_OK);
+    }
+    else {
+      MessageBox(NULL, "Terrain Vertex Shader Path Incorrrect", "Terrain Vertex Shader ERROR", MB_OK);
+    }
+    return false;
+  }
+
+  if (error) { error->Release(); } // To clean terrain vertex shader errors.
+  error = nullptr;
+
+  // Packed Vertex Shader
+  result = D3DX11CompileFromMemory((const char*)file.data(),
+                                   file.size(),
+                                   kShaderPath,
+                                   NULL,
+                                   NULL,
+                                   "PackedVertexShaderFunction",
+                                   "vs_4_0",
+                                   0,
+                                   0,
+                                   0,
+                                   &packed_vertex_shader,
+                                   &error,
+                                   0);
+
+  if (result != S_OK) {
+    if (error) {
+      MessageBox(NULL, (char*)error->GetBufferPointer(), "Packed Vertex Shader ERROR", MB_OK);
+    }
+    else {
+      MessageBox(NULL, "Packed Vertex Shader Path Incorrrect", "Packed Vertex Shader ERROR", MB_OK);
+    }
+    return false;
+  }
+
+  if (error) { error->Release(); } // To clean packed vertex shader errors.
+  error = nullptr;
 
   // Pixel Shader
-  HRESULT pixel_result = D3DX11CompileFromFile("../data/materials/super_material.shader",
-                                                NULL, 
+  HRESULT pixel_result = D3DX11CompileFromMemory((const char*)file.data(),
+                                                file.size(),
+                                                kShaderPath,
+                                                NULL,
                                                 NULL, 
                                                 "PixelShaderFunction", 
                                                 "ps_4_0", 
@@ -95,14 +173,26 @@ bool SuperMaterial::init() {
     { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 32, D3D11_INPUT_PER_VERTEX_DATA, 0 }
   };
 
+  // Packed Layout, Geo::PackedVertexData. Expanded to floats by the input assembler.
+  D3D11_INPUT_ELEMENT_DESC packed_layout_info[]{
+    { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "NORMAL", 0, DXGI_FORMAT_R10G10B10A2_UNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+    { "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+  };
+
   // Graphic Card Shader Creation.
   auto* device = Core::instance().d3d_.device();
   device->CreateVertexShader(vertex_shader->GetBufferPointer(), vertex_shader->GetBufferSize(), 0, &vertex_shader_);
+  device->CreateVertexShader(terrain_vertex_shader->GetBufferPointer(), terrain_vertex_shader->GetBufferSize(), 0, &terrain_vertex_shader_);
   device->CreatePixelShader(pixel_shader->GetBufferPointer(), pixel_shader->GetBufferSize(), 0, &pixel_shader_);
   device->CreateInputLayout(layout_info, 4, vertex_shader->GetBufferPointer(), vertex_shader->GetBufferSize(), &input_layout_);
+  device->CreateVertexShader(packed_vertex_shader->GetBufferPointer(), packed_vertex_shader->GetBufferSize(), 0, &packed_vertex_shader_);
+  device->CreateInputLayout(packed_layout_info, 4, packed_vertex_shader->GetBufferPointer(), packed_vertex_shader->GetBufferSize(), &packed_input_layout_);
 
   if (error) { error->Release(); }
   if (!createMatrixBuffer()) { return false; }
+  if (!createTerrainBuffer()) { return false; }
 
   return true;
 }
@@ -126,4 +216,22 @@ bool SuperMaterial::createMatrixBuffer() {
   return true;
 }
 
+bool SuperMaterial::createTerrainBuffer() {
+  D3D11_BUFFER_DESC terrain_description;
+  ZeroMemory(&terrain_description, sizeof(D3D11_BUFFER_DESC));
+
+  terrain_description.Usage = D3D11_USAGE_DYNAMIC;
+  terrain_description.ByteWidth = sizeof(TerrainSettings);
+  terrain_description.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+  terrain_description.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+  auto* device = Core::instance().d3d_.device();
+
+  if (FAILED(device->CreateBuffer(&terrain_description, NULL, &terrain_buffer_))) {
+    MessageBox(NULL, "ERROR - Terrain buffer not created", "ERROR", MB_OK);
+    return false;
+  }
+  return true;
+}
+
 }; /* W3D */
@@ -99,20 +99,18 @@ void SuperSprite::render(Sprite* sprite) {
   memcpy(shader_constant_buffer.pData, &super_mat.settings_, sizeof(MaterialSettings));
   device_context->Unmap(super_mat.buffer_, 0);
 
-  uint32 stride = sizeof(Geo::VertexData);
-  uint32 offset = 0;
-
   // Setup the render.
   device_context->OMSetBlendState(core.d3d_.blendState(), 0, 0xffffffff);
-  device_context->IASetVertexBuffers(0, 1, &geometry->vertex_buffer_, &stride, &offset);
-  device_context->IASetIndexBuffer(geometry->vertex_index_buffer_, DXGI_FORMAT_R32_UINT, 0);
+  core.geometry_arena_.bind(geometry->vertex_allocation_.pool, geometry->index_allocation_.pool);
   device_context->IASetPrimitiveTopology(geometry->topology_);
   device_context->VSSetShader(super_mat.vertex_shader_, 0, 0);
   device_context->PSSetShader(super_mat.pixel_shader_, 0, 0);
   device_context->VSSetConstantBuffers(0, 1, &super_mat.buffer_);
   device_context->PSSetConstantBuffers(0, 1, &super_mat.buffer_);
   device_context->IASetInputLayout(super_mat.input_layout_);
-  device_context->DrawIndexed(geometry->vertex_index_.size(), 0, 0);
+  device_context->DrawIndexed(geometry->index_allocation_.count,
+                              geometry->index_allocation_.offset,
+                              geometry->vertex_allocation_.offset);
 }
 
 
@@ -0,0 +1,56 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/terrain_mesh.h"
+
+namespace W3D {
+namespace TerrainMesh {
+
+/*******************************************************************************
+***                             Public functions                             ***
+*******************************************************************************/
+
+void GeneratePatch(const int32 num_quads,
+                   const DirectX::XMFLOAT4 color,
+                   std::vector<Geo::VertexData>& vertices,
+                   std::vector<uint32>& indices) {
+
+  const int32 num_points = num_quads + 1;
+  const int32 half = num_quads / 2;
+  const float32 inv_quads = 1.0f / (float32)num_quads;
+
+  vertices.resize(num_points * num_points);
+  for (int32 z = 0; z < num_points; ++z) {
+    for (int32 x = 0; x < num_points; ++x) {
+      vertices[z * num_points + x] = { { (float32)x * inv_quads, 0.0f, (float32)z * inv_quads },
+                                       { 0.0f, 1.0f, 0.0f },
+                                       { (float32)x * inv_quads, 1.0f - (float32)z * inv_quads },
+                                       color };
+    }
+  }
+
+  indices.resize(num_quads * num_quads * 6);
+  uint32* output = indices.data();
+  for (int32 quadrant = 0; quadrant < 4; ++quadrant) {
+    int32 first_x = (quadrant & 1) * half;
+    int32 first_z = (quadrant >> 1) * half;
+    for (int32 z = first_z; z < first_z + half; ++z) {
+      for (int32 x = first_x; x < first_x + half; ++x) {
+        uint32 corner = z * num_points + x;
+        *output++ = corner;
+        *output++ = corner + num_points;
+        *output++ = corner + 1;
+        *output++ = corner + 1;
+        *output++ = corner + num_points;
+        *output++ = corner + num_points + 1;
+      }
+    }
+  }
+}
+
+}; /* TerrainMesh */
+}; /* W3D */
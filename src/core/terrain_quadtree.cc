@@ -0,0 +1,439 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/terrain_quadtree.h"
+#include <float.h>
+#include <math.h>
+
+namespace W3D {
+
+/// Range of the leaves, in leaf sizes. Every level doubles the previous one.
+const float32 kLodRangeScale = 2.5f;
+/// Part of its range where a level starts morphing into the next one.
+const float32 kMorphStartRatio = 0.66f;
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+TerrainQuadTree::TerrainQuadTree() {
+  samples_ = { 0, 0 };
+  spacing_ = { 1.0f, 1.0f };
+  height_scale_ = 1.0f;
+  num_levels_ = 0;
+}
+
+TerrainQuadTree::~TerrainQuadTree() {}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void TerrainQuadTree::build(std::vector<uint16>& heights,
+                            const DirectX::XMINT2 samples,
+                            const DirectX::XMFLOAT2 spacing,
+                            const float32 max_height) {
+
+  heights_.swap(heights);
+  heights.clear();
+  samples_ = samples;
+  spacing_ = spacing;
+  height_scale_ = max_height / 65535.0f;
+
+  // Enough levels for the root to cover every quad.
+  int32 num_quads = samples.x > samples.y ? samples.x - 1 : samples.y - 1;
+  num_levels_ = 1;
+  while ((kPatchQuads << (num_levels_ - 1)) < num_quads) { num_levels_++; }
+
+  nodes_.clear();
+  buildNode(0, 0, num_levels_ - 1);
+
+  // The root has no coarser level to morph into, its range never ends.
+  float32 leaf_size = (float32)kPatchQuads * (spacing_.x > spacing_.y ? spacing_.x : spacing_.y);
+  lod_ranges_.resize(num_levels_);
+  morph_starts_.resize(num_levels_);
+  float32 previous_range = 0.0f;
+  for (int32 level = 0; level < num_levels_; ++level) {
+    lod_ranges_[level] = leaf_size * kLodRangeScale * (float32)(1 << level);
+    morph_starts_[level] = previous_range + (lod_ranges_[level] - previous_range) * kMorphStartRatio;
+    previous_range = lod_ranges_[level];
+  }
+  lod_ranges_[num_levels_ - 1] = FLT_MAX;
+  morph_starts_[num_levels_ - 1] = FLT_MAX * 0.5f;
+}
+
+const std::vector<TerrainQuadTree::Selection>& TerrainQuadTree::select(const DirectX::XMFLOAT3 camera_position,
+                                                                       const DirectX::BoundingFrustum& frustum) {
+  selection_.clear();
+  if (!nodes_.empty()) {
+    selectNode(0, camera_position, frustum);
+  }
+  return selection_;
+}
+
+float32 TerrainQuadTree::heightAt(const float32 x, const float32 z) const {
+
+  float32 sample_x = x / spacing_.x;
+  float32 sample_z = z / spacing_.y;
+  const float32 last_x = (float32)(samples_.x - 1);
+  const float32 last_z = (float32)(samples_.y - 1);
+  if (sample_x < 0.0f) { sample_x = 0.0f; }
+  if (sample_z < 0.0f) { sample_z = 0.0f; }
+  if (sample_x > last_x) { sample_x = last_x; }
+  if (sample_z > last_z) { sample_z = last_z; }
+
+  int32 x0 = (int32)sample_x;
+  int32 z0 = (int32)sample_z;
+  int32 x1 = x0 + 1 < samples_.x ? x0 + 1 : x0;
+  int32 z1 = z0 + 1 < samples_.y ? z0 + 1 : z0;
+  float32 tx = sample_x - (float32)x0;
+  float32 tz = sample_z - (float32)z0;
+
+  float32 h0 = sampleHeight(x0, z0) + (sampleHeight(x1, z0) - sampleHeight(x0, z0)) * tx;
+  float32 h1 = sampleHeight(x0, z1) + (sampleHeight(x1, z1) - sampleHeight(x0, z1)) * tx;
+  return h0 + (h1 - h0) * tz;
+}
+
+DirectX::XMFLOAT3 TerrainQuadTree::normalAt(const float32 x, const float32 z) const {
+
+  float32 left = heightAt(x - spacing_.x, z);
+  float32 right = heightAt(x + spacing_.x, z);
+  float32 back = heightAt(x, z - spacing_.y);
+  float32 front = heightAt(x, z + spacing_.y);
+
+  DirectX::XMFLOAT3 normal = { (left - right) / (2.0f * spacing_.x),
+                               1.0f,
+                               (back - front) / (2.0f * spacing_.y) };
+  DirectX::XMStoreFloat3(&normal, DirectX::XMVector3Normalize(DirectX::XMLoadFloat3(&normal)));
+  return normal;
+}
+
+bool TerrainQuadTree::raycast(const DirectX::XMFLOAT3 origin,
+                              const DirectX::XMFLOAT3 direction,
+                              const float32 max_distance,
+                              float32* distance) const {
+
+  if (nodes_.empty()) { return false; }
+
+  float32 enter, exit;
+  if (!rayNodeLimits(nodes_[0], origin, direction, &enter, &exit) || enter > max_distance) {
+    return false;
+  }
+  if (exit > max_distance) { exit = max_distance; }
+
+  return raycastNode(0, origin, direction, enter, exit, distance);
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+const TerrainQuadTree::Node& TerrainQuadTree::node(const int32 index) const {
+  return nodes_[index];
+}
+
+float32 TerrainQuadTree::lod_range(const int32 level) const {
+  return lod_ranges_[level];
+}
+
+float32 TerrainQuadTree::morph_start(const int32 level) const {
+  return morph_starts_[level];
+}
+
+DirectX::XMFLOAT2 TerrainQuadTree::sample_spacing() const {
+  return spacing_;
+}
+
+DirectX::XMINT2 TerrainQuadTree::samples() const {
+  return samples_;
+}
+
+float32 TerrainQuadTree::max_height() const {
+  return height_scale_ * 65535.0f;
+}
+
+uint32 TerrainQuadTree::num_nodes() const {
+  return nodes_.size();
+}
+
+const std::vector<uint16>& TerrainQuadTree::heights() const {
+  return heights_;
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+int32 TerrainQuadTree::buildNode(const int32 x,
+                                 const int32 z,
+                                 const int32 level) {
+
+  // Children are pushed while building, the node is written at the end.
+  int32 index = nodes_.size();
+  nodes_.push_back(Node());
+
+  Node node;
+  node.x = x;
+  node.z = z;
+  node.size = kPatchQuads << level;
+  node.level = level;
+  node.children[0] = node.children[1] = node.children[2] = node.children[3] = -1;
+
+  uint16 min_value = 65535;
+  uint16 max_value = 0;
+
+  if (level == 0) {
+    int32 last_x = x + node.size < samples_.x - 1 ? x + node.size : samples_.x - 1;
+    int32 last_z = z + node.size < samples_.y - 1 ? z + node.size : samples_.y - 1;
+    for (int32 j = z; j <= last_z; ++j) {
+      const uint16* row = heights_.data() + (uint64)j * samples_.x;
+      for (int32 i = x; i <= last_x; ++i) {
+        if (row[i] < min_value) { min_value = row[i]; }
+        if (row[i] > max_value) { max_value = row[i]; }
+      }
+    }
+    node.min_height = (float32)min_value * height_scale_;
+    node.max_height = (float32)max_value * height_scale_;
+  }
+  else {
+    int32 half = node.size / 2;
+    node.min_height = FLT_MAX;
+    node.max_height = -FLT_MAX;
+    for (int32 quadrant = 0; quadrant < 4; ++quadrant) {
+      int32 child_x = x + (quadrant & 1) * half;
+      int32 child_z = z + (quadrant >> 1) * half;
+      if (child_x >= samples_.x - 1 || child_z >= samples_.y - 1) { continue; }
+
+      int32 child = buildNode(child_x, child_z, level - 1);
+      node.children[quadrant] = child;
+      if (nodes_[child].min_height < node.min_height) { node.min_height = nodes_[child].min_height; }
+      if (nodes_[child].max_height > node.max_height) { node.max_height = nodes_[child].max_height; }
+    }
+  }
+
+  nodes_[index] = node;
+  return index;
+}
+
+bool TerrainQuadTree::selectNode(const int32 index,
+                                 const DirectX::XMFLOAT3& camera_position,
+                                 const DirectX::BoundingFrustum& frustum) {
+
+  const Node& node = nodes_[index];
+
+  // Out of range, the parent will draw this area with its level.
+  if (!isInRange(node, camera_position, lod_ranges_[node.level])) { return false; }
+
+  // Not visible, but handled.
+  if (!frustum.Intersects(bounds(node))) { return true; }
+
+  if (node.level == 0 ||
+      !isInRange(node, camera_position, lod_ranges_[node.level - 1])) {
+    selection_.push_back({ index, kAllQuadrants });
+    return true;
+  }
+
+  uint32 quadrants = 0;
+  for (int32 quadrant = 0; quadrant < 4; ++quadrant) {
+    int32 child = node.children[quadrant];
+    if (child >= 0 && !selectNode(child, camera_position, frustum)) {
+      quadrants |= 1 << quadrant;
+    }
+  }
+  if (quadrants) {
+    selection_.push_back({ index, quadrants });
+  }
+
+  return true;
+}
+
+DirectX::BoundingBox TerrainQuadTree::bounds(const Node& node) const {
+  int32 last_x = node.x + node.size < samples_.x - 1 ? node.x + node.size : samples_.x - 1;
+  int32 last_z = node.z + node.size < samples_.y - 1 ? node.z + node.size : samples_.y - 1;
+
+  DirectX::XMFLOAT3 min = { node.x * spacing_.x, node.min_height, node.z * spacing_.y };
+  DirectX::XMFLOAT3 max = { last_x * spacing_.x, node.max_height, last_z * spacing_.y };
+
+  DirectX::BoundingBox box;
+  DirectX::BoundingBox::CreateFromPoints(box, DirectX::XMLoadFloat3(&min), DirectX::XMLoadFloat3(&max));
+  return box;
+}
+
+bool TerrainQuadTree::isInRange(const Node& node,
+                                const DirectX::XMFLOAT3& camera_position,
+                                const float32 range) const {
+  if (range >= FLT_MAX) { return true; }
+  DirectX::BoundingSphere sphere(camera_position, range);
+  return sphere.Intersects(bounds(node));
+}
+
+float32 TerrainQuadTree::sampleHeight(const int32 x, const int32 z) const {
+  return (float32)heights_[(uint64)z * samples_.x + x] * height_scale_;
+}
+
+bool TerrainQuadTree::rayNodeLimits(const Node& node,
+                                    const DirectX::XMFLOAT3& origin,
+                                    const DirectX::XMFLOAT3& direction,
+                                    float32* enter,
+                                    float32* exit) const {
+
+  int32 last_x = node.x + node.size < samples_.x - 1 ? node.x + node.size : samples_.x - 1;
+  int32 last_z = node.z + node.size < samples_.y - 1 ? node.z + node.size : samples_.y - 1;
+  const float32 box_min[3] = { node.x * spacing_.x, node.min_height, node.z * spacing_.y };
+  const float32 box_max[3] = { last_x * spacing_.x, node.max_height, last_z * spacing_.y };
+  const float32 ray_origin[3] = { origin.x, origin.y, origin.z };
+  const float32 ray_direction[3] = { direction.x, direction.y, direction.z };
+
+  // Slabs, the height limits can be flat so the boxes are not strict.
+  float32 near_limit = 0.0f;
+  float32 far_limit = FLT_MAX;
+  for (int32 axis = 0; axis < 3; ++axis) {
+    if (ray_direction[axis] == 0.0f) {
+      if (ray_origin[axis] < box_min[axis] || ray_origin[axis] > box_max[axis]) { return false; }
+      continue;
+    }
+    float32 inverse = 1.0f / ray_direction[axis];
+    float32 t0 = (box_min[axis] - ray_origin[axis]) * inverse;
+    float32 t1 = (box_max[axis] - ray_origin[axis]) * inverse;
+    if (t0 > t1) { float32 swap = t0; t0 = t1; t1 = swap; }
+    if (t0 > near_limit) { near_limit = t0; }
+    if (t1 < far_limit) { far_limit = t1; }
+    if (near_limit > far_limit) { return false; }
+  }
+
+  *enter = near_limit;
+  *exit = far_limit;
+  return true;
+}
+
+bool TerrainQuadTree::raycastNode(const int32 index,
+                                  const DirectX::XMFLOAT3& origin,
+                                  const DirectX::XMFLOAT3& direction,
+                                  const float32 enter,
+                                  const float32 exit,
+                                  float32* distance) const {
+
+  const Node& node = nodes_[index];
+  if (node.level == 0) {
+    return raycastLeaf(node, origin, direction, enter, exit, distance);
+  }
+
+  // Children sorted by entry distance. They do not overlap in x and z, so
+  // a hit in one child is always nearer than any hit in the next ones.
+  int32 children[4];
+  float32 enters[4];
+  float32 exits[4];
+  int32 num_children = 0;
+  for (int32 quadrant = 0; quadrant < 4; ++quadrant) {
+    int32 child = node.children[quadrant];
+    float32 child_enter, child_exit;
+    if (child < 0 ||
+        !rayNodeLimits(nodes_[child], origin, direction, &child_enter, &child_exit)) {
+      continue;
+    }
+    if (child_enter < enter) { child_enter = enter; }
+    if (child_exit > exit) { child_exit = exit; }
+    if (child_enter > child_exit) { continue; }
+
+    int32 i = num_children++;
+    while (i > 0 && enters[i - 1] > child_enter) {
+      children[i] = children[i - 1];
+      enters[i] = enters[i - 1];
+      exits[i] = exits[i - 1];
+      i--;
+    }
+    children[i] = child;
+    enters[i] = child_enter;
+    exits[i] = child_exit;
+  }
+
+  for (int32 i = 0; i < num_children; ++i) {
+    if (raycastNode(children[i], origin, direction, enters[i], exits[i], distance)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool TerrainQuadTree::raycastLeaf(const Node& node,
+                                  const DirectX::XMFLOAT3& origin,
+                                  const DirectX::XMFLOAT3& direction,
+                                  const float32 enter,
+                                  const float32 exit,
+                                  float32* distance) const {
+
+  int32 last_x = node.x + node.size < samples_.x - 1 ? node.x + node.size : samples_.x - 1;
+  int32 last_z = node.z + node.size < samples_.y - 1 ? node.z + node.size : samples_.y - 1;
+
+  // Cell where the ray enters the leaf, clamped against rounding.
+  int32 cell_x = (int32)floorf((origin.x + direction.x * enter) / spacing_.x);
+  int32 cell_z = (int32)floorf((origin.z + direction.z * enter) / spacing_.y);
+  if (cell_x < node.x) { cell_x = node.x; }
+  if (cell_z < node.z) { cell_z = node.z; }
+  if (cell_x > last_x - 1) { cell_x = last_x - 1; }
+  if (cell_z > last_z - 1) { cell_z = last_z - 1; }
+
+  // Distances to the next cell border and between borders, per axis.
+  const int32 step_x = direction.x < 0.0f ? -1 : 1;
+  const int32 step_z = direction.z < 0.0f ? -1 : 1;
+  float32 next_x = FLT_MAX, next_z = FLT_MAX;
+  float32 delta_x = FLT_MAX, delta_z = FLT_MAX;
+  if (direction.x != 0.0f) {
+    next_x = ((float32)(cell_x + (step_x > 0 ? 1 : 0)) * spacing_.x - origin.x) / direction.x;
+    delta_x = spacing_.x / fabsf(direction.x);
+  }
+  if (direction.z != 0.0f) {
+    next_z = ((float32)(cell_z + (step_z > 0 ? 1 : 0)) * spacing_.y - origin.z) / direction.z;
+    delta_z = spacing_.y / fabsf(direction.z);
+  }
+
+  DirectX::XMVECTOR ray_origin = DirectX::XMLoadFloat3(&origin);
+  DirectX::XMVECTOR ray_direction = DirectX::XMLoadFloat3(&direction);
+
+  for (;;) {
+    // Same two triangles the patch grid uses.
+    float32 x0 = (float32)cell_x * spacing_.x;
+    float32 x1 = (float32)(cell_x + 1) * spacing_.x;
+    float32 z0 = (float32)cell_z * spacing_.y;
+    float32 z1 = (float32)(cell_z + 1) * spacing_.y;
+    DirectX::XMVECTOR p00 = DirectX::XMVectorSet(x0, sampleHeight(cell_x, cell_z), z0, 0.0f);
+    DirectX::XMVECTOR p10 = DirectX::XMVectorSet(x1, sampleHeight(cell_x + 1, cell_z), z0, 0.0f);
+    DirectX::XMVECTOR p01 = DirectX::XMVectorSet(x0, sampleHeight(cell_x, cell_z + 1), z1, 0.0f);
+    DirectX::XMVECTOR p11 = DirectX::XMVectorSet(x1, sampleHeight(cell_x + 1, cell_z + 1), z1, 0.0f);
+
+    float32 nearest = FLT_MAX;
+    float32 hit;
+    if (DirectX::TriangleTests::Intersects(ray_origin, ray_direction, p00, p01, p10, hit)) {
+      nearest = hit;
+    }
+    if (DirectX::TriangleTests::Intersects(ray_origin, ray_direction, p10, p01, p11, hit) &&
+        hit < nearest) {
+      nearest = hit;
+    }
+    if (nearest <= exit) {
+      *distance = nearest;
+      return true;
+    }
+
+    if (next_x < next_z) {
+      if (next_x > exit) { break; }
+      cell_x += step_x;
+      next_x += delta_x;
+      if (cell_x < node.x || cell_x >= last_x) { break; }
+    }
+    else {
+      if (next_z > exit) { break; }
+      cell_z += step_z;
+      next_z += delta_z;
+      if (cell_z < node.z || cell_z >= last_z) { break; }
+    }
+  }
+
+  return false;
+}
+
+}; /* W3D */
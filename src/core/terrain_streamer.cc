@@ -0,0 +1,303 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/terrain_streamer.h"
+#include "core/terrain_quadtree.h"
+#include "core/geo.h"
+#include "core/core.h"
+#include <algorithm>
+#include <math.h>
+
+namespace W3D {
+
+/// Default memory budget of the resident tiles.
+const uint64 kDefaultTerrainBudgetBytes = 64 * 1024 * 1024;
+/// Frames a failed tile waits before being requested again.
+const uint64 kTerrainRetryFrames = 60;
+
+static uint64 TileKey(const int32 x, const int32 z) {
+  return ((uint64)(uint32)z << 32) | (uint32)x;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+TerrainStreamer::TerrainStreamer() {
+  budget_bytes_ = kDefaultTerrainBudgetBytes;
+  ring_radius_ = 2;
+  max_loading_tiles_ = 4;
+  patch_ = nullptr;
+  num_tiles_ = { 0, 0 };
+  spacing_ = { 1.0f, 1.0f };
+  max_height_ = 1.0f;
+  color_ = { 1.0f, 1.0f, 1.0f, 1.0f };
+  ring_offsets_radius_ = -1;
+  resident_bytes_ = 0;
+  frame_ = 0;
+  num_loading_ = 0;
+}
+
+TerrainStreamer::~TerrainStreamer() {
+  // Tiles still loading are referenced by the loader.
+  Core::instance().loader_.flush();
+  for (auto& tile : tiles_) {
+    delete tile.second.geometry;
+    delete tile.second.coarse;
+  }
+  tiles_.clear();
+  if (patch_) { delete patch_; }
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+bool TerrainStreamer::init(const char* height_map_filename,
+                           const DirectX::XMFLOAT3 grid_size,
+                           const DirectX::XMFLOAT4 color) {
+
+  if (!source_.open(height_map_filename)) { return false; }
+
+  DirectX::XMINT2 samples = source_.size();
+  if (samples.x < 2 || samples.y < 2) {
+    MessageBox(NULL, "ERROR - Heightmap too small.", "ERROR", MB_OK);
+    return false;
+  }
+
+  // Same spacing as a terrain with the whole heightmap.
+  spacing_ = { grid_size.x / (float32)samples.x, grid_size.z / (float32)samples.y };
+  max_height_ = grid_size.y;
+  color_ = color;
+  num_tiles_ = { (samples.x - 2) / kTileQuads + 1, (samples.y - 2) / kTileQuads + 1 };
+
+  patch_ = new Geo();
+  patch_->buildTerrainPatch(color);
+  return patch_->createBuffers();
+}
+
+void TerrainStreamer::update(const DirectX::XMFLOAT3 camera_position) {
+
+  frame_++;
+
+  if (ring_offsets_radius_ != ring_radius_) {
+    ring_offsets_.clear();
+    for (int32 z = -ring_radius_; z <= ring_radius_; ++z) {
+      for (int32 x = -ring_radius_; x <= ring_radius_; ++x) {
+        ring_offsets_.push_back({ x, z });
+      }
+    }
+    std::sort(ring_offsets_.begin(), ring_offsets_.end(),
+              [](const DirectX::XMINT2& a, const DirectX::XMINT2& b) {
+                return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+              });
+    ring_offsets_radius_ = ring_radius_;
+  }
+
+  const float32 tile_size_x = spacing_.x * (float32)kTileQuads;
+  const float32 tile_size_z = spacing_.y * (float32)kTileQuads;
+  const int32 camera_x = (int32)floorf(camera_position.x / tile_size_x);
+  const int32 camera_z = (int32)floorf(camera_position.z / tile_size_z);
+
+  visible_.clear();
+  for (uint32 i = 0; i < ring_offsets_.size(); ++i) {
+    int32 x = camera_x + ring_offsets_[i].x;
+    int32 z = camera_z + ring_offsets_[i].y;
+    if (x < 0 || z < 0 || x >= num_tiles_.x || z >= num_tiles_.y) { continue; }
+
+    auto tile = tiles_.find(TileKey(x, z));
+    if (tile == tiles_.end()) {
+      requestTile(x, z);
+      tile = tiles_.find(TileKey(x, z));
+    }
+
+    // Coarse tiles never wait for a slot, they are tiny.
+    Tile& data = tile->second;
+    data.last_used_frame = frame_;
+    if (frame_ >= data.retry_frame) {
+      if (data.coarse->load_state_ == Geo::kLoadState_Failed) {
+        requestGeometry(x, z, data.coarse, kCoarseStride);
+      }
+      if (data.geometry->load_state_ == Geo::kLoadState_Failed && num_loading_ < max_loading_tiles_) {
+        requestGeometry(x, z, data.geometry, 1);
+      }
+    }
+
+    Geo* geometry = ReadyGeometry(data);
+    if (geometry) {
+      visible_.push_back({ geometry, { (float32)x * tile_size_x, 0.0f, (float32)z * tile_size_z } });
+    }
+  }
+
+  evict();
+}
+
+Geo* TerrainStreamer::tileAt(const float32 x, const float32 z, DirectX::XMFLOAT3* offset) const {
+
+  const float32 tile_size_x = spacing_.x * (float32)kTileQuads;
+  const float32 tile_size_z = spacing_.y * (float32)kTileQuads;
+  const int32 tile_x = (int32)floorf(x / tile_size_x);
+  const int32 tile_z = (int32)floorf(z / tile_size_z);
+  if (tile_x < 0 || tile_z < 0 || tile_x >= num_tiles_.x || tile_z >= num_tiles_.y) {
+    return nullptr;
+  }
+
+  auto tile = tiles_.find(TileKey(tile_x, tile_z));
+  Geo* geometry = tile != tiles_.end() ? ReadyGeometry(tile->second) : nullptr;
+  if (!geometry) { return nullptr; }
+
+  *offset = { (float32)tile_x * tile_size_x, 0.0f, (float32)tile_z * tile_size_z };
+  return geometry;
+}
+
+bool TerrainStreamer::raycast(const DirectX::XMFLOAT3 origin,
+                              const DirectX::XMFLOAT3 direction,
+                              const float32 max_distance,
+                              float32* distance) const {
+
+  const float32 tile_size_x = spacing_.x * (float32)kTileQuads;
+  const float32 tile_size_z = spacing_.y * (float32)kTileQuads;
+
+  // Every tile limits the next ones to nearer hits.
+  float32 nearest = max_distance;
+  bool hit = false;
+  for (auto& tile : tiles_) {
+    Geo* geometry = ReadyGeometry(tile.second);
+    if (!geometry) { continue; }
+    int32 tile_x = (int32)(tile.first & 0xFFFFFFFF);
+    int32 tile_z = (int32)(tile.first >> 32);
+    DirectX::XMFLOAT3 tile_origin = { origin.x - (float32)tile_x * tile_size_x,
+                                      origin.y,
+                                      origin.z - (float32)tile_z * tile_size_z };
+    float32 tile_distance;
+    if (geometry->terrain_tree_->raycast(tile_origin, direction, nearest, &tile_distance)) {
+      nearest = tile_distance;
+      hit = true;
+    }
+  }
+
+  if (hit) { *distance = nearest; }
+  return hit;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+const std::vector<TerrainStreamer::VisibleTile>& TerrainStreamer::visible_tiles() const {
+  return visible_;
+}
+
+Geo* TerrainStreamer::patch() const {
+  return patch_;
+}
+
+uint32 TerrainStreamer::num_tiles() const {
+  return tiles_.size();
+}
+
+uint64 TerrainStreamer::resident_bytes() const {
+  return resident_bytes_;
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+void TerrainStreamer::requestTile(const int32 x, const int32 z) {
+
+  Tile tile;
+  tile.geometry = new Geo();
+  tile.geometry->name_ = "Terrain Tile";
+  tile.geometry->load_state_ = Geo::kLoadState_Failed;
+  tile.coarse = new Geo();
+  tile.coarse->name_ = "Coarse Terrain Tile";
+  tile.last_used_frame = frame_;
+  tile.bytes = 0;
+  tile.retry_frame = 0;
+  tiles_[TileKey(x, z)] = tile;
+
+  // The tile is requested by update once there is room, as if it had failed.
+  requestGeometry(x, z, tile.coarse, kCoarseStride);
+}
+
+void TerrainStreamer::requestGeometry(const int32 x, const int32 z,
+                                      Geo* geometry, const int32 stride) {
+
+  DirectX::XMINT2 samples = source_.size();
+  DirectX::XMINT2 first_sample = { x * kTileQuads, z * kTileQuads };
+  DirectX::XMINT2 num_samples = { samples.x - first_sample.x, samples.y - first_sample.y };
+  if (num_samples.x > kTileQuads + 1) { num_samples.x = kTileQuads + 1; }
+  if (num_samples.y > kTileQuads + 1) { num_samples.y = kTileQuads + 1; }
+  // Coarse tiles round up, repeating the last samples of the heightmap.
+  num_samples = { (num_samples.x + stride - 2) / stride + 1, (num_samples.y + stride - 2) / stride + 1 };
+  DirectX::XMFLOAT2 spacing = { spacing_.x * (float32)stride, spacing_.y * (float32)stride };
+
+  geometry->load_state_ = Geo::kLoadState_Loading;
+  const bool coarse = stride != 1;
+  if (!coarse) { num_loading_++; }
+
+  uint64 key = TileKey(x, z);
+  Core::instance().loader_.load(geometry,
+    [this, geometry, first_sample, num_samples, spacing, stride](const char**) {
+      return geometry->buildTerrainTile(source_, first_sample, num_samples,
+                                        spacing, max_height_, color_, stride);
+    },
+    [this, geometry, key, num_samples, coarse](const bool parsed) {
+      bool uploaded = parsed && geometry->createHeightTexture();
+      geometry->load_state_ = uploaded ? Geo::kLoadState_Ready : Geo::kLoadState_Failed;
+      if (!coarse) { num_loading_--; }
+
+      // Heights, in the height texture and in the quadtree, and the nodes.
+      Tile& tile = tiles_[key];
+      if (uploaded) {
+        uint64 bytes = (uint64)num_samples.x * num_samples.y * sizeof(uint16) * 2 +
+                       geometry->terrain_tree_->num_nodes() * sizeof(TerrainQuadTree::Node);
+        tile.bytes += bytes;
+        resident_bytes_ += bytes;
+      }
+      else {
+        tile.retry_frame = frame_ + kTerrainRetryFrames;
+      }
+      return uploaded;
+    },
+    nullptr);
+}
+
+Geo* TerrainStreamer::ReadyGeometry(const Tile& tile) {
+  if (tile.geometry->load_state_ == Geo::kLoadState_Ready) { return tile.geometry; }
+  if (tile.coarse->load_state_ == Geo::kLoadState_Ready) { return tile.coarse; }
+  return nullptr;
+}
+
+void TerrainStreamer::evict() {
+
+  while (resident_bytes_ > budget_bytes_) {
+    auto oldest = tiles_.end();
+    for (auto tile = tiles_.begin(); tile != tiles_.end(); ++tile) {
+      if (tile->second.last_used_frame == frame_ ||
+          tile->second.geometry->load_state_ == Geo::kLoadState_Loading ||
+          tile->second.coarse->load_state_ == Geo::kLoadState_Loading) {
+        continue;
+      }
+      if (oldest == tiles_.end() ||
+          tile->second.last_used_frame < oldest->second.last_used_frame) {
+        oldest = tile;
+      }
+    }
+
+    // Everything left is in the ring, the budget is too small for it.
+    if (oldest == tiles_.end()) { break; }
+
+    resident_bytes_ -= oldest->second.bytes;
+    delete oldest->second.geometry;
+    delete oldest->second.coarse;
+    tiles_.erase(oldest);
+  }
+}
+
+}; /* W3D */
@@ -21,7 +21,9 @@ namespace W3D {
 Texture::Texture() {
   texture_handle_ = nullptr;
   sampler_state_ = nullptr;
+  staging_texture_ = nullptr;
   name_ = "";
+  load_state_ = kLoadState_Ready;
 }
 
 Texture::~Texture() {
@@ -33,6 +35,10 @@ Texture::~Texture() {
     sampler_state_->Release();
     sampler_state_ = nullptr;
   }
+  if (staging_texture_) {
+    staging_texture_->Release();
+    staging_texture_ = nullptr;
+  }
 }
 
 /*******************************************************************************
@@ -41,51 +47,114 @@ Texture::~Texture() {
 
 bool Texture::initFromFile(const char* texture_path) {
 
-  HRESULT result;
+  HRESULT result = E_FAIL;
+  auto& core = Core::instance();
 
-  result = D3DX11CreateShaderResourceViewFromFile(Core::instance().d3d_.device(), 
-                                                  texture_path, 
-                                                  NULL, 
-                                                  NULL, 
-                                                  &texture_handle_, 
-                                                  NULL);
+  FileView file;
+  if (core.vfs_.open(texture_path, file)) {
+    result = D3DX11CreateShaderResourceViewFromMemory(core.d3d_.device(),
+                                                      file.data(),
+                                                      file.size(),
+                                                      NULL,
+                                                      NULL,
+                                                      &texture_handle_,
+                                                      NULL);
+  }
 
-  auto& core = Core::instance();
   if (FAILED(result)) {
     MessageBox(NULL, "Error loading texture", "ERROR", MB_OK);
     uint32 id = core.error_texture_.id();
     return false;
   }
 
-  D3D11_SAMPLER_DESC sampler_description;
-  sampler_description.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
-  sampler_description.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
-  sampler_description.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
-  sampler_description.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
-  sampler_description.MipLODBias = 0.0f;
-  sampler_description.MaxAnisotropy = 1;
-  sampler_description.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
-  sampler_description.BorderColor[0] = 0;
-  sampler_description.BorderColor[1] = 0;
-  sampler_description.BorderColor[2] = 0;
-  sampler_description.BorderColor[3] = 0;
-  sampler_description.MinLOD = 0;
-  sampler_description.MaxLOD = D3D11_FLOAT32_MAX;
+  if (!createSampler()) { return false; }
+
+  name_ = texture_path;
+  return true;
+}
+
+bool Texture::decodeFromFile(const char* texture_path, const char** error) {
+
+  HRESULT result = E_FAIL;
+  auto& core = Core::instance();
+
+  // Decoded into a staging resource, the device is free threaded and the
+  // copy to the final texture is done later in the main thread.
+  D3DX11_IMAGE_LOAD_INFO load_info;
+  load_info.Usage = D3D11_USAGE_STAGING;
+  load_info.BindFlags = 0;
+  load_info.CpuAccessFlags = D3D11_CPU_ACCESS_READ;
+
+  FileView file;
+  ID3D11Resource* resource = nullptr;
+  if (core.vfs_.open(texture_path, file)) {
+    result = D3DX11CreateTextureFromMemory(core.d3d_.device(),
+                                           file.data(),
+                                           file.size(),
+                                           &load_info,
+                                           NULL,
+                                           &resource,
+                                           NULL);
+  }
 
-  // Create the texture sampler state.
-  result = core.d3d_.device()->CreateSamplerState(&sampler_description, &sampler_state_);
-  
   if (FAILED(result)) {
-    MessageBox(NULL, "Error sampling texture", "ERROR", MB_OK);
-    uint32 id = core.error_texture_.id();
+    ReportLoadError("Error loading texture", error);
+    return false;
+  }
+
+  result = resource->QueryInterface(__uuidof(ID3D11Texture2D), (void**)&staging_texture_);
+  resource->Release();
+  if (FAILED(result)) {
+    ReportLoadError("Error loading texture, only 2D textures supported", error);
     return false;
   }
 
-  name_ = texture_path;
   return true;
 }
 
+bool Texture::createFromDecoded() {
+
+  if (!staging_texture_) { return false; }
+
+  auto& core = Core::instance();
+  D3D11_TEXTURE2D_DESC description;
+  staging_texture_->GetDesc(&description);
+  description.Usage = D3D11_USAGE_DEFAULT;
+  description.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+  description.CPUAccessFlags = 0;
+
+  ID3D11Texture2D* texture = nullptr;
+  if (FAILED(core.d3d_.device()->CreateTexture2D(&description, NULL, &texture))) {
+    MessageBox(NULL, "Error creating texture", "ERROR", MB_OK);
+    return false;
+  }
+
+  core.d3d_.deviceContext()->CopyResource(texture, staging_texture_);
+  staging_texture_->Release();
+  staging_texture_ = nullptr;
+
+  HRESULT result = core.d3d_.device()->CreateShaderResourceView(texture, NULL, &texture_handle_);
+  texture->Release();
+  if (FAILED(result)) {
+    MessageBox(NULL, "Error creating texture view", "ERROR", MB_OK);
+    return false;
+  }
+
+  return createSampler();
+}
+
 void Texture::use(const uint32 texture_slot, const bool pixel_shader_access) {
+
+  // Textures still loading use the error texture meanwhile.
+  if (load_state_ != kLoadState_Ready) {
+    auto& core = Core::instance();
+    Texture* error_texture = core.texture_factory_[core.error_texture_.id()];
+    if (error_texture != this) {
+      error_texture->use(texture_slot, pixel_shader_access);
+    }
+    return;
+  }
+
   if (texture_handle_) {
     auto* dev_context = Core::instance().d3d_.deviceContext();
     if (pixel_shader_access) {
@@ -103,6 +172,41 @@ void Texture::use(const uint32 texture_slot, const bool pixel_shader_access) {
 
 }
 
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+bool Texture::createSampler() {
+
+  auto& core = Core::instance();
+  HRESULT result;
+
+  D3D11_SAMPLER_DESC sampler_description;
+  sampler_description.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+  sampler_description.AddressU = D3D11_TEXTURE_ADDRESS_WRAP;
+  sampler_description.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
+  sampler_description.AddressW = D3D11_TEXTURE_ADDRESS_WRAP;
+  sampler_description.MipLODBias = 0.0f;
+  sampler_description.MaxAnisotropy = 1;
+  sampler_description.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+  sampler_description.BorderColor[0] = 0;
+  sampler_description.BorderColor[1] = 0;
+  sampler_description.BorderColor[2] = 0;
+  sampler_description.BorderColor[3] = 0;
+  sampler_description.MinLOD = 0;
+  sampler_description.MaxLOD = D3D11_FLOAT32_MAX;
+
+  // Create the texture sampler state.
+  result = core.d3d_.device()->CreateSamplerState(&sampler_description, &sampler_state_);
+  
+  if (FAILED(result)) {
+    MessageBox(NULL, "Error sampling texture", "ERROR", MB_OK);
+    return false;
+  }
+
+  return true;
+}
+
 
 
 }; /* W3D */
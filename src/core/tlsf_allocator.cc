@@ -0,0 +1,271 @@
+/** Copyright Julio Picardo 2017-18, all rights reserved.
+*
+*  @project Wolfy3D
+*  @authors Julio Marcelo Picardo <juliomarcelopicardo@gmail.com>
+*
+*/
+
+#include "core/tlsf_allocator.h"
+#include <intrin.h>
+
+namespace W3D {
+
+/// Index of the lowest bit set, value can't be 0.
+static uint32 LowestBit(const uint32 value) {
+  unsigned long index;
+  _BitScanForward(&index, value);
+  return (uint32)index;
+}
+
+/// Index of the highest bit set, value can't be 0.
+static uint32 HighestBit(const uint32 value) {
+  unsigned long index;
+  _BitScanReverse(&index, value);
+  return (uint32)index;
+}
+
+/*******************************************************************************
+***                        Constructor and destructor                        ***
+*******************************************************************************/
+
+TlsfAllocator::TlsfAllocator() {
+  init(0);
+}
+
+TlsfAllocator::~TlsfAllocator() {
+  blocks_.clear();
+  unused_blocks_.clear();
+}
+
+/*******************************************************************************
+***                               Public methods                             ***
+*******************************************************************************/
+
+void TlsfAllocator::init(const uint32 size) {
+
+  blocks_.clear();
+  unused_blocks_.clear();
+  for (uint32 i = 0; i < kFirstLevels; ++i) {
+    second_level_bitmaps_[i] = 0;
+    for (uint32 j = 0; j < kSecondLevels; ++j) { free_heads_[i][j] = kInvalidHandle; }
+  }
+  first_level_bitmap_ = 0;
+  last_block_ = kInvalidHandle;
+  size_ = size;
+  used_ = 0;
+  num_allocations_ = 0;
+
+  if (size == 0) { return; }
+
+  uint32 block = newBlock();
+  blocks_[block] = { 0, size, kInvalidHandle, kInvalidHandle, kInvalidHandle, kInvalidHandle, false };
+  insertFree(block);
+  last_block_ = block;
+}
+
+uint32 TlsfAllocator::allocate(const uint32 size, uint32* offset) {
+
+  const uint32 wanted = size > 0 ? size : 1;
+  uint32 block = findFree(wanted);
+  if (block == kInvalidHandle) { return kInvalidHandle; }
+  removeFree(block);
+
+  // The rest of the block goes back to the free lists.
+  if (blocks_[block].size > wanted) {
+    uint32 rest = newBlock();
+    Block& used = blocks_[block];
+    blocks_[rest] = { used.offset + wanted, used.size - wanted, block, used.next_physical,
+                      kInvalidHandle, kInvalidHandle, false };
+    if (used.next_physical != kInvalidHandle) {
+      blocks_[used.next_physical].previous_physical = rest;
+    }
+    else {
+      last_block_ = rest;
+    }
+    used.next_physical = rest;
+    used.size = wanted;
+    insertFree(rest);
+  }
+
+  blocks_[block].free = false;
+  used_ += wanted;
+  num_allocations_++;
+  *offset = blocks_[block].offset;
+  return block;
+}
+
+void TlsfAllocator::release(const uint32 handle) {
+
+  if (handle >= blocks_.size() || blocks_[handle].free) { return; }
+
+  uint32 block = handle;
+  used_ -= blocks_[block].size;
+  num_allocations_--;
+
+  // Merges with the free neighbours, the first block of the range survives.
+  uint32 previous = blocks_[block].previous_physical;
+  if (previous != kInvalidHandle && blocks_[previous].free) {
+    removeFree(previous);
+    blocks_[previous].size += blocks_[block].size;
+    blocks_[previous].next_physical = blocks_[block].next_physical;
+    if (blocks_[block].next_physical != kInvalidHandle) {
+      blocks_[blocks_[block].next_physical].previous_physical = previous;
+    }
+    if (last_block_ == block) { last_block_ = previous; }
+    unused_blocks_.push_back(block);
+    block = previous;
+  }
+
+  uint32 next = blocks_[block].next_physical;
+  if (next != kInvalidHandle && blocks_[next].free) {
+    removeFree(next);
+    blocks_[block].size += blocks_[next].size;
+    blocks_[block].next_physical = blocks_[next].next_physical;
+    if (blocks_[next].next_physical != kInvalidHandle) {
+      blocks_[blocks_[next].next_physical].previous_physical = block;
+    }
+    if (last_block_ == next) { last_block_ = block; }
+    unused_blocks_.push_back(next);
+  }
+
+  insertFree(block);
+}
+
+void TlsfAllocator::grow(const uint32 new_size) {
+
+  if (new_size <= size_) { return; }
+  const uint32 added = new_size - size_;
+
+  if (last_block_ != kInvalidHandle && blocks_[last_block_].free) {
+    removeFree(last_block_);
+    blocks_[last_block_].size += added;
+    insertFree(last_block_);
+  }
+  else {
+    uint32 block = newBlock();
+    blocks_[block] = { size_, added, last_block_, kInvalidHandle,
+                       kInvalidHandle, kInvalidHandle, false };
+    if (last_block_ != kInvalidHandle) { blocks_[last_block_].next_physical = block; }
+    last_block_ = block;
+    insertFree(block);
+  }
+
+  size_ = new_size;
+}
+
+/*******************************************************************************
+***                           Setters & Getters                              ***
+*******************************************************************************/
+
+uint32 TlsfAllocator::size() const {
+  return size_;
+}
+
+uint32 TlsfAllocator::used() const {
+  return used_;
+}
+
+uint32 TlsfAllocator::num_allocations() const {
+  return num_allocations_;
+}
+
+/*******************************************************************************
+***                              Private methods                             ***
+*******************************************************************************/
+
+void TlsfAllocator::Mapping(const uint32 size, uint32* first_level, uint32* second_level) {
+  // Sizes under kSecondLevels get a class each.
+  if (size < kSecondLevels) {
+    *first_level = 0;
+    *second_level = size;
+    return;
+  }
+  uint32 log2 = HighestBit(size);
+  *first_level = log2 - kSecondLevelBits + 1;
+  *second_level = (size >> (log2 - kSecondLevelBits)) ^ kSecondLevels;
+}
+
+uint32 TlsfAllocator::newBlock() {
+  if (!unused_blocks_.empty()) {
+    uint32 block = unused_blocks_.back();
+    unused_blocks_.pop_back();
+    return block;
+  }
+  blocks_.push_back(Block());
+  return blocks_.size() - 1;
+}
+
+void TlsfAllocator::insertFree(const uint32 block) {
+  uint32 first_level, second_level;
+  Mapping(blocks_[block].size, &first_level, &second_level);
+
+  uint32& head = free_heads_[first_level][second_level];
+  blocks_[block].free = true;
+  blocks_[block].previous_free = kInvalidHandle;
+  blocks_[block].next_free = head;
+  if (head != kInvalidHandle) { blocks_[head].previous_free = block; }
+  head = block;
+
+  first_level_bitmap_ |= 1 << first_level;
+  second_level_bitmaps_[first_level] |= 1 << second_level;
+}
+
+void TlsfAllocator::removeFree(const uint32 block) {
+  uint32 first_level, second_level;
+  Mapping(blocks_[block].size, &first_level, &second_level);
+
+  Block& removed = blocks_[block];
+  if (removed.previous_free != kInvalidHandle) {
+    blocks_[removed.previous_free].next_free = removed.next_free;
+  }
+  else {
+    free_heads_[first_level][second_level] = removed.next_free;
+  }
+  if (removed.next_free != kInvalidHandle) {
+    blocks_[removed.next_free].previous_free = removed.previous_free;
+  }
+  removed.free = false;
+
+  if (free_heads_[first_level][second_level] == kInvalidHandle) {
+    second_level_bitmaps_[first_level] &= ~(1 << second_level);
+    if (second_level_bitmaps_[first_level] == 0) {
+      first_level_bitmap_ &= ~(1 << first_level);
+    }
+  }
+}
+
+uint32 TlsfAllocator::findFree(const uint32 size) const {
+
+  // Rounded up to the next class, so any block of the class found fits.
+  uint32 rounded = size;
+  if (size >= kSecondLevels) {
+    uint32 round = (1 << (HighestBit(size) - kSecondLevelBits)) - 1;
+    if (size > 0xFFFFFFFF - round) { return kInvalidHandle; }
+    rounded += round;
+  }
+
+  uint32 first_level, second_level;
+  Mapping(rounded, &first_level, &second_level);
+
+  uint32 second_map = second_level_bitmaps_[first_level] & (0xFFFFFFFF << second_level);
+  if (second_map == 0 && first_level + 1 < kFirstLevels) {
+    uint32 first_map = first_level_bitmap_ & (0xFFFFFFFF << (first_level + 1));
+    if (first_map != 0) {
+      first_level = LowestBit(first_map);
+      second_map = second_level_bitmaps_[first_level];
+    }
+  }
+  if (second_map != 0) {
+    return free_heads_[first_level][LowestBit(second_map)];
+  }
+
+  // Nothing in the bigger classes, some block of the size class may fit.
+  Mapping(size, &first_level, &second_level);
+  uint32 block = free_heads_[first_level][second_level];
+  while (block != kInvalidHandle && blocks_[block].size < size) {
+    block = blocks_[block].next_free;
+  }
+  return block;
+}
+
+}; /* W3D */
@@ -56,8 +56,13 @@ bool Wnd::startFrame(const float32 delta_seconds) {
   if (!updateMessages()) {
     return false;
   }
+  core.loader_.update();
   core.cam_.update(delta_seconds);
   core.d3d_.startRenderFrame(0.4f, 0.5f, 1.0f, 1.0f);
+  // The interface binds its own buffers at the end of the frame.
+  core.geometry_arena_.beginFrame();
+  // Vertices edited during the last frame, once for every draw of this one.
+  core.geometry_arena_.uploadDirty();
   return true;
 }
 
@@ -81,6 +86,8 @@ bool Wnd::updateMessages() {
 
 void Wnd::shutdown() {
 	ImGui_ImplDX11_Shutdown();
+  Core::instance().jobs_.shutdown();
+  Core::instance().geometry_arena_.shutdown();
   Core::instance().d3d_.shutdown();
 }
 